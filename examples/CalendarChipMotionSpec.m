@@ -16,68 +16,82 @@
 
 #import "CalendarChipMotionSpec.h"
 
-static id<MDMTimingCurve> StandardTimingCurve(void) {
-  return [CAMediaTimingFunction functionWithControlPoints:0.4f :0.0f :0.2f :1.0f];
-}
-
-static id<MDMTimingCurve> LinearTimingCurve(void) {
-  return [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
-}
-
-@interface CalendarChipExpansionTiming: NSObject <CalendarChipTiming>
+#import "MotionAnimator.h"
+
+enum {
+  StandardTimingCurve,
+  LinearTimingCurve,
+};
+
+static const MDMMotionSpecCurve kTimingCurves[] = {
+  [StandardTimingCurve] = MDMMotionSpecCubicBezier(0.4, 0.0, 0.2, 1.0),
+  [LinearTimingCurve] = MDMMotionSpecCubicBezier(0.0, 0.0, 1.0, 1.0),
+};
+
+typedef NS_ENUM(NSUInteger, CalendarChipTimingEntry) {
+  CalendarChipTimingChipWidth,
+  CalendarChipTimingChipHeight,
+  CalendarChipTimingChipY,
+  CalendarChipTimingChipContentOpacity,
+  CalendarChipTimingHeaderContentOpacity,
+};
+
+static const MDMMotionSpecEntry kExpansionEntries[] = {
+  [CalendarChipTimingChipWidth] = MDMMotionSpecEntryMake(0.000, 0.285, StandardTimingCurve),
+  [CalendarChipTimingChipHeight] = MDMMotionSpecEntryMake(0.015, 0.360, StandardTimingCurve),
+  [CalendarChipTimingChipY] = MDMMotionSpecEntryMake(0.015, 0.360, StandardTimingCurve),
+  [CalendarChipTimingChipContentOpacity] = MDMMotionSpecEntryMake(0.000, 0.075, LinearTimingCurve),
+  [CalendarChipTimingHeaderContentOpacity] = MDMMotionSpecEntryMake(0.075, 0.150, LinearTimingCurve),
+};
+
+static const MDMMotionSpecEntry kCollapseEntries[] = {
+  [CalendarChipTimingChipWidth] = MDMMotionSpecEntryMake(0.045, 0.330, StandardTimingCurve),
+  [CalendarChipTimingChipHeight] = MDMMotionSpecEntryMake(0.000, 0.330, StandardTimingCurve),
+  [CalendarChipTimingChipY] = MDMMotionSpecEntryMake(0.015, 0.330, StandardTimingCurve),
+  [CalendarChipTimingChipContentOpacity] = MDMMotionSpecEntryMake(0.150, 0.150, LinearTimingCurve),
+  [CalendarChipTimingHeaderContentOpacity] = MDMMotionSpecEntryMake(0.000, 0.075, LinearTimingCurve),
+};
+
+static const MDMMotionSpecTable kExpansionTable = MDMMotionSpecTableMake(kTimingCurves,
+                                                                         kExpansionEntries);
+static const MDMMotionSpecTable kCollapseTable = MDMMotionSpecTableMake(kTimingCurves,
+                                                                        kCollapseEntries);
+
+// Serves a compiled spec's traits, which are created once and shared by every reader.
+@interface CalendarChipCompiledTiming: NSObject <CalendarChipTiming>
+- (instancetype)initWithSpec:(MDMCompiledMotionSpec *)spec;
 @end
 
-@implementation CalendarChipExpansionTiming
-
-- (MDMAnimationTraits *)chipWidth {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.000 duration:0.285 timingCurve:StandardTimingCurve()];
-}
-
-- (MDMAnimationTraits *)chipHeight {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.015 duration:0.360 timingCurve:StandardTimingCurve()];
-}
-
-- (MDMAnimationTraits *)chipY {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.015 duration:0.360 timingCurve:StandardTimingCurve()];
-}
-
-- (MDMAnimationTraits *)chipContentOpacity {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.000 duration:0.075 timingCurve:LinearTimingCurve()];
-}
-
-- (MDMAnimationTraits *)headerContentOpacity {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.075 duration:0.150 timingCurve:LinearTimingCurve()];
+@implementation CalendarChipCompiledTiming {
+  MDMCompiledMotionSpec *_spec;
 }
 
-- (MDMAnimationTraits *)navigationBarY {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.015 duration:0.360 timingCurve:StandardTimingCurve()];
+- (instancetype)initWithSpec:(MDMCompiledMotionSpec *)spec {
+  self = [super init];
+  if (self) {
+    _spec = spec;
+  }
+  return self;
 }
 
-@end
-
-@interface CalendarChipCollapseTiming: NSObject <CalendarChipTiming>
-@end
-
-@implementation CalendarChipCollapseTiming
-
 - (MDMAnimationTraits *)chipWidth {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.045 duration:0.330 timingCurve:StandardTimingCurve()];
+  return _spec[CalendarChipTimingChipWidth];
 }
 
 - (MDMAnimationTraits *)chipHeight {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.000 duration:0.330 timingCurve:StandardTimingCurve()];
+  return _spec[CalendarChipTimingChipHeight];
 }
 
 - (MDMAnimationTraits *)chipY {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.015 duration:0.330 timingCurve:StandardTimingCurve()];
+  return _spec[CalendarChipTimingChipY];
 }
 
 - (MDMAnimationTraits *)chipContentOpacity {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.150 duration:0.150 timingCurve:LinearTimingCurve()];
+  return _spec[CalendarChipTimingChipContentOpacity];
 }
 
 - (MDMAnimationTraits *)headerContentOpacity {
-  return [[MDMAnimationTraits alloc] initWithDelay:0.000 duration:0.075 timingCurve:LinearTimingCurve()];
+  return _spec[CalendarChipTimingHeaderContentOpacity];
 }
 
 @end
@@ -85,12 +99,23 @@ static id<MDMTimingCurve> LinearTimingCurve(void) {
 @implementation CalendarChipMotionSpec
 
 + (id<CalendarChipTiming>)expansion {
-  return [[CalendarChipExpansionTiming alloc] init];
+  static CalendarChipCompiledTiming *expansion = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    MDMCompiledMotionSpec *spec = [MDMCompiledMotionSpec specWithTable:&kExpansionTable];
+    expansion = [[CalendarChipCompiledTiming alloc] initWithSpec:spec];
+  });
+  return expansion;
 }
 
 + (id<CalendarChipTiming>)collapse {
-  return [[CalendarChipCollapseTiming alloc] init];
+  static CalendarChipCompiledTiming *collapse = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    MDMCompiledMotionSpec *spec = [MDMCompiledMotionSpec specWithTable:&kCollapseTable];
+    collapse = [[CalendarChipCompiledTiming alloc] initWithSpec:spec];
+  });
+  return collapse;
 }
 
 @end
-
@@ -0,0 +1,114 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <CoreGraphics/CoreGraphics.h>
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+
+#ifdef IS_BAZEL_BUILD
+#import <MotionInterchange/MotionInterchange.h>
+#else
+#import <MotionInterchange/MotionInterchange.h>
+#endif
+
+#import "MDMAnimatableKeyPaths.h"
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+/**
+ An immutable set of prepared animations, created by an MDMAnimationPlanBuilder and applied to
+ their layers with -[MDMMotionAnimator applyPlan:completion:].
+
+ Plans are safe to pass between threads and may be applied more than once.
+ */
+NS_SWIFT_NAME(AnimationPlan)
+@interface MDMAnimationPlan : NSObject
+
+/**
+ The number of animations in the plan, including those that only change their layer's value.
+ */
+@property(nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ Plans are created by MDMAnimationPlanBuilder.
+ */
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ Builds animation plans on any thread.
+
+ A builder performs the work of the animator's animateWithTraits:between: family of methods that
+ doesn't involve the layer: resolving traits and spring constants, computing additive
+ displacements and initial velocities, and scaling durations and delays. Layers are retained but
+ never read or written, so plans can be built while the next screen is prepared in the background.
+ Applying the plan on the main thread then only writes the model values and adds the animations.
+
+ Plan animations always begin at the first of their values, as if beginFromCurrentState were
+ disabled. The transaction-scoped time scale factor of CATransaction is not consulted.
+
+ A builder may be used from any thread, but not from several threads at once.
+ */
+NS_SWIFT_NAME(AnimationPlanBuilder)
+@interface MDMAnimationPlanBuilder : NSObject
+
+/**
+ The scaling factor to apply to the durations and delays of subsequently added animations.
+
+ 1.0 by default.
+ */
+@property(nonatomic, assign) CGFloat timeScaleFactor;
+
+/**
+ Whether subsequently added animations are additive where their key path and values allow it. See
+ -[MDMMotionAnimator additive].
+
+ Enabled by default.
+ */
+@property(nonatomic, assign) BOOL additive;
+
+/**
+ The number of animations added since the builder was created or last built a plan.
+ */
+@property(nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ Adds an animation of the layer's key path between the given values to the plan.
+
+ @param traits  The traits to be used for the animation.
+
+ @param values  The values to be used in the animation. Must contain exactly two values. Supported
+                UIKit types will be coerced to their Core Animation equivalent.
+
+ @param layer   The layer to be animated.
+
+ @param keyPath The key path of the property to be animated.
+ */
+- (void)animateWithTraits:(nonnull MDMAnimationTraits *)traits
+                  between:(nonnull NSArray *)values
+                    layer:(nonnull CALayer *)layer
+                  keyPath:(nonnull MDMAnimatableKeyPath)keyPath;
+
+/**
+ Returns a plan of the animations added so far and empties the builder.
+ */
+- (nonnull MDMAnimationPlan *)build;
+
+@end
+
+API_DEPRECATED_END
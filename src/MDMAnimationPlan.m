@@ -0,0 +1,131 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMAnimationPlan.h"
+
+#import "private/CABasicAnimation+MotionAnimator.h"
+#import "private/MDMAnimationPlan+Private.h"
+#import "private/MDMDragCoefficient.h"
+#import "private/MDMUIKitValueCoercion.h"
+
+@interface MDMAnimationPlanStep ()
+- (instancetype)initWithLayer:(CALayer *)layer
+                      keyPath:(NSString *)keyPath
+                   modelValue:(id)modelValue
+                    animation:(CABasicAnimation *)animation
+                        delay:(CFTimeInterval)delay;
+@end
+
+@interface MDMAnimationPlan ()
+- (instancetype)initWithSteps:(NSArray<MDMAnimationPlanStep *> *)steps;
+@end
+
+@implementation MDMAnimationPlanStep
+
+- (instancetype)initWithLayer:(CALayer *)layer
+                      keyPath:(NSString *)keyPath
+                   modelValue:(id)modelValue
+                    animation:(CABasicAnimation *)animation
+                        delay:(CFTimeInterval)delay {
+  self = [super init];
+  if (self) {
+    _layer = layer;
+    _keyPath = [keyPath copy];
+    _modelValue = modelValue;
+    _animation = animation;
+    _delay = delay;
+  }
+  return self;
+}
+
+@end
+
+@implementation MDMAnimationPlan
+
+- (instancetype)initWithSteps:(NSArray<MDMAnimationPlanStep *> *)steps {
+  self = [super init];
+  if (self) {
+    _steps = [steps copy];
+  }
+  return self;
+}
+
+- (NSUInteger)count {
+  return _steps.count;
+}
+
+@end
+
+@implementation MDMAnimationPlanBuilder {
+  NSMutableArray<MDMAnimationPlanStep *> *_steps;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _steps = [NSMutableArray array];
+    _timeScaleFactor = 1;
+    _additive = YES;
+  }
+  return self;
+}
+
+- (NSUInteger)count {
+  return _steps.count;
+}
+
+- (void)animateWithTraits:(MDMAnimationTraits *)traits
+                  between:(NSArray *)values
+                    layer:(CALayer *)layer
+                  keyPath:(MDMAnimatableKeyPath)keyPath {
+  NSAssert([values count] == 2, @"The values array must contain exactly two values.");
+  MDMValueClass valueClass = MDMValueClassUnknown;
+  values = MDMCoerceUIKitValuesToCoreAnimationValues(values, &valueClass);
+
+  // Mirrors -[MDMMotionAnimator addAnimation:toLayer:withKeyPath:...], minus everything that
+  // depends on the layer's state or on the time at which the animation is added.
+  CGFloat timeScaleFactor = MDMSimulatorAnimationDragCoefficient() * _timeScaleFactor;
+  CABasicAnimation *animation = nil;
+  CFTimeInterval delay = 0;
+  if (timeScaleFactor != 0) {
+    animation = MDMAnimationFromTraits(traits, timeScaleFactor);
+  }
+  if (animation != nil) {
+    animation.keyPath = keyPath;
+    animation.toValue = [values lastObject];
+    animation.additive = _additive && MDMCanAnimationBeAdditive(keyPath, valueClass);
+    animation.fromValue = [values firstObject];
+    MDMConfigureAnimation(animation, traits, valueClass, NULL);
+    if (traits.delay != 0) {
+      delay = traits.delay * timeScaleFactor;
+      animation.fillMode = kCAFillModeBackwards;
+    }
+  }
+
+  [_steps addObject:[[MDMAnimationPlanStep alloc] initWithLayer:layer
+                                                         keyPath:keyPath
+                                                      modelValue:[values lastObject]
+                                                       animation:animation
+                                                           delay:delay]];
+}
+
+- (MDMAnimationPlan *)build {
+  MDMAnimationPlan *plan = [[MDMAnimationPlan alloc] initWithSteps:_steps];
+  [_steps removeAllObjects];
+  return plan;
+}
+
+@end
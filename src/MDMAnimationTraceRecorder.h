@@ -0,0 +1,97 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+/**
+ Records the work performed by every MDMMotionAnimator in the process into a fixed-size ring buffer
+ of timestamped events.
+
+ Unlike the tracers registered with MDMCoreAnimationTraceable, the recorder doesn't invoke any
+ code per animation. It records when animation traits are converted into Core Animation
+ animations, when animations are configured and registered, when implicit animation blocks
+ capture their actions, and when completion blocks are invoked. Once the buffer is full, the
+ oldest events are overwritten.
+
+ Recording is cheap and the instrumentation costs next to nothing while no recorder is recording,
+ so the recorder can be left in production builds and started when jank needs to be diagnosed.
+
+ At most one recorder records at any given time. Recorders must be used from the main thread.
+ */
+NS_SWIFT_NAME(AnimationTraceRecorder)
+@interface MDMAnimationTraceRecorder : NSObject
+
+/**
+ Creates a recorder holding up to 4096 events.
+ */
+- (nonnull instancetype)init;
+
+/**
+ Creates a recorder holding up to the given number of events, which must be greater than zero.
+
+ The recorder's storage is allocated up front.
+ */
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ The maximum number of events held by the recorder.
+ */
+@property(nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+ Whether the recorder is currently recording.
+ */
+@property(nonatomic, assign, readonly, getter=isRecording) BOOL recording;
+
+/**
+ The number of events currently held by the recorder.
+ */
+@property(nonatomic, assign, readonly) NSUInteger eventCount;
+
+/**
+ The number of events that were overwritten because the recorder was full.
+ */
+@property(nonatomic, assign, readonly) uint64_t droppedEventCount;
+
+/**
+ Starts recording events, stopping any other recorder that is currently recording.
+ */
+- (void)startRecording;
+
+/**
+ Stops recording events. Recorded events are kept.
+ */
+- (void)stopRecording;
+
+/**
+ Removes every recorded event.
+ */
+- (void)removeAllEvents;
+
+/**
+ Returns the recorded events in Chrome's trace event JSON format, which can be opened with
+ chrome://tracing or https://ui.perfetto.dev.
+
+ Timestamps share their timebase with CACurrentMediaTime.
+ */
+- (nonnull NSData *)chromeTraceData;
+
+@end
+
+API_DEPRECATED_END
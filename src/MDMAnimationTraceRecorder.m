@@ -0,0 +1,88 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMAnimationTraceRecorder.h"
+
+#import "private/MDMTraceBuffer.h"
+
+static const NSUInteger kDefaultCapacity = 4096;
+
+static void AppendToData(void *context, const char *bytes, size_t length) {
+  [(__bridge NSMutableData *)context appendBytes:bytes length:length];
+}
+
+@implementation MDMAnimationTraceRecorder {
+  MDMTraceBuffer *_buffer;
+}
+
+- (instancetype)init {
+  return [self initWithCapacity:kDefaultCapacity];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+  NSAssert(capacity > 0, @"The capacity must be greater than zero.");
+  self = [super init];
+  if (self) {
+    _buffer = MDMTraceBufferCreate(MAX(capacity, 1u));
+    _capacity = _buffer != NULL ? MDMTraceBufferCapacity(_buffer) : 0;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  // Also stops recording if this recorder is the active one.
+  MDMTraceBufferDestroy(_buffer);
+}
+
+- (BOOL)isRecording {
+  return _buffer != NULL && MDMTraceActiveBuffer == _buffer;
+}
+
+- (NSUInteger)eventCount {
+  return _buffer != NULL ? MDMTraceBufferCount(_buffer) : 0;
+}
+
+- (uint64_t)droppedEventCount {
+  return _buffer != NULL ? MDMTraceBufferDroppedCount(_buffer) : 0;
+}
+
+- (void)startRecording {
+  if (_buffer != NULL) {
+    MDMTraceBufferSetActive(_buffer);
+  }
+}
+
+- (void)stopRecording {
+  if (self.isRecording) {
+    MDMTraceBufferSetActive(NULL);
+  }
+}
+
+- (void)removeAllEvents {
+  if (_buffer != NULL) {
+    MDMTraceBufferRemoveAll(_buffer);
+  }
+}
+
+- (NSData *)chromeTraceData {
+  NSMutableData *data = [NSMutableData data];
+  if (_buffer != NULL) {
+    MDMTraceBufferWriteChromeJSON(_buffer, AppendToData, (__bridge void *)data);
+  }
+  return data;
+}
+
+@end
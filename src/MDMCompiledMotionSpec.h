@@ -0,0 +1,99 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+#ifdef IS_BAZEL_BUILD
+#import <MotionInterchange/MotionInterchange.h>
+#else
+#import <MotionInterchange/MotionInterchange.h>
+#endif
+
+#import "MDMMotionSpecTable.h"
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+/**
+ An immutable motion spec backed by an MDMMotionSpecTable.
+
+ A compiled spec vends one MDMAnimationTraits instance per entry of its table. Each instance is
+ created the first time it is requested and reused from then on, so reading traits from a spec
+ does not allocate. Timing curves are shared across every spec in the process.
+
+ Specs are interned: creating a spec with the same contents as an existing spec returns the
+ existing spec. Interned specs live for the remainder of the process.
+
+ Compiled specs are safe to use from any thread. The traits they vend are shared and must not be
+ modified; copy them first if you need to make changes.
+ */
+NS_SWIFT_NAME(CompiledMotionSpec)
+@interface MDMCompiledMotionSpec : NSObject
+
+/**
+ Returns the spec described by the given table, or nil if the table is invalid.
+
+ The table's curves and entries are used in place and must remain valid for the remainder of the
+ process, e.g. by being declared with static storage duration.
+ */
++ (nullable instancetype)specWithTable:(nonnull const MDMMotionSpecTable *)table;
+
+/**
+ Returns the spec serialized in the given data, or nil if the data is not a valid serialized table.
+
+ The data is retained and used in place where its alignment allows it.
+ */
++ (nullable instancetype)specWithData:(nonnull NSData *)data;
+
+/**
+ Memory-maps the file at the given path and returns the spec serialized in it.
+
+ Returns nil if the file could not be read or does not contain a valid serialized table, in which
+ case the error is in NSCocoaErrorDomain.
+ */
++ (nullable instancetype)specWithContentsOfFile:(nonnull NSString *)path
+                                          error:(NSError * _Nullable * _Nullable)error;
+
+/**
+ The spec's table in the format read by specWithData:. See MDMMotionSpecTableSerialize.
+ */
+@property(nonatomic, strong, nonnull, readonly) NSData *serializedData;
+
+/**
+ The number of entries in the spec.
+ */
+@property(nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ Returns the traits of the entry at the given index.
+
+ The returned instance is shared and must not be modified.
+ */
+- (nonnull MDMAnimationTraits *)traitsAtIndex:(NSUInteger)index;
+
+/**
+ Equivalent to traitsAtIndex:.
+ */
+- (nonnull MDMAnimationTraits *)objectAtIndexedSubscript:(NSUInteger)index;
+
+/**
+ Compiled specs are created with the class methods above.
+ */
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
+
+API_DEPRECATED_END
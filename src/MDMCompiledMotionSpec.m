@@ -0,0 +1,215 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMCompiledMotionSpec.h"
+
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+
+#pragma mark - Private
+
+// Specs with the same contents share a single instance. Keyed by MDMMotionSpecTableHash.
+static NSMutableDictionary<NSNumber *, NSMutableArray<MDMCompiledMotionSpec *> *> *sInternedSpecs;
+static os_unfair_lock sInternedSpecsLock = OS_UNFAIR_LOCK_INIT;
+
+// Timing curves shared by every spec, keyed by the curve's kind and parameters.
+static NSMutableDictionary<NSData *, id<MDMTimingCurve>> *sInternedCurves;
+static os_unfair_lock sInternedCurvesLock = OS_UNFAIR_LOCK_INIT;
+
+static id<MDMTimingCurve> CreateTimingCurve(const MDMMotionSpecCurve *curve) {
+  const double *parameters = curve->parameters;
+  switch (curve->kind) {
+    case MDMMotionSpecCurveKindCubicBezier:
+      return [CAMediaTimingFunction functionWithControlPoints:(float)parameters[0]
+                                                            :(float)parameters[1]
+                                                            :(float)parameters[2]
+                                                            :(float)parameters[3]];
+    case MDMMotionSpecCurveKindSpring:
+      return [[MDMSpringTimingCurve alloc] initWithMass:(CGFloat)parameters[0]
+                                                tension:(CGFloat)parameters[1]
+                                               friction:(CGFloat)parameters[2]
+                                        initialVelocity:(CGFloat)parameters[3]];
+  }
+  return nil;
+}
+
+static id<MDMTimingCurve> InternedTimingCurve(const MDMMotionSpecCurve *curve) {
+  NSMutableData *key = [NSMutableData dataWithBytes:&curve->kind length:sizeof(curve->kind)];
+  [key appendBytes:curve->parameters length:sizeof(curve->parameters)];
+
+  os_unfair_lock_lock(&sInternedCurvesLock);
+  id<MDMTimingCurve> timingCurve = sInternedCurves[key];
+  os_unfair_lock_unlock(&sInternedCurvesLock);
+  if (timingCurve != nil) {
+    return timingCurve;
+  }
+
+  id<MDMTimingCurve> createdTimingCurve = CreateTimingCurve(curve);
+  os_unfair_lock_lock(&sInternedCurvesLock);
+  if (!sInternedCurves) {
+    sInternedCurves = [NSMutableDictionary dictionary];
+  }
+  // Another thread may have created the same curve in the meantime.
+  timingCurve = sInternedCurves[key];
+  if (timingCurve == nil) {
+    timingCurve = createdTimingCurve;
+    sInternedCurves[key] = timingCurve;
+  }
+  os_unfair_lock_unlock(&sInternedCurvesLock);
+  return timingCurve;
+}
+
+@implementation MDMCompiledMotionSpec {
+  MDMMotionSpecTable _table;
+
+  // Backs the table when the spec was created from serialized data.
+  NSData *_data;
+
+  // One retained MDMAnimationTraits instance per entry, created on demand.
+  CFTypeRef *_traits;
+  os_unfair_lock _traitsLock;
+}
+
+- (instancetype)initWithTable:(const MDMMotionSpecTable *)table data:(NSData *)data {
+  self = [super init];
+  if (self) {
+    _table = *table;
+    _data = data;
+    _traits = calloc(MAX(table->entryCount, 1u), sizeof(CFTypeRef));
+    _traitsLock = OS_UNFAIR_LOCK_INIT;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  for (uint32_t i = 0; i < _table.entryCount; ++i) {
+    if (_traits[i] != NULL) {
+      CFRelease(_traits[i]);
+    }
+  }
+  free(_traits);
+}
+
+// Returns the interned spec with the table's contents, creating it if necessary.
++ (instancetype)internedSpecWithTable:(const MDMMotionSpecTable *)table data:(NSData *)data {
+  NSNumber *hash = @(MDMMotionSpecTableHash(table));
+
+  os_unfair_lock_lock(&sInternedSpecsLock);
+  if (!sInternedSpecs) {
+    sInternedSpecs = [NSMutableDictionary dictionary];
+  }
+  NSMutableArray<MDMCompiledMotionSpec *> *candidates = sInternedSpecs[hash];
+  MDMCompiledMotionSpec *spec = nil;
+  for (MDMCompiledMotionSpec *candidate in candidates) {
+    if (MDMMotionSpecTableEqual(&candidate->_table, table)) {
+      spec = candidate;
+      break;
+    }
+  }
+  if (spec == nil) {
+    spec = [[self alloc] initWithTable:table data:data];
+    if (spec != nil) {
+      if (!candidates) {
+        candidates = [NSMutableArray arrayWithCapacity:1];
+        sInternedSpecs[hash] = candidates;
+      }
+      [candidates addObject:spec];
+    }
+  }
+  os_unfair_lock_unlock(&sInternedSpecsLock);
+  return spec;
+}
+
+#pragma mark - Public
+
++ (instancetype)specWithTable:(const MDMMotionSpecTable *)table {
+  if (!MDMMotionSpecTableValidate(table)) {
+    return nil;
+  }
+  return [self internedSpecWithTable:table data:nil];
+}
+
++ (instancetype)specWithData:(NSData *)data {
+  MDMMotionSpecTable table;
+  if (!MDMMotionSpecTableInitWithBytes(&table, data.bytes, data.length)) {
+    // Heap allocations are suitably aligned, so a copy succeeds if misalignment was the problem.
+    data = [NSData dataWithBytes:data.bytes length:data.length];
+    if (!MDMMotionSpecTableInitWithBytes(&table, data.bytes, data.length)) {
+      return nil;
+    }
+  }
+  return [self internedSpecWithTable:&table data:data];
+}
+
++ (instancetype)specWithContentsOfFile:(NSString *)path error:(NSError **)error {
+  NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:error];
+  if (data == nil) {
+    return nil;
+  }
+  MDMCompiledMotionSpec *spec = [self specWithData:data];
+  if (spec == nil && error) {
+    *error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                 code:NSFileReadCorruptFileError
+                             userInfo:@{NSFilePathErrorKey: path}];
+  }
+  return spec;
+}
+
+- (NSData *)serializedData {
+  NSMutableData *data = [NSMutableData dataWithLength:MDMMotionSpecTableSerializedSize(&_table)];
+  MDMMotionSpecTableSerialize(&_table, data.mutableBytes, data.length);
+  return data;
+}
+
+- (NSUInteger)count {
+  return _table.entryCount;
+}
+
+- (MDMAnimationTraits *)traitsAtIndex:(NSUInteger)index {
+  NSAssert(index < _table.entryCount, @"Index %lu is out of bounds of a spec with %u entries.",
+           (unsigned long)index, _table.entryCount);
+  if (index >= _table.entryCount) {
+    return [[MDMAnimationTraits alloc] initWithDuration:0];
+  }
+
+  os_unfair_lock_lock(&_traitsLock);
+  CFTypeRef traits = _traits[index];
+  os_unfair_lock_unlock(&_traitsLock);
+  if (traits != NULL) {
+    return (__bridge MDMAnimationTraits *)traits;
+  }
+
+  const MDMMotionSpecEntry *entry = &_table.entries[index];
+  id<MDMTimingCurve> timingCurve = InternedTimingCurve(&_table.curves[entry->curveIndex]);
+  MDMAnimationTraits *createdTraits = [[MDMAnimationTraits alloc] initWithDelay:entry->delay
+                                                                       duration:entry->duration
+                                                                    timingCurve:timingCurve];
+
+  os_unfair_lock_lock(&_traitsLock);
+  // Another thread may have created the same traits in the meantime.
+  if (_traits[index] == NULL) {
+    _traits[index] = CFBridgingRetain(createdTraits);
+  }
+  traits = _traits[index];
+  os_unfair_lock_unlock(&_traitsLock);
+  return (__bridge MDMAnimationTraits *)traits;
+}
+
+- (MDMAnimationTraits *)objectAtIndexedSubscript:(NSUInteger)index {
+  return [self traitsAtIndex:index];
+}
+
+@end
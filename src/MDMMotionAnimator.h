@@ -24,7 +24,10 @@
 #endif
 
 #import "MDMAnimatableKeyPaths.h"
+#import "MDMAnimationPlan.h"
 #import "MDMCoreAnimationTraceable.h"
+#import "MDMMotionAnimatorMetrics.h"
+#import "MDMStagger.h"
 
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
@@ -49,6 +52,10 @@ NS_SWIFT_NAME(MotionAnimator)
 /**
  If enabled, all animations will start from their current presentation value.
 
+ Spring animations that interrupt a non-additive animation added by the animator also
+ start with the interrupted animation's current velocity. The velocity is computed from the
+ interrupted animation's timing curve rather than read from the presentation layer.
+
  If disabled, animations will start from the first value in the values array.
 
  Disabled by default.
@@ -65,6 +72,47 @@ NS_SWIFT_NAME(MotionAnimator)
  */
 @property(nonatomic, assign) BOOL additive;
 
+/**
+ The deepest stack of additive animations that a layer's key path may accumulate before it is
+ compacted. 0, the default, disables compaction.
+
+ Every retarget of an additive key path adds another animation that Core Animation evaluates on
+ every frame until it settles, so a gesture that retargets continuously can build up dozens of
+ them. When adding an animation exceeds this depth, the older animations of the stack are folded
+ into at most two spring animations that continue with the stack's current displacement and
+ velocity. Completion blocks of folded animations are invoked once the springs they were folded
+ into complete.
+
+ Depths below 3 are treated as 3, as compaction leaves up to two folded animations alongside the
+ newest one. Only stacks of additive animations that the animator added under keys of its own, and
+ whose timing it can evaluate, are compacted. Stacks that include an animation that repeats,
+ autoreverses or has its own speed or time offset are left as they are.
+ */
+@property(nonatomic, assign) NSUInteger maximumAdditiveStackDepth;
+
+/**
+ If enabled, animations are handed to Core Animation as linear keyframe animations that approximate
+ their spring or bezier timing curve, rather than as spring or bezier animations.
+
+ Keyframes are sampled adaptively: the fewest keyframes whose linear interpolation stays within
+ keyframeTolerance of the true curve are kept. Keyframes are computed once per timing curve,
+ duration and tolerance, and are shared by every animation with the same motion spec regardless
+ of the values they animate between.
+
+ Animations that are linear, or whose value is a transform, are added as-is.
+
+ Disabled by default.
+ */
+@property(nonatomic, assign) BOOL usesKeyframeAnimations;
+
+/**
+ The maximum error of keyframe animations, as a fraction of the distance between an animation's
+ initial and final values.
+
+ Defaults to 0.001.
+ */
+@property(nonatomic, assign) CGFloat keyframeTolerance;
+
 #pragma mark - Explicitly animating between values
 
 /**
@@ -126,6 +174,89 @@ NS_SWIFT_NAME(MotionAnimator)
  */
 @property(nonatomic, assign) BOOL shouldReverseValues;
 
+/**
+ Records the explicit animations requested within `animations` and submits them together once the
+ block returns.
+
+ Calls to the animateWithTraits:between: family of methods made within the block are recorded
+ rather than performed. Submission reads the time scale factor once, adds every animation in a
+ single transaction, writes every model value in a single transaction with actions disabled and
+ then invokes the tracers for all of the animations. Animations whose traits are equal to those of
+ the preceding request share a single configured template.
+
+ Submitted animations behave as if they had been requested one by one, including animations that
+ begin from the current state of a key path that an earlier request of the same recording
+ animated. Animations requested with a completion block of their own still complete individually.
+ Traits are copied as they are requested, so they may be modified and reused within the block.
+
+ Implicit animations requested within the block are performed immediately. Nested invocations are
+ submitted along with the outermost invocation.
+
+ @param animations  The block to be executed. The block is non-escaping.
+
+ @param completion  A block object to be executed once every recorded animation has completed or
+                    has been removed from the animation hierarchy. The provided `finished` argument
+                    is currently always YES.
+ */
+- (void)recordAnimations:(nonnull void(^)(void))animations
+              completion:(nullable void(^)(BOOL finished))completion;
+
+#pragma mark - Animating groups of layers
+
+/**
+ Animates the same key path of every layer in a group between the same values, delaying each
+ layer's animation according to a stagger.
+
+ Behaves as if animateWithTraits:between:layer:keyPath: were invoked for each layer with the
+ traits' delay increased by the layer's stagger delay, except that every animation of the group
+ begins relative to the same moment, is added in a single transaction and shares a single
+ completion block. Unless beginFromCurrentState is enabled, the animation is configured once and
+ copied for every layer. Model values are written in a single transaction with actions disabled.
+
+ Groups are performed immediately, including within recordAnimations:completion:.
+
+ @param traits      The traits to be used for every animation of the group.
+
+ @param stagger     Determines the additional delay of each layer's animation.
+
+ @param values      The values to be used in the animations. Must contain exactly two values.
+                    Supported UIKit types will be coerced to their Core Animation equivalent.
+
+ @param layers      The layers to be animated. A layer should appear at most once.
+
+ @param keyPath     The key path of the property to be animated.
+
+ @param completion  A block object to be executed once every animation of the group has completed
+                    or has been removed from the animation hierarchy. If the animations have no
+                    duration, this block is executed immediately. The provided `finished` argument
+                    is currently always YES.
+ */
+- (void)animateWithTraits:(nonnull MDMAnimationTraits *)traits
+                  stagger:(nonnull MDMStagger *)stagger
+                  between:(nonnull NSArray *)values
+                   layers:(nonnull NSArray<CALayer *> *)layers
+                  keyPath:(nonnull MDMAnimatableKeyPath)keyPath
+               completion:(nullable void(^)(BOOL finished))completion;
+
+#pragma mark - Applying animation plans
+
+/**
+ Sets the model value of and adds the prepared animation for every entry of a plan built by an
+ MDMAnimationPlanBuilder, possibly on another thread.
+
+ Plans are applied with a single model layer transaction and share a single completion block. The
+ animator's timeScaleFactor, additive, beginFromCurrentState and shouldReverseValues properties
+ do not affect plans; the builder's settings apply instead. Must be called on the main thread.
+
+ @param plan        The plan to apply. Plans may be applied more than once.
+
+ @param completion  A block object to be executed once every animation of the plan has completed or
+                    has been removed from the animation hierarchy. The provided `finished` argument
+                    is currently always YES.
+ */
+- (void)applyPlan:(nonnull MDMAnimationPlan *)plan
+       completion:(nullable void(^)(BOOL finished))completion;
+
 #pragma mark - Implicitly animating
 
 /**
@@ -135,7 +266,7 @@ NS_SWIFT_NAME(MotionAnimator)
 
  @param animations  The block to be executed. Any animatable properties changed within this block
                     will result in animations being added to the view's layer with the provided
-                    traits. The block is non-escaping.
+                    traits. The block is non-escaping. Must be called on the main thread.
  */
 - (void)animateWithTraits:(nonnull MDMAnimationTraits *)traits
                animations:(nonnull void(^)(void))animations;
@@ -148,7 +279,7 @@ NS_SWIFT_NAME(MotionAnimator)
 
  @param animations  The block to be executed. Any animatable properties changed within this block
                     will result in animations being added to the view's layer with the provided
-                    traits. The block is non-escaping.
+                    traits. The block is non-escaping. Must be called on the main thread.
 
  @param completion  A block object to be executed once the animation sequence ends or it has been
                     removed from the animation hierarchy. If the duration of the animation is 0,
@@ -179,6 +310,38 @@ NS_SWIFT_NAME(MotionAnimator)
  */
 - (void)stopAllAnimations;
 
+#pragma mark - Inspecting implicit animations
+
+/**
+ The number of animatable property changes intercepted by this animator's
+ animateWithTraits:animations: family of methods.
+ */
+@property(nonatomic, readonly) NSUInteger interceptedActionCount;
+
+/**
+ The number of intercepted property changes that were merged into an earlier change of the same
+ layer and key path within the same animations block.
+
+ Merged changes do not add animations of their own. The merged animation begins from the value the
+ property had before its first change and ends at the property's final value.
+ */
+@property(nonatomic, readonly) NSUInteger coalescedActionCount;
+
+#pragma mark - Measuring activity
+
+/**
+ Returns a snapshot of the animator's activity.
+
+ Obtaining a snapshot costs a single pass over the animator's active animations, so it is cheap
+ enough to do once per frame.
+ */
+- (nonnull MDMMotionAnimatorMetrics *)currentMetrics;
+
+/**
+ Resets the animator's cumulative counts, and its peak counts to their current values.
+ */
+- (void)resetMetrics;
+
 @end
 
 @interface MDMMotionAnimator (UIKitEquivalency)
@@ -382,6 +545,19 @@ NS_SWIFT_NAME(MotionAnimator)
 + (nonnull id<CALayerDelegate>)sharedLayerDelegate
     __deprecated_msg("No longer needed for implicit animations of headless layers.");
 
+/**
+ Installs the animator's layer action hook for the remainder of the process.
+
+ By default, the animator replaces CALayer's actionForKey: implementation when the outermost
+ animateWithTraits:animations: block begins and restores it when the block ends. Each replacement
+ invalidates the Objective-C method caches of every layer in the process. Once this method has been
+ called, the hook is installed a single time and actions requested outside of an animation block
+ are forwarded to the original implementation after a single thread-local check.
+
+ This cannot be undone. Must be called on the main thread.
+ */
++ (void)installPersistentImplicitAnimationHook;
+
 @end
 
 API_DEPRECATED_END
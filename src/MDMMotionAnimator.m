@@ -20,14 +20,121 @@
 
 #import "CATransaction+MotionAnimator.h"
 #import "private/CABasicAnimation+MotionAnimator.h"
+#import "private/MDMAnimationPlan+Private.h"
 #import "private/MDMAnimationRegistrar.h"
 #import "private/MDMUIKitValueCoercion.h"
 #import "private/MDMBlockAnimations.h"
+#import "private/MDMCommandBuffer.h"
 #import "private/MDMDragCoefficient.h"
+#import "private/MDMMotionAnimatorMetrics+Private.h"
+#import "private/MDMStagger+Private.h"
+#import "private/MDMTracing.h"
+
+static const void *RetainObject(const void *object) {
+  return CFRetain(object);
+}
+
+static void ReleaseObject(const void *object) {
+  CFRelease(object);
+}
+
+static const MDMCommandBufferCallbacks kObjectCallbacks = {RetainObject, ReleaseObject};
+
+// Returns a Boolean indicating whether or not the timing curves produce the same animations.
+static BOOL TimingCurvesAreEqual(id<MDMTimingCurve> a, id<MDMTimingCurve> b) {
+  if (a == b) {
+    return YES;
+  }
+  if ([a isKindOfClass:[CAMediaTimingFunction class]]
+      && [b isKindOfClass:[CAMediaTimingFunction class]]) {
+    for (size_t i = 1; i <= 2; ++i) {
+      float pointA[2];
+      float pointB[2];
+      [(CAMediaTimingFunction *)a getControlPointAtIndex:i values:pointA];
+      [(CAMediaTimingFunction *)b getControlPointAtIndex:i values:pointB];
+      if (pointA[0] != pointB[0] || pointA[1] != pointB[1]) {
+        return NO;
+      }
+    }
+    return YES;
+  }
+  if ([a isKindOfClass:[MDMSpringTimingCurveGenerator class]]
+      && [b isKindOfClass:[MDMSpringTimingCurveGenerator class]]) {
+    MDMSpringTimingCurveGenerator *generatorA = (MDMSpringTimingCurveGenerator *)a;
+    MDMSpringTimingCurveGenerator *generatorB = (MDMSpringTimingCurveGenerator *)b;
+    return (generatorA.duration == generatorB.duration
+            && generatorA.dampingRatio == generatorB.dampingRatio
+            && generatorA.initialVelocity == generatorB.initialVelocity);
+  }
+  if ([a isMemberOfClass:[MDMSpringTimingCurve class]]
+      && [b isMemberOfClass:[MDMSpringTimingCurve class]]) {
+    MDMSpringTimingCurve *springA = (MDMSpringTimingCurve *)a;
+    MDMSpringTimingCurve *springB = (MDMSpringTimingCurve *)b;
+    return (springA.mass == springB.mass
+            && springA.tension == springB.tension
+            && springA.friction == springB.friction
+            && springA.initialVelocity == springB.initialVelocity);
+  }
+  return NO;
+}
+
+// Returns a Boolean indicating whether or not the traits produce the same animations. Traits that
+// can't be compared by value are considered to differ.
+static BOOL TraitsAreEqual(MDMAnimationTraits *a, MDMAnimationTraits *b) {
+  return (a.delay == b.delay
+          && a.duration == b.duration
+          && a.repetition == b.repetition
+          && TimingCurvesAreEqual(a.timingCurve, b.timingCurve));
+}
+
+// The rate of change of a key path's value at the moment an animation of it begins.
+typedef struct {
+  BOOL isKnown;
+  MDMValue value;
+} InitialVelocity;
+
+// Returns the value an animation of the layer's key path begins from when beginFromCurrentState is
+// enabled. If the presentation value is evaluated from the registered animations, its current rate
+// of change is written to `velocity` as well.
+static id CurrentValue(MDMAnimationRegistrar *registrar,
+                      CALayer *layer,
+                      NSString *keyPath,
+                      id modelValue,
+                      BOOL wantsPresentationValue,
+                      InitialVelocity *velocity) {
+  if (wantsPresentationValue) {
+    id presentationValue = [registrar presentationValueOfLayer:layer
+                                                    forKeyPath:keyPath
+                                                    modelValue:modelValue
+                                                      velocity:&velocity->value];
+    if (presentationValue != nil) {
+      velocity->isKnown = YES;
+      return presentationValue;
+    }
+    if ([layer presentationLayer]) {
+      return [[layer presentationLayer] valueForKeyPath:keyPath];
+    }
+  }
+  return modelValue;
+}
 
 @implementation MDMMotionAnimator {
   NSMutableArray *_tracers;
   MDMAnimationRegistrar *_registrar;
+  MDMMotionAnimatorCounters _counters;
+
+  // Explicit animations requested within recordAnimations:completion:, created on first use.
+  MDMCommandBuffer *_commandBuffer;
+  NSUInteger _recordingDepth;
+  NSMutableArray<void (^)(BOOL)> *_nestedRecordingCompletions;
+
+  // Layer, key path and value triples of the model layer writes deferred by the current scope.
+  NSUInteger _modelLayerScopeDepth;
+  NSMutableArray *_deferredModelLayerWrites;
+
+  // The empty tables of pending model values that submissions reuse, created on first use.
+  NSMapTable<CALayer *, NSMutableDictionary<NSString *, id> *> *_reusablePendingModelValues;
+  NSMutableArray<NSMutableDictionary<NSString *, id> *> *_reusableLayerModelValues;
 }
 
 - (instancetype)init {
@@ -36,10 +143,15 @@
     _registrar = [[MDMAnimationRegistrar alloc] init];
     _timeScaleFactor = 1;
     _additive = true;
+    _keyframeTolerance = (CGFloat)0.001;
   }
   return self;
 }
 
+- (void)dealloc {
+  MDMCommandBufferDestroy(_commandBuffer);
+}
+
 - (void)animateWithTraits:(MDMAnimationTraits *)traits
                   between:(NSArray *)values
                     layer:(CALayer *)layer
@@ -53,21 +165,53 @@
                   keyPath:(MDMAnimatableKeyPath)keyPath
                completion:(void(^)(BOOL))completion {
   NSAssert([values count] == 2, @"The values array must contain exactly two values.");
+  uint64_t start = MDMTraceNow();
 
   if (_shouldReverseValues) {
     values = [[values reverseObjectEnumerator] allObjects];
   }
-  values = MDMCoerceUIKitValuesToCoreAnimationValues(values);
+  MDMValueClass valueClass = MDMValueClassUnknown;
+  values = MDMCoerceUIKitValuesToCoreAnimationValues(values, &valueClass);
+
+  if (_recordingDepth > 0 && _commandBuffer != NULL) {
+    // The buffer retains the heap copy of the completion block for as long as it is recorded.
+    void (^recordedCompletion)(BOOL) = [completion copy];
+
+    // Traits are mutable and often reused from one request to the next, so the buffer retains a
+    // snapshot of them instead. Consecutive requests with equal traits share a snapshot, and thus
+    // an animation template once submitted.
+    size_t recordedCount = 0;
+    const MDMCommand *recordedCommands = MDMCommandBufferCommands(_commandBuffer, &recordedCount);
+    MDMAnimationTraits *recordedTraits =
+        recordedCount > 0
+            ? (__bridge MDMAnimationTraits *)recordedCommands[recordedCount - 1].traits
+            : nil;
+    if (recordedTraits == nil || !TraitsAreEqual(traits, recordedTraits)) {
+      recordedTraits = [traits copy];
+    }
+    MDMCommand command = {
+      (__bridge void *)layer,
+      (__bridge void *)keyPath,
+      (__bridge void *)recordedTraits,
+      (__bridge void *)values,
+      (__bridge void *)recordedCompletion,
+      valueClass,
+    };
+    if (MDMCommandBufferAppend(_commandBuffer, &command)) {
+      _counters.mainThreadNanoseconds += MDMTraceNow() - start;
+      return;
+    }
+    // Performs the animation immediately if the buffer couldn't grow.
+  }
 
   void (^commitToModelLayer)(void) = ^{
-    [CATransaction begin];
-    [CATransaction setDisableActions:YES];
-    [layer setValue:[values lastObject] forKeyPath:keyPath];
-    [CATransaction commit];
+    [self commitModelValue:[values lastObject] toLayer:layer keyPath:keyPath];
   };
 
   void (^exitEarly)(void) = ^{
     commitToModelLayer();
+    self->_counters.earlyExitCount++;
+    self->_counters.mainThreadNanoseconds += MDMTraceNow() - start;
 
     if (completion) {
       completion(YES);
@@ -80,7 +224,9 @@
     return;
   }
 
+  uint64_t traceStart = MDMTraceBegin();
   CABasicAnimation *animation = MDMAnimationFromTraits(traits, timeScaleFactor);
+  MDMTraceEndForKeyPath(MDMTraceEventKindAnimationFromTraits, traceStart, layer, keyPath);
 
   if (animation == nil) {
     exitEarly();
@@ -88,31 +234,33 @@
   }
 
   BOOL beginFromCurrentState = self.beginFromCurrentState;
-
-  [self addAnimation:animation
-             toLayer:layer
-         withKeyPath:keyPath
-              traits:traits
-     timeScaleFactor:timeScaleFactor
-         destination:[values lastObject]
-        initialValue:^(BOOL wantsPresentationValue) {
-          if (beginFromCurrentState) {
-            if (wantsPresentationValue && [layer presentationLayer]) {
-              return [[layer presentationLayer] valueForKeyPath:keyPath];
-            } else {
-              return [layer valueForKeyPath:keyPath];
-            }
-          } else {
-            return [values firstObject];
-          }
-
-        } completion:completion];
+  MDMAnimationRegistrar *registrar = _registrar;
+
+  id (^initialValue)(BOOL, InitialVelocity *) = ^(BOOL wantsPresentationValue,
+                                                   InitialVelocity *velocity) {
+    if (beginFromCurrentState) {
+      return CurrentValue(registrar, layer, keyPath, [layer valueForKeyPath:keyPath],
+                          wantsPresentationValue, velocity);
+    } else {
+      return [values firstObject];
+    }
+  };
+  CAAnimation *addedAnimation = [self addAnimation:animation
+                                           toLayer:layer
+                                       withKeyPath:keyPath
+                                            traits:traits
+                                   timeScaleFactor:timeScaleFactor
+                                       destination:[values lastObject]
+                                        valueClass:valueClass
+                                      initialValue:initialValue
+                                        completion:completion];
 
   commitToModelLayer();
 
   for (void (^tracer)(CALayer *, CAAnimation *) in _tracers) {
-    tracer(layer, animation);
+    tracer(layer, addedAnimation);
   }
+  _counters.mainThreadNanoseconds += MDMTraceNow() - start;
 }
 
 - (void)animateWithTraits:(MDMAnimationTraits *)traits animations:(void (^)(void))animations {
@@ -122,63 +270,328 @@
 - (void)animateWithTraits:(MDMAnimationTraits *)traits
                animations:(void (^)(void))animations
                completion:(void(^)(BOOL))completion {
-  NSArray<MDMImplicitAction *> *actions = MDMAnimateImplicitly(animations);
+  uint64_t start = MDMTraceNow();
+  // Time spent in the animations block is the caller's, not ours.
+  __block uint64_t animationsNanoseconds = 0;
+  void (^measuredAnimations)(void) = ^{
+    uint64_t animationsStart = MDMTraceNow();
+    if (animations) {
+      animations();
+    }
+    animationsNanoseconds += MDMTraceNow() - animationsStart;
+  };
 
-  void (^exitEarly)(void) = ^{
-    [CATransaction begin];
-    [CATransaction setDisableActions:YES];
-    animations();
-    [CATransaction commit];
+  MDMImplicitAnimationOptions options = MDMImplicitAnimationOptionNone;
+  if (self.beginFromCurrentState) {
+    options |= MDMImplicitAnimationOptionBeginFromCurrentState;
+  }
+  if (self.additive) {
+    options |= MDMImplicitAnimationOptionAdditive;
+  }
+  // Filled in before the handler below is invoked.
+  __block MDMImplicitAnimationStatistics statistics;
+  MDMAnimationRegistrar *registrar = _registrar;
+  MDMPresentationValueProvider presentationValueProvider =
+      ^id(CALayer *layer, NSString *keyPath, id modelValue, MDMValue *velocity) {
+        return [registrar presentationValueOfLayer:layer
+                                        forKeyPath:keyPath
+                                        modelValue:modelValue
+                                          velocity:velocity];
+      };
+  // The actions are only valid within the handler, which is invoked before MDMAnimateImplicitly
+  // returns.
+  MDMAnimateImplicitly(options, presentationValueProvider, &statistics, measuredAnimations,
+                       ^(NSArray<MDMImplicitAction *> *actions) {
+    self->_interceptedActionCount += statistics.interceptedActionCount;
+    self->_coalescedActionCount += statistics.coalescedActionCount;
+
+    void (^exitEarly)(void) = ^{
+      [CATransaction begin];
+      [CATransaction setDisableActions:YES];
+      measuredAnimations();
+      [CATransaction commit];
+      self->_counters.earlyExitCount++;
+      self->_counters.mainThreadNanoseconds += MDMTraceNow() - start - animationsNanoseconds;
+
+      if (completion) {
+        completion(YES);
+      }
+    };
+
+    CGFloat timeScaleFactor = [self computedTimeScaleFactor];
+    if (timeScaleFactor == 0) {
+      exitEarly();
+      return; // No need to animate anything.
+    }
+
+    // We'll reuse this animation template for each action.
+    uint64_t traceStart = MDMTraceBegin();
+    CABasicAnimation *animationTemplate = MDMAnimationFromTraits(traits, timeScaleFactor);
+    MDMTraceEnd(MDMTraceEventKindAnimationFromTraits, traceStart, NULL,
+                MDMAnimatableKeyPathKindNone);
+    if (animationTemplate == nil) {
+      exitEarly();
+      return;
+    }
+
+    // Every animation added below shares the batch's transaction and completion block.
+    [self->_registrar beginBatch];
 
+    for (MDMImplicitAction *action in actions) {
+      CABasicAnimation *animation = [animationTemplate copy];
+      id destination = [action.layer valueForKeyPath:action.keyPath];
+
+      id (^initialValue)(BOOL, InitialVelocity *) = ^(BOOL wantsPresentationValue,
+                                                       InitialVelocity *velocity) {
+        if (wantsPresentationValue && action.hasInitialPresentationValue) {
+          const MDMValue *initialVelocity = action.initialVelocity;
+          if (initialVelocity != NULL) {
+            velocity->isKnown = YES;
+            velocity->value = *initialVelocity;
+          }
+          return action.initialPresentationValue;
+        } else {
+          // Additive animations always animate from the initial model layer value.
+          return action.initialModelValue;
+        }
+      };
+      CAAnimation *addedAnimation = [self addAnimation:animation
+                                               toLayer:action.layer
+                                           withKeyPath:action.keyPath
+                                                traits:traits
+                                       timeScaleFactor:timeScaleFactor
+                                           destination:destination
+                                            valueClass:MDMClassifyValue(destination)
+                                          initialValue:initialValue
+                                            completion:nil];
+
+      for (void (^tracer)(CALayer *, CAAnimation *) in self->_tracers) {
+        tracer(action.layer, addedAnimation);
+      }
+    }
+
+    [self->_registrar commitBatchWithCompletion:completion];
+    self->_counters.mainThreadNanoseconds += MDMTraceNow() - start - animationsNanoseconds;
+  });
+}
+
+- (void)recordAnimations:(void (^)(void))animations completion:(void (^)(BOOL))completion {
+  if (_commandBuffer == NULL) {
+    _commandBuffer = MDMCommandBufferCreate(&kObjectCallbacks);
+  }
+  _recordingDepth++;
+  animations();
+  _recordingDepth--;
+
+  if (_recordingDepth > 0) {
+    // Nested recordings are submitted and complete along with the outermost recording.
     if (completion) {
-      completion(YES);
+      if (!_nestedRecordingCompletions) {
+        _nestedRecordingCompletions = [NSMutableArray array];
+      }
+      [_nestedRecordingCompletions addObject:[completion copy]];
     }
-  };
+    return;
+  }
+
+  NSArray<void (^)(BOOL)> *nestedCompletions = _nestedRecordingCompletions;
+  _nestedRecordingCompletions = nil;
+  void (^batchCompletion)(BOOL) = completion;
+  if (nestedCompletions != nil) {
+    batchCompletion = ^(BOOL finished) {
+      for (void (^nestedCompletion)(BOOL) in nestedCompletions) {
+        nestedCompletion(finished);
+      }
+      if (completion) {
+        completion(finished);
+      }
+    };
+  }
+
+  uint64_t start = MDMTraceNow();
+  [self submitRecordedAnimationsWithCompletion:batchCompletion];
+  _counters.mainThreadNanoseconds += MDMTraceNow() - start;
+}
+
+- (void)animateWithTraits:(MDMAnimationTraits *)traits
+                  stagger:(MDMStagger *)stagger
+                  between:(NSArray *)values
+                   layers:(NSArray<CALayer *> *)layers
+                  keyPath:(MDMAnimatableKeyPath)keyPath
+               completion:(void(^)(BOOL))completion {
+  NSAssert([values count] == 2, @"The values array must contain exactly two values.");
+  uint64_t start = MDMTraceNow();
+
+  if (_shouldReverseValues) {
+    values = [[values reverseObjectEnumerator] allObjects];
+  }
+  MDMValueClass valueClass = MDMValueClassUnknown;
+  values = MDMCoerceUIKitValuesToCoreAnimationValues(values, &valueClass);
+  id destination = [values lastObject];
+  NSUInteger count = layers.count;
 
   CGFloat timeScaleFactor = [self computedTimeScaleFactor];
-  if (timeScaleFactor == 0) {
-    exitEarly();
-    return; // No need to animate anything.
+  CABasicAnimation *prototype = nil;
+  if (timeScaleFactor != 0 && count > 0) {
+    uint64_t traceStart = MDMTraceBegin();
+    prototype = MDMAnimationFromTraits(traits, timeScaleFactor);
+    MDMTraceEndForKeyPath(MDMTraceEventKindAnimationFromTraits, traceStart, layers.firstObject,
+                          keyPath);
   }
 
-  // We'll reuse this animation template for each action.
-  CABasicAnimation *animationTemplate = MDMAnimationFromTraits(traits, timeScaleFactor);
-  if (animationTemplate == nil) {
-    exitEarly();
+  // Every model value is written in a single transaction once the animations have been added.
+  [self beginModelLayerScope];
+
+  if (prototype == nil) {
+    for (CALayer *layer in layers) {
+      [self commitModelValue:destination toLayer:layer keyPath:keyPath];
+    }
+    [self commitModelLayerScope];
+    _counters.earlyExitCount += count;
+    _counters.mainThreadNanoseconds += MDMTraceNow() - start;
+
+    if (completion) {
+      completion(YES);
+    }
     return;
   }
 
-  [CATransaction begin];
-  if (completion) {
-    [CATransaction setCompletionBlock:^{
-      completion(YES);
-    }];
-  }
-
-  for (MDMImplicitAction *action in actions) {
-    CABasicAnimation *animation = [animationTemplate copy];
-
-    [self addAnimation:animation
-               toLayer:action.layer
-           withKeyPath:action.keyPath
-                traits:traits
-       timeScaleFactor:timeScaleFactor
-           destination:[action.layer valueForKeyPath:action.keyPath]
-          initialValue:^(BOOL wantsPresentationValue) {
-               if (wantsPresentationValue && action.hadPresentationLayer) {
-                 return action.initialPresentationValue;
-               } else {
-                 // Additive animations always animate from the initial model layer value.
-                 return action.initialModelValue;
-               }
-             } completion:nil];
+  NSMutableData *delayData = [NSMutableData dataWithLength:count * sizeof(double)];
+  double *delays = delayData.mutableBytes;
+  [stagger getDelays:delays count:count];
+
+  BOOL beginFromCurrentState = self.beginFromCurrentState;
+  MDMAnimationRegistrar *registrar = _registrar;
+
+  // Unless the animations begin from each layer's current state, every animation of the group is
+  // configured identically, so the prototype is configured once and copied for every layer.
+  if (!beginFromCurrentState) {
+    id initialValue = [values firstObject];
+    [self configureAnimation:prototype
+                    forLayer:layers.firstObject
+                 withKeyPath:keyPath
+                      traits:traits
+                 destination:destination
+                  valueClass:valueClass
+                initialValue:^(BOOL wantsPresentationValue, InitialVelocity *velocity) {
+                  return initialValue;
+                }];
+  }
+
+  // Every animation begins relative to the same moment, regardless of how long adding the group's
+  // animations takes.
+  CFTimeInterval mediaTime = CACurrentMediaTime();
+  CFTimeInterval traitsDelay = traits.delay;
+
+  // Every animation added below shares the batch's transaction and completion block.
+  [_registrar beginBatch];
+
+  for (NSUInteger i = 0; i < count; ++i) {
+    CALayer *layer = layers[i];
+    CABasicAnimation *animation = [prototype copy];
+    if (beginFromCurrentState) {
+      [self configureAnimation:animation
+                      forLayer:layer
+                   withKeyPath:keyPath
+                        traits:traits
+                   destination:destination
+                    valueClass:valueClass
+                  initialValue:^(BOOL wantsPresentationValue, InitialVelocity *velocity) {
+                    return CurrentValue(registrar, layer, keyPath, [layer valueForKeyPath:keyPath],
+                                        wantsPresentationValue, velocity);
+                  }];
+    }
+    if (animation.additive) {
+      _counters.additiveAnimationCount++;
+    } else {
+      _counters.nonAdditiveAnimationCount++;
+    }
+
+    // See addAnimation:toLayer:withKeyPath: for why animations without a delay begin now.
+    CFTimeInterval delay = (traitsDelay + delays[i]) * timeScaleFactor;
+    animation.beginTime = [layer convertTime:mediaTime fromLayer:nil] + delay;
+    if (delay != 0) {
+      animation.fillMode = kCAFillModeBackwards;
+    }
+
+    NSString *key = animation.additive ? nil : keyPath;
+    CAAnimation *addedAnimation = [_registrar addAnimation:animation
+                                                   toLayer:layer
+                                                    forKey:key
+                                                completion:nil];
+    [self commitModelValue:destination toLayer:layer keyPath:keyPath];
 
     for (void (^tracer)(CALayer *, CAAnimation *) in _tracers) {
-      tracer(action.layer, animation);
+      tracer(layer, addedAnimation);
     }
   }
 
-  [CATransaction commit];
+  [_registrar commitBatchWithCompletion:completion];
+  [self commitModelLayerScope];
+  _counters.mainThreadNanoseconds += MDMTraceNow() - start;
+}
+
+- (void)applyPlan:(MDMAnimationPlan *)plan completion:(void(^)(BOOL))completion {
+  uint64_t start = MDMTraceNow();
+  NSArray<MDMAnimationPlanStep *> *steps = plan.steps;
+
+  // Every animation added below shares the batch's transaction and completion block, and every
+  // model value is written in a single transaction once the animations have been added.
+  [self beginModelLayerScope];
+  [_registrar beginBatch];
+
+  for (MDMAnimationPlanStep *step in steps) {
+    [self commitModelValue:step.modelValue toLayer:step.layer keyPath:step.keyPath];
+    if (step.animation == nil) {
+      _counters.earlyExitCount++;
+      continue;
+    }
+    CABasicAnimation *animation = [step.animation copy];
+    if (animation.additive) {
+      _counters.additiveAnimationCount++;
+    } else {
+      _counters.nonAdditiveAnimationCount++;
+    }
+    // See addAnimation:toLayer:withKeyPath: for why animations without a delay begin now on iOS 14.
+    if (step.delay != 0) {
+      animation.beginTime = ([step.layer convertTime:CACurrentMediaTime() fromLayer:nil]
+                             + step.delay);
+    } else if (@available(iOS 14, *)) {
+      animation.beginTime = [step.layer convertTime:CACurrentMediaTime() fromLayer:nil];
+    }
+
+    NSString *key = animation.additive ? nil : step.keyPath;
+    CAAnimation *addedAnimation = [_registrar addAnimation:animation
+                                                   toLayer:step.layer
+                                                    forKey:key
+                                                completion:nil];
+
+    for (void (^tracer)(CALayer *, CAAnimation *) in _tracers) {
+      tracer(step.layer, addedAnimation);
+    }
+  }
+
+  [_registrar commitBatchWithCompletion:completion];
+  [self commitModelLayerScope];
+  _counters.mainThreadNanoseconds += MDMTraceNow() - start;
+}
+
+- (NSUInteger)maximumAdditiveStackDepth {
+  return _registrar.maximumAdditiveStackDepth;
+}
+
+- (void)setMaximumAdditiveStackDepth:(NSUInteger)maximumAdditiveStackDepth {
+  _registrar.maximumAdditiveStackDepth = maximumAdditiveStackDepth;
+}
+
+- (void)setUsesKeyframeAnimations:(BOOL)usesKeyframeAnimations {
+  _usesKeyframeAnimations = usesKeyframeAnimations;
+  _registrar.keyframeTolerance = _usesKeyframeAnimations ? _keyframeTolerance : 0;
+}
+
+- (void)setKeyframeTolerance:(CGFloat)keyframeTolerance {
+  _keyframeTolerance = keyframeTolerance;
+  _registrar.keyframeTolerance = _usesKeyframeAnimations ? _keyframeTolerance : 0;
 }
 
 - (void)addCoreAnimationTracer:(void (^)(CALayer *, CAAnimation *))tracer {
@@ -188,13 +601,23 @@
   [_tracers addObject:[tracer copy]];
 }
 
+- (MDMMotionAnimatorMetrics *)currentMetrics {
+  MDMAnimationRegistrarMetrics metrics;
+  [_registrar getMetrics:&metrics];
+  return [[MDMMotionAnimatorMetrics alloc] initWithMetrics:&metrics counters:_counters];
+}
+
+- (void)resetMetrics {
+  memset(&_counters, 0, sizeof(_counters));
+  [_registrar resetPeakMetrics];
+}
+
 - (void)removeAllAnimations {
   [_registrar removeAllAnimations];
 }
 
 - (void)stopAllAnimations {
-  [_registrar commitCurrentAnimationValuesToAllLayers];
-  [_registrar removeAllAnimations];
+  [_registrar stopAllAnimations];
 }
 
 #pragma mark - UIKit equivalency
@@ -310,19 +733,218 @@
   return MDMSimulatorAnimationDragCoefficient() * timeScaleFactor;
 }
 
-- (void)addAnimation:(CABasicAnimation *)animation
-             toLayer:(CALayer *)layer
-         withKeyPath:(NSString *)keyPath
-              traits:(MDMAnimationTraits *)traits
-     timeScaleFactor:(CGFloat)timeScaleFactor
-         destination:(id)destination
-        initialValue:(id(^)(BOOL wantsPresentationValue))initialValueBlock
-          completion:(void(^)(BOOL))completion {
+// Model layer writes made until the matching commitModelLayerScope are deferred and then performed
+// in a single transaction. Scopes may be nested.
+- (void)beginModelLayerScope {
+  if (_modelLayerScopeDepth == 0) {
+    _deferredModelLayerWrites = [NSMutableArray array];
+  }
+  _modelLayerScopeDepth++;
+}
+
+- (void)commitModelLayerScope {
+  NSAssert(_modelLayerScopeDepth > 0, @"commitModelLayerScope called without a matching begin.");
+  _modelLayerScopeDepth--;
+  if (_modelLayerScopeDepth > 0) {
+    return;
+  }
+  NSArray *writes = _deferredModelLayerWrites;
+  _deferredModelLayerWrites = nil;
+  NSUInteger writeCount = writes.count / 3;
+  if (writeCount == 0) {
+    return;
+  }
+  [CATransaction begin];
+  [CATransaction setDisableActions:YES];
+  for (NSUInteger i = 0; i < writeCount; ++i) {
+    id value = writes[i * 3 + 2];
+    [(CALayer *)writes[i * 3] setValue:(value == [NSNull null] ? nil : value)
+                            forKeyPath:writes[i * 3 + 1]];
+  }
+  [CATransaction commit];
+  _counters.avoidedTransactionCount += writeCount - 1;
+}
+
+// Writes the value to the layer's model without adding an implicit animation.
+- (void)commitModelValue:(id)value toLayer:(CALayer *)layer keyPath:(NSString *)keyPath {
+  if (_deferredModelLayerWrites != nil) {
+    [_deferredModelLayerWrites addObject:layer];
+    [_deferredModelLayerWrites addObject:keyPath];
+    [_deferredModelLayerWrites addObject:value ?: [NSNull null]];
+    return;
+  }
+  if (MDMIsAnimatingImplicitly()) {
+    // Deferring the write would reorder it with the changes that the rest of the animations block
+    // makes. Disabling the actions of the block's transaction for the duration of the write has the
+    // same effect as a transaction of its own.
+    BOOL disableActions = [CATransaction disableActions];
+    [CATransaction setDisableActions:YES];
+    [layer setValue:value forKeyPath:keyPath];
+    [CATransaction setDisableActions:disableActions];
+    _counters.avoidedTransactionCount++;
+    return;
+  }
+  [CATransaction begin];
+  [CATransaction setDisableActions:YES];
+  [layer setValue:value forKeyPath:keyPath];
+  [CATransaction commit];
+}
+
+// Performs the animations recorded into the command buffer and empties it.
+- (void)submitRecordedAnimationsWithCompletion:(void (^)(BOOL))completion {
+  // Tracers and completion blocks may record animations of their own, which go to a new buffer
+  // while this one is being submitted.
+  MDMCommandBuffer *buffer = _commandBuffer;
+  _commandBuffer = NULL;
+  size_t count = 0;
+  const MDMCommand *commands = buffer != NULL ? MDMCommandBufferCommands(buffer, &count) : NULL;
+
+  CGFloat timeScaleFactor = [self computedTimeScaleFactor];
+  BOOL beginFromCurrentState = self.beginFromCurrentState;
+  MDMAnimationRegistrar *registrar = _registrar;
+
+  // Model values are written once every animation has been added, so later commands for a key path
+  // that an earlier command animated read the earlier command's destination from here instead. The
+  // table is taken from the animator while in use, so that a nested submission gets its own.
+  NSMapTable<CALayer *, NSMutableDictionary<NSString *, id> *> *pendingModelValues = nil;
+  if (beginFromCurrentState && count > 1) {
+    pendingModelValues =
+        _reusablePendingModelValues ?: [NSMapTable strongToStrongObjectsMapTable];
+    _reusablePendingModelValues = nil;
+  }
+  NSMutableArray *addedAnimations = _tracers.count > 0 ? [NSMutableArray array] : nil;
+  NSMutableArray<void (^)(BOOL)> *earlyCompletions = nil;
+
+  // Consecutive commands with equal traits share a snapshot of them, and thus a template.
+  MDMAnimationTraits *templateTraits = nil;
+  CABasicAnimation *animationTemplate = nil;
+
+  // Every animation added below shares the batch's transaction and completion block, other than
+  // those that have a completion block of their own. Model values are written in a single
+  // transaction once every animation has been added.
+  [self beginModelLayerScope];
+  [_registrar beginBatch];
+
+  for (size_t i = 0; i < count; ++i) {
+    CALayer *layer = (__bridge CALayer *)commands[i].layer;
+    NSString *keyPath = (__bridge NSString *)commands[i].keyPath;
+    MDMAnimationTraits *traits = (__bridge MDMAnimationTraits *)commands[i].traits;
+    NSArray *values = (__bridge NSArray *)commands[i].values;
+    void (^commandCompletion)(BOOL) = (__bridge void (^)(BOOL))commands[i].completion;
+
+    CABasicAnimation *animation = nil;
+    if (timeScaleFactor != 0) {
+      if (traits != templateTraits) {
+        uint64_t traceStart = MDMTraceBegin();
+        animationTemplate = MDMAnimationFromTraits(traits, timeScaleFactor);
+        MDMTraceEndForKeyPath(MDMTraceEventKindAnimationFromTraits, traceStart, layer, keyPath);
+        templateTraits = traits;
+      }
+      animation = [animationTemplate copy];
+    }
+
+    NSMutableDictionary<NSString *, id> *layerModelValues = [pendingModelValues objectForKey:layer];
+    if (animation == nil) {
+      _counters.earlyExitCount++;
+      if (commandCompletion) {
+        if (!earlyCompletions) {
+          earlyCompletions = [NSMutableArray array];
+        }
+        [earlyCompletions addObject:commandCompletion];
+      }
+      [addedAnimations addObject:[NSNull null]];
+    } else {
+      id (^initialValue)(BOOL, InitialVelocity *) = ^(BOOL wantsPresentationValue,
+                                                       InitialVelocity *velocity) {
+        if (beginFromCurrentState) {
+          id modelValue = layerModelValues[keyPath] ?: [layer valueForKeyPath:keyPath];
+          return CurrentValue(registrar, layer, keyPath, modelValue, wantsPresentationValue,
+                              velocity);
+        } else {
+          return [values firstObject];
+        }
+      };
+      CAAnimation *addedAnimation = [self addAnimation:animation
+                                               toLayer:layer
+                                           withKeyPath:keyPath
+                                                traits:traits
+                                       timeScaleFactor:timeScaleFactor
+                                           destination:[values lastObject]
+                                            valueClass:commands[i].valueClass
+                                          initialValue:initialValue
+                                            completion:commandCompletion];
+      [addedAnimations addObject:addedAnimation];
+    }
+
+    [self commitModelValue:[values lastObject] toLayer:layer keyPath:keyPath];
+    if (pendingModelValues != nil) {
+      if (!layerModelValues) {
+        layerModelValues = [_reusableLayerModelValues lastObject];
+        if (layerModelValues != nil) {
+          [_reusableLayerModelValues removeLastObject];
+        } else {
+          layerModelValues = [NSMutableDictionary dictionary];
+        }
+        [pendingModelValues setObject:layerModelValues forKey:layer];
+      }
+      layerModelValues[keyPath] = [values lastObject];
+    }
+  }
+
+  if (pendingModelValues != nil) {
+    if (!_reusableLayerModelValues) {
+      _reusableLayerModelValues = [NSMutableArray array];
+    }
+    for (NSMutableDictionary<NSString *, id> *layerModelValues in
+         [pendingModelValues objectEnumerator]) {
+      [layerModelValues removeAllObjects];
+      [_reusableLayerModelValues addObject:layerModelValues];
+    }
+    [pendingModelValues removeAllObjects];
+    _reusablePendingModelValues = pendingModelValues;
+  }
+
+  [_registrar commitBatchWithCompletion:completion];
+  [self commitModelLayerScope];
+
+  for (void (^tracer)(CALayer *, CAAnimation *) in _tracers) {
+    for (size_t i = 0; i < count; ++i) {
+      CAAnimation *addedAnimation = addedAnimations[i];
+      if ((id)addedAnimation != [NSNull null]) {
+        tracer((__bridge CALayer *)commands[i].layer, addedAnimation);
+      }
+    }
+  }
+
+  if (buffer != NULL) {
+    MDMCommandBufferRemoveAll(buffer);
+    if (_commandBuffer == NULL) {
+      // Keeps the storage for the next recording.
+      _commandBuffer = buffer;
+    } else {
+      MDMCommandBufferDestroy(buffer);
+    }
+  }
+  for (void (^earlyCompletion)(BOOL) in earlyCompletions) {
+    earlyCompletion(YES);
+  }
+}
+
+// Configures the animation's key path and values, including whether it is additive, for an
+// animation of the layer's key path to `destination`.
+- (void)configureAnimation:(CABasicAnimation *)animation
+                  forLayer:(CALayer *)layer
+               withKeyPath:(NSString *)keyPath
+                    traits:(MDMAnimationTraits *)traits
+               destination:(id)destination
+                valueClass:(MDMValueClass)valueClass
+              initialValue:(id(^)(BOOL wantsPresentationValue,
+                                     InitialVelocity *velocity))initialValueBlock {
   // Must configure the keyPath and toValue before we can identify whether the animation supports
   // being additive.
   animation.keyPath = keyPath;
   animation.toValue = destination;
-  animation.additive = self.additive && MDMCanAnimationBeAdditive(keyPath, animation.toValue);
+  animation.additive = self.additive && MDMCanAnimationBeAdditive(keyPath, valueClass);
 
   // Additive animations always read from the model layer's value so that the new displacement
   // reflects the change in destination and momentum appears to be conserved across multiple
@@ -331,12 +953,42 @@
   // Non-additive animations should try to read from the presentation layer's current value
   // because we'll be interrupting whatever animation previously existed and immediately moving
   // toward the new destination.
+  //
+  // When the presentation value is evaluated from the interrupted animations, so is its velocity,
+  // which the new animation continues with.
   BOOL wantsPresentationValue = self.beginFromCurrentState && !animation.additive;
-  animation.fromValue = initialValueBlock(wantsPresentationValue);
+  InitialVelocity velocity = {0};
+  animation.fromValue = initialValueBlock(wantsPresentationValue, &velocity);
 
-  NSString *key = animation.additive ? nil : keyPath;
+  uint64_t traceStart = MDMTraceBegin();
+  MDMConfigureAnimation(animation, traits, valueClass, velocity.isKnown ? &velocity.value : NULL);
+  MDMTraceEndForKeyPath(MDMTraceEventKindConfigureAnimation, traceStart, layer, keyPath);
+}
 
-  MDMConfigureAnimation(animation, traits);
+- (CAAnimation *)addAnimation:(CABasicAnimation *)animation
+                      toLayer:(CALayer *)layer
+                  withKeyPath:(NSString *)keyPath
+                       traits:(MDMAnimationTraits *)traits
+              timeScaleFactor:(CGFloat)timeScaleFactor
+                  destination:(id)destination
+                   valueClass:(MDMValueClass)valueClass
+                 initialValue:(id(^)(BOOL wantsPresentationValue,
+                                     InitialVelocity *velocity))initialValueBlock
+                   completion:(void(^)(BOOL))completion {
+  [self configureAnimation:animation
+                  forLayer:layer
+               withKeyPath:keyPath
+                    traits:traits
+               destination:destination
+                valueClass:valueClass
+              initialValue:initialValueBlock];
+  if (animation.additive) {
+    _counters.additiveAnimationCount++;
+  } else {
+    _counters.nonAdditiveAnimationCount++;
+  }
+
+  NSString *key = animation.additive ? nil : keyPath;
 
   if (traits.delay != 0) {
     animation.beginTime = ([layer convertTime:CACurrentMediaTime() fromLayer:nil]
@@ -357,7 +1009,7 @@
   }
 
 
-  [_registrar addAnimation:animation toLayer:layer forKey:key completion:completion];
+  return [_registrar addAnimation:animation toLayer:layer forKey:key completion:completion];
 }
 
 @end
@@ -0,0 +1,125 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "MDMAnimatableKeyPaths.h"
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+/**
+ Stacks at least this deep are counted together by the stack depth histograms of
+ MDMMotionAnimatorMetrics.
+ */
+FOUNDATION_EXPORT const NSUInteger MDMMotionAnimatorMetricsMaximumStackDepth
+    NS_SWIFT_NAME(MotionAnimatorMetrics.maximumStackDepth);
+
+/**
+ An immutable snapshot of an MDMMotionAnimator's activity, as returned by its currentMetrics
+ method.
+
+ A stack is the set of animations an animator has in flight for a single layer and key path, e.g.
+ the additive animations that build up on a view's position while it is being flung.
+
+ Cumulative counts start when the animator is created or when its metrics are reset.
+ */
+NS_SWIFT_NAME(MotionAnimatorMetrics)
+@interface MDMMotionAnimatorMetrics : NSObject
+
+/**
+ The number of animations the animator currently has in flight.
+
+ Animations added by a single call, such as the animations of an implicit animation block or of a
+ staggered group, share one completion. An animation that finishes before the others added by the
+ same call is counted until all of them have finished.
+ */
+@property(nonatomic, assign, readonly) NSUInteger activeAnimationCount;
+
+/**
+ The largest number of animations the animator has had in flight at once.
+ */
+@property(nonatomic, assign, readonly) NSUInteger peakActiveAnimationCount;
+
+/**
+ The number of additive animations the animator has added.
+ */
+@property(nonatomic, assign, readonly) NSUInteger additiveAnimationCount;
+
+/**
+ The number of non-additive animations the animator has added.
+ */
+@property(nonatomic, assign, readonly) NSUInteger nonAdditiveAnimationCount;
+
+/**
+ The number of additive animations that have been folded by stack compaction. See
+ -[MDMMotionAnimator maximumAdditiveStackDepth].
+ */
+@property(nonatomic, assign, readonly) NSUInteger foldedAnimationCount;
+
+/**
+ The number of animation requests that changed their values without animating, either because the
+ effective time scale factor was zero or because the traits did not produce an animation.
+ */
+@property(nonatomic, assign, readonly) NSUInteger earlyExitCount;
+
+/**
+ The number of model layer transactions the animator did not need to open.
+
+ Outside of an animator-managed scope, each explicit animation writes its destination to the model
+ layer in a transaction of its own. Within recordAnimations:completion: and applyPlan:completion:,
+ the writes of the whole scope are deferred until its animations have been added and then share a
+ single transaction. Within the animations block of animateWithTraits:animations:, writes disable
+ the actions of the block's transaction instead of opening a transaction.
+ */
+@property(nonatomic, assign, readonly) NSUInteger avoidedTransactionCount;
+
+/**
+ The cumulative time, in seconds, spent inside the animator's animateWithTraits: family of methods,
+ excluding the animations blocks that they invoke.
+ */
+@property(nonatomic, assign, readonly) NSTimeInterval mainThreadTime;
+
+/**
+ Returns the number of layers that currently have exactly `depth` animations in flight, or at
+ least `depth` animations for MDMMotionAnimatorMetricsMaximumStackDepth.
+ */
+- (NSUInteger)numberOfLayersWithAnimationCount:(NSUInteger)depth;
+
+/**
+ Returns the number of stacks on the given key path that are currently exactly `depth` animations
+ deep, or at least `depth` animations deep for MDMMotionAnimatorMetricsMaximumStackDepth.
+
+ Key paths that are not declared in MDMAnimatableKeyPaths.h are counted together.
+ */
+- (NSUInteger)numberOfStacksWithDepth:(NSUInteger)depth
+                            forKeyPath:(nonnull MDMAnimatableKeyPath)keyPath;
+
+/**
+ Returns the depth of the deepest stack the given key path has had.
+
+ Key paths that are not declared in MDMAnimatableKeyPaths.h are counted together.
+ */
+- (NSUInteger)peakStackDepthForKeyPath:(nonnull MDMAnimatableKeyPath)keyPath;
+
+/**
+ Metrics are obtained from -[MDMMotionAnimator currentMetrics].
+ */
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
+
+API_DEPRECATED_END
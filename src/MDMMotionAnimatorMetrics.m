@@ -0,0 +1,63 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMMotionAnimatorMetrics.h"
+
+#import "private/MDMKeyPathKind.h"
+#import "private/MDMMotionAnimatorMetrics+Private.h"
+
+const NSUInteger MDMMotionAnimatorMetricsMaximumStackDepth = MDMAnimationIndexDepthBucketCount;
+
+@implementation MDMMotionAnimatorMetrics {
+  MDMAnimationRegistrarMetrics _registrarMetrics;
+}
+
+- (instancetype)initWithMetrics:(const MDMAnimationRegistrarMetrics *)metrics
+                       counters:(MDMMotionAnimatorCounters)counters {
+  self = [super init];
+  if (self) {
+    _registrarMetrics = *metrics;
+    _activeAnimationCount = metrics->activeAnimationCount;
+    _peakActiveAnimationCount = metrics->peakActiveAnimationCount;
+    _additiveAnimationCount = counters.additiveAnimationCount;
+    _nonAdditiveAnimationCount = counters.nonAdditiveAnimationCount;
+    _foldedAnimationCount = metrics->foldedAnimationCount;
+    _earlyExitCount = counters.earlyExitCount;
+    _avoidedTransactionCount = counters.avoidedTransactionCount;
+    _mainThreadTime = (NSTimeInterval)counters.mainThreadNanoseconds * 1e-9;
+  }
+  return self;
+}
+
+- (NSUInteger)numberOfLayersWithAnimationCount:(NSUInteger)depth {
+  if (depth == 0 || depth > MDMMotionAnimatorMetricsMaximumStackDepth) {
+    return 0;
+  }
+  return (NSUInteger)_registrarMetrics.histograms.layers[depth - 1];
+}
+
+- (NSUInteger)numberOfStacksWithDepth:(NSUInteger)depth forKeyPath:(MDMAnimatableKeyPath)keyPath {
+  if (depth == 0 || depth > MDMMotionAnimatorMetricsMaximumStackDepth) {
+    return 0;
+  }
+  return (NSUInteger)_registrarMetrics.histograms.tags[MDMKindOfKeyPath(keyPath)][depth - 1];
+}
+
+- (NSUInteger)peakStackDepthForKeyPath:(MDMAnimatableKeyPath)keyPath {
+  return _registrarMetrics.peakStackDepths[MDMKindOfKeyPath(keyPath)];
+}
+
+@end
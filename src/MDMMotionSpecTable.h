@@ -0,0 +1,139 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_MOTION_SPEC_TABLE_H
+#define MDM_MOTION_SPEC_TABLE_H
+
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The kinds of timing curve a motion spec table can describe. */
+typedef uint32_t MDMMotionSpecCurveKind;
+enum {
+  /** parameters: x1, y1, x2, y2, as in CAMediaTimingFunction. */
+  MDMMotionSpecCurveKindCubicBezier = 1,
+
+  /** parameters: mass, tension, friction and initial velocity, as in MDMSpringTimingCurve. */
+  MDMMotionSpecCurveKindSpring = 2,
+};
+
+/**
+ A timing curve shared by any number of a table's entries.
+
+ The layout of this struct is part of the serialized format.
+ */
+typedef struct {
+  MDMMotionSpecCurveKind kind;
+  uint32_t reserved;
+  double parameters[4];
+} MDMMotionSpecCurve;
+
+/**
+ The timing of a single animation: the equivalent of one MDMAnimationTraits instance.
+
+ The layout of this struct is part of the serialized format.
+ */
+typedef struct {
+  double delay;
+  double duration;
+  /** The index of the entry's timing curve in its table's curves. */
+  uint32_t curveIndex;
+  uint32_t reserved;
+} MDMMotionSpecEntry;
+
+/**
+ A motion spec expressed as plain data.
+
+ Tables are typically declared once with static storage duration and never modified, which makes
+ them safe to share across threads:
+
+     static const MDMMotionSpecCurve kCurves[] = {
+       MDMMotionSpecCubicBezier(0.4, 0, 0.2, 1),
+     };
+     static const MDMMotionSpecEntry kEntries[] = {
+       MDMMotionSpecEntryMake(0.000, 0.285, 0),
+       MDMMotionSpecEntryMake(0.015, 0.360, 0),
+     };
+     static const MDMMotionSpecTable kSpec = MDMMotionSpecTableMake(kCurves, kEntries);
+ */
+typedef struct {
+  const MDMMotionSpecCurve *curves;
+  uint32_t curveCount;
+  const MDMMotionSpecEntry *entries;
+  uint32_t entryCount;
+} MDMMotionSpecTable;
+
+#define MDMMotionSpecCubicBezier(x1, y1, x2, y2) \
+  { MDMMotionSpecCurveKindCubicBezier, 0, { (x1), (y1), (x2), (y2) } }
+
+#define MDMMotionSpecSpring(mass, tension, friction, initialVelocity) \
+  { MDMMotionSpecCurveKindSpring, 0, { (mass), (tension), (friction), (initialVelocity) } }
+
+#define MDMMotionSpecEntryMake(delay, duration, curveIndex) \
+  { (delay), (duration), (curveIndex), 0 }
+
+#define MDMMotionSpecTableMake(curves, entries)                                    \
+  { (curves), (uint32_t)(sizeof(curves) / sizeof((curves)[0])), (entries),         \
+    (uint32_t)(sizeof(entries) / sizeof((entries)[0])) }
+
+/**
+ Returns 1 if every entry refers to an existing curve of a known kind and has a finite,
+ non-negative delay and duration. Returns 0 otherwise.
+ */
+int MDMMotionSpecTableValidate(const MDMMotionSpecTable *table);
+
+/** Returns whether the two tables describe the same curves and entries. */
+int MDMMotionSpecTableEqual(const MDMMotionSpecTable *table, const MDMMotionSpecTable *other);
+
+/** Returns a hash of the table's contents that is consistent with MDMMotionSpecTableEqual. */
+uint64_t MDMMotionSpecTableHash(const MDMMotionSpecTable *table);
+
+/**
+ Returns the number of bytes MDMMotionSpecTableSerialize writes for the table.
+
+ The serialized form is a 24 byte header followed by the table's curves and entries, laid out
+ exactly as they are in memory. Every field is naturally aligned, so a serialized table that is
+ loaded at an 8 byte aligned address, e.g. by memory-mapping a file, can be used in place.
+ */
+size_t MDMMotionSpecTableSerializedSize(const MDMMotionSpecTable *table);
+
+/**
+ Writes the table to `buffer`. Returns the number of bytes written, or 0 if the table is invalid or
+ `size` is too small.
+ */
+size_t MDMMotionSpecTableSerialize(const MDMMotionSpecTable *table, void *buffer, size_t size);
+
+/**
+ Points `table` at the curves and entries of a serialized table without copying them. `bytes` must
+ remain valid for as long as `table` is in use.
+
+ Returns 0 if the bytes are not a valid serialized table, were written by a machine of a different
+ byte order, or are not 8 byte aligned.
+ */
+int MDMMotionSpecTableInitWithBytes(MDMMotionSpecTable *table, const void *bytes, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_MOTION_SPEC_TABLE_H
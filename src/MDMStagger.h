@@ -0,0 +1,66 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+/**
+ Describes how the animations of a staggered group are delayed relative to one another.
+
+ The delay of each layer of a group is added to the delay of the group's traits. Delays are scaled
+ by the animator's time scale factor along with the rest of the animation.
+ */
+NS_SWIFT_NAME(Stagger)
+@interface MDMStagger : NSObject
+
+/**
+ Returns a stagger that delays the layer at index i of the group by i * interval.
+ */
++ (nonnull instancetype)linearStaggerWithInterval:(NSTimeInterval)interval
+    NS_SWIFT_NAME(linear(interval:));
+
+/**
+ Returns a stagger that distributes the delays of a group's layers along a timing function.
+
+ The first layer of the group begins immediately and the last one begins after `duration`. The
+ layer at index i of n begins after `duration` multiplied by the timing function's progress at
+ i / (n - 1).
+ */
++ (nonnull instancetype)easedStaggerWithDuration:(NSTimeInterval)duration
+                                  timingFunction:(nonnull CAMediaTimingFunction *)timingFunction
+    NS_SWIFT_NAME(eased(duration:timingFunction:));
+
+/**
+ Returns a stagger whose delays are provided by a block.
+
+ @param block  Returns the delay of the layer at `index` of a group of `count` layers. The block is
+               invoked once per layer, in index order, each time the stagger is used.
+ */
++ (nonnull instancetype)staggerWithBlock:
+    (nonnull NSTimeInterval (^)(NSUInteger index, NSUInteger count))block
+    NS_SWIFT_NAME(custom(_:));
+
+/**
+ Staggers are created with one of the class factory methods.
+ */
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
+
+API_DEPRECATED_END
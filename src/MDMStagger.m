@@ -0,0 +1,71 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMStagger.h"
+
+#import "private/MDMStagger+Private.h"
+#import "private/MDMStaggerTiming.h"
+
+@implementation MDMStagger {
+  MDMStaggerTiming _timing;
+  NSTimeInterval (^_block)(NSUInteger, NSUInteger);
+}
+
+- (instancetype)initWithTiming:(const MDMStaggerTiming *)timing
+                         block:(NSTimeInterval (^)(NSUInteger, NSUInteger))block {
+  self = [super init];
+  if (self) {
+    if (timing != NULL) {
+      _timing = *timing;
+    }
+    _block = [block copy];
+  }
+  return self;
+}
+
++ (instancetype)linearStaggerWithInterval:(NSTimeInterval)interval {
+  MDMStaggerTiming timing;
+  MDMStaggerTimingInitLinear(&timing, interval);
+  return [[self alloc] initWithTiming:&timing block:nil];
+}
+
++ (instancetype)easedStaggerWithDuration:(NSTimeInterval)duration
+                          timingFunction:(CAMediaTimingFunction *)timingFunction {
+  float controlPoint1[2];
+  float controlPoint2[2];
+  [timingFunction getControlPointAtIndex:1 values:controlPoint1];
+  [timingFunction getControlPointAtIndex:2 values:controlPoint2];
+  MDMStaggerTiming timing;
+  MDMStaggerTimingInitEased(&timing, duration, controlPoint1[0], controlPoint1[1],
+                            controlPoint2[0], controlPoint2[1]);
+  return [[self alloc] initWithTiming:&timing block:nil];
+}
+
++ (instancetype)staggerWithBlock:(NSTimeInterval (^)(NSUInteger, NSUInteger))block {
+  return [[self alloc] initWithTiming:NULL block:block];
+}
+
+- (void)getDelays:(double *)delays count:(NSUInteger)count {
+  if (_block) {
+    for (NSUInteger i = 0; i < count; ++i) {
+      delays[i] = _block(i, count);
+    }
+    return;
+  }
+  MDMStaggerTimingComputeDelays(&_timing, count, delays);
+}
+
+@end
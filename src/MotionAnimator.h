@@ -16,5 +16,11 @@
 
 #import "CATransaction+MotionAnimator.h"
 #import "MDMAnimatableKeyPaths.h"
+#import "MDMAnimationPlan.h"
+#import "MDMAnimationTraceRecorder.h"
+#import "MDMCompiledMotionSpec.h"
 #import "MDMMotionAnimator.h"
+#import "MDMMotionAnimatorMetrics.h"
+#import "MDMMotionSpecTable.h"
+#import "MDMStagger.h"
 
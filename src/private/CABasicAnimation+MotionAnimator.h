@@ -24,6 +24,10 @@
 #import <MotionInterchange/MotionInterchange.h>
 #endif
 
+#import "MDMPresentationEvaluator.h"
+#import "MDMValueClass.h"
+#import "MDMValueKernels.h"
+
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
 
@@ -31,15 +35,59 @@ API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
 FOUNDATION_EXPORT
 CABasicAnimation *MDMAnimationFromTraits(MDMAnimationTraits *traits, CGFloat timeScaleFactor);
 
-// Returns a Boolean indicating whether or not an animation with the given key path and toValue
-// can be animated additively.
-FOUNDATION_EXPORT BOOL MDMCanAnimationBeAdditive(NSString *keyPath, id toValue);
+// Returns a Boolean indicating whether or not an animation with the given key path and class of
+// toValue can be animated additively.
+FOUNDATION_EXPORT BOOL MDMCanAnimationBeAdditive(NSString *keyPath, MDMValueClass valueClass);
 
 // If the animation's additive property is enabled, then its from/to values will be transformed into
 // additive equivalents.
 //
 // Not all animation value types support being additive. If an animation's value type was not
 // supported, the animation's values will not be modified.
-FOUNDATION_EXPORT void MDMConfigureAnimation(CABasicAnimation *animation, MDMAnimationTraits *traits);
+//
+// Springs of an MDMSpringTimingCurve are given an initial velocity that combines the traits'
+// initial velocity with `initialVelocity`, the rate of change of the animated value at the moment
+// the animation begins, so that an interrupted animation's momentum carries over to the animation
+// that replaces it. Their duration is then the settling duration of the resulting spring. Springs
+// of an MDMSpringTimingCurveGenerator take neither.
+//
+// @param valueClass      The class of the animation's toValue.
+// @param initialVelocity The rate of change of the value in units per second, or NULL if unknown.
+FOUNDATION_EXPORT void MDMConfigureAnimation(CABasicAnimation *animation,
+                                             MDMAnimationTraits *traits,
+                                             MDMValueClass valueClass,
+                                             const MDMValue *initialVelocity);
+
+// Unboxes a Core Animation value. Returns NO if the value is not of a type that can be animated
+// additively.
+FOUNDATION_EXPORT BOOL MDMUnboxValue(id boxedValue, MDMValue *value);
+
+// Unboxes a Core Animation value that has already been classified as `valueClass`.
+FOUNDATION_EXPORT
+BOOL MDMUnboxValueOfClass(id boxedValue, MDMValueClass valueClass, MDMValue *value);
+
+// Boxes a value in the NSNumber or NSValue type Core Animation expects for its value type.
+FOUNDATION_EXPORT id MDMBoxValue(const MDMValue *value);
+
+// Describes the animation to the presentation evaluator, assuming it begins at `beginTime` in its
+// layer's timespace.
+//
+// Returns NO if the animation relies on timing or value features the evaluator does not model,
+// such as repetition, a non-unit speed or a missing fromValue.
+FOUNDATION_EXPORT
+BOOL MDMEvaluatorAnimationFromAnimation(CABasicAnimation *animation,
+                                        CFTimeInterval beginTime,
+                                        MDMEvaluatorAnimation *evaluatorAnimation);
+
+// Returns a linear keyframe animation that approximates the animation's timing curve to within
+// `tolerance`, a fraction of the distance between its from and to values. Keyframes are memoized
+// per timing curve, duration and tolerance.
+//
+// Returns nil if the animation is already linear, or if its timing or values can't be described
+// to the presentation evaluator. Transforms are not supported, as Core Animation interpolates
+// them by decomposition rather than per component.
+FOUNDATION_EXPORT
+CAKeyframeAnimation *MDMKeyframeAnimationFromAnimation(CABasicAnimation *animation,
+                                                       double tolerance);
 
 API_DEPRECATED_END
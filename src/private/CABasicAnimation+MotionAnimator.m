@@ -18,121 +18,348 @@
 
 #import "CAMediaTimingFunction+MotionAnimator.h"
 #import "MDMAnimatableKeyPaths.h"
+#import "MDMKeyframeCache.h"
+#import "MDMSpringCache.h"
+#import "MDMUIKitValueCoercion.h"
 
 #import <UIKit/UIKit.h>
+#import <os/lock.h>
 
 #pragma mark - Private
 
-static BOOL IsNumberValue(id someValue) {
-  return [someValue isKindOfClass:[NSNumber class]];
+static BOOL IsAnimationKeyPathAlwaysNonAdditive(NSString *keyPath) {
+  static NSSet *nonAdditiveKeyPaths = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    nonAdditiveKeyPaths = [NSSet setWithArray:@[MDMKeyPathAnchorPoint,
+                                                MDMKeyPathBackgroundColor,
+                                                MDMKeyPathOpacity]];
+  });
+
+  return [nonAdditiveKeyPaths containsObject:keyPath];
 }
 
-static BOOL IsCGPointType(id someValue) {
-  if ([someValue isKindOfClass:[NSValue class]]) {
-    NSValue *asValue = (NSValue *)someValue;
-    const char *objCType = @encode(CGPoint);
-    return strncmp(asValue.objCType, objCType, strlen(objCType)) == 0;
-  }
-  return NO;
+static CABasicAnimation *SpringAnimation(CGFloat mass,
+                                         CGFloat tension,
+                                         CGFloat friction,
+                                         CFTimeInterval duration) {
+#pragma clang diagnostic push
+  // CASpringAnimation is a private API on iOS 8 - we're able to make use of it because we're
+  // linking against the public API on iOS 9+.
+#pragma clang diagnostic ignored "-Wpartial-availability"
+  CASpringAnimation *animation = [CASpringAnimation animation];
+#pragma clang diagnostic pop
+  animation.mass = mass;
+  animation.stiffness = tension;
+  animation.damping = friction;
+  animation.duration = duration;
+  return animation;
 }
 
-static BOOL IsCGSizeType(id someValue) {
-  if ([someValue isKindOfClass:[NSValue class]]) {
-    NSValue *asValue = (NSValue *)someValue;
-    const char *objCType = @encode(CGSize);
-    return strncmp(asValue.objCType, objCType, strlen(objCType)) == 0;
+// MDMSpringCacheGeneratorResolver that generates the timing curve of an
+// MDMSpringTimingCurveGenerator.
+static int ResolveSpringTimingCurveGenerator(void *context, double coefficients[4]) {
+  MDMSpringTimingCurveGenerator *generator = (__bridge MDMSpringTimingCurveGenerator *)context;
+  MDMSpringTimingCurve *springTimingCurve = generator.springTimingCurve;
+  if (springTimingCurve == nil) {
+    return 0;
   }
-  return NO;
+  coefficients[0] = springTimingCurve.mass;
+  coefficients[1] = springTimingCurve.tension;
+  coefficients[2] = springTimingCurve.friction;
+  coefficients[3] = springTimingCurve.initialVelocity;
+  return 1;
+}
+
+// The number of keyframes MDMKeyframeAnimationFromAnimation looks up without allocating. Most
+// curves need far fewer at the default tolerance.
+#define kKeyframeBufferCount 128
+
+// A cache of fully configured animations that MDMAnimationFromTraits copies from, rather than
+// building a new animation from scratch for each call.
+//
+// Prototypes are keyed by the identity of the timing curve object and by the parameters read from
+// it, so that a hit neither classifies the curve nor resolves its coefficients. Each slot retains
+// its timing curve so that the curve's address can't be reused by another object while cached.
+
+#define kPrototypeCacheSize 64
+
+typedef enum {
+  PrototypeKindNone,
+  PrototypeKindCubicBezier,
+  PrototypeKindSpring,
+  PrototypeKindSpringGenerator,
+} PrototypeKind;
+
+typedef struct {
+  PrototypeKind kind;
+  // Mass, tension and friction for springs. Duration, damping ratio and initial velocity for spring
+  // generators. Unused for cubic beziers, whose timing functions are immutable.
+  double values[3];
+  // The traits' duration, scaled by the time scale factor for cubic beziers.
+  CFTimeInterval duration;
+} PrototypeKey;
+
+typedef struct {
+  CFTypeRef timingCurve;
+  PrototypeKey key;
+  CFTypeRef animation;
+} PrototypeSlot;
+
+static PrototypeSlot sPrototypes[kPrototypeCacheSize];
+static os_unfair_lock sPrototypesLock = OS_UNFAIR_LOCK_INIT;
+
+static NSUInteger PrototypeSlotIndex(id timingCurve) {
+  uint64_t hash = (uint64_t)(uintptr_t)(__bridge void *)timingCurve * 0x9e3779b97f4a7c15ULL;
+  return (NSUInteger)((hash ^ (hash >> 32)) % kPrototypeCacheSize);
 }
 
-static BOOL IsCGRectType(id someValue) {
-  if ([someValue isKindOfClass:[NSValue class]]) {
-    NSValue *asValue = (NSValue *)someValue;
-    const char *objCType = @encode(CGRect);
-    return strncmp(asValue.objCType, objCType, strlen(objCType)) == 0;
+static PrototypeKind PrototypeKindOfTimingCurve(id<MDMTimingCurve> timingCurve) {
+  if ([timingCurve isKindOfClass:[CAMediaTimingFunction class]]) {
+    return PrototypeKindCubicBezier;
+  } else if ([timingCurve isKindOfClass:[MDMSpringTimingCurveGenerator class]]) {
+    return PrototypeKindSpringGenerator;
+  } else if ([timingCurve isKindOfClass:[MDMSpringTimingCurve class]]) {
+    return PrototypeKindSpring;
   }
-  return NO;
+  return PrototypeKindNone;
 }
 
-static BOOL IsCATransform3DType(id someValue) {
-  if ([someValue isKindOfClass:[NSValue class]]) {
-    NSValue *asValue = (NSValue *)someValue;
-    const char *objCType = @encode(CATransform3D);
-    return strncmp(asValue.objCType, objCType, strlen(objCType)) == 0;
+// Reads the parameters of a timing curve of the given kind. Returns NO if the curve produces no
+// animation.
+static BOOL GetPrototypeKey(id<MDMTimingCurve> timingCurve,
+                            PrototypeKind kind,
+                            MDMAnimationTraits *traits,
+                            CGFloat timeScaleFactor,
+                            PrototypeKey *key) {
+  memset(key, 0, sizeof(PrototypeKey));  // Keys are compared including their padding.
+  key->kind = kind;
+  key->duration = traits.duration;
+  switch (kind) {
+    case PrototypeKindCubicBezier:
+      key->duration *= timeScaleFactor;
+      return key->duration != 0;
+    case PrototypeKindSpring: {
+      MDMSpringTimingCurve *springTiming = (MDMSpringTimingCurve *)timingCurve;
+      key->values[0] = springTiming.mass;
+      key->values[1] = springTiming.tension;
+      key->values[2] = springTiming.friction;
+      return YES;
+    }
+    case PrototypeKindSpringGenerator: {
+      MDMSpringTimingCurveGenerator *springTimingGenerator =
+          (MDMSpringTimingCurveGenerator *)timingCurve;
+      key->values[0] = springTimingGenerator.duration;
+      key->values[1] = springTimingGenerator.dampingRatio;
+      key->values[2] = springTimingGenerator.initialVelocity;
+      return YES;
+    }
+    case PrototypeKindNone:
+      return NO;
   }
   return NO;
 }
 
-static BOOL IsAnimationKeyPathAlwaysNonAdditive(NSString *keyPath) {
-  static NSSet *nonAdditiveKeyPaths = nil;
-  static dispatch_once_t onceToken;
-  dispatch_once(&onceToken, ^{
-    nonAdditiveKeyPaths = [NSSet setWithArray:@[MDMKeyPathAnchorPoint,
-                                                MDMKeyPathBackgroundColor,
-                                                MDMKeyPathOpacity]];
-  });
+// Returns a copy of the timing curve's prototype if one is cached and its key still matches the
+// curve's parameters. Sets `*cachedKind` to the kind the curve was cached as, or PrototypeKindNone
+// if no prototype is cached for the curve.
+static CABasicAnimation *CopyOfPrototype(id<MDMTimingCurve> timingCurve,
+                                         MDMAnimationTraits *traits,
+                                         CGFloat timeScaleFactor,
+                                         PrototypeKind *cachedKind) {
+  PrototypeSlot *slot = &sPrototypes[PrototypeSlotIndex(timingCurve)];
+  CABasicAnimation *prototype = nil;
+  PrototypeKey cachedKey;
+  os_unfair_lock_lock(&sPrototypesLock);
+  if (slot->timingCurve == (__bridge CFTypeRef)timingCurve) {
+    memcpy(&cachedKey, &slot->key, sizeof(PrototypeKey));
+    prototype = (__bridge CABasicAnimation *)slot->animation;
+  }
+  os_unfair_lock_unlock(&sPrototypesLock);
+  if (prototype == nil) {
+    *cachedKind = PrototypeKindNone;
+    return nil;
+  }
+  *cachedKind = cachedKey.kind;
 
-  return [nonAdditiveKeyPaths containsObject:keyPath];
+  // The curve is the same object, so it is still of the kind it was cached as. Its parameters may
+  // have been mutated since, however.
+  PrototypeKey key;
+  if (!GetPrototypeKey(timingCurve, cachedKey.kind, traits, timeScaleFactor, &key)
+      || memcmp(&key, &cachedKey, sizeof(PrototypeKey)) != 0) {
+    return nil;
+  }
+  // Prototypes are never mutated once stored, so they can be copied outside of the lock.
+  return [prototype copy];
+}
+
+static void StorePrototype(id<MDMTimingCurve> timingCurve,
+                           const PrototypeKey *key,
+                           CABasicAnimation *animation) {
+  PrototypeSlot *slot = &sPrototypes[PrototypeSlotIndex(timingCurve)];
+  // The prototype must not be affected by mutations to the animation we hand back to the caller.
+  CFTypeRef prototype = CFBridgingRetain([animation copy]);
+  CFTypeRef retainedTimingCurve = CFBridgingRetain(timingCurve);
+  os_unfair_lock_lock(&sPrototypesLock);
+  CFTypeRef evictedTimingCurve = slot->timingCurve;
+  CFTypeRef evictedAnimation = slot->animation;
+  slot->timingCurve = retainedTimingCurve;
+  memcpy(&slot->key, key, sizeof(PrototypeKey));  // Includes padding, which keys are compared by.
+  slot->animation = prototype;
+  os_unfair_lock_unlock(&sPrototypesLock);
+  if (evictedAnimation != NULL) {
+    CFRelease(evictedAnimation);
+  }
+  if (evictedTimingCurve != NULL) {
+    CFRelease(evictedTimingCurve);
+  }
 }
 
 #pragma mark - Public
 
-CABasicAnimation *MDMAnimationFromTraits(MDMAnimationTraits *traits, CGFloat timeScaleFactor) {
-  if (traits.timingCurve == nil) {
-    return nil;
+BOOL MDMUnboxValue(id boxedValue, MDMValue *value) {
+  return MDMUnboxValueOfClass(boxedValue, MDMClassifyValue(boxedValue), value);
+}
+
+BOOL MDMUnboxValueOfClass(id boxedValue, MDMValueClass valueClass, MDMValue *value) {
+  switch (valueClass) {
+    case MDMValueClassNumber: {
+      double lane = [boxedValue doubleValue];
+      MDMValueInit(value, MDMValueTypeScalar, &lane);
+      return YES;
+    }
+    case MDMValueClassSize: {
+      CGSize size = [boxedValue CGSizeValue];
+      double lanes[2] = {size.width, size.height};
+      MDMValueInit(value, MDMValueTypeSize, lanes);
+      return YES;
+    }
+    case MDMValueClassPoint: {
+      CGPoint point = [boxedValue CGPointValue];
+      double lanes[2] = {point.x, point.y};
+      MDMValueInit(value, MDMValueTypePoint, lanes);
+      return YES;
+    }
+    case MDMValueClassRect: {
+      CGRect rect = [boxedValue CGRectValue];
+      double lanes[4] = {rect.origin.x, rect.origin.y, rect.size.width, rect.size.height};
+      MDMValueInit(value, MDMValueTypeRect, lanes);
+      return YES;
+    }
+    case MDMValueClassTransform3D: {
+      CATransform3D t = [boxedValue CATransform3DValue];
+      double lanes[16] = {
+        t.m11, t.m12, t.m13, t.m14,
+        t.m21, t.m22, t.m23, t.m24,
+        t.m31, t.m32, t.m33, t.m34,
+        t.m41, t.m42, t.m43, t.m44,
+      };
+      MDMValueInit(value, MDMValueTypeTransform3D, lanes);
+      return YES;
+    }
+    default:
+      return NO;
   }
+}
 
-  if ([traits.timingCurve isKindOfClass:[CAMediaTimingFunction class]]) {
-    CFTimeInterval duration = traits.duration * timeScaleFactor;
-    if (duration == 0) {
-      return nil;
+id MDMBoxValue(const MDMValue *value) {
+  const double *lanes = value->lanes;
+  switch (value->type) {
+    case MDMValueTypeScalar:
+      return @(lanes[0]);
+    case MDMValueTypePoint:
+      return [NSValue valueWithCGPoint:CGPointMake((CGFloat)lanes[0], (CGFloat)lanes[1])];
+    case MDMValueTypeSize:
+      return [NSValue valueWithCGSize:CGSizeMake((CGFloat)lanes[0], (CGFloat)lanes[1])];
+    case MDMValueTypeRect:
+      return [NSValue valueWithCGRect:CGRectMake((CGFloat)lanes[0], (CGFloat)lanes[1],
+                                                 (CGFloat)lanes[2], (CGFloat)lanes[3])];
+    case MDMValueTypeTransform3D: {
+      CATransform3D t;
+      t.m11 = (CGFloat)lanes[0];  t.m12 = (CGFloat)lanes[1];
+      t.m13 = (CGFloat)lanes[2];  t.m14 = (CGFloat)lanes[3];
+      t.m21 = (CGFloat)lanes[4];  t.m22 = (CGFloat)lanes[5];
+      t.m23 = (CGFloat)lanes[6];  t.m24 = (CGFloat)lanes[7];
+      t.m31 = (CGFloat)lanes[8];  t.m32 = (CGFloat)lanes[9];
+      t.m33 = (CGFloat)lanes[10]; t.m34 = (CGFloat)lanes[11];
+      t.m41 = (CGFloat)lanes[12]; t.m42 = (CGFloat)lanes[13];
+      t.m43 = (CGFloat)lanes[14]; t.m44 = (CGFloat)lanes[15];
+      return [NSValue valueWithCATransform3D:t];
     }
-    CABasicAnimation *animation = [CABasicAnimation animation];
-    animation.timingFunction = (CAMediaTimingFunction *)traits.timingCurve;
-    animation.duration = duration;
-    return animation;
   }
+  return nil;
+}
 
-  CABasicAnimation *(^animationFromSpring)(MDMSpringTimingCurve *) =
-      ^(MDMSpringTimingCurve *springTiming) {
-#pragma clang diagnostic push
-        // CASpringAnimation is a private API on iOS 8 - we're able to make use of it because we're
-        // linking against the public API on iOS 9+.
-#pragma clang diagnostic ignored "-Wpartial-availability"
-        CASpringAnimation *animation = [CASpringAnimation animation];
-#pragma clang diagnostic pop
-        animation.mass = springTiming.mass;
-        animation.stiffness = springTiming.tension;
-        animation.damping = springTiming.friction;
-        animation.duration = traits.duration;
-        return animation;
-      };
+CABasicAnimation *MDMAnimationFromTraits(MDMAnimationTraits *traits, CGFloat timeScaleFactor) {
+  id<MDMTimingCurve> timingCurve = traits.timingCurve;
+  if (timingCurve == nil) {
+    return nil;
+  }
 
-  if ([traits.timingCurve isKindOfClass:[MDMSpringTimingCurveGenerator class]]) {
-    MDMSpringTimingCurveGenerator *springTimingGenerator =
-        (MDMSpringTimingCurveGenerator *)traits.timingCurve;
-    return animationFromSpring(springTimingGenerator.springTimingCurve);
+  PrototypeKind kind;
+  CABasicAnimation *animation = CopyOfPrototype(timingCurve, traits, timeScaleFactor, &kind);
+  if (animation != nil) {
+    return animation;
   }
 
-  if ([traits.timingCurve isKindOfClass:[MDMSpringTimingCurve class]]) {
-    return animationFromSpring((MDMSpringTimingCurve *)traits.timingCurve);
+  // If the curve was cached before, only its parameters have changed since.
+  if (kind == PrototypeKindNone) {
+    kind = PrototypeKindOfTimingCurve(timingCurve);
+  }
+  if (kind == PrototypeKindNone) {
+    NSCAssert(NO, @"Unsupported animation trait: %@", traits);
+    return nil;
+  }
+  PrototypeKey key;
+  if (!GetPrototypeKey(timingCurve, kind, traits, timeScaleFactor, &key)) {
+    return nil;
   }
 
-  NSCAssert(NO, @"Unsupported animation trait: %@", traits);
-  return nil;
+  switch (kind) {
+    case PrototypeKindCubicBezier:
+      animation = [CABasicAnimation animation];
+      animation.timingFunction = (CAMediaTimingFunction *)timingCurve;
+      animation.duration = key.duration;
+      break;
+    case PrototypeKindSpring:
+      animation = SpringAnimation((CGFloat)key.values[0], (CGFloat)key.values[1],
+                                  (CGFloat)key.values[2], key.duration);
+      break;
+    case PrototypeKindSpringGenerator: {
+      // Generating a spring timing curve is relatively expensive, so we memoize the coefficients
+      // of each distinct generator configuration.
+      double coefficients[4];
+      if (!MDMSpringCacheResolveGenerator(MDMSpringCacheShared(),
+                                          key.values[0],
+                                          key.values[1],
+                                          key.values[2],
+                                          ResolveSpringTimingCurveGenerator,
+                                          (__bridge void *)timingCurve,
+                                          coefficients)) {
+        return nil;
+      }
+      animation = SpringAnimation((CGFloat)coefficients[0], (CGFloat)coefficients[1],
+                                  (CGFloat)coefficients[2], key.duration);
+      break;
+    }
+    case PrototypeKindNone:
+      return nil;
+  }
+  StorePrototype(timingCurve, &key, animation);
+  return animation;
 }
 
-BOOL MDMCanAnimationBeAdditive(NSString *keyPath, id toValue) {
-  if (IsAnimationKeyPathAlwaysNonAdditive(keyPath)) {
+BOOL MDMCanAnimationBeAdditive(NSString *keyPath, MDMValueClass valueClass) {
+  if (!MDMValueClassIsAdditive(valueClass)) {
     return NO;
   }
-  return (IsNumberValue(toValue)
-          || IsCGSizeType(toValue)
-          || IsCGPointType(toValue)
-          || IsCATransform3DType(toValue));
+  return !IsAnimationKeyPathAlwaysNonAdditive(keyPath);
 }
 
-void MDMConfigureAnimation(CABasicAnimation *animation, MDMAnimationTraits * traits) {
+void MDMConfigureAnimation(CABasicAnimation *animation,
+                           MDMAnimationTraits *traits,
+                           MDMValueClass valueClass,
+                           const MDMValue *initialVelocity) {
 #pragma clang diagnostic push
   // CASpringAnimation is a private API on iOS 8 - we're able to make use of it because we're
   // linking against the public API on iOS 9+.
@@ -143,12 +370,16 @@ void MDMConfigureAnimation(CABasicAnimation *animation, MDMAnimationTraits * tra
   MDMSpringTimingCurve *springTimingCurve = (MDMSpringTimingCurve *)traits.timingCurve;
   CASpringAnimation *springAnimation = (CASpringAnimation *)animation;
 #pragma clang diagnostic pop
+  // Springs generated from a duration and damping ratio don't take an initial velocity, so only
+  // springs configured from a spring timing curve carry the value's velocity over.
+  BOOL carriesVelocity = isSpringAnimation && initialVelocity != NULL;
 
   if (!animation.additive && !isSpringAnimation) {
     return; // Nothing to do here.
   }
 
-  if (IsNumberValue(animation.toValue)) {
+  MDMValue to;
+  if (MDMUnboxValueOfClass(animation.toValue, valueClass, &to)) {
     // Non-additive animations animate along a direct path between fromValue and toValue, regardless
     // of the model layer. Additive animations, on the other hand, animate towards the layer's model
     // value by applying this formula:
@@ -175,15 +406,26 @@ void MDMConfigureAnimation(CABasicAnimation *animation, MDMAnimationTraits * tra
     //  |         100 |         -10 |                 90 |
     //  |         100 |          -5 |                 95 |
     //  |         100 |           0 |                100 |
+    //
+    // Transforms compose by concatenation rather than addition, so their additive displacement is
+    // from x to^-1 and their accumulator animates to the identity transform instead.
+    id fromValue = animation.fromValue;
+    MDMValue from;
+    if (MDMClassifyValue(fromValue) != valueClass
+        || !MDMUnboxValueOfClass(fromValue, valueClass, &from)) {
+      // Matches the zero-valued structs that unboxing a nil fromValue produces.
+      static const double kZeroLanes[MDMValueMaxLaneCount];
+      MDMValueInit(&from, to.type, kZeroLanes);
+    }
 
-    CGFloat from = (CGFloat)[animation.fromValue doubleValue];
-    CGFloat to = (CGFloat)[animation.toValue doubleValue];
-    CGFloat displacement = to - from;
-    CGFloat additiveDisplacement = -displacement;
+    MDMValue additiveDisplacement;
+    MDMValueAdditiveDisplacement(&from, &to, &additiveDisplacement);
 
     if (animation.additive) {
-      animation.fromValue = @(additiveDisplacement);
-      animation.toValue = @0;
+      MDMValue identity;
+      MDMValueInitAdditiveIdentity(&identity, to.type);
+      animation.fromValue = MDMBoxValue(&additiveDisplacement);
+      animation.toValue = MDMBoxValue(&identity);
     }
 
     if (isSpringAnimation) {
@@ -225,112 +467,170 @@ void MDMConfigureAnimation(CABasicAnimation *animation, MDMAnimationTraits * tra
       //
       // As for our sign, if absoluteInitialVelocity matches the direction of displacement, then our
       // sign will be positive. Otherwise, our sign will be negative, as expected by Core Animation.
-
-      if (fabs(displacement) > 0.00001) {
-        springAnimation.initialVelocity = absoluteInitialVelocity / displacement;
+      //
+      // Core Animation's velocity system is single dimensional, so multi-dimensional values pick
+      // the dominant direction of movement and normalize accordingly. Transforms are left as-is.
+      double normalizedVelocity;
+      if (MDMValueNormalizeVelocity(&additiveDisplacement, absoluteInitialVelocity,
+                                    &normalizedVelocity)) {
+        springAnimation.initialVelocity = (CGFloat)normalizedVelocity;
       }
     }
 
-  } else if (IsCGSizeType(animation.toValue)) {
-    CGSize from = [animation.fromValue CGSizeValue];
-    CGSize to = [animation.toValue CGSizeValue];
-    CGSize additiveDisplacement = CGSizeMake(from.width - to.width, from.height - to.height);
-
-    if (animation.additive) {
-      animation.fromValue = [NSValue valueWithCGSize:additiveDisplacement];
-      animation.toValue = [NSValue valueWithCGSize:CGSizeZero];
+    // An animation that interrupts another continues with the value's current velocity rather
+    // than starting from rest, which would otherwise produce a visible kink. The velocity is in the
+    // same absolute units as the traits' initial velocity, so it is normalized the same way.
+    double carriedVelocity;
+    if (carriesVelocity
+        && MDMValueNormalizeVelocityValue(&additiveDisplacement, initialVelocity,
+                                          &carriedVelocity)) {
+      springAnimation.initialVelocity += (CGFloat)carriedVelocity;
     }
+  }
 
-    if (isSpringAnimation) {
-      // Core Animation's velocity system is single dimensional, so we pick the dominant direction
-      // of movement and normalize accordingly.
-      CGFloat biggestDelta;
-      if (fabs(additiveDisplacement.width) > fabs(additiveDisplacement.height)) {
-        biggestDelta = additiveDisplacement.width;
-      } else {
-        biggestDelta = additiveDisplacement.height;
-      }
-      CGFloat displacement = -biggestDelta;
-      CGFloat absoluteInitialVelocity = springTimingCurve.initialVelocity;
-      if (fabs(displacement) > 0.00001) {
-        springAnimation.initialVelocity = absoluteInitialVelocity / displacement;
-      }
+  if (isSpringAnimation) {
+    // CASpringAnimation's settlingDuration simulates the spring on every access, so we solve for
+    // the settling duration analytically instead. Solutions are memoized per configuration.
+    MDMSpringCacheSolution solution;
+    if (MDMSpringCacheSolve(MDMSpringCacheShared(),
+                            springAnimation.mass,
+                            springAnimation.stiffness,
+                            springAnimation.damping,
+                            springAnimation.initialVelocity,
+                            &solution)
+        && isfinite(solution.settlingDuration)) {
+      animation.duration = solution.settlingDuration;
     }
+  }
+}
 
-  } else if (IsCGPointType(animation.toValue)) {
-    CGPoint from = [animation.fromValue CGPointValue];
-    CGPoint to = [animation.toValue CGPointValue];
-    CGPoint additiveDisplacement = CGPointMake(from.x - to.x, from.y - to.y);
+BOOL MDMEvaluatorAnimationFromAnimation(CABasicAnimation *animation,
+                                        CFTimeInterval beginTime,
+                                        MDMEvaluatorAnimation *evaluatorAnimation) {
+  if (animation.speed != 1 || animation.timeOffset != 0 || animation.repeatCount != 0
+      || animation.repeatDuration != 0 || animation.autoreverses || animation.isCumulative
+      || animation.byValue != nil || animation.valueFunction != nil) {
+    return NO;
+  }
+  if (!MDMUnboxValue(animation.fromValue, &evaluatorAnimation->fromValue)
+      || !MDMUnboxValue(animation.toValue, &evaluatorAnimation->toValue)
+      || evaluatorAnimation->fromValue.type != evaluatorAnimation->toValue.type) {
+    return NO;
+  }
+  evaluatorAnimation->additive = animation.additive;
+  evaluatorAnimation->beginTime = beginTime;
+  evaluatorAnimation->duration = animation.duration;
+
+  // Animations that are removed on completion never fill forwards, regardless of their fill mode.
+  NSString *fillMode = animation.fillMode;
+  BOOL fillsBoth = [fillMode isEqualToString:kCAFillModeBoth];
+  int fill = MDMFillModeRemoved;
+  if (fillsBoth || [fillMode isEqualToString:kCAFillModeBackwards]) {
+    fill |= MDMFillModeBackwards;
+  }
+  if (!animation.removedOnCompletion
+      && (fillsBoth || [fillMode isEqualToString:kCAFillModeForwards])) {
+    fill |= MDMFillModeForwards;
+  }
+  evaluatorAnimation->fillMode = (MDMFillMode)fill;
 
-    if (animation.additive) {
-      animation.fromValue = [NSValue valueWithCGPoint:additiveDisplacement];
-      animation.toValue = [NSValue valueWithCGPoint:CGPointZero];
+  MDMTimingCurve *timingCurve = &evaluatorAnimation->timingCurve;
+  memset(timingCurve, 0, sizeof(*timingCurve));
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpartial-availability"
+  if ([animation isKindOfClass:[CASpringAnimation class]]) {
+    if (animation.timingFunction != nil) {
+      return NO;
     }
-
-    if (isSpringAnimation) {
-      // Core Animation's velocity system is single dimensional, so we pick the dominant direction
-      // of movement and normalize accordingly.
-      CGFloat biggestDelta;
-      if (fabs(additiveDisplacement.x) > fabs(additiveDisplacement.y)) {
-        biggestDelta = additiveDisplacement.x;
-      } else {
-        biggestDelta = additiveDisplacement.y;
-      }
-      CGFloat displacement = -biggestDelta;
-      CGFloat absoluteInitialVelocity = springTimingCurve.initialVelocity;
-      if (fabs(displacement) > 0.00001) {
-        springAnimation.initialVelocity = absoluteInitialVelocity / displacement;
-      }
+    CASpringAnimation *springAnimation = (CASpringAnimation *)animation;
+    MDMSpringCacheSolution solution;
+    if (!MDMSpringCacheSolve(MDMSpringCacheShared(),
+                             springAnimation.mass,
+                             springAnimation.stiffness,
+                             springAnimation.damping,
+                             springAnimation.initialVelocity,
+                             &solution)) {
+      return NO;
     }
+    timingCurve->kind = MDMTimingCurveKindSpring;
+    timingCurve->spring = solution.solver;
+    return YES;
+  }
+#pragma clang diagnostic pop
 
-  } else if (IsCGRectType(animation.toValue)) {
-    CGRect from = [animation.fromValue CGRectValue];
-    CGRect to = [animation.toValue CGRectValue];
-    CGRect additiveDisplacement = CGRectMake(from.origin.x - to.origin.x,
-                                             from.origin.y - to.origin.y,
-                                             from.size.width - to.size.width,
-                                             from.size.height - to.size.height);
-
-    if (animation.additive) {
-      animation.fromValue = [NSValue valueWithCGRect:additiveDisplacement];
-      animation.toValue = [NSValue valueWithCGRect:CGRectZero];
-    }
+  CAMediaTimingFunction *timingFunction = animation.timingFunction;
+  if (timingFunction == nil) {
+    timingCurve->kind = MDMTimingCurveKindLinear;
+    return YES;
+  }
+  float controlPoint1[2];
+  float controlPoint2[2];
+  [timingFunction getControlPointAtIndex:1 values:controlPoint1];
+  [timingFunction getControlPointAtIndex:2 values:controlPoint2];
+  timingCurve->kind = MDMTimingCurveKindCubicBezier;
+  MDMCubicBezierInit(&timingCurve->bezier,
+                     controlPoint1[0], controlPoint1[1], controlPoint2[0], controlPoint2[1]);
+  return YES;
+}
 
-    if (isSpringAnimation) {
-      // Core Animation's velocity system is single dimensional, so we pick the dominant direction
-      // of movement and normalize accordingly.
-      CGFloat biggestDelta = additiveDisplacement.origin.x;
-      if (fabs(additiveDisplacement.origin.y) > fabs(biggestDelta)) {
-        biggestDelta = additiveDisplacement.origin.y;
-      }
-      if (fabs(additiveDisplacement.size.width) > fabs(biggestDelta)) {
-        biggestDelta = additiveDisplacement.size.width;
-      }
-      if (fabs(additiveDisplacement.size.height) > fabs(biggestDelta)) {
-        biggestDelta = additiveDisplacement.size.height;
-      }
-      CGFloat displacement = -biggestDelta;
-      CGFloat absoluteInitialVelocity = springTimingCurve.initialVelocity;
-      if (fabs(displacement) > 0.00001) {
-        springAnimation.initialVelocity = absoluteInitialVelocity / displacement;
-      }
+CAKeyframeAnimation *MDMKeyframeAnimationFromAnimation(CABasicAnimation *animation,
+                                                       double tolerance) {
+  MDMEvaluatorAnimation evaluatorAnimation;
+  if (!MDMEvaluatorAnimationFromAnimation(animation, animation.beginTime, &evaluatorAnimation)
+      || evaluatorAnimation.timingCurve.kind == MDMTimingCurveKindLinear
+      || evaluatorAnimation.toValue.type == MDMValueTypeTransform3D) {
+    return nil;
+  }
+  // Matches Core Animation's treatment of a zero duration.
+  CFTimeInterval duration = animation.duration > 0 ? animation.duration : 0.25;
+
+  MDMKeyframe buffer[kKeyframeBufferCount];
+  MDMKeyframe *keyframes = buffer;
+  size_t count = MDMKeyframeCacheLookup(MDMKeyframeCacheShared(), &evaluatorAnimation.timingCurve,
+                                        duration, tolerance, buffer, kKeyframeBufferCount);
+  if (count > kKeyframeBufferCount) {
+    keyframes = malloc(count * sizeof(MDMKeyframe));
+    if (!keyframes) {
+      return nil;
     }
-
-  } else if (IsCATransform3DType(animation.toValue)) {
-    CATransform3D from = [animation.fromValue CATransform3DValue];
-    CATransform3D to = [animation.toValue CATransform3DValue];
-
-    if (animation.additive) {
-      CATransform3D divisor = CATransform3DInvert(to);
-      animation.fromValue = [NSValue valueWithCATransform3D:CATransform3DConcat(from, divisor)];
-      animation.toValue = [NSValue valueWithCATransform3D:CATransform3DIdentity];
+    count = MDMKeyframeCacheLookup(MDMKeyframeCacheShared(), &evaluatorAnimation.timingCurve,
+                                   duration, tolerance, keyframes, count);
+  }
+  if (count < 2) {
+    if (keyframes != buffer) {
+      free(keyframes);
     }
+    return nil;
   }
 
-  if (isSpringAnimation) {
-    // This API is only available on iOS 9+
-    if ([springAnimation respondsToSelector:@selector(settlingDuration)]) {
-      animation.duration = springAnimation.settlingDuration;
+  const MDMValue *from = &evaluatorAnimation.fromValue;
+  const MDMValue *to = &evaluatorAnimation.toValue;
+  size_t laneCount = MDMValueTypeLaneCount(to->type);
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:count];
+  NSMutableArray<NSNumber *> *keyTimes = [NSMutableArray arrayWithCapacity:count];
+  for (size_t i = 0; i < count; ++i) {
+    MDMValue value;
+    value.type = to->type;
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+      value.lanes[lane] = (from->lanes[lane]
+                           + (to->lanes[lane] - from->lanes[lane]) * keyframes[i].progress);
     }
+    [values addObject:MDMBoxValue(&value)];
+    [keyTimes addObject:@(keyframes[i].time)];
+  }
+  if (keyframes != buffer) {
+    free(keyframes);
   }
+
+  CAKeyframeAnimation *keyframeAnimation =
+      [CAKeyframeAnimation animationWithKeyPath:animation.keyPath];
+  keyframeAnimation.values = values;
+  keyframeAnimation.keyTimes = keyTimes;
+  keyframeAnimation.calculationMode = kCAAnimationLinear;
+  keyframeAnimation.duration = duration;
+  keyframeAnimation.beginTime = animation.beginTime;
+  keyframeAnimation.fillMode = animation.fillMode;
+  keyframeAnimation.additive = animation.additive;
+  keyframeAnimation.removedOnCompletion = animation.removedOnCompletion;
+  return keyframeAnimation;
 }
@@ -0,0 +1,103 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMAdditiveCompaction.h"
+
+#include <math.h>
+
+#pragma mark - Private
+
+static double LargestMagnitude(const MDMValue *value, size_t laneCount) {
+  double largest = 0;
+  for (size_t lane = 0; lane < laneCount; ++lane) {
+    largest = fmax(largest, fabs(value->lanes[lane]));
+  }
+  return largest;
+}
+
+#pragma mark - Public
+
+int MDMAdditiveFoldAnimations(const MDMEvaluatorAnimation *animations,
+                              size_t count,
+                              double time,
+                              double timeConstant,
+                              double tolerance,
+                              MDMAdditiveFold *fold) {
+  if (count == 0 || !(timeConstant > 0)) {
+    return 0;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (!animations[i].additive) {
+      return 0;
+    }
+  }
+
+  // Evaluating the animations on top of the additive identity yields their combined displacement.
+  MDMValueType type = animations[0].fromValue.type;
+  MDMEvaluatorStack stack = {.animations = animations, .count = count};
+  MDMValueInitAdditiveIdentity(&stack.modelValue, type);
+  MDMValue displacement;
+  MDMValue velocity;
+  if (!MDMEvaluatorEvaluate(&stack, time, &displacement)
+      || !MDMEvaluatorEvaluateVelocity(&stack, time, &velocity)) {
+    return 0;
+  }
+
+  // The primary spring carries the velocity's projection onto the displacement. Its unit velocity
+  // v satisfies -v * displacement = projection, as its value is displacement * (1 - progress).
+  size_t laneCount = MDMValueTypeLaneCount(type);
+  double primaryVelocity = 0;
+  if (LargestMagnitude(&displacement, laneCount) > tolerance) {
+    double dot = 0;
+    double squaredLength = 0;
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+      dot += velocity.lanes[lane] * displacement.lanes[lane];
+      squaredLength += displacement.lanes[lane] * displacement.lanes[lane];
+    }
+    primaryVelocity = -dot / squaredLength;
+  }
+
+  // The residual spring starts at perpendicular * timeConstant with a unit velocity of
+  // primaryVelocity - 1 / timeConstant. The primary spring then starts at displacement - residual,
+  // and the two springs' velocities sum to projection + perpendicular = velocity.
+  MDMValue residual;
+  MDMValueInitAdditiveIdentity(&residual, type);
+  for (size_t lane = 0; lane < laneCount; ++lane) {
+    double perpendicular = velocity.lanes[lane] + primaryVelocity * displacement.lanes[lane];
+    residual.lanes[lane] = perpendicular * timeConstant;
+  }
+
+  fold->displacement = displacement;
+  fold->velocity = velocity;
+  fold->count = 0;
+  int hasResidual = LargestMagnitude(&residual, laneCount) > tolerance;
+  if (!hasResidual && LargestMagnitude(&displacement, laneCount) <= tolerance) {
+    return 1;  // The stack has settled.
+  }
+
+  MDMFoldedAnimation *primary = &fold->animations[fold->count++];
+  primary->displacement = displacement;
+  primary->initialVelocity = primaryVelocity;
+  if (hasResidual) {
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+      primary->displacement.lanes[lane] -= residual.lanes[lane];
+    }
+    MDMFoldedAnimation *secondary = &fold->animations[fold->count++];
+    secondary->displacement = residual;
+    secondary->initialVelocity = primaryVelocity - 1 / timeConstant;
+  }
+  return 1;
+}
@@ -0,0 +1,78 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_ADDITIVE_COMPACTION_H
+#define MDM_ADDITIVE_COMPACTION_H
+
+// Folds a stack of additive animations into at most two equivalent spring animations.
+//
+// Each additive animation contributes a displacement that settles at zero. At the moment of
+// compaction, the stack's combined displacement O and velocity V are replaced by:
+//
+// - a primary spring whose displacement moves parallel to O and carries V's component along O, and
+// - a residual spring carrying V's component perpendicular to O, which is omitted when it would
+//   displace the value by no more than the tolerance.
+//
+// Core Animation's spring velocity is single dimensional, so a single spring can only move along
+// its own displacement. The residual spring is what allows the fold to preserve the direction of
+// V. Only vector value types are supported. This file is intentionally free of any Apple framework
+// dependencies so that it can be built and tested on any platform.
+
+#include <stddef.h>
+
+#include "MDMPresentationEvaluator.h"
+#include "MDMValueKernels.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// An additive spring animation that settles at the additive identity.
+typedef struct {
+  // The animation's additive fromValue.
+  MDMValue displacement;
+  // In Core Animation's unit coordinate system: positive values move towards the identity.
+  double initialVelocity;
+} MDMFoldedAnimation;
+
+typedef struct {
+  // The folded animations' combined displacement and velocity, in units per second.
+  MDMValue displacement;
+  MDMValue velocity;
+  // The animations replacing the folded stack. Only the first `count` are valid.
+  MDMFoldedAnimation animations[2];
+  size_t count;
+} MDMAdditiveFold;
+
+// Folds the `count` animations at `time`. `timeConstant` is the time, in seconds, the residual
+// spring would take to travel its displacement at its initial velocity; 1 / the spring's undamped
+// angular frequency is a good choice. Residual displacements no larger than `tolerance` in any
+// lane are dropped.
+//
+// Returns 0 if any of the animations is non-additive or of an unsupported or mismatched type, in
+// which case `fold` is left untouched.
+int MDMAdditiveFoldAnimations(const MDMEvaluatorAnimation *animations,
+                              size_t count,
+                              double time,
+                              double timeConstant,
+                              double tolerance,
+                              MDMAdditiveFold *fold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_ADDITIVE_COMPACTION_H
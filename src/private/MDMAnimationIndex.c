@@ -0,0 +1,543 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMAnimationIndex.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kEmptySlot (-1)
+#define kInitialTableCapacity 16
+#define kInitialEntryCapacity 4
+
+typedef struct {
+  const void *layer;
+  MDMAnimationIndexEntry *entries;
+  size_t count;
+  size_t capacity;
+  // The number of entries that have not been removed. Only differs from `count` during iteration.
+  size_t liveCount;
+} LayerRecord;
+
+struct MDMAnimationIndex {
+  MDMAnimationIndexCallbacks layerCallbacks;
+  MDMAnimationIndexCallbacks valueCallbacks;
+
+  // Dense array of layers with at least one entry. The records between `recordCount` and
+  // `recordCapacity` are spares whose entry arrays are reused by the next layers to be inserted, so
+  // that steady-state churn of layers doesn't allocate.
+  LayerRecord *records;
+  size_t recordCount;
+  size_t recordCapacity;
+
+  // Open-addressed, linearly probed table of indices into `records`. The capacity is a power of two
+  // and the table is kept at most half full.
+  int32_t *table;
+  size_t tableCapacity;
+
+  size_t entryCount;
+  size_t layerCount;
+
+  // Distinguishes the keys rendered by this index from those of every other index.
+  uint64_t serial;
+  // The key numbers released by removed entries, most recently released last. The capacity is kept
+  // at least `keyNumberCount`, so that releasing a key number never needs to allocate.
+  uint32_t *freeKeyNumbers;
+  size_t freeKeyNumberCount;
+  size_t freeKeyNumberCapacity;
+  // The number of key numbers assigned so far, which is also the largest.
+  uint32_t keyNumberCount;
+
+  // The most recent identifier assigned by this index.
+  MDMAnimationID lastIdentifier;
+  uint64_t generation;
+
+  // While greater than zero, removals only mark entries as removed and records are never moved.
+  size_t iterationDepth;
+  int needsCompaction;
+};
+
+// The most recent identifier assigned by any index.
+static MDMAnimationID sLastIdentifier = MDMAnimationIDNone;
+
+// The serial number of the most recently created index.
+static uint64_t sLastSerial = 0;
+
+#pragma mark - Private
+
+static const void *Retain(const MDMAnimationIndexCallbacks *callbacks, const void *value) {
+  if (value != NULL && callbacks->retain != NULL) {
+    return callbacks->retain(value);
+  }
+  return value;
+}
+
+static void Release(const MDMAnimationIndexCallbacks *callbacks, const void *value) {
+  if (value != NULL && callbacks->release != NULL) {
+    callbacks->release(value);
+  }
+}
+
+static size_t HomeSlot(const void *layer, size_t tableCapacity) {
+  uint64_t hash = (uint64_t)(uintptr_t)layer * 0x9e3779b97f4a7c15ULL;
+  hash ^= hash >> 32;
+  return (size_t)hash & (tableCapacity - 1);
+}
+
+// Returns the table slot holding the layer, or the empty slot where it would be inserted.
+static size_t FindSlot(const MDMAnimationIndex *index, const void *layer) {
+  size_t mask = index->tableCapacity - 1;
+  size_t slot = HomeSlot(layer, index->tableCapacity);
+  while (index->table[slot] != kEmptySlot && index->records[index->table[slot]].layer != layer) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+static LayerRecord *FindRecord(const MDMAnimationIndex *index, const void *layer) {
+  if (index->tableCapacity == 0) {
+    return NULL;
+  }
+  int32_t recordIndex = index->table[FindSlot(index, layer)];
+  return recordIndex == kEmptySlot ? NULL : &index->records[recordIndex];
+}
+
+static int ResizeTable(MDMAnimationIndex *index, size_t tableCapacity) {
+  int32_t *table = malloc(tableCapacity * sizeof(int32_t));
+  if (!table) {
+    return 0;
+  }
+  for (size_t i = 0; i < tableCapacity; ++i) {
+    table[i] = kEmptySlot;
+  }
+  free(index->table);
+  index->table = table;
+  index->tableCapacity = tableCapacity;
+  for (size_t i = 0; i < index->recordCount; ++i) {
+    table[FindSlot(index, index->records[i].layer)] = (int32_t)i;
+  }
+  return 1;
+}
+
+// Returns the layer's record, creating it if needed.
+static LayerRecord *InsertRecord(MDMAnimationIndex *index, const void *layer) {
+  if ((index->recordCount + 1) * 2 > index->tableCapacity) {
+    size_t tableCapacity = index->tableCapacity ? index->tableCapacity * 2 : kInitialTableCapacity;
+    if (!ResizeTable(index, tableCapacity)) {
+      return NULL;
+    }
+  }
+  size_t slot = FindSlot(index, layer);
+  if (index->table[slot] != kEmptySlot) {
+    return &index->records[index->table[slot]];
+  }
+  if (index->recordCount == index->recordCapacity) {
+    size_t recordCapacity = index->recordCapacity ? index->recordCapacity * 2 : kInitialTableCapacity;
+    LayerRecord *records = realloc(index->records, recordCapacity * sizeof(LayerRecord));
+    if (!records) {
+      return NULL;
+    }
+    memset(&records[index->recordCapacity], 0,
+           (recordCapacity - index->recordCapacity) * sizeof(LayerRecord));
+    index->records = records;
+    index->recordCapacity = recordCapacity;
+  }
+  LayerRecord *record = &index->records[index->recordCount];
+  MDMAnimationIndexEntry *entries = record->entries;
+  size_t capacity = record->capacity;
+  memset(record, 0, sizeof(LayerRecord));
+  record->entries = entries;
+  record->capacity = capacity;
+  record->layer = Retain(&index->layerCallbacks, layer);
+  index->table[slot] = (int32_t)index->recordCount;
+  index->recordCount++;
+  return record;
+}
+
+// Removes an empty record from the table and the dense record array.
+static void RemoveRecord(MDMAnimationIndex *index, LayerRecord *record) {
+  size_t mask = index->tableCapacity - 1;
+  size_t recordIndex = (size_t)(record - index->records);
+  size_t slot = FindSlot(index, record->layer);
+
+  // Backward-shift deletion keeps every remaining layer reachable from its home slot.
+  size_t next = (slot + 1) & mask;
+  while (index->table[next] != kEmptySlot) {
+    size_t home = HomeSlot(index->records[index->table[next]].layer, index->tableCapacity);
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      index->table[slot] = index->table[next];
+      slot = next;
+    }
+    next = (next + 1) & mask;
+  }
+  index->table[slot] = kEmptySlot;
+
+  const void *layer = record->layer;
+  LayerRecord spare = {NULL, record->entries, 0, record->capacity, 0};
+
+  size_t lastIndex = index->recordCount - 1;
+  if (recordIndex != lastIndex) {
+    index->records[recordIndex] = index->records[lastIndex];
+    index->table[FindSlot(index, index->records[recordIndex].layer)] = (int32_t)recordIndex;
+  }
+  index->records[lastIndex] = spare;
+  index->recordCount--;
+
+  Release(&index->layerCallbacks, layer);
+}
+
+// Removes a record that was inserted for an entry that could not be added.
+static void RemoveRecordIfEmpty(MDMAnimationIndex *index, LayerRecord *record) {
+  if (record->count == 0 && index->iterationDepth == 0) {
+    RemoveRecord(index, record);
+  }
+}
+
+static void FreeRecords(LayerRecord *records, size_t recordCapacity) {
+  for (size_t i = 0; i < recordCapacity; ++i) {
+    free(records[i].entries);
+  }
+  free(records);
+}
+
+// Returns the histogram bucket of a group of `count` entries, which must be greater than zero.
+static size_t DepthBucket(size_t count) {
+  return count < MDMAnimationIndexDepthBucketCount ? count - 1
+                                                   : MDMAnimationIndexDepthBucketCount - 1;
+}
+
+// Returns a key number for a new entry, or 0 if memory could not be allocated.
+static uint32_t AcquireKeyNumber(MDMAnimationIndex *index) {
+  if (index->freeKeyNumberCount > 0) {
+    return index->freeKeyNumbers[--index->freeKeyNumberCount];
+  }
+  if (index->keyNumberCount == UINT32_MAX) {
+    return 0;
+  }
+  if (index->keyNumberCount == index->freeKeyNumberCapacity) {
+    size_t capacity = index->freeKeyNumberCapacity ? index->freeKeyNumberCapacity * 2
+                                                   : kInitialEntryCapacity;
+    uint32_t *freeKeyNumbers = realloc(index->freeKeyNumbers, capacity * sizeof(uint32_t));
+    if (!freeKeyNumbers) {
+      return 0;
+    }
+    index->freeKeyNumbers = freeKeyNumbers;
+    index->freeKeyNumberCapacity = capacity;
+  }
+  return ++index->keyNumberCount;
+}
+
+static void ReleaseEntry(MDMAnimationIndex *index, const MDMAnimationIndexEntry *entry) {
+  if (entry->keyNumber != 0) {
+    index->freeKeyNumbers[index->freeKeyNumberCount++] = entry->keyNumber;
+  }
+  Release(&index->valueCallbacks, entry->animation);
+  Release(&index->valueCallbacks, entry->key);
+}
+
+// Marks an entry as removed. Its values are released when the index is compacted.
+static void MarkRemoved(MDMAnimationIndex *index, LayerRecord *record, MDMAnimationIndexEntry *entry) {
+  entry->identifier = MDMAnimationIDNone;
+  record->liveCount--;
+  if (record->liveCount == 0) {
+    index->layerCount--;
+  }
+  index->entryCount--;
+  index->needsCompaction = 1;
+}
+
+// Reclaims the entries and records that were marked as removed during iteration.
+static void Compact(MDMAnimationIndex *index) {
+  index->needsCompaction = 0;
+  // Walking backwards means that the record moved into a removed record's position has already been
+  // compacted.
+  for (size_t i = index->recordCount; i > 0; --i) {
+    LayerRecord *record = &index->records[i - 1];
+    size_t count = 0;
+    for (size_t j = 0; j < record->count; ++j) {
+      if (record->entries[j].identifier == MDMAnimationIDNone) {
+        ReleaseEntry(index, &record->entries[j]);
+      } else {
+        record->entries[count++] = record->entries[j];
+      }
+    }
+    record->count = count;
+    if (count == 0) {
+      RemoveRecord(index, record);
+    }
+  }
+}
+
+#pragma mark - Public
+
+MDMAnimationIndex *MDMAnimationIndexCreate(const MDMAnimationIndexCallbacks *layerCallbacks,
+                                           const MDMAnimationIndexCallbacks *valueCallbacks) {
+  MDMAnimationIndex *index = calloc(1, sizeof(MDMAnimationIndex));
+  if (!index) {
+    return NULL;
+  }
+  if (layerCallbacks) {
+    index->layerCallbacks = *layerCallbacks;
+  }
+  if (valueCallbacks) {
+    index->valueCallbacks = *valueCallbacks;
+  }
+  index->serial = __atomic_add_fetch(&sLastSerial, 1, __ATOMIC_RELAXED);
+  return index;
+}
+
+void MDMAnimationIndexDestroy(MDMAnimationIndex *index) {
+  if (!index) {
+    return;
+  }
+  MDMAnimationIndexRemoveAll(index);
+  FreeRecords(index->records, index->recordCapacity);
+  free(index->table);
+  free(index->freeKeyNumbers);
+  free(index);
+}
+
+MDMAnimationID MDMAnimationIndexAdd(MDMAnimationIndex *index,
+                                    const void *layer,
+                                    const void *animation,
+                                    const void *key,
+                                    double beginTime,
+                                    uint32_t tag) {
+  LayerRecord *record = InsertRecord(index, layer);
+  if (!record) {
+    return MDMAnimationIDNone;
+  }
+  if (record->count == record->capacity) {
+    size_t capacity = record->capacity ? record->capacity * 2 : kInitialEntryCapacity;
+    MDMAnimationIndexEntry *entries =
+        realloc(record->entries, capacity * sizeof(MDMAnimationIndexEntry));
+    if (!entries) {
+      RemoveRecordIfEmpty(index, record);
+      return MDMAnimationIDNone;
+    }
+    record->entries = entries;
+    record->capacity = capacity;
+  }
+  uint32_t keyNumber = 0;
+  if (key == NULL) {
+    keyNumber = AcquireKeyNumber(index);
+    if (keyNumber == 0) {
+      RemoveRecordIfEmpty(index, record);
+      return MDMAnimationIDNone;
+    }
+  }
+  MDMAnimationIndexEntry *entry = &record->entries[record->count++];
+  entry->identifier = __atomic_add_fetch(&sLastIdentifier, 1, __ATOMIC_RELAXED);
+  index->lastIdentifier = entry->identifier;
+  entry->animation = Retain(&index->valueCallbacks, animation);
+  entry->key = Retain(&index->valueCallbacks, key);
+  entry->keyNumber = keyNumber;
+  entry->beginTime = beginTime;
+  entry->tag = tag;
+  if (record->liveCount == 0) {
+    index->layerCount++;
+  }
+  record->liveCount++;
+  index->entryCount++;
+  index->generation++;
+  return entry->identifier;
+}
+
+int MDMAnimationIndexRemove(MDMAnimationIndex *index, const void *layer, MDMAnimationID identifier) {
+  LayerRecord *record = FindRecord(index, layer);
+  if (!record) {
+    return 0;
+  }
+  if (identifier == MDMAnimationIDNone) {
+    return 0;
+  }
+  for (size_t i = 0; i < record->count; ++i) {
+    if (record->entries[i].identifier != identifier) {
+      continue;
+    }
+    index->generation++;
+    if (index->iterationDepth > 0) {
+      MarkRemoved(index, record, &record->entries[i]);
+      return 1;
+    }
+    MDMAnimationIndexEntry removed = record->entries[i];
+    // Preserve the oldest-to-newest order of the remaining entries.
+    memmove(&record->entries[i], &record->entries[i + 1],
+            (record->count - i - 1) * sizeof(MDMAnimationIndexEntry));
+    record->count--;
+    record->liveCount--;
+    index->entryCount--;
+    if (record->count == 0) {
+      index->layerCount--;
+      RemoveRecord(index, record);
+    }
+    ReleaseEntry(index, &removed);
+    return 1;
+  }
+  return 0;
+}
+
+size_t MDMAnimationIndexRemoveHandles(MDMAnimationIndex *index,
+                                      const MDMAnimationIndexHandle *handles,
+                                      size_t count) {
+  size_t removedCount = 0;
+  for (size_t i = 0; i < count; ++i) {
+    removedCount += (size_t)MDMAnimationIndexRemove(index, handles[i].layer, handles[i].identifier);
+  }
+  return removedCount;
+}
+
+void MDMAnimationIndexRemoveAll(MDMAnimationIndex *index) {
+  index->generation++;
+  if (index->iterationDepth > 0) {
+    for (size_t i = 0; i < index->recordCount; ++i) {
+      LayerRecord *record = &index->records[i];
+      for (size_t j = 0; j < record->count && record->liveCount > 0; ++j) {
+        if (record->entries[j].identifier != MDMAnimationIDNone) {
+          MarkRemoved(index, record, &record->entries[j]);
+        }
+      }
+    }
+    return;
+  }
+
+  // Detach the records before releasing anything so that release callbacks observe an empty index.
+  LayerRecord *records = index->records;
+  size_t recordCount = index->recordCount;
+  size_t recordCapacity = index->recordCapacity;
+  index->records = NULL;
+  index->recordCount = 0;
+  index->recordCapacity = 0;
+  index->entryCount = 0;
+  index->layerCount = 0;
+  index->needsCompaction = 0;
+  for (size_t i = 0; i < index->tableCapacity; ++i) {
+    index->table[i] = kEmptySlot;
+  }
+
+  for (size_t i = 0; i < recordCount; ++i) {
+    for (size_t j = 0; j < records[i].count; ++j) {
+      ReleaseEntry(index, &records[i].entries[j]);
+    }
+    Release(&index->layerCallbacks, records[i].layer);
+    records[i].layer = NULL;
+    records[i].count = 0;
+    records[i].liveCount = 0;
+  }
+  if (index->records == NULL) {
+    // Nothing was added by the release callbacks, so the records and their entry arrays are kept
+    // for reuse.
+    index->records = records;
+    index->recordCapacity = recordCapacity;
+  } else {
+    FreeRecords(records, recordCapacity);
+  }
+}
+
+size_t MDMAnimationIndexCount(const MDMAnimationIndex *index) {
+  return index->entryCount;
+}
+
+size_t MDMAnimationIndexLayerCount(const MDMAnimationIndex *index) {
+  return index->layerCount;
+}
+
+const MDMAnimationIndexEntry *MDMAnimationIndexEntriesForLayer(const MDMAnimationIndex *index,
+                                                               const void *layer,
+                                                               size_t *count) {
+  LayerRecord *record = FindRecord(index, layer);
+  *count = record ? record->count : 0;
+  return record ? record->entries : NULL;
+}
+
+void MDMAnimationIndexForEach(MDMAnimationIndex *index,
+                              MDMAnimationIndexVisitor visitor,
+                              void *context) {
+  // Records are never removed or reordered while iterating, and entries are only ever appended, so
+  // positions remain stable. Entries beyond the last identifier were added during iteration.
+  MDMAnimationID lastIdentifier = index->lastIdentifier;
+  index->iterationDepth++;
+  for (size_t i = 0; i < index->recordCount; ++i) {
+    for (size_t j = 0; j < index->records[i].count; ++j) {
+      // The visitor may grow the record's storage, so the entry is copied before each visit. The
+      // copy's values remain retained until the iteration ends even if the entry is removed.
+      MDMAnimationIndexEntry entry = index->records[i].entries[j];
+      if (entry.identifier == MDMAnimationIDNone || entry.identifier > lastIdentifier) {
+        continue;
+      }
+      visitor(context, index->records[i].layer, &entry);
+    }
+  }
+  index->iterationDepth--;
+  if (index->iterationDepth == 0 && index->needsCompaction) {
+    Compact(index);
+  }
+}
+
+size_t MDMAnimationIndexCountForTag(const MDMAnimationIndex *index,
+                                    const void *layer,
+                                    uint32_t tag) {
+  const LayerRecord *record = FindRecord(index, layer);
+  if (!record) {
+    return 0;
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < record->count; ++i) {
+    const MDMAnimationIndexEntry *entry = &record->entries[i];
+    count += entry->identifier != MDMAnimationIDNone && entry->tag == tag;
+  }
+  return count;
+}
+
+void MDMAnimationIndexComputeDepthHistograms(const MDMAnimationIndex *index,
+                                             MDMAnimationIndexDepthHistograms *histograms) {
+  memset(histograms, 0, sizeof(*histograms));
+  for (size_t i = 0; i < index->recordCount; ++i) {
+    const LayerRecord *record = &index->records[i];
+    if (record->liveCount == 0) {
+      continue;
+    }
+    histograms->layers[DepthBucket(record->liveCount)]++;
+
+    size_t tagCounts[MDMAnimationIndexMaxHistogramTagCount] = {0};
+    for (size_t j = 0; j < record->count; ++j) {
+      const MDMAnimationIndexEntry *entry = &record->entries[j];
+      if (entry->identifier != MDMAnimationIDNone
+          && entry->tag < MDMAnimationIndexMaxHistogramTagCount) {
+        tagCounts[entry->tag]++;
+      }
+    }
+    for (size_t tag = 0; tag < MDMAnimationIndexMaxHistogramTagCount; ++tag) {
+      if (tagCounts[tag] > 0) {
+        histograms->tags[tag][DepthBucket(tagCounts[tag])]++;
+      }
+    }
+  }
+}
+
+uint64_t MDMAnimationIndexGeneration(const MDMAnimationIndex *index) {
+  return index->generation;
+}
+
+size_t MDMAnimationIndexFormatKey(const MDMAnimationIndex *index,
+                                  uint32_t keyNumber,
+                                  char *buffer,
+                                  size_t bufferSize) {
+  int length = snprintf(buffer, bufferSize, "mdm.%" PRIu64 ".%" PRIu32, index->serial, keyNumber);
+  return length > 0 ? (size_t)length : 0;
+}
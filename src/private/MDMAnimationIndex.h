@@ -0,0 +1,184 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_ANIMATION_INDEX_H
+#define MDM_ANIMATION_INDEX_H
+
+// Flat storage for the animations that MDMAnimationRegistrar has added to layers.
+//
+// Each layer owns a contiguous array of entries. Layers are located through an open-addressed hash
+// table keyed by pointer identity. Animations are identified by a monotonically increasing 64-bit
+// identifier that is unique across every index in the process.
+//
+// Animations added without a key are also assigned a key number, from which their Core Animation
+// key is rendered. Key numbers are reused once their entry has been removed, so an index renders no
+// more distinct keys than it has ever had entries at once, and callers can intern the rendered
+// keys. Keys include a serial number of their index, so keys rendered by different indices never
+// collide, e.g. those of two animators adding animations to the same layer.
+//
+// Layers, animations and keys are opaque pointers whose lifetimes are managed through the
+// callbacks provided on creation. This file is free of any Apple framework dependencies so that it
+// can be built and tested on any platform. It is not thread safe.
+//
+// Storage is pooled: the entry array of a layer whose last entry is removed is kept for the next
+// layer to be added rather than freed, so an index whose working set has been reached stops
+// allocating. Pooled storage is freed when the index is destroyed.
+//
+// The index may be mutated while it is being iterated. Entries removed during iteration are marked
+// as removed in place and their storage is reclaimed once the outermost iteration ends.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t MDMAnimationID;
+
+// An identifier that is never assigned to an animation.
+#define MDMAnimationIDNone ((MDMAnimationID)0)
+
+// Large enough to hold any key rendered by MDMAnimationIndexFormatKey, including the terminator.
+#define MDMAnimationIndexKeyBufferSize 48
+
+typedef struct {
+  // Returns the value to be stored. May be NULL, in which case the value is stored as-is.
+  const void *(*retain)(const void *value);
+  // May be NULL.
+  void (*release)(const void *value);
+} MDMAnimationIndexCallbacks;
+
+typedef struct {
+  MDMAnimationID identifier;
+  const void *animation;
+  // The key the animation was added with, or NULL if it was added with a generated key.
+  const void *key;
+  // The time, in the layer's timespace, at which the animation begins.
+  double beginTime;
+  // A caller-defined classification of the entry, e.g. the kind of key path it animates.
+  uint32_t tag;
+  // The number the generated key is rendered from, or 0 if the animation was added with a key.
+  uint32_t keyNumber;
+} MDMAnimationIndexEntry;
+
+// Identifies an entry for bulk removal.
+typedef struct {
+  const void *layer;
+  MDMAnimationID identifier;
+} MDMAnimationIndexHandle;
+
+typedef struct MDMAnimationIndex MDMAnimationIndex;
+
+// Invoked once for each entry. The visitor may add and remove entries. `entry` points to a copy
+// that remains valid for the duration of the call.
+typedef void (*MDMAnimationIndexVisitor)(void *context,
+                                         const void *layer,
+                                         const MDMAnimationIndexEntry *entry);
+
+// Creates an empty index. `layerCallbacks` are applied to layers while they have at least one
+// entry; `valueCallbacks` are applied to animations and keys. Either may be NULL.
+MDMAnimationIndex *MDMAnimationIndexCreate(const MDMAnimationIndexCallbacks *layerCallbacks,
+                                           const MDMAnimationIndexCallbacks *valueCallbacks);
+
+// Releases every entry and frees the index.
+void MDMAnimationIndexDestroy(MDMAnimationIndex *index);
+
+// Adds an entry for the animation and returns its identifier, or MDMAnimationIDNone if memory
+// could not be allocated. The new entry is the layer's newest entry.
+//
+// If `key` is NULL, the entry is assigned the key number most recently released by a removed entry,
+// or a new key number if none is available.
+MDMAnimationID MDMAnimationIndexAdd(MDMAnimationIndex *index,
+                                    const void *layer,
+                                    const void *animation,
+                                    const void *key,
+                                    double beginTime,
+                                    uint32_t tag);
+
+// Removes the entry with the given identifier from the layer. Returns 0 if no such entry exists.
+int MDMAnimationIndexRemove(MDMAnimationIndex *index, const void *layer, MDMAnimationID identifier);
+
+// Removes the entries identified by `handles`, skipping any that have already been removed. Returns
+// the number of entries that were removed.
+size_t MDMAnimationIndexRemoveHandles(MDMAnimationIndex *index,
+                                      const MDMAnimationIndexHandle *handles,
+                                      size_t count);
+
+// Removes every entry. The index keeps its storage for reuse.
+void MDMAnimationIndexRemoveAll(MDMAnimationIndex *index);
+
+// The total number of entries across all layers.
+size_t MDMAnimationIndexCount(const MDMAnimationIndex *index);
+
+// The number of layers with at least one entry.
+size_t MDMAnimationIndexLayerCount(const MDMAnimationIndex *index);
+
+// Returns the layer's entries, ordered from oldest to newest, and writes their count to `count`.
+// The returned pointer is invalidated by any mutation of the index. While the index is being
+// iterated, entries that have been removed are still present with an identifier of
+// MDMAnimationIDNone.
+const MDMAnimationIndexEntry *MDMAnimationIndexEntriesForLayer(const MDMAnimationIndex *index,
+                                                               const void *layer,
+                                                               size_t *count);
+
+// Visits every entry without allocating. Entries removed during iteration are not visited once
+// they have been removed; entries added during iteration are not visited at all. Calls may be
+// nested.
+void MDMAnimationIndexForEach(MDMAnimationIndex *index,
+                              MDMAnimationIndexVisitor visitor,
+                              void *context);
+
+// Returns the number of the layer's entries with the given tag.
+size_t MDMAnimationIndexCountForTag(const MDMAnimationIndex *index,
+                                    const void *layer,
+                                    uint32_t tag);
+
+// Histograms of how entries stack up, computed by MDMAnimationIndexComputeDepthHistograms.
+//
+// Bucket i counts the groups of exactly i + 1 entries, except for the last bucket, which counts
+// every group of MDMAnimationIndexDepthBucketCount or more entries.
+#define MDMAnimationIndexDepthBucketCount 8
+
+// Tags at or beyond this value are not included in the per-tag histograms.
+#define MDMAnimationIndexMaxHistogramTagCount 32
+
+typedef struct {
+  // Layers, grouped by their number of entries.
+  uint64_t layers[MDMAnimationIndexDepthBucketCount];
+  // For each tag, the layers with entries of that tag, grouped by their number of such entries.
+  uint64_t tags[MDMAnimationIndexMaxHistogramTagCount][MDMAnimationIndexDepthBucketCount];
+} MDMAnimationIndexDepthHistograms;
+
+// Computes the histograms in a single pass over the index's entries.
+void MDMAnimationIndexComputeDepthHistograms(const MDMAnimationIndex *index,
+                                             MDMAnimationIndexDepthHistograms *histograms);
+
+// Returns a counter that changes every time an entry is added or removed.
+uint64_t MDMAnimationIndexGeneration(const MDMAnimationIndex *index);
+
+// Renders the Core Animation key for a key number of the index into `buffer`. Returns the length of
+// the key, excluding the terminator.
+size_t MDMAnimationIndexFormatKey(const MDMAnimationIndex *index,
+                                  uint32_t keyNumber,
+                                  char *buffer,
+                                  size_t bufferSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_ANIMATION_INDEX_H
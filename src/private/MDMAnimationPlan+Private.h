@@ -0,0 +1,43 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "MDMAnimationPlan.h"
+
+API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
+                     ios(12, API_TO_BE_DEPRECATED))
+
+// A single prepared animation of a plan. Steps are immutable once built.
+@interface MDMAnimationPlanStep : NSObject
+@property(nonatomic, strong, readonly, nonnull) CALayer *layer;
+@property(nonatomic, copy, readonly, nonnull) NSString *keyPath;
+
+// The value the layer's key path is set to when the plan is applied.
+@property(nonatomic, strong, readonly, nullable) id modelValue;
+
+// A fully configured animation whose beginTime is resolved when the plan is applied. Applying a
+// plan adds copies, so the same plan can be applied more than once. nil if the step only changes
+// the layer's value, e.g. because the time scale factor was 0.
+@property(nonatomic, strong, readonly, nullable) CABasicAnimation *animation;
+
+// The scaled delay of the animation, relative to the moment the plan is applied.
+@property(nonatomic, assign, readonly) CFTimeInterval delay;
+@end
+
+@interface MDMAnimationPlan ()
+@property(nonatomic, copy, readonly, nonnull) NSArray<MDMAnimationPlanStep *> *steps;
+@end
+
+API_DEPRECATED_END
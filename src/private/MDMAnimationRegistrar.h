@@ -17,27 +17,123 @@
 #import <Foundation/Foundation.h>
 #import <QuartzCore/QuartzCore.h>
 
+#import "MDMAnimationIndex.h"
+#import "MDMKeyPathClassifier.h"
+#import "MDMValueKernels.h"
+
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
 
+// A snapshot of the animations tracked by a registrar.
+typedef struct {
+  NSUInteger activeAnimationCount;
+  NSUInteger peakActiveAnimationCount;
+  // The deepest stack of animations on a single layer and key path, indexed by
+  // MDMAnimatableKeyPathKind. Key paths that aren't animatable key paths share the
+  // MDMAnimatableKeyPathKindNone slot.
+  NSUInteger peakStackDepths[MDMAnimatableKeyPathKindCount];
+  // Per-tag histograms are indexed by MDMAnimatableKeyPathKind.
+  MDMAnimationIndexDepthHistograms histograms;
+  // The number of additive animations that have been folded by stack compaction.
+  NSUInteger foldedAnimationCount;
+} MDMAnimationRegistrarMetrics;
+
+// Compaction leaves up to two folded animations alongside the newest animation of a stack, so
+// shallower limits are raised to this depth.
+#define MDMAnimationRegistrarMinimumCompactionDepth 3
+
 // Tracks and manipulates animations that have been added to a layer.
 @interface MDMAnimationRegistrar : NSObject
 
 // Invokes the layer's addAnimation:forKey: method with the provided animation and key and tracks
 // its association. Upon completion of the animation, the provided optional completion block will be
 // executed.
-- (void)addAnimation:(nonnull CABasicAnimation *)animation
-             toLayer:(nonnull CALayer *)layer
-              forKey:(nullable NSString *)key
-          completion:(void(^ __nullable)(BOOL))completion;
+//
+// Returns the animation that was added to the layer, which is a keyframe rendition of the provided
+// animation if keyframeTolerance is enabled and the animation can be sampled.
+- (nonnull CAAnimation *)addAnimation:(nonnull CABasicAnimation *)animation
+                              toLayer:(nonnull CALayer *)layer
+                               forKey:(nullable NSString *)key
+                           completion:(void(^ __nullable)(BOOL))completion;
+
+// Begins a batch of animations. Animations added without a completion block until the matching
+// commitBatchWithCompletion: share a single CATransaction and a single completion block.
+//
+// Batches may be nested, in which case only the outermost batch opens a transaction.
+- (void)beginBatch;
+
+// Ends the current batch. Once every animation added during the outermost batch has completed,
+// the batch's animations are unregistered in bulk and the provided optional completion block is
+// executed.
+//
+// Animations that finish before the rest of their batch therefore remain registered, and are
+// counted as active, until the whole batch completes. Core Animation has already removed them from
+// their layers by then, so presentation values of those layers are read from their presentation
+// layers rather than evaluated until the batch completes.
+- (void)commitBatchWithCompletion:(void(^ __nullable)(BOOL))completion;
+
+// The deepest stack of additive animations that a layer's key path may accumulate. Once adding an
+// additive animation exceeds this depth, the stack's older animations are folded into at most two
+// springs that continue with the stack's current displacement and velocity, and are replaced on
+// the layer. Completion blocks of folded animations are invoked once the springs they were folded
+// into complete.
+//
+// Only stacks of generated-key additive animations whose timing the presentation evaluator can
+// model are folded. 0, the default, disables compaction.
+@property(nonatomic) NSUInteger maximumAdditiveStackDepth;
+
+// If greater than 0, animations are added to their layer as linear keyframe animations that
+// approximate their timing curve to within this fraction of their displacement. The registrar
+// continues to track the original animations, so presentation values and compaction are computed
+// from the exact curves. 0, the default, adds animations as-is.
+@property(nonatomic) double keyframeTolerance;
 
-// For every active animation, reads the associated layer's presentation layer key path and writes
-// it to the layer.
+// The number of CATransactions the registrar has opened.
+@property(nonatomic, readonly) NSUInteger transactionCount;
+
+// The number of completion blocks the registrar has handed to Core Animation.
+@property(nonatomic, readonly) NSUInteger completionBlockCount;
+
+// Writes a snapshot of the registrar's animations to `metrics`. Costs a single pass over the active
+// animations, without sending any messages.
+- (void)getMetrics:(nonnull MDMAnimationRegistrarMetrics *)metrics;
+
+// Resets the peak counts to the current state and the cumulative counts to zero.
+- (void)resetPeakMetrics;
+
+// For every active animation, writes the current presentation value of its key path to the
+// associated layer.
+//
+// Presentation values are computed from the registered animations where possible. Layers with
+// animations the registrar can't evaluate are read from their presentation layer instead.
 - (void)commitCurrentAnimationValuesToAllLayers;
 
+// Returns the current presentation value of the layer's key path, computed from the animations
+// registered with the layer and the provided model value rather than from the layer's presentation
+// layer. Works for layers that are not part of a window.
+//
+// Returns nil if the value can't be computed this way, e.g. because the layer has animations that
+// were not added through the registrar, or because of the key path's value type or the timing of
+// one of its animations.
+- (nullable id)presentationValueOfLayer:(nonnull CALayer *)layer
+                             forKeyPath:(nonnull NSString *)keyPath
+                             modelValue:(nullable id)modelValue;
+
+// Like presentationValueOfLayer:forKeyPath:modelValue:, but also writes the value's current rate
+// of change, in units per second, to `velocity` if the value could be computed. Both are evaluated
+// from the same animations, without reading the layer's presentation layer. `velocity` may be NULL.
+- (nullable id)presentationValueOfLayer:(nonnull CALayer *)layer
+                             forKeyPath:(nonnull NSString *)keyPath
+                             modelValue:(nullable id)modelValue
+                               velocity:(nullable MDMValue *)velocity;
+
 // Removes all active animations from their associated layer.
 - (void)removeAllAnimations;
 
+// Equivalent to commitCurrentAnimationValuesToAllLayers followed by removeAllAnimations, performed
+// in a single pass that evaluates each layer's presentation values once.
+- (void)stopAllAnimations;
+
 @end
 
 API_DEPRECATED_END
@@ -16,87 +16,852 @@
 
 #import "MDMAnimationRegistrar.h"
 
-#import "MDMRegisteredAnimation.h"
+#import "CABasicAnimation+MotionAnimator.h"
+#import "MDMAdditiveCompaction.h"
+#import "MDMAnimationIndex.h"
+#import "MDMKeyPathKind.h"
+#import "MDMSpringCache.h"
+#import "MDMTracing.h"
+
+_Static_assert(MDMAnimatableKeyPathKindCount <= MDMAnimationIndexMaxHistogramTagCount,
+               "Every key path kind needs a histogram.");
+
+// Folded residual springs that would displace a value by no more than this many units are dropped.
+static const double kCompactionTolerance = 1e-3;
+
+static const void *RetainObject(const void *object) {
+  return CFRetain(object);
+}
+
+static void ReleaseObject(const void *object) {
+  CFRelease(object);
+}
+
+// Layers are retained for as long as they have registered animations.
+static const MDMAnimationIndexCallbacks kObjectCallbacks = {RetainObject, ReleaseObject};
+
+// Returns the key rendered for one of the index's key numbers. Keys are rendered once and interned
+// in `keys`, indexed by key number, as the index reuses the numbers of removed entries.
+static NSString *GeneratedKey(const MDMAnimationIndex *index,
+                              NSMutableArray<NSString *> *keys,
+                              uint32_t keyNumber) {
+  while (keys.count < keyNumber) {
+    char buffer[MDMAnimationIndexKeyBufferSize];
+    size_t length = MDMAnimationIndexFormatKey(index, (uint32_t)keys.count + 1, buffer,
+                                               sizeof(buffer));
+    [keys addObject:[[NSString alloc] initWithBytes:buffer
+                                             length:length
+                                           encoding:NSASCIIStringEncoding]];
+  }
+  return keys[keyNumber - 1];
+}
+
+// Returns the Core Animation key of a registered animation.
+static NSString *KeyForEntry(const MDMAnimationIndex *index,
+                             NSMutableArray<NSString *> *keys,
+                             const MDMAnimationIndexEntry *entry) {
+  if (entry->key != NULL) {
+    return (__bridge NSString *)entry->key;
+  }
+  return GeneratedKey(index, keys, entry->keyNumber);
+}
+
+typedef void (^MDMAnimationRegistrarWork)(CALayer *, CABasicAnimation *, NSString *);
+
+typedef struct {
+  __unsafe_unretained MDMAnimationRegistrarWork work;
+  const MDMAnimationIndex *index;
+  __unsafe_unretained NSMutableArray<NSString *> *keys;
+} WorkContext;
+
+static void InvokeWork(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  const WorkContext *workContext = context;
+  id animation = (__bridge id)entry->animation;
+  if (![animation isKindOfClass:[CABasicAnimation class]]) {
+    return;
+  }
+  workContext->work((__bridge CALayer *)layer, animation,
+                    KeyForEntry(workContext->index, workContext->keys, entry));
+}
+
+// Whether a later entry with the same key has replaced the entry's animation on its layer.
+static BOOL IsEntrySuperseded(const MDMAnimationIndexEntry *entries, size_t count, size_t index) {
+  const void *key = entries[index].key;
+  if (key == NULL) {
+    return NO;
+  }
+  for (size_t i = index + 1; i < count; ++i) {
+    if (entries[i].identifier != MDMAnimationIDNone && entries[i].key != NULL
+        && CFEqual(key, entries[i].key)) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+// Whether one key path is a component of the other, e.g. position and position.x.
+static BOOL KeyPathsOverlap(NSString *keyPath, NSString *otherKeyPath) {
+  NSString *shorter = keyPath.length < otherKeyPath.length ? keyPath : otherKeyPath;
+  NSString *longer = shorter == keyPath ? otherKeyPath : keyPath;
+  return (longer.length > shorter.length
+          && [longer characterAtIndex:shorter.length] == '.'
+          && [longer hasPrefix:shorter]);
+}
+
+// Boxes an evaluated value. Scalars keep the precision of the model value so that callers receive
+// the same type the presentation layer would have returned.
+static id BoxEvaluatedValue(const MDMValue *value, id modelValue) {
+  if (value->type == MDMValueTypeScalar && [modelValue isKindOfClass:[NSNumber class]]
+      && strcmp([(NSNumber *)modelValue objCType], @encode(float)) == 0) {
+    return @((float)value->lanes[0]);
+  }
+  return MDMBoxValue(value);
+}
+
+// Returns the additive spring animation that replaces part of a folded stack.
+static CABasicAnimation *FoldedAnimation(NSString *keyPath,
+                                         const MDMFoldedAnimation *folded,
+                                         const double spring[3],
+                                         CFTimeInterval beginTime,
+                                         CFTimeInterval fallbackDuration) {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpartial-availability"
+  CASpringAnimation *animation = [CASpringAnimation animationWithKeyPath:keyPath];
+#pragma clang diagnostic pop
+  MDMValue identity;
+  MDMValueInitAdditiveIdentity(&identity, folded->displacement.type);
+  animation.additive = YES;
+  animation.fromValue = MDMBoxValue(&folded->displacement);
+  animation.toValue = MDMBoxValue(&identity);
+  animation.mass = (CGFloat)spring[0];
+  animation.stiffness = (CGFloat)spring[1];
+  animation.damping = (CGFloat)spring[2];
+  animation.initialVelocity = (CGFloat)folded->initialVelocity;
+  animation.beginTime = beginTime;
+
+  MDMSpringCacheSolution solution;
+  if (MDMSpringCacheSolve(MDMSpringCacheShared(), spring[0], spring[1], spring[2],
+                          folded->initialVelocity, &solution)
+      && isfinite(solution.settlingDuration)) {
+    animation.duration = solution.settlingDuration;
+  } else {
+    animation.duration = fallbackDuration;
+  }
+  return animation;
+}
+
+// Writes the mass, stiffness and damping with which to continue a stack that is being folded. The
+// newest animation's spring is reused where possible. Otherwise, a critically damped spring that
+// settles over the newest animation's duration is used.
+static void ResolveFoldSpring(CABasicAnimation *newestAnimation, double spring[3]) {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpartial-availability"
+  if ([newestAnimation isKindOfClass:[CASpringAnimation class]]) {
+    CASpringAnimation *springAnimation = (CASpringAnimation *)newestAnimation;
+    if (springAnimation.mass > 0 && springAnimation.stiffness > 0 && springAnimation.damping >= 0) {
+      spring[0] = springAnimation.mass;
+      spring[1] = springAnimation.stiffness;
+      spring[2] = springAnimation.damping;
+      return;
+    }
+  }
+#pragma clang diagnostic pop
+
+  // A critically damped spring at rest settles in a time inversely proportional to its frequency.
+  static double unitSettlingDuration = 0;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    MDMSpringSolver solver;
+    MDMSpringSolverInit(&solver, 1, 1, 2, 0);
+    unitSettlingDuration = MDMSpringSolverSettlingDuration(&solver,
+                                                           MDMSpringSolverDefaultSettlingThreshold);
+  });
+  double duration = newestAnimation.duration > 0 ? newestAnimation.duration : 0.25;
+  double frequency = unitSettlingDuration / duration;
+  spring[0] = 1;
+  spring[1] = frequency * frequency;
+  spring[2] = 2 * frequency;
+}
+
+// The springs that a stack of additive animations was folded into. Completion blocks of the
+// folded animations are deferred until the springs have completed.
+@interface MDMAnimationFold : NSObject
+- (instancetype)initWithAnimationCount:(NSUInteger)animationCount;
+- (void)performAfterCompletion:(void (^)(void))block;
+- (void)animationDidComplete;
+@end
+
+@implementation MDMAnimationFold {
+  NSUInteger _pendingAnimationCount;
+  NSMutableArray<void (^)(void)> *_deferredBlocks;
+}
+
+- (instancetype)initWithAnimationCount:(NSUInteger)animationCount {
+  self = [super init];
+  if (self) {
+    _pendingAnimationCount = animationCount;
+  }
+  return self;
+}
+
+- (void)performAfterCompletion:(void (^)(void))block {
+  if (_pendingAnimationCount == 0) {
+    block();
+    return;
+  }
+  if (!_deferredBlocks) {
+    _deferredBlocks = [NSMutableArray array];
+  }
+  [_deferredBlocks addObject:[block copy]];
+}
+
+- (void)animationDidComplete {
+  NSAssert(_pendingAnimationCount > 0, @"More folded animations completed than were added.");
+  if (--_pendingAnimationCount > 0) {
+    return;
+  }
+  NSArray<void (^)(void)> *blocks = _deferredBlocks;
+  _deferredBlocks = nil;
+  for (void (^block)(void) in blocks) {
+    block();
+  }
+}
+
+@end
+
+// The number of completed batches' buffers kept for reuse. Batches overlap while earlier batches'
+// animations are still in flight, so more than one buffer can be in use at a time.
+#define kSpareBatchBufferCount 4
+
+typedef struct {
+  MDMAnimationIndexHandle *handles;
+  size_t capacity;
+} BatchBuffer;
 
 @implementation MDMAnimationRegistrar {
-  NSMapTable<CALayer *, NSMutableSet<MDMRegisteredAnimation *> *> *_layersToRegisteredAnimation;
+  MDMAnimationIndex *_index;
+
+  // The animations added during the current batch. The buffer is handed to the batch's completion
+  // block on commit, which returns it to the spares once the batch completes.
+  MDMAnimationIndexHandle *_batchHandles;
+  size_t _batchCount;
+  size_t _batchCapacity;
+  BatchBuffer _spareBatchBuffers[kSpareBatchBufferCount];
+  size_t _spareBatchBufferCount;
+  NSUInteger _batchDepth;
+  NSMutableArray<void (^)(BOOL)> *_nestedBatchCompletions;
+
+  // Scratch space for presentation value evaluation, reused across evaluations.
+  MDMEvaluatorAnimation *_evaluatorAnimations;
+  size_t _evaluatorAnimationCapacity;
+  MDMEvaluatorStack *_evaluatorStacks;
+  MDMValue *_evaluatorResults;
+  size_t _evaluatorStackCapacity;
+
+  NSUInteger _peakAnimationCount;
+  NSUInteger _peakStackDepths[MDMAnimatableKeyPathKindCount];
+
+  // The keys of animations added without a key, indexed by the index's key numbers.
+  NSMutableArray<NSString *> *_generatedKeys;
+
+  // The folds that absorbed animations whose completion has not yet been observed, keyed by the
+  // folded animations' identifiers.
+  NSMutableDictionary<NSNumber *, MDMAnimationFold *> *_foldsByIdentifier;
+  NSUInteger _foldedAnimationCount;
 }
 
 - (instancetype)init {
   self = [super init];
   if (self) {
-    _layersToRegisteredAnimation = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory
-                                                      valueOptions:NSPointerFunctionsStrongMemory];
+    _index = MDMAnimationIndexCreate(&kObjectCallbacks, &kObjectCallbacks);
+    _generatedKeys = [NSMutableArray array];
   }
   return self;
 }
 
+- (void)dealloc {
+  MDMAnimationIndexDestroy(_index);
+  free(_batchHandles);
+  for (size_t i = 0; i < _spareBatchBufferCount; ++i) {
+    free(_spareBatchBuffers[i].handles);
+  }
+  free(_evaluatorAnimations);
+  free(_evaluatorStacks);
+  free(_evaluatorResults);
+}
+
 #pragma mark - Private
 
-- (void)forEachAnimation:(void (^)(CALayer *, CABasicAnimation *, NSString *))work {
-  // Copy the registered animations before iteration in case further modifications happen to the
-  // registered animations. Consider if we remove an animation, its associated completion block
-  // might invoke logic that adds a new animation, potentially modifying our collections.
-  for (CALayer *layer in [_layersToRegisteredAnimation copy]) {
-    NSSet *keyPathAnimations = [_layersToRegisteredAnimation objectForKey:layer];
-    for (MDMRegisteredAnimation *keyPathAnimation in [keyPathAnimations copy]) {
-      if (![keyPathAnimation.animation isKindOfClass:[CABasicAnimation class]]) {
+- (void)updatePeakMetricsForLayer:(CALayer *)layer keyPathKind:(MDMAnimatableKeyPathKind)kind {
+  _peakAnimationCount = MAX(_peakAnimationCount, MDMAnimationIndexCount(_index));
+  size_t depth = MDMAnimationIndexCountForTag(_index, (__bridge void *)layer, (uint32_t)kind);
+  _peakStackDepths[kind] = MAX(_peakStackDepths[kind], depth);
+}
+
+// Invokes `completion` once every fold that absorbed one of the given animations has completed.
+- (void)performCompletion:(void (^)(void))completion
+    afterFoldsOfAnimations:(const MDMAnimationIndexHandle *)handles
+                     count:(size_t)count {
+  NSMutableSet<MDMAnimationFold *> *folds = nil;
+  if (_foldsByIdentifier.count > 0) {
+    for (size_t i = 0; i < count; ++i) {
+      NSNumber *identifier = @(handles[i].identifier);
+      MDMAnimationFold *fold = _foldsByIdentifier[identifier];
+      if (fold) {
+        [_foldsByIdentifier removeObjectForKey:identifier];
+        if (!folds) {
+          folds = [NSMutableSet set];
+        }
+        [folds addObject:fold];
+      }
+    }
+  }
+  if (folds.count == 0) {
+    completion();
+    return;
+  }
+  __block NSUInteger remainingFoldCount = folds.count;
+  void (^countdown)(void) = ^{
+    if (--remainingFoldCount == 0) {
+      completion();
+    }
+  };
+  for (MDMAnimationFold *fold in folds) {
+    [fold performAfterCompletion:countdown];
+  }
+}
+
+- (void)compactIfNeededAfterAddingAnimation:(CABasicAnimation *)animation
+                                    toLayer:(CALayer *)layer
+                                 identifier:(MDMAnimationID)identifier
+                                keyPathKind:(MDMAnimatableKeyPathKind)kind {
+  // Stacks are at most as deep as the number of the layer's animations with the same tag, which is
+  // cheap to count.
+  if (_maximumAdditiveStackDepth == 0 || !animation.additive || identifier == MDMAnimationIDNone
+      || MDMAnimationIndexCountForTag(_index, (__bridge void *)layer, (uint32_t)kind)
+             <= MAX(_maximumAdditiveStackDepth, MDMAnimationRegistrarMinimumCompactionDepth)) {
+    return;
+  }
+  [self compactAdditiveStackOfLayer:layer
+                    newestAnimation:animation
+                         identifier:identifier
+                                tag:(uint32_t)kind];
+}
+
+// Folds the stack of additive animations on the newest animation's layer and key path, other than
+// the newest animation itself, if the stack has grown deeper than maximumAdditiveStackDepth.
+- (void)compactAdditiveStackOfLayer:(CALayer *)layer
+                    newestAnimation:(CABasicAnimation *)newestAnimation
+                         identifier:(MDMAnimationID)newestIdentifier
+                                tag:(uint32_t)tag {
+  NSString *keyPath = newestAnimation.keyPath;
+  size_t entryCount = 0;
+  const MDMAnimationIndexEntry *entries =
+      MDMAnimationIndexEntriesForLayer(_index, (__bridge void *)layer, &entryCount);
+
+  // Additive animations commute, which is what allows the folded springs to be added on top of the
+  // newest animation. A non-additive animation in the stack replaces everything beneath it, so the
+  // stack's order matters and it is left as-is.
+  size_t foldCount = 0;
+  for (size_t i = 0; i < entryCount; ++i) {
+    if (entries[i].identifier == MDMAnimationIDNone || entries[i].identifier == newestIdentifier
+        || entries[i].tag != tag) {
+      continue;
+    }
+    CABasicAnimation *animation = (__bridge CABasicAnimation *)entries[i].animation;
+    if (![animation.keyPath isEqualToString:keyPath]) {
+      continue;
+    }
+    if (!animation.additive || entries[i].key != NULL) {
+      return;
+    }
+    foldCount++;
+  }
+  NSUInteger maximumDepth = MAX(_maximumAdditiveStackDepth,
+                                MDMAnimationRegistrarMinimumCompactionDepth);
+  if (foldCount + 1 <= maximumDepth || ![self reserveEvaluatorAnimations:foldCount stacks:0]) {
+    return;
+  }
+  uint64_t traceStart = MDMTraceBegin();
+
+  MDMAnimationIndexHandle *handles = malloc(foldCount * sizeof(MDMAnimationIndexHandle));
+  if (!handles) {
+    return;
+  }
+  size_t handleCount = 0;
+  for (size_t i = 0; i < entryCount && handleCount < foldCount; ++i) {
+    if (entries[i].identifier == MDMAnimationIDNone || entries[i].identifier == newestIdentifier
+        || entries[i].tag != tag) {
+      continue;
+    }
+    CABasicAnimation *animation = (__bridge CABasicAnimation *)entries[i].animation;
+    if (![animation.keyPath isEqualToString:keyPath]) {
+      continue;
+    }
+    if (!MDMEvaluatorAnimationFromAnimation(animation, entries[i].beginTime,
+                                            &_evaluatorAnimations[handleCount])) {
+      free(handles);
+      return;
+    }
+    handles[handleCount++] = (MDMAnimationIndexHandle){(__bridge void *)layer,
+                                                       entries[i].identifier};
+  }
+
+  double spring[3];
+  ResolveFoldSpring(newestAnimation, spring);
+  CFTimeInterval time = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+  MDMAdditiveFold fold;
+  if (!MDMAdditiveFoldAnimations(_evaluatorAnimations, handleCount, time,
+                                 sqrt(spring[0] / spring[1]), kCompactionTolerance, &fold)) {
+    free(handles);
+    return;
+  }
+
+  MDMAnimationFold *animationFold = [[MDMAnimationFold alloc] initWithAnimationCount:fold.count];
+  if (!_foldsByIdentifier) {
+    _foldsByIdentifier = [NSMutableDictionary dictionary];
+  }
+  // The index hasn't been mutated since the handles were collected, and the handles are in the
+  // order of the layer's entries.
+  for (size_t i = 0, j = 0; i < entryCount && j < handleCount; ++i) {
+    if (entries[i].identifier != handles[j].identifier) {
+      continue;
+    }
+    [layer removeAnimationForKey:KeyForEntry(_index, _generatedKeys, &entries[i])];
+    _foldsByIdentifier[@(handles[j].identifier)] = animationFold;
+    ++j;
+  }
+  MDMAnimationIndexRemoveHandles(_index, handles, handleCount);
+  free(handles);
+  _foldedAnimationCount += handleCount;
+
+  // The replacements are shallower than any permitted depth, so adding them can't fold again.
+  for (size_t i = 0; i < fold.count; ++i) {
+    CABasicAnimation *animation = FoldedAnimation(keyPath, &fold.animations[i], spring, time,
+                                                  newestAnimation.duration);
+    [self addAnimation:animation toLayer:layer forKey:nil completion:^(BOOL finished) {
+      [animationFold animationDidComplete];
+    }];
+  }
+  if (traceStart != 0) {
+    MDMTraceEnd(MDMTraceEventKindCompactAdditiveAnimations, traceStart, (__bridge void *)layer,
+                (uint32_t)handleCount);
+  }
+}
+
+- (void)forEachAnimation:(MDMAnimationRegistrarWork)work {
+  // The index tolerates modifications made during iteration without copying its contents. Consider
+  // if we remove an animation, its associated completion block might invoke logic that adds a new
+  // animation, potentially modifying our collections. Entries are visited grouped by layer.
+  WorkContext context = {work, _index, _generatedKeys};
+  MDMAnimationIndexForEach(_index, InvokeWork, &context);
+}
+
+// Returns NO if the handle could not be stored, in which case the animation needs a completion
+// block of its own.
+- (BOOL)appendBatchHandle:(MDMAnimationIndexHandle)handle {
+  if (_batchHandles == NULL && _spareBatchBufferCount > 0) {
+    BatchBuffer spare = _spareBatchBuffers[--_spareBatchBufferCount];
+    _batchHandles = spare.handles;
+    _batchCapacity = spare.capacity;
+  }
+  if (_batchCount == _batchCapacity) {
+    size_t capacity = _batchCapacity ? _batchCapacity * 2 : 16;
+    MDMAnimationIndexHandle *handles = realloc(_batchHandles,
+                                               capacity * sizeof(MDMAnimationIndexHandle));
+    if (!handles) {
+      return NO;
+    }
+    _batchHandles = handles;
+    _batchCapacity = capacity;
+  }
+  _batchHandles[_batchCount++] = handle;
+  return YES;
+}
+
+// Keeps the buffer of a completed batch for reuse by later batches.
+- (void)recycleBatchBuffer:(BatchBuffer)buffer {
+  if (_spareBatchBufferCount < kSpareBatchBufferCount) {
+    _spareBatchBuffers[_spareBatchBufferCount++] = buffer;
+  } else {
+    free(buffer.handles);
+  }
+}
+
+- (BOOL)reserveEvaluatorAnimations:(size_t)animationCount stacks:(size_t)stackCount {
+  if (animationCount > _evaluatorAnimationCapacity) {
+    MDMEvaluatorAnimation *animations = realloc(_evaluatorAnimations,
+                                                animationCount * sizeof(MDMEvaluatorAnimation));
+    if (!animations) {
+      return NO;
+    }
+    _evaluatorAnimations = animations;
+    _evaluatorAnimationCapacity = animationCount;
+  }
+  if (stackCount > _evaluatorStackCapacity) {
+    MDMEvaluatorStack *stacks = realloc(_evaluatorStacks, stackCount * sizeof(MDMEvaluatorStack));
+    if (!stacks) {
+      return NO;
+    }
+    _evaluatorStacks = stacks;
+    MDMValue *results = realloc(_evaluatorResults, stackCount * sizeof(MDMValue));
+    if (!results) {
+      return NO;
+    }
+    _evaluatorResults = results;
+    _evaluatorStackCapacity = stackCount;
+  }
+  return YES;
+}
+
+// Evaluates the current presentation value of each key path from the animations registered with
+// the layer and the key path's model value. Returns nil if any of the values can't be computed
+// without the layer's presentation layer. If `velocities` is non-NULL, the current rate of change
+// of each value is written to it as well.
+- (NSArray *)evaluatePresentationValuesOfLayer:(CALayer *)layer
+                                      keyPaths:(NSArray<NSString *> *)keyPaths
+                                   modelValues:(NSArray *)modelValues
+                                    velocities:(MDMValue *)velocities {
+  size_t entryCount = 0;
+  const MDMAnimationIndexEntry *entries =
+      MDMAnimationIndexEntriesForLayer(_index, (__bridge void *)layer, &entryCount);
+
+  // The evaluator only knows about the animations we added, so it can't be used if anyone else
+  // added animations to the layer, if Core Animation has removed any of ours while they remain
+  // registered, or if our animations affect a key path only partially. Every live entry's key must
+  // be on the layer under the entry's key path, and the layer must have no other keys.
+  size_t liveCount = 0;
+  for (size_t i = 0; i < entryCount; ++i) {
+    if (entries[i].identifier == MDMAnimationIDNone || IsEntrySuperseded(entries, entryCount, i)) {
+      continue;
+    }
+    liveCount++;
+    NSString *entryKeyPath = [(__bridge CABasicAnimation *)entries[i].animation keyPath];
+    for (NSString *keyPath in keyPaths) {
+      if (KeyPathsOverlap(entryKeyPath, keyPath)) {
+        return nil;
+      }
+    }
+    CAAnimation *added = [layer animationForKey:KeyForEntry(_index, _generatedKeys, &entries[i])];
+    if (![added isKindOfClass:[CAPropertyAnimation class]]
+        || ![((CAPropertyAnimation *)added).keyPath isEqualToString:entryKeyPath]) {
+      return nil;
+    }
+  }
+  if (liveCount != layer.animationKeys.count) {
+    return nil;
+  }
+
+  size_t stackCount = keyPaths.count;
+  if (![self reserveEvaluatorAnimations:liveCount stacks:stackCount]) {
+    return nil;
+  }
+  size_t animationCount = 0;
+  for (size_t stackIndex = 0; stackIndex < stackCount; ++stackIndex) {
+    NSString *keyPath = keyPaths[stackIndex];
+    MDMEvaluatorStack *stack = &_evaluatorStacks[stackIndex];
+    if (!MDMUnboxValue(modelValues[stackIndex], &stack->modelValue)) {
+      return nil;
+    }
+    stack->animations = &_evaluatorAnimations[animationCount];
+    stack->count = 0;
+    for (size_t i = 0; i < entryCount; ++i) {
+      if (entries[i].identifier == MDMAnimationIDNone
+          || IsEntrySuperseded(entries, entryCount, i)) {
+        continue;
+      }
+      CABasicAnimation *animation = (__bridge CABasicAnimation *)entries[i].animation;
+      if (![animation.keyPath isEqualToString:keyPath]) {
         continue;
       }
+      if (!MDMEvaluatorAnimationFromAnimation(animation, entries[i].beginTime,
+                                              &_evaluatorAnimations[animationCount])) {
+        return nil;
+      }
+      animationCount++;
+      stack->count++;
+    }
+  }
 
-      work(layer, [keyPathAnimation.animation copy], keyPathAnimation.key);
+  CFTimeInterval time = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+  if (MDMEvaluatorEvaluateBatch(_evaluatorStacks, stackCount, time, _evaluatorResults, NULL)
+      != stackCount) {
+    return nil;
+  }
+  if (velocities != NULL) {
+    for (size_t stackIndex = 0; stackIndex < stackCount; ++stackIndex) {
+      MDMEvaluatorEvaluateVelocity(&_evaluatorStacks[stackIndex], time, &velocities[stackIndex]);
     }
   }
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:stackCount];
+  for (size_t stackIndex = 0; stackIndex < stackCount; ++stackIndex) {
+    [values addObject:BoxEvaluatedValue(&_evaluatorResults[stackIndex], modelValues[stackIndex])];
+  }
+  return values;
+}
+
+// Returns the current presentation value of every key path animated by the layer's registered
+// animations, or nil if they can't all be computed without the layer's presentation layer.
+- (NSDictionary<NSString *, id> *)presentationValuesOfLayer:(CALayer *)layer {
+  size_t entryCount = 0;
+  const MDMAnimationIndexEntry *entries =
+      MDMAnimationIndexEntriesForLayer(_index, (__bridge void *)layer, &entryCount);
+  NSMutableOrderedSet<NSString *> *keyPaths = [NSMutableOrderedSet orderedSet];
+  for (size_t i = 0; i < entryCount; ++i) {
+    if (entries[i].identifier != MDMAnimationIDNone) {
+      [keyPaths addObject:[(__bridge CABasicAnimation *)entries[i].animation keyPath]];
+    }
+  }
+  NSMutableArray *modelValues = [NSMutableArray arrayWithCapacity:keyPaths.count];
+  for (NSString *keyPath in keyPaths) {
+    id modelValue = [layer valueForKeyPath:keyPath];
+    if (modelValue == nil) {
+      return nil;
+    }
+    [modelValues addObject:modelValue];
+  }
+  NSArray *values = [self evaluatePresentationValuesOfLayer:layer
+                                                   keyPaths:keyPaths.array
+                                                modelValues:modelValues
+                                                 velocities:NULL];
+  if (values == nil) {
+    return nil;
+  }
+  return [NSDictionary dictionaryWithObjects:values forKeys:keyPaths.array];
+}
+
+// Writes the presentation value of each registered animation's key path to its layer. Values are
+// computed from the registered animations where possible, falling back to each layer's
+// presentation layer otherwise. If `removeAnimations` is YES, the animations are removed as well.
+- (void)commitPresentationValuesRemovingAnimations:(BOOL)removeAnimations {
+  __block CALayer *currentLayer = nil;
+  __block NSDictionary<NSString *, id> *presentationValues = nil;
+  __block id presentationLayer = nil;
+  [self forEachAnimation:^(CALayer *layer, CABasicAnimation *animation, NSString *key) {
+    if (layer != currentLayer) {
+      // Both sources are snapshots of the layer's state before we modify it below.
+      currentLayer = layer;
+      presentationValues = [self presentationValuesOfLayer:layer];
+      presentationLayer = presentationValues ? nil : [layer presentationLayer];
+    }
+    if (presentationValues != nil) {
+      [layer setValue:presentationValues[animation.keyPath] forKeyPath:animation.keyPath];
+    } else if (presentationLayer != nil) {
+      id presentationValue = [presentationLayer valueForKeyPath:animation.keyPath];
+      [layer setValue:presentationValue forKeyPath:animation.keyPath];
+    }
+    if (removeAnimations) {
+      [layer removeAnimationForKey:key];
+    }
+  }];
 }
 
 #pragma mark - Public
 
-- (void)addAnimation:(CABasicAnimation *)animation
-                toLayer:(CALayer *)layer
-                 forKey:(NSString *)key
-             completion:(void(^)(BOOL))completion {
-  if (key == nil) {
-    key = [NSUUID UUID].UUIDString;
+- (CAAnimation *)addAnimation:(CABasicAnimation *)animation
+                      toLayer:(CALayer *)layer
+                       forKey:(NSString *)key
+                   completion:(void(^)(BOOL))completion {
+  uint64_t traceStart = MDMTraceBegin();
+
+  // The index tracks the original animation, which the presentation evaluator models exactly.
+  CAAnimation *renderedAnimation = animation;
+  if (_keyframeTolerance > 0) {
+    CAKeyframeAnimation *keyframeAnimation =
+        MDMKeyframeAnimationFromAnimation(animation, _keyframeTolerance);
+    if (keyframeAnimation != nil) {
+      renderedAnimation = keyframeAnimation;
+    }
   }
 
-  NSMutableSet *animatedKeyPaths = [_layersToRegisteredAnimation objectForKey:layer];
-  if (!animatedKeyPaths) {
-    animatedKeyPaths = [[NSMutableSet alloc] init];
-    [_layersToRegisteredAnimation setObject:animatedKeyPaths forKey:layer];
+  // Core Animation assigns a beginTime of 0 the current time once the animation is committed. The
+  // current time is our best approximation of that moment.
+  CFTimeInterval beginTime = animation.beginTime;
+  if (beginTime == 0) {
+    beginTime = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+  }
+  MDMAnimatableKeyPathKind keyPathKind = MDMKindOfKeyPath(animation.keyPath);
+  MDMAnimationID identifier = MDMAnimationIndexAdd(_index,
+                                                   (__bridge void *)layer,
+                                                   (__bridge void *)animation,
+                                                   (__bridge void *)key,
+                                                   beginTime,
+                                                   (uint32_t)keyPathKind);
+  [self updatePeakMetricsForLayer:layer keyPathKind:keyPathKind];
+  // Animations that the index could not store are added without a key.
+  if (key == nil && identifier != MDMAnimationIDNone) {
+    size_t entryCount = 0;
+    const MDMAnimationIndexEntry *entries =
+        MDMAnimationIndexEntriesForLayer(_index, (__bridge void *)layer, &entryCount);
+    // The new entry is the layer's newest.
+    key = GeneratedKey(_index, _generatedKeys, entries[entryCount - 1].keyNumber);
+  }
+
+  // The index retains the layer until its entry is removed, so an unretained reference suffices
+  // for the lookup.
+  const void *layerIdentity = (__bridge void *)layer;
+
+  if (_batchDepth > 0 && completion == nil
+      && [self appendBatchHandle:(MDMAnimationIndexHandle){layerIdentity, identifier}]) {
+    // The batch's transaction and completion block take care of this animation.
+    [layer addAnimation:renderedAnimation forKey:key];
+    MDMTraceEndForKeyPath(MDMTraceEventKindRegisterAnimation, traceStart, layer, animation.keyPath);
+    [self compactIfNeededAfterAddingAnimation:animation
+                                      toLayer:layer
+                                   identifier:identifier
+                                  keyPathKind:keyPathKind];
+    return renderedAnimation;
   }
-  MDMRegisteredAnimation *keyPathAnimation =
-      [[MDMRegisteredAnimation alloc] initWithKey:key animation:animation];
-  [animatedKeyPaths addObject:keyPathAnimation];
 
   [CATransaction begin];
+  _transactionCount++;
   [CATransaction setCompletionBlock:^{
-    [animatedKeyPaths removeObject:keyPathAnimation];
+    MDMAnimationIndexRemove(self->_index, layerIdentity, identifier);
+    MDMTraceInstant(MDMTraceEventKindCompletion, layerIdentity, 1);
+
+    MDMAnimationIndexHandle handle = {layerIdentity, identifier};
+    [self performCompletion:^{
+      if (completion) {
+        completion(YES);
+      }
+    } afterFoldsOfAnimations:&handle count:1];
+  }];
+  _completionBlockCount++;
+
+  [layer addAnimation:renderedAnimation forKey:key];
 
+  [CATransaction commit];
+  MDMTraceEndForKeyPath(MDMTraceEventKindRegisterAnimation, traceStart, layer, animation.keyPath);
+
+  [self compactIfNeededAfterAddingAnimation:animation
+                                    toLayer:layer
+                                 identifier:identifier
+                                keyPathKind:keyPathKind];
+  return renderedAnimation;
+}
+
+- (void)beginBatch {
+  if (_batchDepth == 0) {
+    [CATransaction begin];
+    _transactionCount++;
+  }
+  _batchDepth++;
+}
+
+- (void)commitBatchWithCompletion:(void (^)(BOOL))completion {
+  NSAssert(_batchDepth > 0, @"commitBatchWithCompletion: called without a matching beginBatch.");
+  _batchDepth--;
+
+  if (_batchDepth > 0) {
+    // Nested batches complete along with the outermost batch.
     if (completion) {
-      completion(YES);
+      if (!_nestedBatchCompletions) {
+        _nestedBatchCompletions = [NSMutableArray array];
+      }
+      [_nestedBatchCompletions addObject:[completion copy]];
     }
-  }];
+    return;
+  }
 
-  [layer addAnimation:animation forKey:key];
+  // The batch's buffer is handed over to its completion block rather than copied.
+  size_t count = _batchCount;
+  BatchBuffer buffer = {NULL, 0};
+  if (count > 0) {
+    buffer = (BatchBuffer){_batchHandles, _batchCapacity};
+    _batchHandles = NULL;
+    _batchCapacity = 0;
+  }
+  MDMAnimationIndexHandle *handles = buffer.handles;
+  _batchCount = 0;
+  NSArray<void (^)(BOOL)> *nestedCompletions = _nestedBatchCompletions;
+  _nestedBatchCompletions = nil;
+
+  if (handles != NULL || completion != nil || nestedCompletions != nil) {
+    [CATransaction setCompletionBlock:^{
+      if (handles) {
+        MDMAnimationIndexRemoveHandles(self->_index, handles, count);
+      }
+      MDMTraceInstant(MDMTraceEventKindCompletion, NULL, 1);
+
+      [self performCompletion:^{
+        for (void (^nestedCompletion)(BOOL) in nestedCompletions) {
+          nestedCompletion(YES);
+        }
+        if (completion) {
+          completion(YES);
+        }
+      } afterFoldsOfAnimations:handles count:handles ? count : 0];
+      if (handles) {
+        [self recycleBatchBuffer:buffer];
+      }
+    }];
+    _completionBlockCount++;
+  }
 
   [CATransaction commit];
 }
 
-- (void)commitCurrentAnimationValuesToAllLayers {
-  [self forEachAnimation:^(CALayer *layer, CABasicAnimation *animation, NSString *key) {
-    id presentationLayer = [layer presentationLayer];
-    if (presentationLayer != nil) {
-      id presentationValue = [presentationLayer valueForKeyPath:animation.keyPath];
-      [layer setValue:presentationValue forKeyPath:animation.keyPath];
+- (void)getMetrics:(MDMAnimationRegistrarMetrics *)metrics {
+  metrics->activeAnimationCount = MDMAnimationIndexCount(_index);
+  metrics->peakActiveAnimationCount = _peakAnimationCount;
+  memcpy(metrics->peakStackDepths, _peakStackDepths, sizeof(_peakStackDepths));
+  MDMAnimationIndexComputeDepthHistograms(_index, &metrics->histograms);
+  metrics->foldedAnimationCount = _foldedAnimationCount;
+}
+
+- (void)resetPeakMetrics {
+  _foldedAnimationCount = 0;
+  _peakAnimationCount = MDMAnimationIndexCount(_index);
+  MDMAnimationIndexDepthHistograms histograms;
+  MDMAnimationIndexComputeDepthHistograms(_index, &histograms);
+  for (size_t kind = 0; kind < MDMAnimatableKeyPathKindCount; ++kind) {
+    // The deepest current stack, up to MDMAnimationIndexDepthBucketCount, is the highest non-empty
+    // bucket.
+    _peakStackDepths[kind] = 0;
+    for (size_t bucket = 0; bucket < MDMAnimationIndexDepthBucketCount; ++bucket) {
+      if (histograms.tags[kind][bucket] > 0) {
+        _peakStackDepths[kind] = bucket + 1;
+      }
     }
-  }];
+  }
+}
+
+- (void)commitCurrentAnimationValuesToAllLayers {
+  [self commitPresentationValuesRemovingAnimations:NO];
+}
+
+- (id)presentationValueOfLayer:(CALayer *)layer
+                    forKeyPath:(NSString *)keyPath
+                    modelValue:(id)modelValue {
+  return [self presentationValueOfLayer:layer
+                             forKeyPath:keyPath
+                             modelValue:modelValue
+                               velocity:NULL];
+}
+
+- (id)presentationValueOfLayer:(CALayer *)layer
+                    forKeyPath:(NSString *)keyPath
+                    modelValue:(id)modelValue
+                      velocity:(MDMValue *)velocity {
+  if (modelValue == nil) {
+    return nil;
+  }
+  return [[self evaluatePresentationValuesOfLayer:layer
+                                         keyPaths:@[keyPath]
+                                      modelValues:@[modelValue]
+                                       velocities:velocity] firstObject];
 }
 
 - (void)removeAllAnimations {
   [self forEachAnimation:^(CALayer *layer, CABasicAnimation *animation, NSString *key) {
     [layer removeAnimationForKey:key];
   }];
-  [_layersToRegisteredAnimation removeAllObjects];
+  MDMAnimationIndexRemoveAll(_index);
+}
+
+- (void)stopAllAnimations {
+  [self commitPresentationValuesRemovingAnimations:YES];
+  MDMAnimationIndexRemoveAll(_index);
 }
 
 @end
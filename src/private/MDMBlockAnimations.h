@@ -17,17 +17,80 @@
 #import <Foundation/Foundation.h>
 #import <QuartzCore/QuartzCore.h>
 
+#import "MDMValueKernels.h"
+
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
 
+typedef NS_OPTIONS(NSUInteger, MDMImplicitAnimationOptions) {
+  MDMImplicitAnimationOptionNone = 0,
+
+  // The intercepted actions will animate non-additive key paths from their presentation value.
+  MDMImplicitAnimationOptionBeginFromCurrentState = 1 << 0,
+
+  // The intercepted actions will animate additively where their key path and value allow it.
+  MDMImplicitAnimationOptionAdditive = 1 << 1,
+};
+
 @interface MDMImplicitAction: NSObject
 @property(nonatomic, strong, readonly) id initialModelValue;
-@property(nonatomic, readonly) BOOL hadPresentationLayer;
+
+// Whether an initial presentation value is available for this action. Presentation values are only
+// determined for actions whose animations will begin from the current state.
+@property(nonatomic, readonly) BOOL hasInitialPresentationValue;
+
+// Either provided by the presentation value provider when the action was intercepted or read on
+// demand from a presentation layer captured at that time. Presentation layers are captured at most
+// once per layer per MDMAnimateImplicitly invocation, and only if the provider could not provide a
+// value.
 @property(nonatomic, strong, readonly) id initialPresentationValue;
+
+// The rate of change of the initial presentation value in units per second, or NULL if it is not
+// known. Only known for presentation values provided by the presentation value provider.
+@property(nonatomic, readonly) const MDMValue *initialVelocity;
+
 @property(nonatomic, copy, readonly) NSString *keyPath;
 @property(nonatomic, strong, readonly) CALayer *layer;
 @end
 
-NSArray<MDMImplicitAction *> *MDMAnimateImplicitly(void (^animations)(void));
+// Returns the presentation value of a layer's key path given its model value, or nil if it can't be
+// determined without the layer's presentation layer. If a value is returned, its current rate of
+// change in units per second is written to `velocity`.
+typedef id (^MDMPresentationValueProvider)(CALayer *layer,
+                                           NSString *keyPath,
+                                           id modelValue,
+                                           MDMValue *velocity);
+
+typedef struct {
+  // The number of animatable actions requested while the block was executing.
+  NSUInteger interceptedActionCount;
+
+  // The number of those actions that were merged into an earlier action for the same layer and key
+  // path.
+  NSUInteger coalescedActionCount;
+} MDMImplicitAnimationStatistics;
+
+// Executes `animations` and then invokes `actionsHandler` with one action for each layer and key
+// path that was changed, in the order in which they were first changed. Each action's initial
+// values reflect the layer's state before its first change. `presentationValueProvider` and
+// `statistics` may be nil and NULL respectively; `statistics` is filled in before the handler is
+// invoked.
+//
+// The actions and their array are pooled and recycled once the handler returns, so neither may be
+// retained beyond it. Must be called on the main thread: the context stack and pools are shared
+// process-wide, and the actionForKey: hook is swapped in and out for every thread at once.
+void MDMAnimateImplicitly(MDMImplicitAnimationOptions options,
+                          MDMPresentationValueProvider presentationValueProvider,
+                          MDMImplicitAnimationStatistics *statistics,
+                          void (^animations)(void),
+                          void (^actionsHandler)(NSArray<MDMImplicitAction *> *actions));
+
+// Returns YES while an invocation of MDMAnimateImplicitly is executing its block on the current
+// thread.
+BOOL MDMIsAnimatingImplicitly(void);
+
+// Installs the actionForKey: hook used by MDMAnimateImplicitly for the remainder of the process
+// instead of for the duration of each outermost invocation. Must be called on the main thread.
+void MDMInstallPersistentImplicitAnimationHook(void);
 
 API_DEPRECATED_END
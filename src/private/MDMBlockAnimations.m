@@ -18,6 +18,10 @@
 
 #import "MDMMotionAnimator.h"
 #import "MDMAnimatableKeyPaths.h"
+#import "CABasicAnimation+MotionAnimator.h"
+#import "MDMKeyPathClassifier.h"
+#import "MDMTracing.h"
+#import "MDMUIKitValueCoercion.h"
 
 #import <UIKit/UIKit.h>
 #import <objc/runtime.h>
@@ -53,50 +57,267 @@ static NSSet<MDMAnimatableKeyPath> *AllAnimatableKeyPaths(void) {
   return animatableKeyPaths;
 }
 
+// Returns YES if the key path is supported by MDMMotionAnimator's implicit animations.
+//
+// This is invoked for every action a layer looks up within an implicit animation block, so we try
+// the cheapest checks first: pointer identity against the MDMKeyPath constants, then a perfect hash
+// of the key path's characters. The set lookup only handles strings whose characters can't be
+// accessed directly.
+static BOOL IsAnimatableKeyPath(NSString *keyPath) {
+  static __unsafe_unretained NSString *animatableKeyPaths[MDMAnimatableKeyPathKindCount - 1];
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    int index = 0;
+    for (NSString *animatableKeyPath in AllAnimatableKeyPaths()) {
+      if (index < MDMAnimatableKeyPathKindCount - 1) {
+        animatableKeyPaths[index++] = animatableKeyPath;
+      }
+    }
+  });
+  for (int i = 0; i < MDMAnimatableKeyPathKindCount - 1; ++i) {
+    if (keyPath == animatableKeyPaths[i]) {
+      return YES;
+    }
+  }
+
+  CFStringRef string = (__bridge CFStringRef)keyPath;
+  CFIndex length = CFStringGetLength(string);
+  if (length > MDMAnimatableKeyPathMaxLength) {
+    return NO;
+  }
+  const char *characters = CFStringGetCStringPtr(string, kCFStringEncodingASCII);
+  char buffer[MDMAnimatableKeyPathMaxLength + 1];
+  if (characters == NULL
+      && CFStringGetCString(string, buffer, sizeof(buffer), kCFStringEncodingASCII)) {
+    characters = buffer;
+  }
+  if (characters != NULL) {
+    return MDMClassifyKeyPath(characters, (size_t)length) != MDMAnimatableKeyPathKindNone;
+  }
+  return [AllAnimatableKeyPaths() containsObject:keyPath];
+}
+
+// Contexts are pooled and reused across MDMAnimateImplicitly invocations, along with the actions
+// and intercepted layers they hand out, so that steady-state implicit animations don't allocate new
+// bookkeeping objects.
 @interface MDMActionContext: NSObject
+- (void)beginWithOptions:(MDMImplicitAnimationOptions)options
+    presentationValueProvider:(MDMPresentationValueProvider)presentationValueProvider;
+// Returns every action and intercepted layer to the context's pools and drops all references to
+// layers and values.
+- (void)reset;
+// Only valid until the context is reset.
 @property(nonatomic, readonly) NSArray<MDMImplicitAction *> *interceptedActions;
+@property(nonatomic, readonly) MDMImplicitAnimationStatistics statistics;
+@end
+
+// The actions intercepted for a single layer within an MDMActionContext.
+@interface MDMInterceptedLayer: NSObject
+@end
+
+@implementation MDMInterceptedLayer {
+@public
+  BOOL _didCapturePresentationLayer;
+  CALayer *_presentationLayer;
+  NSMutableSet<NSString *> *_keyPaths;
+}
 @end
 
 // The original CALayer method implementation of -actionForKey:
 static IMP sOriginalActionForKeyLayerImp = NULL;
 
+// Whether our -actionForKey: implementation remains installed between implicit animation blocks.
+static BOOL sPersistentHookInstalled = NO;
+
+// The number of MDMAnimateImplicitly invocations in progress on the current thread. When the hook is
+// persistent, this is what distinguishes actions we should intercept from everyone else's.
+static __thread NSUInteger sImplicitAnimationDepth = 0;
+
+// The stack of contexts of the MDMAnimateImplicitly invocations in progress. Like the pool below,
+// it is only accessed on the main thread.
 static NSMutableArray<MDMActionContext *> *sActionContext = nil;
 
-@implementation MDMImplicitAction
+// Contexts that are not in use by any MDMAnimateImplicitly invocation. Grows to the deepest nesting
+// of invocations.
+static NSMutableArray<MDMActionContext *> *sReusableActionContexts = nil;
 
-- (instancetype)initWithLayer:(CALayer *)layer
-                      keyPath:(NSString *)keyPath {
-  self = [super init];
-  if (self) {
-    _layer = layer;
-    _keyPath = [keyPath copy];
-    _initialModelValue = [_layer valueForKeyPath:_keyPath];
-    _hadPresentationLayer = [_layer presentationLayer] != nil;
-    _initialPresentationValue = [[_layer presentationLayer] valueForKeyPath:_keyPath];
+@implementation MDMImplicitAction {
+  id _providedPresentationValue;
+  CALayer *_presentationLayer;
+  MDMValue _providedVelocity;
+}
+
+- (void)reinitializeWithLayer:(CALayer *)layer
+                      keyPath:(NSString *)keyPath
+            initialModelValue:(id)initialModelValue
+    providedPresentationValue:(id)providedPresentationValue
+             providedVelocity:(const MDMValue *)providedVelocity
+            presentationLayer:(CALayer *)presentationLayer {
+  _layer = layer;
+  _keyPath = [keyPath copy];
+  _initialModelValue = initialModelValue;
+  _providedPresentationValue = providedPresentationValue;
+  _presentationLayer = presentationLayer;
+  _hasInitialPresentationValue = providedPresentationValue != nil || presentationLayer != nil;
+  if (providedPresentationValue != nil) {
+    _providedVelocity = *providedVelocity;
   }
-  return self;
+}
+
+- (void)prepareForReuse {
+  _layer = nil;
+  _keyPath = nil;
+  _initialModelValue = nil;
+  _providedPresentationValue = nil;
+  _presentationLayer = nil;
+  _hasInitialPresentationValue = NO;
+}
+
+- (id)initialPresentationValue {
+  if (_providedPresentationValue != nil) {
+    return _providedPresentationValue;
+  }
+  // The presentation layer is a snapshot, so reading from it later yields the same value as reading
+  // from it at the time of capture.
+  return [_presentationLayer valueForKeyPath:_keyPath];
+}
+
+- (const MDMValue *)initialVelocity {
+  return _providedPresentationValue != nil ? &_providedVelocity : NULL;
 }
 
 @end
 
 @implementation MDMActionContext {
+  MDMImplicitAnimationOptions _options;
+  MDMPresentationValueProvider _presentationValueProvider;
   NSMutableArray<MDMImplicitAction *> *_interceptedActions;
+
+  // Keyed by pointer identity.
+  NSMapTable<CALayer *, MDMInterceptedLayer *> *_interceptedLayers;
+
+  NSMutableArray<MDMImplicitAction *> *_reusableActions;
+  NSMutableArray<MDMInterceptedLayer *> *_reusableInterceptedLayers;
 }
 
 - (instancetype)init {
   self = [super init];
   if (self) {
     _interceptedActions = [NSMutableArray array];
+    _reusableActions = [NSMutableArray array];
+    _reusableInterceptedLayers = [NSMutableArray array];
   }
   return self;
 }
 
+- (void)beginWithOptions:(MDMImplicitAnimationOptions)options
+    presentationValueProvider:(MDMPresentationValueProvider)presentationValueProvider {
+  _options = options;
+  _presentationValueProvider = presentationValueProvider;
+  _statistics = (MDMImplicitAnimationStatistics){0, 0};
+}
+
+- (void)reset {
+  for (MDMImplicitAction *action in _interceptedActions) {
+    [action prepareForReuse];
+    [_reusableActions addObject:action];
+  }
+  [_interceptedActions removeAllObjects];
+
+  for (MDMInterceptedLayer *interceptedLayer in [_interceptedLayers objectEnumerator]) {
+    interceptedLayer->_didCapturePresentationLayer = NO;
+    interceptedLayer->_presentationLayer = nil;
+    [interceptedLayer->_keyPaths removeAllObjects];
+    [_reusableInterceptedLayers addObject:interceptedLayer];
+  }
+  [_interceptedLayers removeAllObjects];
+
+  _presentationValueProvider = nil;
+}
+
+- (BOOL)wantsPresentationValueForKeyPath:(NSString *)keyPath initialModelValue:(id)value {
+  if (!(_options & MDMImplicitAnimationOptionBeginFromCurrentState)) {
+    return NO;
+  }
+  // Mirrors the animator's own additivity check. The destination isn't known yet, but it will be of
+  // the same type as the initial model value.
+  BOOL additive = ((_options & MDMImplicitAnimationOptionAdditive)
+                   && MDMCanAnimationBeAdditive(keyPath, MDMClassifyValue(value)));
+  return !additive;
+}
+
+- (MDMInterceptedLayer *)interceptedLayerForLayer:(CALayer *)layer {
+  if (!_interceptedLayers) {
+    NSPointerFunctionsOptions keyOptions = (NSPointerFunctionsStrongMemory
+                                            | NSPointerFunctionsObjectPointerPersonality);
+    _interceptedLayers = [[NSMapTable alloc] initWithKeyOptions:keyOptions
+                                                   valueOptions:NSPointerFunctionsStrongMemory
+                                                       capacity:0];
+  }
+  MDMInterceptedLayer *interceptedLayer = [_interceptedLayers objectForKey:layer];
+  if (interceptedLayer == nil) {
+    interceptedLayer = [_reusableInterceptedLayers lastObject];
+    if (interceptedLayer != nil) {
+      [_reusableInterceptedLayers removeLastObject];
+    } else {
+      interceptedLayer = [[MDMInterceptedLayer alloc] init];
+      interceptedLayer->_keyPaths = [NSMutableSet set];
+    }
+    [_interceptedLayers setObject:interceptedLayer forKey:layer];
+  }
+  return interceptedLayer;
+}
+
 - (void)addActionForLayer:(CALayer *)layer keyPath:(NSString *)keyPath {
-  [_interceptedActions addObject:[[MDMImplicitAction alloc] initWithLayer:layer keyPath:keyPath]];
+  _statistics.interceptedActionCount++;
+  MDMTraceInstantForKeyPath(MDMTraceEventKindImplicitAction, layer, keyPath);
+
+  MDMInterceptedLayer *interceptedLayer = [self interceptedLayerForLayer:layer];
+  if ([interceptedLayer->_keyPaths containsObject:keyPath]) {
+    // The earlier action already holds the initial value, and the destination is read from the
+    // model layer once the block completes, so later changes don't need an action of their own.
+    _statistics.coalescedActionCount++;
+    return;
+  }
+  [interceptedLayer->_keyPaths addObject:keyPath];
+
+  id initialModelValue = [layer valueForKeyPath:keyPath];
+  id providedPresentationValue = nil;
+  MDMValue providedVelocity;
+  CALayer *presentationLayer = nil;
+  BOOL wantsPresentationValue = [self wantsPresentationValueForKeyPath:keyPath
+                                                     initialModelValue:initialModelValue];
+  if (wantsPresentationValue && _presentationValueProvider) {
+    // Cheaper than capturing the presentation layer, and works for layers that don't have one.
+    providedPresentationValue =
+        _presentationValueProvider(layer, keyPath, initialModelValue, &providedVelocity);
+  }
+  if (wantsPresentationValue && providedPresentationValue == nil) {
+    if (!interceptedLayer->_didCapturePresentationLayer) {
+      // Actions are requested before the layer's value changes, so the first capture for a given
+      // layer reflects its state prior to any of the changes made in this block.
+      interceptedLayer->_presentationLayer = [layer presentationLayer];
+      interceptedLayer->_didCapturePresentationLayer = YES;
+    }
+    presentationLayer = interceptedLayer->_presentationLayer;
+  }
+  MDMImplicitAction *action = [_reusableActions lastObject];
+  if (action != nil) {
+    [_reusableActions removeLastObject];
+  } else {
+    action = [[MDMImplicitAction alloc] init];
+  }
+  [action reinitializeWithLayer:layer
+                        keyPath:keyPath
+              initialModelValue:initialModelValue
+      providedPresentationValue:providedPresentationValue
+               providedVelocity:&providedVelocity
+              presentationLayer:presentationLayer];
+  [_interceptedActions addObject:action];
 }
 
 - (NSArray<MDMImplicitAction *> *)interceptedActions {
-  return [_interceptedActions copy];
+  return _interceptedActions;
 }
 
 @end
@@ -109,11 +330,17 @@ static id<CAAction> ActionForKey(CALayer *layer, SEL _cmd, NSString *event) {
                 NSStringFromSelector(@selector(actionForKey:))],
             @"Invalid method signature.");
 
+  if (sImplicitAnimationDepth == 0) {
+    // Either the persistent hook is installed and we're outside of an implicit animation block, or
+    // another thread is performing one.
+    return ((id<CAAction>(*)(id, SEL, NSString *))sOriginalActionForKeyLayerImp)
+              (layer, _cmd, event);
+  }
+
   MDMActionContext *context = [sActionContext lastObject];
   NSCAssert(context != nil, @"MotionAnimator action method invoked out of implicit scope.");
 
-  BOOL shouldAnimateWithAnimator = [AllAnimatableKeyPaths() containsObject:event];
-  if (context == nil || !shouldAnimateWithAnimator) {
+  if (context == nil || !IsAnimatableKeyPath(event)) {
     // Fall through to the original CALayer implementation.
     return ((id<CAAction>(*)(id, SEL, NSString *))sOriginalActionForKeyLayerImp)
               (layer, _cmd, event);
@@ -127,10 +354,20 @@ static id<CAAction> ActionForKey(CALayer *layer, SEL _cmd, NSString *event) {
   return nil;
 }
 
-NSArray<MDMImplicitAction *> *MDMAnimateImplicitly(void (^work)(void)) {
+void MDMAnimateImplicitly(MDMImplicitAnimationOptions options,
+                          MDMPresentationValueProvider presentationValueProvider,
+                          MDMImplicitAnimationStatistics *statistics,
+                          void (^work)(void),
+                          void (^actionsHandler)(NSArray<MDMImplicitAction *> *actions)) {
+  if (statistics) {
+    *statistics = (MDMImplicitAnimationStatistics){0, 0};
+  }
+  NSCAssert([NSThread isMainThread], @"MDMAnimateImplicitly must be called on the main thread.");
   if (!work) {
-    return nil;
+    actionsHandler(@[]);
+    return;
   }
+  uint64_t traceStart = MDMTraceBegin();
 
   SEL actionForKeySelector = @selector(actionForKey:);
   Method actionForKeyMethod = class_getInstanceMethod([CALayer class], actionForKeySelector);
@@ -139,37 +376,76 @@ NSArray<MDMImplicitAction *> *MDMAnimateImplicitly(void (^work)(void)) {
   // method. Note that this is absolutely not thread safe, but neither is Core Animation.
   if (!sActionContext) {
     sActionContext = [NSMutableArray array];
-
+  }
+  if (sOriginalActionForKeyLayerImp == NULL) {
     // Swap the original CALayer implementation with our own so that we can intercept all
     // actionForKey: events.
     sOriginalActionForKeyLayerImp = method_setImplementation(actionForKeyMethod,
                                                              (IMP)ActionForKey);
   }
 
-  [sActionContext addObject:[[MDMActionContext alloc] init]];
+  if (!sReusableActionContexts) {
+    sReusableActionContexts = [NSMutableArray array];
+  }
+  MDMActionContext *context = [sReusableActionContexts lastObject];
+  if (context != nil) {
+    [sReusableActionContexts removeLastObject];
+  } else {
+    context = [[MDMActionContext alloc] init];
+  }
+  [context beginWithOptions:options presentationValueProvider:presentationValueProvider];
+  [sActionContext addObject:context];
+  sImplicitAnimationDepth++;
 
   work();
 
-  // Return any intercepted actions we received during the invocation of work.
-  MDMActionContext *context = [sActionContext lastObject];
+  sImplicitAnimationDepth--;
   [sActionContext removeLastObject];
 
-  if ([sActionContext count] == 0) {
+  if ([sActionContext count] == 0 && !sPersistentHookInstalled) {
     // Restore our original method if we've emptied the stack.
     method_setImplementation(actionForKeyMethod, sOriginalActionForKeyLayerImp);
     sOriginalActionForKeyLayerImp = nil;
+  }
 
-    sActionContext = nil;
+  if (statistics) {
+    *statistics = context.statistics;
   }
+  NSArray<MDMImplicitAction *> *interceptedActions = context.interceptedActions;
+  MDMTraceEnd(MDMTraceEventKindCaptureImplicitActions, traceStart, NULL,
+              (uint32_t)interceptedActions.count);
 
-  return context.interceptedActions;
+  // The context stays checked out while the handler runs, so implicit animations started by the
+  // handler use contexts of their own.
+  actionsHandler(interceptedActions);
+
+  [context reset];
+  [sReusableActionContexts addObject:context];
+}
+
+BOOL MDMIsAnimatingImplicitly(void) {
+  return sImplicitAnimationDepth > 0;
+}
+
+void MDMInstallPersistentImplicitAnimationHook(void) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    if (sOriginalActionForKeyLayerImp == NULL) {
+      Method actionForKeyMethod = class_getInstanceMethod([CALayer class],
+                                                          @selector(actionForKey:));
+      sOriginalActionForKeyLayerImp = method_setImplementation(actionForKeyMethod,
+                                                               (IMP)ActionForKey);
+    }
+    // If an implicit animation block is in progress, the hook it installed simply stays in place.
+    sPersistentHookInstalled = YES;
+  });
 }
 
 @implementation MDMLayerDelegate
 
 - (id<CAAction>)actionForLayer:(CALayer *)layer forKey:(NSString *)event {
   // Check whether we're inside of an MDMAnimateImplicitly block or not.
-  if (sOriginalActionForKeyLayerImp == nil) {
+  if (sImplicitAnimationDepth == 0) {
     return nil; // Tell Core Animation to Keep searching for an action provider.
   }
   return ActionForKey(layer, _cmd, event);
@@ -189,4 +465,8 @@ NSArray<MDMImplicitAction *> *MDMAnimateImplicitly(void (^work)(void)) {
   return sharedInstance;
 }
 
++ (void)installPersistentImplicitAnimationHook {
+  MDMInstallPersistentImplicitAnimationHook();
+}
+
 @end
@@ -0,0 +1,120 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMCommandBuffer.h"
+
+#include <stdlib.h>
+
+#define kInitialCapacity 16
+
+struct MDMCommandBuffer {
+  MDMCommandBufferCallbacks callbacks;
+  MDMCommand *commands;
+  size_t count;
+  size_t capacity;
+};
+
+#pragma mark - Private
+
+static const void *Retain(const MDMCommandBufferCallbacks *callbacks, const void *value) {
+  if (value != NULL && callbacks->retain != NULL) {
+    return callbacks->retain(value);
+  }
+  return value;
+}
+
+static void Release(const MDMCommandBufferCallbacks *callbacks, const void *value) {
+  if (value != NULL && callbacks->release != NULL) {
+    callbacks->release(value);
+  }
+}
+
+static int Reserve(MDMCommandBuffer *buffer, size_t capacity) {
+  if (capacity <= buffer->capacity) {
+    return 1;
+  }
+  size_t newCapacity = buffer->capacity > 0 ? buffer->capacity : kInitialCapacity;
+  while (newCapacity < capacity) {
+    newCapacity *= 2;
+  }
+  MDMCommand *commands = realloc(buffer->commands, newCapacity * sizeof(MDMCommand));
+  if (!commands) {
+    return 0;
+  }
+  buffer->commands = commands;
+  buffer->capacity = newCapacity;
+  return 1;
+}
+
+#pragma mark - Public
+
+MDMCommandBuffer *MDMCommandBufferCreate(const MDMCommandBufferCallbacks *callbacks) {
+  MDMCommandBuffer *buffer = calloc(1, sizeof(MDMCommandBuffer));
+  if (buffer && callbacks) {
+    buffer->callbacks = *callbacks;
+  }
+  return buffer;
+}
+
+void MDMCommandBufferDestroy(MDMCommandBuffer *buffer) {
+  if (!buffer) {
+    return;
+  }
+  MDMCommandBufferRemoveAll(buffer);
+  free(buffer->commands);
+  free(buffer);
+}
+
+int MDMCommandBufferAppend(MDMCommandBuffer *buffer, const MDMCommand *command) {
+  if (!Reserve(buffer, buffer->count + 1)) {
+    return 0;
+  }
+  const MDMCommandBufferCallbacks *callbacks = &buffer->callbacks;
+  MDMCommand *stored = &buffer->commands[buffer->count++];
+  stored->layer = Retain(callbacks, command->layer);
+  stored->keyPath = Retain(callbacks, command->keyPath);
+  stored->traits = Retain(callbacks, command->traits);
+  stored->values = Retain(callbacks, command->values);
+  stored->completion = Retain(callbacks, command->completion);
+  stored->valueClass = command->valueClass;
+  return 1;
+}
+
+const MDMCommand *MDMCommandBufferCommands(const MDMCommandBuffer *buffer, size_t *count) {
+  *count = buffer->count;
+  return buffer->commands;
+}
+
+size_t MDMCommandBufferCount(const MDMCommandBuffer *buffer) {
+  return buffer->count;
+}
+
+size_t MDMCommandBufferCapacity(const MDMCommandBuffer *buffer) {
+  return buffer->capacity;
+}
+
+void MDMCommandBufferRemoveAll(MDMCommandBuffer *buffer) {
+  const MDMCommandBufferCallbacks *callbacks = &buffer->callbacks;
+  for (size_t i = 0; i < buffer->count; ++i) {
+    const MDMCommand *command = &buffer->commands[i];
+    Release(callbacks, command->layer);
+    Release(callbacks, command->keyPath);
+    Release(callbacks, command->traits);
+    Release(callbacks, command->values);
+    Release(callbacks, command->completion);
+  }
+  buffer->count = 0;
+}
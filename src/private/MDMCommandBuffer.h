@@ -0,0 +1,86 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_COMMAND_BUFFER_H
+#define MDM_COMMAND_BUFFER_H
+
+// A growable, contiguous list of recorded explicit animation requests that MDMMotionAnimator
+// submits together.
+//
+// Commands refer to their layer, key path, traits, values and completion through opaque pointers
+// whose lifetimes are managed through the callbacks provided on creation. Removing every command
+// keeps the buffer's storage, so recording the same number of commands again does not allocate.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform. It is not thread safe.
+
+#include <stddef.h>
+
+#include "MDMValueClass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  // Returns the value to be stored. May be NULL, in which case the value is stored as-is.
+  const void *(*retain)(const void *value);
+  // May be NULL.
+  void (*release)(const void *value);
+} MDMCommandBufferCallbacks;
+
+typedef struct {
+  const void *layer;
+  const void *keyPath;
+  const void *traits;
+  // The values to animate between.
+  const void *values;
+  // May be NULL.
+  const void *completion;
+  // The class of the values, cached so that it isn't probed again when the command is submitted.
+  MDMValueClass valueClass;
+} MDMCommand;
+
+typedef struct MDMCommandBuffer MDMCommandBuffer;
+
+// Creates an empty buffer. `callbacks` are applied to every non-NULL pointer of a command and may
+// be NULL. Returns NULL if memory could not be allocated.
+MDMCommandBuffer *MDMCommandBufferCreate(const MDMCommandBufferCallbacks *callbacks);
+
+// Releases every command and frees the buffer.
+void MDMCommandBufferDestroy(MDMCommandBuffer *buffer);
+
+// Appends a copy of the command. Returns 0 if memory could not be allocated, in which case the
+// command is not retained.
+int MDMCommandBufferAppend(MDMCommandBuffer *buffer, const MDMCommand *command);
+
+// Returns the commands in the order they were appended and writes their count to `count`. The
+// returned pointer is invalidated by any mutation of the buffer.
+const MDMCommand *MDMCommandBufferCommands(const MDMCommandBuffer *buffer, size_t *count);
+
+size_t MDMCommandBufferCount(const MDMCommandBuffer *buffer);
+
+// The number of commands the buffer can hold without allocating.
+size_t MDMCommandBufferCapacity(const MDMCommandBuffer *buffer);
+
+// Releases and removes every command, keeping the buffer's storage.
+void MDMCommandBufferRemoveAll(MDMCommandBuffer *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_COMMAND_BUFFER_H
@@ -0,0 +1,207 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMCubicBezier.h"
+
+#include <math.h>
+
+// The number of Newton-Raphson iterations applied to the initial estimate from the sample table.
+enum { kNewtonIterations = 4 };
+
+// The number of values solved together by MDMCubicBezierSolveBatch.
+enum { kBatchWidth = 8 };
+
+// Newton steps are skipped where x(t) is flatter than this, as the step would be unreliable.
+static const double kMinimumSlope = 1e-6;
+
+static const double kSampleSpacing = 1.0 / (MDMCubicBezierSampleCount - 1);
+
+// Accounts for rounding in the evaluation of y(t).
+static const double kRoundingSlack = 1e-12;
+
+#pragma mark - Private
+
+// NaN is clamped to the lower bound.
+static double Clamp(double value, double lower, double upper) {
+  return !(value > lower) ? lower : (value > upper ? upper : value);
+}
+
+static double CurveX(const MDMCubicBezier *curve, double t) {
+  return ((curve->ax * t + curve->bx) * t + curve->cx) * t;
+}
+
+static double CurveY(const MDMCubicBezier *curve, double t) {
+  return ((curve->ay * t + curve->by) * t + curve->cy) * t;
+}
+
+static double CurveSlopeX(const MDMCubicBezier *curve, double t) {
+  return (3 * curve->ax * t + 2 * curve->bx) * t + curve->cx;
+}
+
+static double CurveSlopeY(const MDMCubicBezier *curve, double t) {
+  return (3 * curve->ay * t + 2 * curve->by) * t + curve->cy;
+}
+
+// Returns the index of the sample interval containing x. x(t) is monotonic, so this is the number
+// of interior samples at or below x, which can be counted without branching.
+static int SampleInterval(const MDMCubicBezier *curve, double x) {
+  int interval = 0;
+  for (int i = 1; i < MDMCubicBezierSampleCount - 1; ++i) {
+    interval += curve->samples[i] <= x;
+  }
+  return interval;
+}
+
+// Interpolates linearly within the sample interval containing x.
+static double EstimateParameter(const MDMCubicBezier *curve, double x, int interval) {
+  double lowerSample = curve->samples[interval];
+  double span = curve->samples[interval + 1] - lowerSample;
+  double fraction = span > 0 ? (x - lowerSample) / span : 0;
+  return (interval + Clamp(fraction, 0, 1)) * kSampleSpacing;
+}
+
+static double NewtonStep(const MDMCubicBezier *curve, double x, double t,
+                         double lower, double upper) {
+  double error = CurveX(curve, t) - x;
+  double slope = CurveSlopeX(curve, t);
+  double step = slope > kMinimumSlope ? error / slope : 0;
+  return Clamp(t - step, lower, upper);
+}
+
+// Whether the exact solution lies within the parameter tolerance of t. x(t) is monotonic, so this
+// is the case if x lies between x(t - tolerance) and x(t + tolerance).
+static int IsWithinTolerance(const MDMCubicBezier *curve, double x, double t) {
+  double below = CurveX(curve, Clamp(t - MDMCubicBezierParameterTolerance, 0, 1));
+  double above = CurveX(curve, Clamp(t + MDMCubicBezierParameterTolerance, 0, 1));
+  return below <= x && x <= above;
+}
+
+static double Bisect(const MDMCubicBezier *curve, double x, double lower, double upper) {
+  while (upper - lower > 2 * MDMCubicBezierParameterTolerance) {
+    double mid = (lower + upper) / 2;
+    if (CurveX(curve, mid) < x) {
+      lower = mid;
+    } else {
+      upper = mid;
+    }
+  }
+  return (lower + upper) / 2;
+}
+
+// Solves x(t) = x for t, given Newton's estimate within the sample interval.
+static double ResolveParameter(const MDMCubicBezier *curve, double x, double t, int interval) {
+  if (IsWithinTolerance(curve, x, t)) {
+    return t;
+  }
+  return Bisect(curve, x, interval * kSampleSpacing, (interval + 1) * kSampleSpacing);
+}
+
+// Solves x(t) = x for t, for x in (0, 1).
+static double SolveParameter(const MDMCubicBezier *curve, double x) {
+  int interval = SampleInterval(curve, x);
+  double lower = interval * kSampleSpacing;
+  double upper = lower + kSampleSpacing;
+  double t = EstimateParameter(curve, x, interval);
+  for (int i = 0; i < kNewtonIterations; ++i) {
+    t = NewtonStep(curve, x, t, lower, upper);
+  }
+  return ResolveParameter(curve, x, t, interval);
+}
+
+#pragma mark - Public
+
+void MDMCubicBezierInit(MDMCubicBezier *curve, double x1, double y1, double x2, double y2) {
+  x1 = Clamp(x1, 0, 1);
+  x2 = Clamp(x2, 0, 1);
+
+  // B(t) = 3(1 - t)^2 t p1 + 3(1 - t) t^2 p2 + t^3, expanded into polynomial form.
+  curve->cx = 3 * x1;
+  curve->bx = 3 * (x2 - x1) - curve->cx;
+  curve->ax = 1 - curve->cx - curve->bx;
+  curve->cy = 3 * y1;
+  curve->by = 3 * (y2 - y1) - curve->cy;
+  curve->ay = 1 - curve->cy - curve->by;
+
+  for (int i = 0; i < MDMCubicBezierSampleCount; ++i) {
+    curve->samples[i] = CurveX(curve, i * kSampleSpacing);
+  }
+
+  // y'(t) is a quadratic bezier curve with control points 3 y1, 3 (y2 - y1) and 3 (1 - y2), so its
+  // magnitude is bounded by the largest of them.
+  double steepestSlope = 3 * fmax(fabs(y1), fmax(fabs(y2 - y1), fabs(1 - y2)));
+  curve->errorBound = steepestSlope * MDMCubicBezierParameterTolerance + kRoundingSlack;
+}
+
+double MDMCubicBezierSolve(const MDMCubicBezier *curve, double x) {
+  if (!(x > 0)) {
+    return 0;
+  }
+  if (x >= 1) {
+    return 1;
+  }
+  return CurveY(curve, SolveParameter(curve, x));
+}
+
+double MDMCubicBezierSlope(const MDMCubicBezier *curve, double x) {
+  // x'(t) vanishes at an end of the curve whose neighbouring control point shares its x coordinate,
+  // so the ends are approached from within the curve instead.
+  double t = MDMCubicBezierParameterTolerance;
+  if (x >= 1) {
+    t = 1 - MDMCubicBezierParameterTolerance;
+  } else if (x > 0) {
+    t = Clamp(SolveParameter(curve, x), MDMCubicBezierParameterTolerance,
+              1 - MDMCubicBezierParameterTolerance);
+  }
+  // dy/dx = y'(t) / x'(t).
+  double slopeX = CurveSlopeX(curve, t);
+  return slopeX > 0 ? CurveSlopeY(curve, t) / slopeX : 0;
+}
+
+void MDMCubicBezierSolveBatch(const MDMCubicBezier *curve, const double *x, double *y, size_t count) {
+  size_t index = 0;
+  for (; index + kBatchWidth <= count; index += kBatchWidth) {
+    double target[kBatchWidth];
+    double t[kBatchWidth];
+    double lower[kBatchWidth];
+    double upper[kBatchWidth];
+    int interval[kBatchWidth];
+    for (int lane = 0; lane < kBatchWidth; ++lane) {
+      target[lane] = Clamp(x[index + lane], 0, 1);
+      interval[lane] = SampleInterval(curve, target[lane]);
+      lower[lane] = interval[lane] * kSampleSpacing;
+      upper[lane] = lower[lane] + kSampleSpacing;
+      t[lane] = EstimateParameter(curve, target[lane], interval[lane]);
+    }
+    for (int i = 0; i < kNewtonIterations; ++i) {
+      for (int lane = 0; lane < kBatchWidth; ++lane) {
+        t[lane] = NewtonStep(curve, target[lane], t[lane], lower[lane], upper[lane]);
+      }
+    }
+    for (int lane = 0; lane < kBatchWidth; ++lane) {
+      t[lane] = ResolveParameter(curve, target[lane], t[lane], interval[lane]);
+    }
+    for (int lane = 0; lane < kBatchWidth; ++lane) {
+      y[index + lane] = CurveY(curve, t[lane]);
+    }
+  }
+  for (; index < count; ++index) {
+    y[index] = MDMCubicBezierSolve(curve, x[index]);
+  }
+}
+
+double MDMCubicBezierErrorBound(const MDMCubicBezier *curve) {
+  return curve->errorBound;
+}
@@ -0,0 +1,82 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_CUBIC_BEZIER_H
+#define MDM_CUBIC_BEZIER_H
+
+// A solver for cubic bezier timing curves such as those described by CAMediaTimingFunction.
+//
+// A timing curve maps an animation's elapsed fraction of time, x, to its progress, y, along the
+// curve B(t) with control points (0, 0), (x1, y1), (x2, y2) and (1, 1). Solving for y requires
+// first solving x(t) = x for the curve parameter t, which this solver does with a per-curve table
+// of samples followed by Newton-Raphson refinement, falling back to bisection where Newton's
+// method fails to converge.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The number of evenly spaced samples of x(t) stored with each curve, including both endpoints.
+#define MDMCubicBezierSampleCount 11
+
+// Solutions for t are accurate to within this distance of the exact solution.
+#define MDMCubicBezierParameterTolerance 1e-7
+
+typedef struct {
+  // x(t) = ((ax * t + bx) * t + cx) * t, and likewise for y(t).
+  double ax, bx, cx;
+  double ay, by, cy;
+  // x(t) at t = i / (MDMCubicBezierSampleCount - 1).
+  double samples[MDMCubicBezierSampleCount];
+  // See MDMCubicBezierErrorBound.
+  double errorBound;
+} MDMCubicBezier;
+
+// Precomputes the curve with the given control points. Like Core Animation, x1 and x2 are clamped
+// to [0, 1] so that the curve is a function of time.
+void MDMCubicBezierInit(MDMCubicBezier *curve, double x1, double y1, double x2, double y2);
+
+// Returns the curve's progress at the elapsed fraction of time x. x is clamped to [0, 1].
+double MDMCubicBezierSolve(const MDMCubicBezier *curve, double x);
+
+// Returns the derivative of the curve's progress with respect to the elapsed fraction of time at x.
+// x is clamped to [0, 1].
+double MDMCubicBezierSlope(const MDMCubicBezier *curve, double x);
+
+// Writes the curve's progress at each of the `count` elapsed fractions of time in `x` to `y`, within
+// the same error bound as MDMCubicBezierSolve. The arrays may be the same.
+//
+// Values are solved in fixed-width groups whose Newton iterations are free of branches, allowing
+// the compiler to vectorize them.
+void MDMCubicBezierSolveBatch(const MDMCubicBezier *curve, const double *x, double *y, size_t count);
+
+// The maximum absolute difference between MDMCubicBezierSolve and the exact progress of the curve,
+// for any x, up to the rounding of x(t) in double precision.
+//
+// The bound follows from the parameter tolerance and the steepest slope of y(t), which is at most
+// three times the largest difference between consecutive control points' y coordinates.
+double MDMCubicBezierErrorBound(const MDMCubicBezier *curve);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_CUBIC_BEZIER_H
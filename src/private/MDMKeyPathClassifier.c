@@ -0,0 +1,88 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMKeyPathClassifier.h"
+
+#include <string.h>
+
+#define kSlotCount 64
+
+static const char *const kKeyPaths[MDMAnimatableKeyPathKindCount] = {
+  NULL,
+  "anchorPoint",
+  "backgroundColor",
+  "bounds",
+  "borderWidth",
+  "borderColor",
+  "cornerRadius",
+  "bounds.size.height",
+  "opacity",
+  "position",
+  "transform.rotation.z",
+  "transform.scale",
+  "shadowColor",
+  "shadowOffset",
+  "shadowOpacity",
+  "shadowRadius",
+  "strokeStart",
+  "strokeEnd",
+  "transform",
+  "bounds.size.width",
+  "position.x",
+  "position.y",
+  "zPosition",
+};
+
+// kKeyPaths[kSlots[Hash(keyPath)]] is the only candidate for a given key path. The multipliers were
+// chosen by search so that no two animatable key paths share a slot; the unit tests verify this.
+static const unsigned char kSlots[kSlotCount] = {
+  17, 0,  0,  18, 10, 6,  12, 0,  1,  0,  20, 0,  0,  0,  0,  0,
+  8,  0,  0,  0,  7,  15, 0,  0,  21, 11, 0,  0,  0,  0,  0,  0,
+  0,  0,  16, 13, 0,  4,  0,  0,  0,  0,  14, 19, 0,  0,  0,  22,
+  0,  5,  0,  0,  0,  2,  0,  0,  0,  0,  3,  0,  9,  0,  0,  0,
+};
+
+#pragma mark - Private
+
+static size_t Hash(const char *keyPath, size_t length) {
+  size_t first = (unsigned char)keyPath[0];
+  size_t last = (unsigned char)keyPath[length - 1];
+  return (length + 5 * first + 14 * last) & (kSlotCount - 1);
+}
+
+#pragma mark - Public
+
+MDMAnimatableKeyPathKind MDMClassifyKeyPath(const char *keyPath, size_t length) {
+  if (length == 0 || length > MDMAnimatableKeyPathMaxLength) {
+    return MDMAnimatableKeyPathKindNone;
+  }
+  unsigned char candidate = kSlots[Hash(keyPath, length)];
+  if (candidate == MDMAnimatableKeyPathKindNone) {
+    return MDMAnimatableKeyPathKindNone;
+  }
+  const char *candidateKeyPath = kKeyPaths[candidate];
+  if (strlen(candidateKeyPath) != length || memcmp(candidateKeyPath, keyPath, length) != 0) {
+    return MDMAnimatableKeyPathKindNone;
+  }
+  return (MDMAnimatableKeyPathKind)candidate;
+}
+
+const char *MDMAnimatableKeyPathKindGetKeyPath(MDMAnimatableKeyPathKind kind) {
+  if (kind <= MDMAnimatableKeyPathKindNone || kind >= MDMAnimatableKeyPathKindCount) {
+    return NULL;
+  }
+  return kKeyPaths[kind];
+}
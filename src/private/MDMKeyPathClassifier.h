@@ -0,0 +1,75 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_KEY_PATH_CLASSIFIER_H
+#define MDM_KEY_PATH_CLASSIFIER_H
+
+// Classifies key path strings as one of the key paths declared in MDMAnimatableKeyPaths.h.
+//
+// Classification uses a perfect hash of the key path's length and its first and last characters
+// followed by a single comparison, so it costs the same regardless of which key path is looked up.
+// This file is free of any Apple framework dependencies so that it can be built and tested on any
+// platform.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Declared in the same order as MDMAnimatableKeyPaths.h.
+typedef enum {
+  MDMAnimatableKeyPathKindNone = 0,
+  MDMAnimatableKeyPathKindAnchorPoint,
+  MDMAnimatableKeyPathKindBackgroundColor,
+  MDMAnimatableKeyPathKindBounds,
+  MDMAnimatableKeyPathKindBorderWidth,
+  MDMAnimatableKeyPathKindBorderColor,
+  MDMAnimatableKeyPathKindCornerRadius,
+  MDMAnimatableKeyPathKindHeight,
+  MDMAnimatableKeyPathKindOpacity,
+  MDMAnimatableKeyPathKindPosition,
+  MDMAnimatableKeyPathKindRotation,
+  MDMAnimatableKeyPathKindScale,
+  MDMAnimatableKeyPathKindShadowColor,
+  MDMAnimatableKeyPathKindShadowOffset,
+  MDMAnimatableKeyPathKindShadowOpacity,
+  MDMAnimatableKeyPathKindShadowRadius,
+  MDMAnimatableKeyPathKindStrokeStart,
+  MDMAnimatableKeyPathKindStrokeEnd,
+  MDMAnimatableKeyPathKindTransform,
+  MDMAnimatableKeyPathKindWidth,
+  MDMAnimatableKeyPathKindX,
+  MDMAnimatableKeyPathKindY,
+  MDMAnimatableKeyPathKindZ,
+  MDMAnimatableKeyPathKindCount,
+} MDMAnimatableKeyPathKind;
+
+// The length of the longest animatable key path, excluding the terminator.
+#define MDMAnimatableKeyPathMaxLength 20
+
+// Returns the kind of the `length` bytes at `keyPath`, or MDMAnimatableKeyPathKindNone if they are
+// not an animatable key path. `keyPath` does not need to be terminated.
+MDMAnimatableKeyPathKind MDMClassifyKeyPath(const char *keyPath, size_t length);
+
+// Returns the key path string of the given kind, or NULL for MDMAnimatableKeyPathKindNone.
+const char *MDMAnimatableKeyPathKindGetKeyPath(MDMAnimatableKeyPathKind kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_KEY_PATH_CLASSIFIER_H
@@ -0,0 +1,41 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "MDMKeyPathClassifier.h"
+
+// Returns the kind of the key path, or MDMAnimatableKeyPathKindNone if it is nil or is not one of
+// the key paths declared in MDMAnimatableKeyPaths.h.
+static inline MDMAnimatableKeyPathKind MDMKindOfKeyPath(NSString *keyPath) {
+  if (keyPath == nil) {
+    return MDMAnimatableKeyPathKindNone;
+  }
+  CFStringRef string = (__bridge CFStringRef)keyPath;
+  CFIndex length = CFStringGetLength(string);
+  if (length > MDMAnimatableKeyPathMaxLength) {
+    return MDMAnimatableKeyPathKindNone;
+  }
+  const char *characters = CFStringGetCStringPtr(string, kCFStringEncodingASCII);
+  char buffer[MDMAnimatableKeyPathMaxLength + 1];
+  if (characters == NULL) {
+    if (!CFStringGetCString(string, buffer, sizeof(buffer), kCFStringEncodingASCII)) {
+      return MDMAnimatableKeyPathKindNone;
+    }
+    characters = buffer;
+  }
+  return MDMClassifyKeyPath(characters, (size_t)length);
+}
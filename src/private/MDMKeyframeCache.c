@@ -0,0 +1,277 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMKeyframeCache.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The number of slots inspected, starting at a key's home slot, when looking up or inserting it.
+#define kProbeWindow 8
+
+// The capacity of MDMKeyframeCacheShared.
+#define kSharedCacheCapacity 64
+
+// Keyframes are sampled into a buffer of this size before the exact number is known.
+#define kInitialSampleCapacity 128
+
+enum { kKeyLength = 9 };
+
+typedef struct {
+  int isOccupied;
+  // The curve's kind and parameters followed by the duration and the error. Compared bitwise.
+  double key[kKeyLength];
+  uint64_t lastUse;
+  size_t count;
+  MDMKeyframe *keyframes;
+} Entry;
+
+struct MDMKeyframeCache {
+  pthread_mutex_t lock;
+  Entry *entries;
+  size_t capacity;
+  size_t count;
+  uint64_t clock;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+};
+
+#pragma mark - Private
+
+static void MakeKey(const MDMTimingCurve *curve, double duration, double maximumError,
+                    double key[kKeyLength]) {
+  memset(key, 0, kKeyLength * sizeof(double));
+  key[0] = curve->kind;
+  switch (curve->kind) {
+    case MDMTimingCurveKindLinear:
+      break;
+    case MDMTimingCurveKindCubicBezier:
+      key[1] = curve->bezier.ax;
+      key[2] = curve->bezier.bx;
+      key[3] = curve->bezier.cx;
+      key[4] = curve->bezier.ay;
+      key[5] = curve->bezier.by;
+      key[6] = curve->bezier.cy;
+      break;
+    case MDMTimingCurveKindSpring:
+      key[1] = curve->spring.regime;
+      key[2] = curve->spring.decay;
+      key[3] = curve->spring.frequency;
+      key[4] = curve->spring.a;
+      key[5] = curve->spring.b;
+      break;
+  }
+  key[7] = duration;
+  key[8] = maximumError;
+}
+
+static uint64_t HashKey(const double key[kKeyLength]) {
+  // splitmix64 finalizer applied to the bits of each component.
+  uint64_t hash = 0;
+  for (int i = 0; i < kKeyLength; ++i) {
+    uint64_t bits;
+    memcpy(&bits, &key[i], sizeof(bits));
+    uint64_t z = hash + bits + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    hash = z ^ (z >> 31);
+  }
+  return hash;
+}
+
+static size_t ProbeWindow(const MDMKeyframeCache *cache) {
+  return cache->capacity < kProbeWindow ? cache->capacity : kProbeWindow;
+}
+
+// Must be called with the lock held.
+static Entry *FindEntry(MDMKeyframeCache *cache, const double key[kKeyLength]) {
+  size_t home = (size_t)(HashKey(key) % cache->capacity);
+  size_t window = ProbeWindow(cache);
+  for (size_t i = 0; i < window; ++i) {
+    Entry *entry = &cache->entries[(home + i) % cache->capacity];
+    if (entry->isOccupied && memcmp(entry->key, key, sizeof(entry->key)) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Must be called with the lock held. Returns the slot that the key should be stored in, evicting
+// the least recently used entry in the key's probe window if necessary. The returned slot's
+// keyframes are released.
+static Entry *SlotForInsertion(MDMKeyframeCache *cache, const double key[kKeyLength]) {
+  Entry *slot = FindEntry(cache, key);
+  if (!slot) {
+    size_t home = (size_t)(HashKey(key) % cache->capacity);
+    size_t window = ProbeWindow(cache);
+    for (size_t i = 0; i < window; ++i) {
+      Entry *entry = &cache->entries[(home + i) % cache->capacity];
+      if (!entry->isOccupied) {
+        cache->count++;
+        slot = entry;
+        break;
+      }
+      if (slot == NULL || entry->lastUse < slot->lastUse) {
+        slot = entry;
+      }
+    }
+    if (slot->isOccupied) {
+      cache->evictions++;
+    }
+  }
+  free(slot->keyframes);
+  slot->keyframes = NULL;
+  return slot;
+}
+
+static size_t CopyKeyframes(const MDMKeyframe *source, size_t count,
+                            MDMKeyframe *keyframes, size_t capacity) {
+  size_t copyCount = count < capacity ? count : capacity;
+  if (copyCount > 0) {
+    memcpy(keyframes, source, copyCount * sizeof(MDMKeyframe));
+  }
+  return count;
+}
+
+static MDMKeyframeCache *sSharedCache = NULL;
+static pthread_once_t sSharedCacheOnce = PTHREAD_ONCE_INIT;
+
+static void InitializeSharedCache(void) {
+  sSharedCache = MDMKeyframeCacheCreate(kSharedCacheCapacity);
+}
+
+#pragma mark - Public
+
+MDMKeyframeCache *MDMKeyframeCacheCreate(size_t capacity) {
+  if (capacity == 0) {
+    return NULL;
+  }
+  MDMKeyframeCache *cache = calloc(1, sizeof(MDMKeyframeCache));
+  if (!cache) {
+    return NULL;
+  }
+  cache->entries = calloc(capacity, sizeof(Entry));
+  if (!cache->entries) {
+    free(cache);
+    return NULL;
+  }
+  cache->capacity = capacity;
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+void MDMKeyframeCacheDestroy(MDMKeyframeCache *cache) {
+  if (!cache) {
+    return;
+  }
+  MDMKeyframeCacheRemoveAll(cache);
+  pthread_mutex_destroy(&cache->lock);
+  free(cache->entries);
+  free(cache);
+}
+
+MDMKeyframeCache *MDMKeyframeCacheShared(void) {
+  pthread_once(&sSharedCacheOnce, InitializeSharedCache);
+  return sSharedCache;
+}
+
+size_t MDMKeyframeCacheLookup(MDMKeyframeCache *cache,
+                              const MDMTimingCurve *curve,
+                              double duration,
+                              double maximumError,
+                              MDMKeyframe *keyframes,
+                              size_t capacity) {
+  if (!cache) {
+    return MDMKeyframeSamplerSample(curve, duration, maximumError, keyframes, capacity);
+  }
+  double key[kKeyLength];
+  MakeKey(curve, duration, maximumError, key);
+
+  pthread_mutex_lock(&cache->lock);
+  Entry *entry = FindEntry(cache, key);
+  if (entry) {
+    entry->lastUse = ++cache->clock;
+    cache->hits++;
+    size_t count = CopyKeyframes(entry->keyframes, entry->count, keyframes, capacity);
+    pthread_mutex_unlock(&cache->lock);
+    return count;
+  }
+  cache->misses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  // Sampling happens outside of the lock.
+  MDMKeyframe initialBuffer[kInitialSampleCapacity];
+  size_t count = MDMKeyframeSamplerSample(curve, duration, maximumError, initialBuffer,
+                                          kInitialSampleCapacity);
+  MDMKeyframe *sampled = count > 0 ? malloc(count * sizeof(MDMKeyframe)) : NULL;
+  if (!sampled) {
+    // Either the configuration is invalid or memory is short; neither is worth caching.
+    return count > kInitialSampleCapacity
+               ? MDMKeyframeSamplerSample(curve, duration, maximumError, keyframes, capacity)
+               : CopyKeyframes(initialBuffer, count, keyframes, capacity);
+  }
+  if (count > kInitialSampleCapacity) {
+    MDMKeyframeSamplerSample(curve, duration, maximumError, sampled, count);
+  } else {
+    memcpy(sampled, initialBuffer, count * sizeof(MDMKeyframe));
+  }
+  CopyKeyframes(sampled, count, keyframes, capacity);
+
+  pthread_mutex_lock(&cache->lock);
+  entry = SlotForInsertion(cache, key);
+  entry->isOccupied = 1;
+  memcpy(entry->key, key, sizeof(entry->key));
+  entry->lastUse = ++cache->clock;
+  entry->count = count;
+  entry->keyframes = sampled;
+  pthread_mutex_unlock(&cache->lock);
+  return count;
+}
+
+MDMKeyframeCacheStatistics MDMKeyframeCacheGetStatistics(MDMKeyframeCache *cache) {
+  MDMKeyframeCacheStatistics statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  if (!cache) {
+    return statistics;
+  }
+  pthread_mutex_lock(&cache->lock);
+  statistics.hits = cache->hits;
+  statistics.misses = cache->misses;
+  statistics.evictions = cache->evictions;
+  statistics.count = cache->count;
+  statistics.capacity = cache->capacity;
+  pthread_mutex_unlock(&cache->lock);
+  return statistics;
+}
+
+void MDMKeyframeCacheRemoveAll(MDMKeyframeCache *cache) {
+  if (!cache) {
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  for (size_t i = 0; i < cache->capacity; ++i) {
+    free(cache->entries[i].keyframes);
+  }
+  memset(cache->entries, 0, cache->capacity * sizeof(Entry));
+  cache->count = 0;
+  cache->clock = 0;
+  cache->hits = 0;
+  cache->misses = 0;
+  cache->evictions = 0;
+  pthread_mutex_unlock(&cache->lock);
+}
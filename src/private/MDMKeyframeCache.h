@@ -0,0 +1,72 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_KEYFRAME_CACHE_H
+#define MDM_KEYFRAME_CACHE_H
+
+// A bounded, thread-safe memoization cache for the keyframes of MDMKeyframeSamplerSample.
+//
+// Keyframes only depend on the timing curve, the duration and the error, so animations that share
+// a motion spec share their keyframes regardless of the values they animate between.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MDMKeyframeSampler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MDMKeyframeCache MDMKeyframeCache;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t count;
+  size_t capacity;
+} MDMKeyframeCacheStatistics;
+
+// Creates a cache holding the keyframes of at most `capacity` configurations. Least recently used
+// entries are evicted once the cache is full. Returns NULL if memory could not be allocated.
+MDMKeyframeCache *MDMKeyframeCacheCreate(size_t capacity);
+
+void MDMKeyframeCacheDestroy(MDMKeyframeCache *cache);
+
+// The process-wide cache used by the animator.
+MDMKeyframeCache *MDMKeyframeCacheShared(void);
+
+// Looks up or samples the keyframes of the given configuration. Behaves like
+// MDMKeyframeSamplerSample otherwise: returns the number of keyframes, of which at most `capacity`
+// are copied to `keyframes`. Configurations are matched exactly.
+size_t MDMKeyframeCacheLookup(MDMKeyframeCache *cache,
+                              const MDMTimingCurve *curve,
+                              double duration,
+                              double maximumError,
+                              MDMKeyframe *keyframes,
+                              size_t capacity);
+
+MDMKeyframeCacheStatistics MDMKeyframeCacheGetStatistics(MDMKeyframeCache *cache);
+
+// Removes every entry and resets the statistics.
+void MDMKeyframeCacheRemoveAll(MDMKeyframeCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_KEYFRAME_CACHE_H
@@ -0,0 +1,90 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMKeyframeSampler.h"
+
+#include <math.h>
+
+#pragma mark - Private
+
+static size_t SampleCount(double duration) {
+  double count = ceil(duration * MDMKeyframeSamplerSamplesPerSecond);
+  if (count < 1) {
+    return 1;
+  }
+  if (count > MDMKeyframeSamplerMaxSampleCount) {
+    return MDMKeyframeSamplerMaxSampleCount;
+  }
+  return (size_t)count;
+}
+
+static double ProgressAtSample(const MDMTimingCurve *curve, double duration, size_t sample,
+                               size_t sampleCount) {
+  return MDMTimingCurveProgress(curve, duration * (double)sample / (double)sampleCount, duration);
+}
+
+static void AppendKeyframe(MDMKeyframe *keyframes, size_t capacity, size_t *count,
+                           double time, double progress) {
+  if (*count < capacity) {
+    keyframes[*count] = (MDMKeyframe){time, progress};
+  }
+  (*count)++;
+}
+
+#pragma mark - Public
+
+size_t MDMKeyframeSamplerSample(const MDMTimingCurve *curve,
+                                double duration,
+                                double maximumError,
+                                MDMKeyframe *keyframes,
+                                size_t capacity) {
+  if (!(duration > 0) || !isfinite(duration) || !(maximumError > 0)) {
+    return 0;
+  }
+  size_t sampleCount = SampleCount(duration);
+  size_t count = 0;
+
+  size_t anchor = 0;
+  double anchorProgress = ProgressAtSample(curve, duration, 0, sampleCount);
+  AppendKeyframe(keyframes, capacity, &count, 0, anchorProgress);
+
+  while (anchor < sampleCount) {
+    // The slopes of the chords from the anchor that pass within the error of every sample visited
+    // so far. A sample can end the segment if the chord to it lies within this cone.
+    double lowestSlope = -INFINITY;
+    double highestSlope = INFINITY;
+    size_t end = anchor + 1;
+    double endProgress = 0;
+    for (size_t sample = anchor + 1; sample <= sampleCount; ++sample) {
+      double progress = ProgressAtSample(curve, duration, sample, sampleCount);
+      double run = (double)(sample - anchor);
+      double slope = (progress - anchorProgress) / run;
+      if (slope >= lowestSlope && slope <= highestSlope) {
+        end = sample;
+        endProgress = progress;
+      }
+      lowestSlope = fmax(lowestSlope, (progress - maximumError - anchorProgress) / run);
+      highestSlope = fmin(highestSlope, (progress + maximumError - anchorProgress) / run);
+      if (lowestSlope > highestSlope) {
+        break;
+      }
+    }
+    AppendKeyframe(keyframes, capacity, &count, (double)end / (double)sampleCount, endProgress);
+    anchor = end;
+    anchorProgress = endProgress;
+  }
+  return count;
+}
@@ -0,0 +1,68 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_KEYFRAME_SAMPLER_H
+#define MDM_KEYFRAME_SAMPLER_H
+
+// Converts timing curves into keyframes that Core Animation interpolates linearly.
+//
+// The curve is evaluated on a grid of MDMKeyframeSamplerSamplesPerSecond samples per second of the
+// animation's duration. Each segment between keyframes is extended greedily for as long as its
+// chord stays within the error of every grid sample it spans, which keeps the number of keyframes
+// close to the minimum without storing the grid.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#include <stddef.h>
+
+#include "MDMPresentationEvaluator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The density of the grid on which the error of the keyframes is measured. Between grid samples,
+// the error additionally depends on the curve's curvature.
+#define MDMKeyframeSamplerSamplesPerSecond 1000
+
+// Longer animations are measured on a coarser grid.
+#define MDMKeyframeSamplerMaxSampleCount 8192
+
+typedef struct {
+  // The fraction of the animation's duration, in [0, 1].
+  double time;
+  // The curve's progress at that time, as returned by MDMTimingCurveProgress.
+  double progress;
+} MDMKeyframe;
+
+// Samples the curve over an animation lasting `duration` seconds into the smallest set of keyframes
+// the greedy search finds whose linear interpolation stays within `maximumError` of the curve's
+// progress at every grid sample. The first and last keyframes are at times 0 and 1.
+//
+// Returns the number of keyframes, of which at most `capacity` are written to `keyframes`. Returns
+// 0 if the duration isn't positive and finite or the error isn't positive.
+size_t MDMKeyframeSamplerSample(const MDMTimingCurve *curve,
+                                double duration,
+                                double maximumError,
+                                MDMKeyframe *keyframes,
+                                size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_KEYFRAME_SAMPLER_H
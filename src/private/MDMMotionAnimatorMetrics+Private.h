@@ -14,26 +14,23 @@
  limitations under the License.
  */
 
-#import "MDMRegisteredAnimation.h"
+#import "MDMMotionAnimatorMetrics.h"
 
-@implementation MDMRegisteredAnimation
+#import "MDMAnimationRegistrar.h"
 
-- (instancetype)initWithKey:(NSString *)key animation:(CABasicAnimation *)animation {
-  self = [super init];
-  if (self) {
-    _key = [key copy];
-    _animation = animation;
-  }
-  return self;
-}
+// The animator-level counters of MDMMotionAnimatorMetrics.
+typedef struct {
+  NSUInteger additiveAnimationCount;
+  NSUInteger nonAdditiveAnimationCount;
+  NSUInteger earlyExitCount;
+  NSUInteger avoidedTransactionCount;
+  // As measured by MDMTraceNow.
+  uint64_t mainThreadNanoseconds;
+} MDMMotionAnimatorCounters;
 
-- (NSUInteger)hash {
-  return _key.hash;
-}
+@interface MDMMotionAnimatorMetrics ()
 
-- (BOOL)isEqual:(id)object {
-  return [_key isEqual:object];
-}
+- (nonnull instancetype)initWithMetrics:(nonnull const MDMAnimationRegistrarMetrics *)metrics
+                               counters:(MDMMotionAnimatorCounters)counters;
 
 @end
-
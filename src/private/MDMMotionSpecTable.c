@@ -0,0 +1,203 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMMotionSpecTable.h"
+
+#include <math.h>
+#include <string.h>
+
+enum {
+  kSerializedVersion = 1,
+  kByteOrderMark = 0x01020304,
+};
+
+static const char kMagic[4] = {'M', 'D', 'M', 'S'};
+
+typedef struct {
+  char magic[4];
+  uint32_t byteOrderMark;
+  uint32_t version;
+  uint32_t curveCount;
+  uint32_t entryCount;
+  uint32_t reserved;
+} SerializedHeader;
+
+// The serialized format relies on these layouts, so they must not vary between compilers.
+typedef char SerializedHeaderLayoutCheck[sizeof(SerializedHeader) == 24 ? 1 : -1];
+typedef char CurveLayoutCheck[sizeof(MDMMotionSpecCurve) == 40 ? 1 : -1];
+typedef char EntryLayoutCheck[sizeof(MDMMotionSpecEntry) == 24 ? 1 : -1];
+
+#pragma mark - Private
+
+static int IsValidTime(double time) {
+  return isfinite(time) && time >= 0;
+}
+
+static int CurvesEqual(const MDMMotionSpecCurve *curve, const MDMMotionSpecCurve *other) {
+  return (curve->kind == other->kind
+          && memcmp(curve->parameters, other->parameters, sizeof(curve->parameters)) == 0);
+}
+
+static int EntriesEqual(const MDMMotionSpecEntry *entry, const MDMMotionSpecEntry *other) {
+  return (entry->curveIndex == other->curveIndex
+          && memcmp(&entry->delay, &other->delay, sizeof(entry->delay)) == 0
+          && memcmp(&entry->duration, &other->duration, sizeof(entry->duration)) == 0);
+}
+
+// FNV-1a.
+static uint64_t HashBytes(uint64_t hash, const void *bytes, size_t length) {
+  const unsigned char *data = bytes;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ data[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+#pragma mark - Public
+
+int MDMMotionSpecTableValidate(const MDMMotionSpecTable *table) {
+  if ((table->curveCount > 0 && table->curves == NULL)
+      || (table->entryCount > 0 && table->entries == NULL)) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < table->curveCount; ++i) {
+    const MDMMotionSpecCurve *curve = &table->curves[i];
+    if (curve->kind != MDMMotionSpecCurveKindCubicBezier
+        && curve->kind != MDMMotionSpecCurveKindSpring) {
+      return 0;
+    }
+    for (int p = 0; p < 4; ++p) {
+      if (!isfinite(curve->parameters[p])) {
+        return 0;
+      }
+    }
+  }
+  for (uint32_t i = 0; i < table->entryCount; ++i) {
+    const MDMMotionSpecEntry *entry = &table->entries[i];
+    if (entry->curveIndex >= table->curveCount
+        || !IsValidTime(entry->delay)
+        || !IsValidTime(entry->duration)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int MDMMotionSpecTableEqual(const MDMMotionSpecTable *table, const MDMMotionSpecTable *other) {
+  if (table->curveCount != other->curveCount || table->entryCount != other->entryCount) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < table->curveCount; ++i) {
+    if (!CurvesEqual(&table->curves[i], &other->curves[i])) {
+      return 0;
+    }
+  }
+  for (uint32_t i = 0; i < table->entryCount; ++i) {
+    if (!EntriesEqual(&table->entries[i], &other->entries[i])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+uint64_t MDMMotionSpecTableHash(const MDMMotionSpecTable *table) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hash = HashBytes(hash, &table->curveCount, sizeof(table->curveCount));
+  hash = HashBytes(hash, &table->entryCount, sizeof(table->entryCount));
+  for (uint32_t i = 0; i < table->curveCount; ++i) {
+    const MDMMotionSpecCurve *curve = &table->curves[i];
+    hash = HashBytes(hash, &curve->kind, sizeof(curve->kind));
+    hash = HashBytes(hash, curve->parameters, sizeof(curve->parameters));
+  }
+  for (uint32_t i = 0; i < table->entryCount; ++i) {
+    const MDMMotionSpecEntry *entry = &table->entries[i];
+    hash = HashBytes(hash, &entry->delay, sizeof(entry->delay));
+    hash = HashBytes(hash, &entry->duration, sizeof(entry->duration));
+    hash = HashBytes(hash, &entry->curveIndex, sizeof(entry->curveIndex));
+  }
+  return hash;
+}
+
+size_t MDMMotionSpecTableSerializedSize(const MDMMotionSpecTable *table) {
+  return (sizeof(SerializedHeader)
+          + table->curveCount * sizeof(MDMMotionSpecCurve)
+          + table->entryCount * sizeof(MDMMotionSpecEntry));
+}
+
+size_t MDMMotionSpecTableSerialize(const MDMMotionSpecTable *table, void *buffer, size_t size) {
+  size_t serializedSize = MDMMotionSpecTableSerializedSize(table);
+  if (!MDMMotionSpecTableValidate(table) || size < serializedSize) {
+    return 0;
+  }
+  SerializedHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byteOrderMark = kByteOrderMark;
+  header.version = kSerializedVersion;
+  header.curveCount = table->curveCount;
+  header.entryCount = table->entryCount;
+  header.reserved = 0;
+
+  unsigned char *cursor = buffer;
+  memcpy(cursor, &header, sizeof(header));
+  cursor += sizeof(header);
+  for (uint32_t i = 0; i < table->curveCount; ++i) {
+    MDMMotionSpecCurve curve = table->curves[i];
+    curve.reserved = 0;
+    memcpy(cursor, &curve, sizeof(curve));
+    cursor += sizeof(curve);
+  }
+  for (uint32_t i = 0; i < table->entryCount; ++i) {
+    MDMMotionSpecEntry entry = table->entries[i];
+    entry.reserved = 0;
+    memcpy(cursor, &entry, sizeof(entry));
+    cursor += sizeof(entry);
+  }
+  return serializedSize;
+}
+
+int MDMMotionSpecTableInitWithBytes(MDMMotionSpecTable *table, const void *bytes, size_t length) {
+  if (bytes == NULL || ((uintptr_t)bytes & 7) != 0 || length < sizeof(SerializedHeader)) {
+    return 0;
+  }
+  const SerializedHeader *header = bytes;
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+      || header->byteOrderMark != kByteOrderMark
+      || header->version != kSerializedVersion) {
+    return 0;
+  }
+  // Checked one count at a time so that the size computation cannot overflow.
+  size_t remaining = length - sizeof(SerializedHeader);
+  if (header->curveCount > remaining / sizeof(MDMMotionSpecCurve)) {
+    return 0;
+  }
+  remaining -= header->curveCount * sizeof(MDMMotionSpecCurve);
+  if (header->entryCount > remaining / sizeof(MDMMotionSpecEntry)) {
+    return 0;
+  }
+
+  const unsigned char *payload = (const unsigned char *)bytes + sizeof(SerializedHeader);
+  MDMMotionSpecTable candidate;
+  candidate.curves = (const MDMMotionSpecCurve *)(const void *)payload;
+  candidate.curveCount = header->curveCount;
+  candidate.entries = (const MDMMotionSpecEntry *)(const void *)(
+      payload + header->curveCount * sizeof(MDMMotionSpecCurve));
+  candidate.entryCount = header->entryCount;
+  if (!MDMMotionSpecTableValidate(&candidate)) {
+    return 0;
+  }
+  *table = candidate;
+  return 1;
+}
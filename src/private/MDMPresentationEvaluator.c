@@ -0,0 +1,172 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMPresentationEvaluator.h"
+
+// Core Animation's default duration for animations whose duration is 0.
+static const double kDefaultDuration = 0.25;
+
+#pragma mark - Private
+
+static int IsSupportedType(MDMValueType type) {
+  return type != MDMValueTypeTransform3D;
+}
+
+static int IsSupportedStack(const MDMEvaluatorStack *stack) {
+  MDMValueType type = stack->modelValue.type;
+  if (!IsSupportedType(type)) {
+    return 0;
+  }
+  for (size_t i = 0; i < stack->count; ++i) {
+    const MDMEvaluatorAnimation *animation = &stack->animations[i];
+    if (animation->fromValue.type != type || animation->toValue.type != type) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Returns 0 if the animation has no effect at `time`. Otherwise writes the animation's duration and
+// its elapsed time, clamped to the duration if the animation fills forwards.
+static int ResolveElapsed(const MDMEvaluatorAnimation *animation,
+                          double time,
+                          double *elapsed,
+                          double *duration) {
+  *duration = animation->duration > 0 ? animation->duration : kDefaultDuration;
+  *elapsed = time - animation->beginTime;
+  if (*elapsed < 0 && !(animation->fillMode & MDMFillModeBackwards)) {
+    return 0;  // Not yet started.
+  }
+  if (*elapsed >= *duration) {
+    if (!(animation->fillMode & MDMFillModeForwards)) {
+      return 0;  // Completed.
+    }
+    *elapsed = *duration;
+  }
+  return 1;
+}
+
+#pragma mark - Public
+
+double MDMTimingCurveProgress(const MDMTimingCurve *curve, double elapsed, double duration) {
+  if (curve->kind == MDMTimingCurveKindSpring) {
+    return MDMSpringSolverPosition(&curve->spring, elapsed < 0 ? 0 : elapsed);
+  }
+  double fraction = duration > 0 ? elapsed / duration : 1;
+  if (fraction <= 0) {
+    return 0;
+  }
+  if (fraction >= 1) {
+    return 1;
+  }
+  if (curve->kind == MDMTimingCurveKindLinear) {
+    return fraction;
+  }
+  return MDMCubicBezierSolve(&curve->bezier, fraction);
+}
+
+double MDMTimingCurveVelocity(const MDMTimingCurve *curve, double elapsed, double duration) {
+  if (curve->kind == MDMTimingCurveKindSpring) {
+    return elapsed < 0 ? 0 : MDMSpringSolverVelocity(&curve->spring, elapsed);
+  }
+  if (!(duration > 0) || elapsed < 0 || elapsed >= duration) {
+    return 0;
+  }
+  if (curve->kind == MDMTimingCurveKindLinear) {
+    return 1 / duration;
+  }
+  return MDMCubicBezierSlope(&curve->bezier, elapsed / duration) / duration;
+}
+
+int MDMEvaluatorEvaluate(const MDMEvaluatorStack *stack, double time, MDMValue *result) {
+  if (!IsSupportedStack(stack)) {
+    return 0;
+  }
+
+  MDMValue value = stack->modelValue;
+  for (size_t i = 0; i < stack->count; ++i) {
+    const MDMEvaluatorAnimation *animation = &stack->animations[i];
+    double elapsed;
+    double duration;
+    if (!ResolveElapsed(animation, time, &elapsed, &duration)) {
+      continue;
+    }
+
+    double progress = MDMTimingCurveProgress(&animation->timingCurve, elapsed, duration);
+    const double *from = animation->fromValue.lanes;
+    const double *to = animation->toValue.lanes;
+    if (animation->additive) {
+      for (int lane = 0; lane < MDMValueMaxLaneCount; ++lane) {
+        value.lanes[lane] += from[lane] + (to[lane] - from[lane]) * progress;
+      }
+    } else {
+      for (int lane = 0; lane < MDMValueMaxLaneCount; ++lane) {
+        value.lanes[lane] = from[lane] + (to[lane] - from[lane]) * progress;
+      }
+    }
+  }
+  *result = value;
+  return 1;
+}
+
+int MDMEvaluatorEvaluateVelocity(const MDMEvaluatorStack *stack, double time, MDMValue *result) {
+  if (!IsSupportedStack(stack)) {
+    return 0;
+  }
+
+  // The model value is constant, so only the animations contribute to the velocity.
+  MDMValue velocity;
+  MDMValueInitAdditiveIdentity(&velocity, stack->modelValue.type);
+  for (size_t i = 0; i < stack->count; ++i) {
+    const MDMEvaluatorAnimation *animation = &stack->animations[i];
+    double elapsed;
+    double duration;
+    if (!ResolveElapsed(animation, time, &elapsed, &duration)) {
+      continue;
+    }
+
+    double rate = MDMTimingCurveVelocity(&animation->timingCurve, elapsed, duration);
+    const double *from = animation->fromValue.lanes;
+    const double *to = animation->toValue.lanes;
+    if (animation->additive) {
+      for (int lane = 0; lane < MDMValueMaxLaneCount; ++lane) {
+        velocity.lanes[lane] += (to[lane] - from[lane]) * rate;
+      }
+    } else {
+      for (int lane = 0; lane < MDMValueMaxLaneCount; ++lane) {
+        velocity.lanes[lane] = (to[lane] - from[lane]) * rate;
+      }
+    }
+  }
+  *result = velocity;
+  return 1;
+}
+
+size_t MDMEvaluatorEvaluateBatch(const MDMEvaluatorStack *stacks,
+                                 size_t count,
+                                 double time,
+                                 MDMValue *results,
+                                 int *statuses) {
+  size_t evaluatedCount = 0;
+  for (size_t i = 0; i < count; ++i) {
+    int status = MDMEvaluatorEvaluate(&stacks[i], time, &results[i]);
+    if (statuses) {
+      statuses[i] = status;
+    }
+    evaluatedCount += (size_t)status;
+  }
+  return evaluatedCount;
+}
@@ -0,0 +1,109 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_PRESENTATION_EVALUATOR_H
+#define MDM_PRESENTATION_EVALUATOR_H
+
+// Computes a layer property's presentation value from the animations applied to it, without asking
+// Core Animation for the layer's presentation layer.
+//
+// Animations are applied in the order they were added, as Core Animation does: an additive
+// animation adds its current value to the value computed so far, while a non-additive animation
+// replaces it. Only vector value types (scalars, points, sizes and rects) are supported. This file
+// is free of any Apple framework dependencies so that it can be built and tested on any platform.
+
+#include <stddef.h>
+
+#include "MDMCubicBezier.h"
+#include "MDMSpringSolver.h"
+#include "MDMValueKernels.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  MDMTimingCurveKindLinear,
+  MDMTimingCurveKindCubicBezier,
+  MDMTimingCurveKindSpring,
+} MDMTimingCurveKind;
+
+typedef struct {
+  MDMTimingCurveKind kind;
+  // The solver of a cubic bezier curve.
+  MDMCubicBezier bezier;
+  // The equation of motion of a spring curve. Springs progress in terms of elapsed time rather than
+  // as a fraction of the animation's duration.
+  MDMSpringSolver spring;
+} MDMTimingCurve;
+
+typedef enum {
+  MDMFillModeRemoved = 0,
+  MDMFillModeBackwards = 1 << 0,
+  // Only applies to animations that are not removed on completion.
+  MDMFillModeForwards = 1 << 1,
+  MDMFillModeBoth = MDMFillModeBackwards | MDMFillModeForwards,
+} MDMFillMode;
+
+typedef struct {
+  MDMValue fromValue;
+  MDMValue toValue;
+  int additive;
+  // In the same timespace as the time passed to the evaluation functions.
+  double beginTime;
+  // Like Core Animation, a duration of 0 is interpreted as 0.25 seconds.
+  double duration;
+  MDMFillMode fillMode;
+  MDMTimingCurve timingCurve;
+} MDMEvaluatorAnimation;
+
+// A property's model value along with the animations applied to it, ordered from oldest to newest.
+typedef struct {
+  MDMValue modelValue;
+  const MDMEvaluatorAnimation *animations;
+  size_t count;
+} MDMEvaluatorStack;
+
+// Returns the curve's progress after `elapsed` seconds of an animation lasting `duration` seconds.
+// 0 is the animation's fromValue and 1 its toValue.
+double MDMTimingCurveProgress(const MDMTimingCurve *curve, double elapsed, double duration);
+
+// Returns the derivative of MDMTimingCurveProgress with respect to `elapsed`, in progress per
+// second. Non-spring curves are at rest outside of [0, duration).
+double MDMTimingCurveVelocity(const MDMTimingCurve *curve, double elapsed, double duration);
+
+// Writes the presentation value of the stack at `time` to `result`. Returns 0 if the stack contains
+// values of an unsupported or mismatched type, in which case `result` is left untouched.
+int MDMEvaluatorEvaluate(const MDMEvaluatorStack *stack, double time, MDMValue *result);
+
+// Writes the rate of change of the stack's presentation value at `time`, in units per second, to
+// `result`. Returns 0 under the same conditions as MDMEvaluatorEvaluate.
+int MDMEvaluatorEvaluateVelocity(const MDMEvaluatorStack *stack, double time, MDMValue *result);
+
+// Evaluates `count` stacks at the same time. `statuses` receives the return value of
+// MDMEvaluatorEvaluate for each stack and may be NULL. Returns the number of stacks that were
+// evaluated.
+size_t MDMEvaluatorEvaluateBatch(const MDMEvaluatorStack *stacks,
+                                 size_t count,
+                                 double time,
+                                 MDMValue *results,
+                                 int *statuses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_PRESENTATION_EVALUATOR_H
@@ -0,0 +1,282 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMSpringCache.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The number of slots inspected, starting at a key's home slot, when looking up or inserting it.
+#define kProbeWindow 8
+
+// The capacity of MDMSpringCacheShared.
+#define kSharedCacheCapacity 128
+
+// Values beyond this magnitude can't be quantized into an int64_t and bypass the cache.
+static const double kMaximumQuantizableValue = 1e14;
+
+typedef enum {
+  EntryKindEmpty = 0,
+  EntryKindSpring,
+  EntryKindGenerator,
+} EntryKind;
+
+typedef struct {
+  EntryKind kind;
+  int isValid;
+  int64_t key[4];
+  uint64_t lastUse;
+  MDMSpringCacheSolution solution;
+  double coefficients[4];
+} Entry;
+
+struct MDMSpringCache {
+  pthread_mutex_t lock;
+  Entry *entries;
+  size_t capacity;
+  size_t count;
+  uint64_t clock;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+};
+
+#pragma mark - Private
+
+static int QuantizeKey(const double values[4], int64_t key[4]) {
+  for (int i = 0; i < 4; ++i) {
+    if (!isfinite(values[i]) || fabs(values[i]) > kMaximumQuantizableValue) {
+      return 0;
+    }
+    key[i] = (int64_t)llround(values[i] / MDMSpringCacheQuantum);
+  }
+  return 1;
+}
+
+static uint64_t HashKey(EntryKind kind, const int64_t key[4]) {
+  // splitmix64 finalizer applied to each component.
+  uint64_t hash = (uint64_t)kind;
+  for (int i = 0; i < 4; ++i) {
+    uint64_t z = hash + (uint64_t)key[i] + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    hash = z ^ (z >> 31);
+  }
+  return hash;
+}
+
+static size_t ProbeWindow(const MDMSpringCache *cache) {
+  return cache->capacity < kProbeWindow ? cache->capacity : kProbeWindow;
+}
+
+// Must be called with the lock held.
+static Entry *FindEntry(MDMSpringCache *cache, EntryKind kind, const int64_t key[4]) {
+  size_t home = (size_t)(HashKey(kind, key) % cache->capacity);
+  size_t window = ProbeWindow(cache);
+  for (size_t i = 0; i < window; ++i) {
+    Entry *entry = &cache->entries[(home + i) % cache->capacity];
+    if (entry->kind == kind && memcmp(entry->key, key, sizeof(entry->key)) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Must be called with the lock held. Returns the slot that the key should be stored in, evicting
+// the least recently used entry in the key's probe window if necessary.
+static Entry *SlotForInsertion(MDMSpringCache *cache, EntryKind kind, const int64_t key[4]) {
+  Entry *existing = FindEntry(cache, kind, key);
+  if (existing) {
+    return existing;
+  }
+  size_t home = (size_t)(HashKey(kind, key) % cache->capacity);
+  size_t window = ProbeWindow(cache);
+  Entry *victim = NULL;
+  for (size_t i = 0; i < window; ++i) {
+    Entry *entry = &cache->entries[(home + i) % cache->capacity];
+    if (entry->kind == EntryKindEmpty) {
+      cache->count++;
+      return entry;
+    }
+    if (victim == NULL || entry->lastUse < victim->lastUse) {
+      victim = entry;
+    }
+  }
+  cache->evictions++;
+  return victim;
+}
+
+static void SolveSpring(const double coefficients[4], int *isValid,
+                        MDMSpringCacheSolution *solution) {
+  *isValid = MDMSpringSolverInit(&solution->solver, coefficients[0], coefficients[1],
+                                 coefficients[2], coefficients[3]);
+  solution->settlingDuration =
+      (*isValid ? MDMSpringSolverSettlingDuration(&solution->solver,
+                                                  MDMSpringSolverDefaultSettlingThreshold)
+                : 0);
+}
+
+static MDMSpringCache *sSharedCache = NULL;
+static pthread_once_t sSharedCacheOnce = PTHREAD_ONCE_INIT;
+
+static void InitializeSharedCache(void) {
+  sSharedCache = MDMSpringCacheCreate(kSharedCacheCapacity);
+}
+
+#pragma mark - Public
+
+MDMSpringCache *MDMSpringCacheCreate(size_t capacity) {
+  if (capacity == 0) {
+    return NULL;
+  }
+  MDMSpringCache *cache = calloc(1, sizeof(MDMSpringCache));
+  if (!cache) {
+    return NULL;
+  }
+  cache->entries = calloc(capacity, sizeof(Entry));
+  if (!cache->entries) {
+    free(cache);
+    return NULL;
+  }
+  cache->capacity = capacity;
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+void MDMSpringCacheDestroy(MDMSpringCache *cache) {
+  if (!cache) {
+    return;
+  }
+  pthread_mutex_destroy(&cache->lock);
+  free(cache->entries);
+  free(cache);
+}
+
+MDMSpringCache *MDMSpringCacheShared(void) {
+  pthread_once(&sSharedCacheOnce, InitializeSharedCache);
+  return sSharedCache;
+}
+
+int MDMSpringCacheSolve(MDMSpringCache *cache,
+                        double mass,
+                        double tension,
+                        double friction,
+                        double initialVelocity,
+                        MDMSpringCacheSolution *solution) {
+  const double coefficients[4] = {mass, tension, friction, initialVelocity};
+  int64_t key[4];
+  int isValid;
+  if (!cache || !QuantizeKey(coefficients, key)) {
+    SolveSpring(coefficients, &isValid, solution);
+    return isValid;
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  Entry *entry = FindEntry(cache, EntryKindSpring, key);
+  if (entry) {
+    entry->lastUse = ++cache->clock;
+    cache->hits++;
+    *solution = entry->solution;
+    isValid = entry->isValid;
+    pthread_mutex_unlock(&cache->lock);
+    return isValid;
+  }
+  cache->misses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  SolveSpring(coefficients, &isValid, solution);
+
+  pthread_mutex_lock(&cache->lock);
+  entry = SlotForInsertion(cache, EntryKindSpring, key);
+  entry->kind = EntryKindSpring;
+  memcpy(entry->key, key, sizeof(entry->key));
+  entry->lastUse = ++cache->clock;
+  entry->isValid = isValid;
+  entry->solution = *solution;
+  pthread_mutex_unlock(&cache->lock);
+  return isValid;
+}
+
+int MDMSpringCacheResolveGenerator(MDMSpringCache *cache,
+                                   double duration,
+                                   double dampingRatio,
+                                   double initialVelocity,
+                                   MDMSpringCacheGeneratorResolver resolver,
+                                   void *context,
+                                   double coefficients[4]) {
+  const double parameters[4] = {duration, dampingRatio, initialVelocity, 0};
+  int64_t key[4];
+  if (!cache || !QuantizeKey(parameters, key)) {
+    return resolver(context, coefficients);
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  Entry *entry = FindEntry(cache, EntryKindGenerator, key);
+  if (entry) {
+    entry->lastUse = ++cache->clock;
+    cache->hits++;
+    memcpy(coefficients, entry->coefficients, sizeof(entry->coefficients));
+    int isValid = entry->isValid;
+    pthread_mutex_unlock(&cache->lock);
+    return isValid;
+  }
+  cache->misses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  int isValid = resolver(context, coefficients);
+
+  pthread_mutex_lock(&cache->lock);
+  entry = SlotForInsertion(cache, EntryKindGenerator, key);
+  entry->kind = EntryKindGenerator;
+  memcpy(entry->key, key, sizeof(entry->key));
+  entry->lastUse = ++cache->clock;
+  entry->isValid = isValid;
+  memcpy(entry->coefficients, coefficients, sizeof(entry->coefficients));
+  pthread_mutex_unlock(&cache->lock);
+  return isValid;
+}
+
+MDMSpringCacheStatistics MDMSpringCacheGetStatistics(MDMSpringCache *cache) {
+  MDMSpringCacheStatistics statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  if (!cache) {
+    return statistics;
+  }
+  pthread_mutex_lock(&cache->lock);
+  statistics.hits = cache->hits;
+  statistics.misses = cache->misses;
+  statistics.evictions = cache->evictions;
+  statistics.count = cache->count;
+  statistics.capacity = cache->capacity;
+  pthread_mutex_unlock(&cache->lock);
+  return statistics;
+}
+
+void MDMSpringCacheRemoveAll(MDMSpringCache *cache) {
+  if (!cache) {
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  memset(cache->entries, 0, cache->capacity * sizeof(Entry));
+  cache->count = 0;
+  cache->clock = 0;
+  cache->hits = 0;
+  cache->misses = 0;
+  cache->evictions = 0;
+  pthread_mutex_unlock(&cache->lock);
+}
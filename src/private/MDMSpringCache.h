@@ -0,0 +1,105 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_SPRING_CACHE_H
+#define MDM_SPRING_CACHE_H
+
+// A bounded, thread-safe memoization cache for spring computations.
+//
+// Motion specs tend to reuse a small number of spring configurations across many animations. This
+// cache ensures that the spring math for each configuration is performed once rather than once per
+// animation. Keys are quantized so that configurations differing only by floating point noise share
+// an entry.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MDMSpringSolver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Key components are rounded to the nearest multiple of this value.
+#define MDMSpringCacheQuantum 1e-4
+
+typedef struct MDMSpringCache MDMSpringCache;
+
+// The memoized result of solving a spring.
+typedef struct {
+  MDMSpringSolver solver;
+  double settlingDuration;
+} MDMSpringCacheSolution;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t count;
+  size_t capacity;
+} MDMSpringCacheStatistics;
+
+// Resolves a spring generator's (duration, dampingRatio, initialVelocity) into spring coefficients,
+// in order: mass, tension, friction, initialVelocity. Returns 0 if the generator could not be
+// resolved.
+typedef int (*MDMSpringCacheGeneratorResolver)(void *context, double coefficients[4]);
+
+// Creates a cache holding at most `capacity` entries. Returns NULL if memory could not be allocated.
+//
+// Entries are stored in an open-addressed table and may only occupy the 8 slots following their
+// key's home slot. When all of those slots are taken, the least recently used entry among them is
+// evicted. Eviction is therefore approximately LRU: it can happen while slots elsewhere are still
+// free, and the evicted entry is not necessarily the least recently used in the whole cache.
+MDMSpringCache *MDMSpringCacheCreate(size_t capacity);
+
+void MDMSpringCacheDestroy(MDMSpringCache *cache);
+
+// The process-wide cache used by the animator.
+MDMSpringCache *MDMSpringCacheShared(void);
+
+// Looks up or computes the solution for a spring with the given coefficients. initialVelocity is
+// expected to be normalized to Core Animation's unit coordinate system.
+//
+// Returns 0 if the coefficients do not describe a valid spring.
+int MDMSpringCacheSolve(MDMSpringCache *cache,
+                        double mass,
+                        double tension,
+                        double friction,
+                        double initialVelocity,
+                        MDMSpringCacheSolution *solution);
+
+// Looks up or resolves the spring coefficients for a spring generator. On a miss, `resolver` is
+// invoked with `context` outside of the cache's lock.
+//
+// Returns 0 if the generator could not be resolved.
+int MDMSpringCacheResolveGenerator(MDMSpringCache *cache,
+                                   double duration,
+                                   double dampingRatio,
+                                   double initialVelocity,
+                                   MDMSpringCacheGeneratorResolver resolver,
+                                   void *context,
+                                   double coefficients[4]);
+
+MDMSpringCacheStatistics MDMSpringCacheGetStatistics(MDMSpringCache *cache);
+
+// Removes every entry and resets the statistics.
+void MDMSpringCacheRemoveAll(MDMSpringCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_SPRING_CACHE_H
@@ -0,0 +1,185 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMSpringSolver.h"
+
+#include <math.h>
+
+// Damping ratios this close to 1 are treated as critically damped in order to avoid dividing by a
+// vanishing damped frequency.
+static const double kCriticalDampingEpsilon = 1e-6;
+
+// Bisection stops once the bracket is narrower than this many seconds.
+static const double kSettlingResolution = 1e-6;
+
+#pragma mark - Private
+
+// Returns an upper bound of the absolute remaining displacement at time t. The envelope is
+// monotonically decreasing for every t >= the value returned by EnvelopePeak.
+static double Envelope(const MDMSpringSolver *solver, double t) {
+  switch (solver->regime) {
+    case MDMSpringSolverRegimeUnderdamped:
+      return sqrt(solver->a * solver->a + solver->b * solver->b) * exp(solver->decay * t);
+    case MDMSpringSolverRegimeCriticallyDamped:
+      return (fabs(solver->a) + fabs(solver->b) * t) * exp(solver->decay * t);
+    case MDMSpringSolverRegimeOverdamped:
+      return fabs(solver->a) * exp(solver->decay * t) + fabs(solver->b) * exp(solver->frequency * t);
+  }
+  return 0;
+}
+
+static double EnvelopePeak(const MDMSpringSolver *solver) {
+  if (solver->regime == MDMSpringSolverRegimeCriticallyDamped && solver->b != 0) {
+    // d/dt (|a| + |b|t)e^(decay t) = 0  =>  t = -1 / decay - |a| / |b|
+    double peak = -1 / solver->decay - fabs(solver->a) / fabs(solver->b);
+    return peak > 0 ? peak : 0;
+  }
+  return 0;
+}
+
+#pragma mark - Public
+
+int MDMSpringSolverInit(MDMSpringSolver *solver,
+                        double mass,
+                        double tension,
+                        double friction,
+                        double initialVelocity) {
+  // At rest: x(t) = 0.
+  solver->regime = MDMSpringSolverRegimeOverdamped;
+  solver->dampingRatio = 1;
+  solver->undampedFrequency = 0;
+  solver->decay = -1;
+  solver->frequency = -1;
+  solver->a = 0;
+  solver->b = 0;
+
+  if (!(mass > 0) || !(tension > 0) || !(friction >= 0) || !isfinite(initialVelocity)) {
+    return 0;
+  }
+
+  double omega0 = sqrt(tension / mass);
+  double zeta = friction / (2 * sqrt(tension * mass));
+  solver->undampedFrequency = omega0;
+  solver->dampingRatio = zeta;
+
+  // Initial conditions: x(0) = 1, x'(0) = -initialVelocity.
+  double x0 = 1;
+  double v0 = -initialVelocity;
+
+  if (fabs(zeta - 1) < kCriticalDampingEpsilon) {
+    solver->regime = MDMSpringSolverRegimeCriticallyDamped;
+    solver->decay = -omega0;
+    solver->frequency = 0;
+    solver->a = x0;
+    solver->b = v0 + omega0 * x0;
+
+  } else if (zeta < 1) {
+    double omegaD = omega0 * sqrt(1 - zeta * zeta);
+    solver->regime = MDMSpringSolverRegimeUnderdamped;
+    solver->decay = -zeta * omega0;
+    solver->frequency = omegaD;
+    solver->a = x0;
+    solver->b = (v0 + zeta * omega0 * x0) / omegaD;
+
+  } else {
+    double root = omega0 * sqrt(zeta * zeta - 1);
+    double r1 = -zeta * omega0 + root;  // The slower of the two decay rates.
+    double r2 = -zeta * omega0 - root;
+    solver->regime = MDMSpringSolverRegimeOverdamped;
+    solver->decay = r1;
+    solver->frequency = r2;
+    solver->b = (v0 - r1 * x0) / (r2 - r1);
+    solver->a = x0 - solver->b;
+  }
+  return 1;
+}
+
+double MDMSpringSolverPosition(const MDMSpringSolver *solver, double t) {
+  double x = 0;
+  switch (solver->regime) {
+    case MDMSpringSolverRegimeUnderdamped:
+      x = exp(solver->decay * t) * (solver->a * cos(solver->frequency * t)
+                                    + solver->b * sin(solver->frequency * t));
+      break;
+    case MDMSpringSolverRegimeCriticallyDamped:
+      x = (solver->a + solver->b * t) * exp(solver->decay * t);
+      break;
+    case MDMSpringSolverRegimeOverdamped:
+      x = solver->a * exp(solver->decay * t) + solver->b * exp(solver->frequency * t);
+      break;
+  }
+  return 1 - x;
+}
+
+double MDMSpringSolverVelocity(const MDMSpringSolver *solver, double t) {
+  double dx = 0;
+  switch (solver->regime) {
+    case MDMSpringSolverRegimeUnderdamped: {
+      double c = cos(solver->frequency * t);
+      double s = sin(solver->frequency * t);
+      dx = exp(solver->decay * t) * ((solver->b * solver->frequency + solver->decay * solver->a) * c
+                                     + (solver->decay * solver->b - solver->a * solver->frequency) * s);
+      break;
+    }
+    case MDMSpringSolverRegimeCriticallyDamped:
+      dx = exp(solver->decay * t) * (solver->b + solver->decay * (solver->a + solver->b * t));
+      break;
+    case MDMSpringSolverRegimeOverdamped:
+      dx = (solver->a * solver->decay * exp(solver->decay * t)
+            + solver->b * solver->frequency * exp(solver->frequency * t));
+      break;
+  }
+  return -dx;
+}
+
+double MDMSpringSolverSettlingDuration(const MDMSpringSolver *solver, double threshold) {
+  if (!(threshold > 0)) {
+    return INFINITY;
+  }
+  if (solver->decay >= 0) {
+    return INFINITY;  // Undamped springs oscillate forever.
+  }
+
+  if (solver->regime == MDMSpringSolverRegimeUnderdamped) {
+    double amplitude = sqrt(solver->a * solver->a + solver->b * solver->b);
+    if (amplitude <= threshold) {
+      return 0;
+    }
+    return log(amplitude / threshold) / -solver->decay;
+  }
+
+  // The remaining regimes don't have a closed-form inverse, so we bisect their envelope instead.
+  double lower = EnvelopePeak(solver);
+  if (Envelope(solver, lower) <= threshold) {
+    return lower;
+  }
+  double span = -1 / solver->decay;
+  double upper = lower + span;
+  while (Envelope(solver, upper) > threshold) {
+    lower = upper;
+    span *= 2;
+    upper += span;
+  }
+  while (upper - lower > kSettlingResolution) {
+    double mid = (lower + upper) / 2;
+    if (Envelope(solver, mid) > threshold) {
+      lower = mid;
+    } else {
+      upper = mid;
+    }
+  }
+  return upper;
+}
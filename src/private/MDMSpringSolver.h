@@ -0,0 +1,87 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_SPRING_SOLVER_H
+#define MDM_SPRING_SOLVER_H
+
+// A closed-form solver for damped harmonic oscillators.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The fraction of the total displacement within which a spring is considered to have settled.
+#define MDMSpringSolverDefaultSettlingThreshold 0.001
+
+typedef enum {
+  MDMSpringSolverRegimeUnderdamped,
+  MDMSpringSolverRegimeCriticallyDamped,
+  MDMSpringSolverRegimeOverdamped,
+} MDMSpringSolverRegime;
+
+// The precomputed constants of a spring's equation of motion.
+//
+// The solver models the spring's remaining displacement, x(t), starting at x(0) = 1 and settling
+// at 0. Progress, as exposed by the accessors below, is 1 - x(t) and matches Core Animation's
+// notion of a spring moving from its fromValue (0) to its toValue (1).
+typedef struct {
+  MDMSpringSolverRegime regime;
+  double dampingRatio;
+  double undampedFrequency;
+  // Underdamped: x(t) = e^(decay * t) * (a * cos(frequency * t) + b * sin(frequency * t))
+  // Critically damped: x(t) = (a + b * t) * e^(decay * t)
+  // Overdamped: x(t) = a * e^(decay * t) + b * e^(frequency * t)
+  double decay;
+  double frequency;
+  double a;
+  double b;
+} MDMSpringSolver;
+
+// Computes the equation of motion for a spring with the given coefficients.
+//
+// initialVelocity is expressed in Core Animation's unit coordinate system, where 1 means traveling
+// the total animation distance in one second and positive values move towards the destination.
+//
+// Returns 0 if the coefficients do not describe a valid spring (non-positive mass or tension,
+// negative friction). The solver is left in an at-rest state in that case.
+int MDMSpringSolverInit(MDMSpringSolver *solver,
+                        double mass,
+                        double tension,
+                        double friction,
+                        double initialVelocity);
+
+// Returns the spring's progress towards its destination at time t, where 0 is the starting value
+// and 1 is the destination.
+double MDMSpringSolverPosition(const MDMSpringSolver *solver, double t);
+
+// Returns the first derivative of MDMSpringSolverPosition at time t, in units of total
+// displacement per second.
+double MDMSpringSolverVelocity(const MDMSpringSolver *solver, double t);
+
+// Returns the time after which the spring's remaining displacement stays within `threshold` of the
+// destination, as a fraction of the total displacement.
+//
+// Returns INFINITY for springs that never settle (e.g. zero friction).
+double MDMSpringSolverSettlingDuration(const MDMSpringSolver *solver, double threshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_SPRING_SOLVER_H
@@ -14,19 +14,15 @@
  limitations under the License.
  */
 
-#import <Foundation/Foundation.h>
-#import <QuartzCore/QuartzCore.h>
+#import "MDMStagger.h"
 
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
 
-@interface MDMRegisteredAnimation : NSObject
+@interface MDMStagger ()
 
-- (instancetype)initWithKey:(NSString *)key animation:(CABasicAnimation *)animation;
-
-@property(nonatomic, copy, readonly) NSString *key;
-
-@property(nonatomic, strong, readonly) CABasicAnimation *animation;
+// Writes the delay of each of the `count` layers of a group to `delays`, in index order.
+- (void)getDelays:(nonnull double *)delays count:(NSUInteger)count;
 
 @end
 
@@ -0,0 +1,69 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMStaggerTiming.h"
+
+#include <string.h>
+
+#pragma mark - Public
+
+void MDMStaggerTimingInitLinear(MDMStaggerTiming *timing, double interval) {
+  memset(timing, 0, sizeof(*timing));
+  timing->kind = MDMStaggerTimingKindLinear;
+  timing->interval = interval;
+}
+
+void MDMStaggerTimingInitEased(MDMStaggerTiming *timing,
+                               double duration,
+                               double x1,
+                               double y1,
+                               double x2,
+                               double y2) {
+  memset(timing, 0, sizeof(*timing));
+  timing->kind = MDMStaggerTimingKindEased;
+  timing->interval = duration;
+  MDMCubicBezierInit(&timing->curve, x1, y1, x2, y2);
+}
+
+void MDMStaggerTimingComputeDelays(const MDMStaggerTiming *timing, size_t count, double *delays) {
+  if (count == 0) {
+    return;
+  }
+  switch (timing->kind) {
+    case MDMStaggerTimingKindLinear:
+      for (size_t i = 0; i < count; ++i) {
+        delays[i] = (double)i * timing->interval;
+      }
+      return;
+
+    case MDMStaggerTimingKindEased: {
+      if (count == 1) {
+        delays[0] = 0;
+        return;
+      }
+      // The elements' fractions of the group are solved for their progress in place.
+      double last = (double)(count - 1);
+      for (size_t i = 0; i < count; ++i) {
+        delays[i] = (double)i / last;
+      }
+      MDMCubicBezierSolveBatch(&timing->curve, delays, delays, count);
+      for (size_t i = 0; i < count; ++i) {
+        delays[i] *= timing->interval;
+      }
+      return;
+    }
+  }
+}
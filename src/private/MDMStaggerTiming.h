@@ -0,0 +1,72 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_STAGGER_TIMING_H
+#define MDM_STAGGER_TIMING_H
+
+// Computes the delays of a staggered group of animations, in which each element of the group begins
+// some time after the element before it.
+//
+// Linear staggers separate consecutive elements by a constant interval. Eased staggers distribute
+// the elements' delays along a cubic bezier timing curve, so that e.g. the first elements of a list
+// follow each other closely and the last ones trail off. Every delay of a group is computed in a
+// single pass.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#include <stddef.h>
+
+#include "MDMCubicBezier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  MDMStaggerTimingKindLinear,
+  MDMStaggerTimingKindEased,
+} MDMStaggerTimingKind;
+
+typedef struct {
+  MDMStaggerTimingKind kind;
+  // For linear staggers, the delay between consecutive elements. For eased staggers, the delay of
+  // the last element.
+  double interval;
+  // The curve along which eased staggers distribute their delays.
+  MDMCubicBezier curve;
+} MDMStaggerTiming;
+
+// Initializes a stagger that delays the element at index i by i * interval.
+void MDMStaggerTimingInitLinear(MDMStaggerTiming *timing, double interval);
+
+// Initializes a stagger that delays the element at index i of n by duration * y(i / (n - 1)), where
+// y is the timing curve with the given control points.
+void MDMStaggerTimingInitEased(MDMStaggerTiming *timing,
+                               double duration,
+                               double x1,
+                               double y1,
+                               double x2,
+                               double y2);
+
+// Writes the delay of each of `count` elements to `delays`, in index order.
+void MDMStaggerTimingComputeDelays(const MDMStaggerTiming *timing, size_t count, double *delays);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_STAGGER_TIMING_H
@@ -0,0 +1,240 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMTraceBuffer.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "MDMKeyPathClassifier.h"
+
+// Large enough for any single exported event.
+#define kEventJSONBufferSize 256
+
+struct MDMTraceBuffer {
+  MDMTraceEvent *events;
+  size_t capacity;
+  // The total number of events recorded since creation or the last MDMTraceBufferRemoveAll.
+  uint64_t recordedCount;
+};
+
+MDMTraceBuffer *MDMTraceActiveBuffer = NULL;
+
+#pragma mark - Private
+
+static const char *EventName(uint32_t kind) {
+  switch (kind) {
+    case MDMTraceEventKindAnimationFromTraits:
+      return "AnimationFromTraits";
+    case MDMTraceEventKindConfigureAnimation:
+      return "ConfigureAnimation";
+    case MDMTraceEventKindRegisterAnimation:
+      return "RegisterAnimation";
+    case MDMTraceEventKindCaptureImplicitActions:
+      return "CaptureImplicitActions";
+    case MDMTraceEventKindImplicitAction:
+      return "ImplicitAction";
+    case MDMTraceEventKindCompletion:
+      return "Completion";
+    case MDMTraceEventKindCompactAdditiveAnimations:
+      return "CompactAdditiveAnimations";
+  }
+  return "Unknown";
+}
+
+static int IsInstant(uint32_t kind) {
+  return kind == MDMTraceEventKindImplicitAction || kind == MDMTraceEventKindCompletion;
+}
+
+// Writes the event's arguments, without the enclosing braces.
+static void FormatArguments(const MDMTraceEvent *event, char *buffer, size_t size) {
+  int length = 0;
+  if (event->object != 0) {
+    length = snprintf(buffer, size, "\"layer\":\"0x%" PRIx64 "\",", event->object);
+    if (length < 0 || (size_t)length >= size) {
+      length = 0;
+    }
+  }
+  buffer += length;
+  size -= (size_t)length;
+
+  switch (event->kind) {
+    case MDMTraceEventKindAnimationFromTraits:
+    case MDMTraceEventKindConfigureAnimation:
+    case MDMTraceEventKindRegisterAnimation:
+    case MDMTraceEventKindImplicitAction: {
+      const char *keyPath = NULL;
+      if (event->detail < MDMAnimatableKeyPathKindCount) {
+        keyPath = MDMAnimatableKeyPathKindGetKeyPath((MDMAnimatableKeyPathKind)event->detail);
+      }
+      snprintf(buffer, size, "\"keyPath\":\"%s\"", keyPath != NULL ? keyPath : "");
+      return;
+    }
+    case MDMTraceEventKindCaptureImplicitActions:
+      snprintf(buffer, size, "\"actionCount\":%" PRIu32, event->detail);
+      return;
+    case MDMTraceEventKindCompletion:
+      snprintf(buffer, size, "\"finished\":%s", event->detail ? "true" : "false");
+      return;
+    case MDMTraceEventKindCompactAdditiveAnimations:
+      snprintf(buffer, size, "\"foldedCount\":%" PRIu32, event->detail);
+      return;
+  }
+  snprintf(buffer, size, "\"detail\":%" PRIu32, event->detail);
+}
+
+static void WriteEvent(const MDMTraceEvent *event,
+                       int isFirst,
+                       MDMTraceWriter writer,
+                       void *context) {
+  char arguments[96];
+  FormatArguments(event, arguments, sizeof(arguments));
+
+  // Timestamps are exported in microseconds with nanosecond precision.
+  char timing[64];
+  if (IsInstant(event->kind)) {
+    snprintf(timing, sizeof(timing), "\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64 ".%03" PRIu64,
+             event->start / 1000, event->start % 1000);
+  } else {
+    snprintf(timing, sizeof(timing),
+             "\"ph\":\"X\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64,
+             event->start / 1000, event->start % 1000,
+             event->duration / 1000, event->duration % 1000);
+  }
+
+  char buffer[kEventJSONBufferSize];
+  int length = snprintf(buffer, sizeof(buffer),
+                        "%s\n{\"name\":\"%s\",\"cat\":\"MotionAnimator\",\"pid\":1,\"tid\":1,%s,"
+                        "\"args\":{%s}}",
+                        isFirst ? "" : ",", EventName(event->kind), timing, arguments);
+  if (length > 0 && (size_t)length < sizeof(buffer)) {
+    writer(context, buffer, (size_t)length);
+  }
+}
+
+// The index of the oldest event held by the buffer.
+static size_t OldestIndex(const MDMTraceBuffer *buffer) {
+  if (buffer->recordedCount < buffer->capacity) {
+    return 0;
+  }
+  return (size_t)(buffer->recordedCount % buffer->capacity);
+}
+
+static void WriteString(MDMTraceWriter writer, void *context, const char *string) {
+  writer(context, string, strlen(string));
+}
+
+#pragma mark - Public
+
+MDMTraceBuffer *MDMTraceBufferCreate(size_t capacity) {
+  if (capacity == 0) {
+    return NULL;
+  }
+  MDMTraceBuffer *buffer = calloc(1, sizeof(MDMTraceBuffer));
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer->events = malloc(capacity * sizeof(MDMTraceEvent));
+  if (buffer->events == NULL) {
+    free(buffer);
+    return NULL;
+  }
+  buffer->capacity = capacity;
+  return buffer;
+}
+
+void MDMTraceBufferDestroy(MDMTraceBuffer *buffer) {
+  if (buffer == NULL) {
+    return;
+  }
+  if (MDMTraceActiveBuffer == buffer) {
+    MDMTraceActiveBuffer = NULL;
+  }
+  free(buffer->events);
+  free(buffer);
+}
+
+void MDMTraceBufferSetActive(MDMTraceBuffer *buffer) {
+  MDMTraceActiveBuffer = buffer;
+}
+
+size_t MDMTraceBufferCapacity(const MDMTraceBuffer *buffer) {
+  return buffer->capacity;
+}
+
+size_t MDMTraceBufferCount(const MDMTraceBuffer *buffer) {
+  return buffer->recordedCount < buffer->capacity ? (size_t)buffer->recordedCount
+                                                  : buffer->capacity;
+}
+
+uint64_t MDMTraceBufferDroppedCount(const MDMTraceBuffer *buffer) {
+  return buffer->recordedCount - MDMTraceBufferCount(buffer);
+}
+
+void MDMTraceBufferRecord(MDMTraceBuffer *buffer, const MDMTraceEvent *event) {
+  buffer->events[buffer->recordedCount % buffer->capacity] = *event;
+  buffer->recordedCount++;
+}
+
+size_t MDMTraceBufferCopyEvents(const MDMTraceBuffer *buffer,
+                                MDMTraceEvent *events,
+                                size_t capacity) {
+  size_t count = MDMTraceBufferCount(buffer);
+  if (capacity < count) {
+    count = capacity;
+  }
+  size_t oldest = OldestIndex(buffer);
+  for (size_t i = 0; i < count; ++i) {
+    events[i] = buffer->events[(oldest + i) % buffer->capacity];
+  }
+  return count;
+}
+
+void MDMTraceBufferRemoveAll(MDMTraceBuffer *buffer) {
+  buffer->recordedCount = 0;
+}
+
+void MDMTraceBufferWriteChromeJSON(const MDMTraceBuffer *buffer,
+                                   MDMTraceWriter writer,
+                                   void *context) {
+  char header[128];
+  int length = snprintf(header, sizeof(header),
+                        "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":%" PRIu64
+                        "},\"traceEvents\":[",
+                        MDMTraceBufferDroppedCount(buffer));
+  if (length > 0 && (size_t)length < sizeof(header)) {
+    writer(context, header, (size_t)length);
+  }
+  size_t count = MDMTraceBufferCount(buffer);
+  size_t oldest = OldestIndex(buffer);
+  for (size_t i = 0; i < count; ++i) {
+    WriteEvent(&buffer->events[(oldest + i) % buffer->capacity], i == 0, writer, context);
+  }
+  WriteString(writer, context, "\n]}\n");
+}
+
+uint64_t MDMTraceNow(void) {
+#if defined(__APPLE__)
+  return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
@@ -0,0 +1,143 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_TRACE_BUFFER_H
+#define MDM_TRACE_BUFFER_H
+
+// A ring buffer of fixed-size trace events that can be exported in Chrome's trace event format.
+//
+// Events are recorded into the active buffer, if any. The recording functions below are inline and
+// reduce to a single load and branch while no buffer is active, so that they can remain in
+// production builds. Once the buffer is full, the oldest events are overwritten.
+//
+// Trace buffers are not thread safe. The animator records events from the main thread.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  // Converting MDMAnimationTraits into a Core Animation animation. The detail is the key path kind.
+  MDMTraceEventKindAnimationFromTraits = 1,
+  // MDMConfigureAnimation. The detail is the key path kind.
+  MDMTraceEventKindConfigureAnimation,
+  // Adding an animation to a layer and to the registrar. The detail is the key path kind.
+  MDMTraceEventKindRegisterAnimation,
+  // Running an implicit animation block. The detail is the number of captured actions.
+  MDMTraceEventKindCaptureImplicitActions,
+  // An instant at which a layer's action was captured. The detail is the key path kind.
+  MDMTraceEventKindImplicitAction,
+  // An instant at which a completion block was invoked. The detail is 1 if the animations finished.
+  MDMTraceEventKindCompletion,
+  // Folding a stack of additive animations. The detail is the number of animations folded.
+  MDMTraceEventKindCompactAdditiveAnimations,
+} MDMTraceEventKind;
+
+typedef struct {
+  // Monotonic timestamp in nanoseconds; see MDMTraceNow.
+  uint64_t start;
+  // In nanoseconds. Zero for instants.
+  uint64_t duration;
+  // The address of the layer the event pertains to, or 0.
+  uint64_t object;
+  uint32_t kind;
+  uint32_t detail;
+} MDMTraceEvent;
+
+typedef struct MDMTraceBuffer MDMTraceBuffer;
+
+// Receives exported bytes.
+typedef void (*MDMTraceWriter)(void *context, const char *bytes, size_t length);
+
+// The buffer events are recorded into, or NULL. Use MDMTraceBufferSetActive to change it.
+extern MDMTraceBuffer *MDMTraceActiveBuffer;
+
+// Creates an empty buffer holding up to `capacity` events. Returns NULL if `capacity` is zero or
+// memory could not be allocated.
+MDMTraceBuffer *MDMTraceBufferCreate(size_t capacity);
+
+// Frees the buffer, deactivating it first if needed.
+void MDMTraceBufferDestroy(MDMTraceBuffer *buffer);
+
+// Makes `buffer` the buffer events are recorded into. Pass NULL to stop recording.
+void MDMTraceBufferSetActive(MDMTraceBuffer *buffer);
+
+size_t MDMTraceBufferCapacity(const MDMTraceBuffer *buffer);
+
+// The number of events currently held by the buffer.
+size_t MDMTraceBufferCount(const MDMTraceBuffer *buffer);
+
+// The number of events that have been overwritten because the buffer was full.
+uint64_t MDMTraceBufferDroppedCount(const MDMTraceBuffer *buffer);
+
+// Appends an event to the buffer, overwriting the oldest event if the buffer is full.
+void MDMTraceBufferRecord(MDMTraceBuffer *buffer, const MDMTraceEvent *event);
+
+// Copies up to `capacity` of the buffer's events into `events`, oldest first, and returns the
+// number of events copied.
+size_t MDMTraceBufferCopyEvents(const MDMTraceBuffer *buffer,
+                                MDMTraceEvent *events,
+                                size_t capacity);
+
+// Removes every event and resets the dropped event count.
+void MDMTraceBufferRemoveAll(MDMTraceBuffer *buffer);
+
+// Writes the buffer's events as a Chrome trace event JSON object, suitable for chrome://tracing and
+// Perfetto. Timestamps are exported in microseconds.
+void MDMTraceBufferWriteChromeJSON(const MDMTraceBuffer *buffer,
+                                   MDMTraceWriter writer,
+                                   void *context);
+
+// Returns a monotonic timestamp in nanoseconds. On Apple platforms this shares its timebase with
+// mach_absolute_time and CACurrentMediaTime.
+uint64_t MDMTraceNow(void);
+
+// Returns the start time of an interval event, or 0 if no buffer is active.
+static inline uint64_t MDMTraceBegin(void) {
+  return MDMTraceActiveBuffer != NULL ? MDMTraceNow() : 0;
+}
+
+// Records an interval event that started at `start`, as returned by MDMTraceBegin.
+static inline void MDMTraceEnd(MDMTraceEventKind kind,
+                               uint64_t start,
+                               const void *object,
+                               uint32_t detail) {
+  if (start != 0 && MDMTraceActiveBuffer != NULL) {
+    MDMTraceEvent event = {start, MDMTraceNow() - start, (uint64_t)(uintptr_t)object,
+                           (uint32_t)kind, detail};
+    MDMTraceBufferRecord(MDMTraceActiveBuffer, &event);
+  }
+}
+
+// Records an instant event.
+static inline void MDMTraceInstant(MDMTraceEventKind kind, const void *object, uint32_t detail) {
+  if (MDMTraceActiveBuffer != NULL) {
+    MDMTraceEvent event = {MDMTraceNow(), 0, (uint64_t)(uintptr_t)object, (uint32_t)kind, detail};
+    MDMTraceBufferRecord(MDMTraceActiveBuffer, &event);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_TRACE_BUFFER_H
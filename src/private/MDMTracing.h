@@ -0,0 +1,38 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "MDMKeyPathKind.h"
+#import "MDMTraceBuffer.h"
+
+// Objective-C conveniences for recording trace events that identify a key path. The key path is
+// only classified while a trace buffer is active.
+
+static inline void MDMTraceEndForKeyPath(MDMTraceEventKind kind,
+                                         uint64_t start,
+                                         id layer,
+                                         NSString *keyPath) {
+  if (start != 0) {
+    MDMTraceEnd(kind, start, (__bridge void *)layer, (uint32_t)MDMKindOfKeyPath(keyPath));
+  }
+}
+
+static inline void MDMTraceInstantForKeyPath(MDMTraceEventKind kind, id layer, NSString *keyPath) {
+  if (MDMTraceActiveBuffer != NULL) {
+    MDMTraceInstant(kind, (__bridge void *)layer, (uint32_t)MDMKindOfKeyPath(keyPath));
+  }
+}
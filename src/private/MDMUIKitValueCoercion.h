@@ -16,9 +16,15 @@
 
 #import <Foundation/Foundation.h>
 
+#import "MDMValueClass.h"
+
 API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
                      ios(12, API_TO_BE_DEPRECATED))
 
+// Classifies a value that may be animated. Returns MDMValueClassUnknown for nil and for values of
+// any other type.
+FOUNDATION_EXPORT MDMValueClass MDMClassifyValue(id value);
+
 // Coerces the following UIKit/CoreGraphics values to Core Animation values:
 //
 // - UIBezierPath -> CGPath
@@ -26,6 +32,9 @@ API_DEPRECATED_BEGIN("Use standard UIKit/CALayer animation APIs instead.",
 // - CGAffineTransform -> CATransform3D
 //
 // @param values All values of this array must be the same type.
-FOUNDATION_EXPORT NSArray* MDMCoerceUIKitValuesToCoreAnimationValues(NSArray *values);
+// @param valueClass On input, the class of the values, or MDMValueClassUnknown if they have yet to
+//                   be classified. On output, the class of the returned values.
+FOUNDATION_EXPORT
+NSArray* MDMCoerceUIKitValuesToCoreAnimationValues(NSArray *values, MDMValueClass *valueClass);
 
 API_DEPRECATED_END
@@ -18,37 +18,67 @@
 
 #import <UIKit/UIKit.h>
 
-static BOOL IsCGAffineTransformType(id someValue) {
-  if ([someValue isKindOfClass:[NSValue class]]) {
-    NSValue *asValue = (NSValue *)someValue;
-    const char *objCType = @encode(CGAffineTransform);
-    return strncmp(asValue.objCType, objCType, strlen(objCType)) == 0;
+MDMValueClass MDMClassifyValue(id value) {
+  // NSNumber is a subclass of NSValue, so it must be checked for first.
+  if ([value isKindOfClass:[NSNumber class]]) {
+    return MDMValueClassNumber;
   }
-  return NO;
+  if ([value isKindOfClass:[NSValue class]]) {
+    return MDMValueClassOfObjCType([(NSValue *)value objCType]);
+  }
+  if ([value isKindOfClass:[UIColor class]]) {
+    return MDMValueClassColor;
+  }
+  if ([value isKindOfClass:[UIBezierPath class]]) {
+    return MDMValueClassBezierPath;
+  }
+  if (value == nil) {
+    return MDMValueClassUnknown;
+  }
+  CFTypeID typeID = CFGetTypeID((__bridge CFTypeRef)value);
+  if (typeID == CGColorGetTypeID()) {
+    return MDMValueClassCGColor;
+  }
+  if (typeID == CGPathGetTypeID()) {
+    return MDMValueClassCGPath;
+  }
+  return MDMValueClassUnknown;
 }
 
-NSArray* MDMCoerceUIKitValuesToCoreAnimationValues(NSArray *values) {
-  if ([[values firstObject] isKindOfClass:[UIColor class]]) {
-    NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
-    for (UIColor *color in values) {
-      [convertedArray addObject:(id)color.CGColor];
+NSArray* MDMCoerceUIKitValuesToCoreAnimationValues(NSArray *values, MDMValueClass *valueClass) {
+  if (*valueClass == MDMValueClassUnknown) {
+    *valueClass = MDMClassifyValue([values firstObject]);
+  }
+  switch (*valueClass) {
+    case MDMValueClassColor: {
+      NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
+      for (UIColor *color in values) {
+        [convertedArray addObject:(id)color.CGColor];
+      }
+      values = convertedArray;
+      break;
     }
-    values = convertedArray;
-
-  } else if ([[values firstObject] isKindOfClass:[UIBezierPath class]]) {
-    NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
-    for (UIBezierPath *bezierPath in values) {
-      [convertedArray addObject:(id)bezierPath.CGPath];
+    case MDMValueClassBezierPath: {
+      NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
+      for (UIBezierPath *bezierPath in values) {
+        [convertedArray addObject:(id)bezierPath.CGPath];
+      }
+      values = convertedArray;
+      break;
     }
-    values = convertedArray;
-
-  } else if (IsCGAffineTransformType([values firstObject])) {
-    NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
-    for (NSValue *value in values) {
-      CATransform3D asTransform3D = CATransform3DMakeAffineTransform(value.CGAffineTransformValue);
-      [convertedArray addObject:[NSValue valueWithCATransform3D:asTransform3D]];
+    case MDMValueClassAffineTransform: {
+      NSMutableArray *convertedArray = [NSMutableArray arrayWithCapacity:values.count];
+      for (NSValue *value in values) {
+        CATransform3D asTransform3D =
+            CATransform3DMakeAffineTransform(value.CGAffineTransformValue);
+        [convertedArray addObject:[NSValue valueWithCATransform3D:asTransform3D]];
+      }
+      values = convertedArray;
+      break;
     }
-    values = convertedArray;
+    default:
+      return values;
   }
+  *valueClass = MDMValueClassCoerced(*valueClass);
   return values;
 }
@@ -0,0 +1,102 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMValueClass.h"
+
+#include <string.h>
+
+#pragma mark - Private
+
+typedef struct {
+  MDMValueClass valueClass;
+  // The encodings with CGFloat as a double and as a float.
+  const char *doubleEncoding;
+  const char *floatEncoding;
+  size_t length;
+} StructEncoding;
+
+#define STRUCT_ENCODING(valueClass, doubleEncoding, floatEncoding) \
+  {valueClass, doubleEncoding, floatEncoding, sizeof(doubleEncoding) - 1}
+
+static const StructEncoding kPointEncoding =
+    STRUCT_ENCODING(MDMValueClassPoint, "{CGPoint=dd}", "{CGPoint=ff}");
+static const StructEncoding kSizeEncoding =
+    STRUCT_ENCODING(MDMValueClassSize, "{CGSize=dd}", "{CGSize=ff}");
+static const StructEncoding kRectEncoding =
+    STRUCT_ENCODING(MDMValueClassRect,
+                    "{CGRect={CGPoint=dd}{CGSize=dd}}", "{CGRect={CGPoint=ff}{CGSize=ff}}");
+static const StructEncoding kTransform3DEncoding =
+    STRUCT_ENCODING(MDMValueClassTransform3D,
+                    "{CATransform3D=dddddddddddddddd}", "{CATransform3D=ffffffffffffffff}");
+static const StructEncoding kAffineTransformEncoding =
+    STRUCT_ENCODING(MDMValueClassAffineTransform,
+                    "{CGAffineTransform=dddddd}", "{CGAffineTransform=ffffff}");
+
+static MDMValueClass MatchStructEncoding(const char *objCType, const StructEncoding *encoding) {
+  if (strncmp(objCType, encoding->doubleEncoding, encoding->length) == 0
+      || strncmp(objCType, encoding->floatEncoding, encoding->length) == 0) {
+    return encoding->valueClass;
+  }
+  return MDMValueClassUnknown;
+}
+
+#pragma mark - Public
+
+MDMValueClass MDMValueClassOfObjCType(const char *objCType) {
+  // Every struct class's name begins with "CG" or "CA", so the fourth character of the encoding
+  // identifies the only candidate that the encoding needs to be compared against.
+  if (objCType == NULL || objCType[0] != '{' || objCType[1] != 'C' || objCType[2] == '\0') {
+    return MDMValueClassUnknown;
+  }
+  switch (objCType[3]) {
+    case 'P':
+      return MatchStructEncoding(objCType, &kPointEncoding);
+    case 'S':
+      return MatchStructEncoding(objCType, &kSizeEncoding);
+    case 'R':
+      return MatchStructEncoding(objCType, &kRectEncoding);
+    case 'T':
+      return MatchStructEncoding(objCType, &kTransform3DEncoding);
+    case 'A':
+      return MatchStructEncoding(objCType, &kAffineTransformEncoding);
+  }
+  return MDMValueClassUnknown;
+}
+
+MDMValueClass MDMValueClassCoerced(MDMValueClass valueClass) {
+  switch (valueClass) {
+    case MDMValueClassColor:
+      return MDMValueClassCGColor;
+    case MDMValueClassBezierPath:
+      return MDMValueClassCGPath;
+    case MDMValueClassAffineTransform:
+      return MDMValueClassTransform3D;
+    default:
+      return valueClass;
+  }
+}
+
+int MDMValueClassIsAdditive(MDMValueClass valueClass) {
+  switch (valueClass) {
+    case MDMValueClassNumber:
+    case MDMValueClassPoint:
+    case MDMValueClassSize:
+    case MDMValueClassTransform3D:
+      return 1;
+    default:
+      return 0;
+  }
+}
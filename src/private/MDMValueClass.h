@@ -0,0 +1,67 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_VALUE_CLASS_H
+#define MDM_VALUE_CLASS_H
+
+// Classifies the values that MDMMotionAnimator animates into a small enum so that coercion,
+// additivity checks and displacement math can branch on a value's type without probing it again.
+//
+// Struct values are classified from their Objective-C type encoding by dispatching on the struct's
+// name and then comparing the encoding against that struct's encoding alone.
+//
+// This file is intentionally free of any Apple framework dependencies so that it can be built and
+// tested on any platform.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  MDMValueClassUnknown = 0,
+  MDMValueClassNumber,
+  MDMValueClassPoint,
+  MDMValueClassSize,
+  MDMValueClassRect,
+  MDMValueClassTransform3D,
+  MDMValueClassAffineTransform,
+  // UIColor and UIBezierPath, which Core Animation can't animate until they are coerced.
+  MDMValueClassColor,
+  MDMValueClassBezierPath,
+  // CGColorRef and CGPathRef.
+  MDMValueClassCGColor,
+  MDMValueClassCGPath,
+} MDMValueClass;
+
+// Classifies an Objective-C type encoding, as returned by -[NSValue objCType], as one of the struct
+// classes: CGPoint, CGSize, CGRect, CATransform3D or CGAffineTransform. CGFloat fields may be
+// encoded as either double or float. Encodings are matched by prefix. Returns MDMValueClassUnknown
+// for any other encoding, including those of numbers.
+MDMValueClass MDMValueClassOfObjCType(const char *objCType);
+
+// Returns the class that values of the given class are coerced to before they are handed to Core
+// Animation, e.g. MDMValueClassCGColor for MDMValueClassColor.
+MDMValueClass MDMValueClassCoerced(MDMValueClass valueClass);
+
+// Returns nonzero if values of the class can be animated additively: numbers, points, sizes and
+// transforms.
+int MDMValueClassIsAdditive(MDMValueClass valueClass);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_VALUE_CLASS_H
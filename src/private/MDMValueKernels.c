@@ -0,0 +1,256 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMValueKernels.h"
+
+#include <math.h>
+#include <string.h>
+
+// Displacements with a smaller magnitude can't be meaningfully normalized against.
+static const double kMinimumNormalizableDisplacement = 0.00001;
+
+static const double kIdentity[16] = {
+  1, 0, 0, 0,
+  0, 1, 0, 0,
+  0, 0, 1, 0,
+  0, 0, 0, 1,
+};
+
+#pragma mark - Private
+
+static int IsAffine(const double m[16]) {
+  return m[3] == 0 && m[7] == 0 && m[11] == 0 && m[15] == 1;
+}
+
+// Inverts a matrix of the form [A 0; t 1] as [A^-1 0; -t A^-1 1].
+static int InvertAffine(const double m[16], double result[16]) {
+  double c00 = m[5] * m[10] - m[6] * m[9];
+  double c01 = m[6] * m[8] - m[4] * m[10];
+  double c02 = m[4] * m[9] - m[5] * m[8];
+  double determinant = m[0] * c00 + m[1] * c01 + m[2] * c02;
+  if (determinant == 0 || !isfinite(determinant)) {
+    return 0;
+  }
+  double scale = 1 / determinant;
+
+  double inverse[16];
+  inverse[0] = c00 * scale;
+  inverse[1] = (m[2] * m[9] - m[1] * m[10]) * scale;
+  inverse[2] = (m[1] * m[6] - m[2] * m[5]) * scale;
+  inverse[3] = 0;
+  inverse[4] = c01 * scale;
+  inverse[5] = (m[0] * m[10] - m[2] * m[8]) * scale;
+  inverse[6] = (m[2] * m[4] - m[0] * m[6]) * scale;
+  inverse[7] = 0;
+  inverse[8] = c02 * scale;
+  inverse[9] = (m[1] * m[8] - m[0] * m[9]) * scale;
+  inverse[10] = (m[0] * m[5] - m[1] * m[4]) * scale;
+  inverse[11] = 0;
+  for (int column = 0; column < 3; ++column) {
+    inverse[12 + column] = -(m[12] * inverse[column]
+                             + m[13] * inverse[4 + column]
+                             + m[14] * inverse[8 + column]);
+  }
+  inverse[15] = 1;
+  memcpy(result, inverse, sizeof(inverse));
+  return 1;
+}
+
+// Inverts an arbitrary matrix through its adjugate.
+static int InvertGeneral(const double m[16], double result[16]) {
+  double inverse[16];
+  inverse[0] = (m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15]
+                + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10]);
+  inverse[4] = (-m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15]
+                - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10]);
+  inverse[8] = (m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15]
+                + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9]);
+  inverse[12] = (-m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14]
+                 - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9]);
+  inverse[1] = (-m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15]
+                - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10]);
+  inverse[5] = (m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15]
+                + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10]);
+  inverse[9] = (-m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15]
+                - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9]);
+  inverse[13] = (m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14]
+                 + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9]);
+  inverse[2] = (m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15]
+                + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6]);
+  inverse[6] = (-m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15]
+                - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6]);
+  inverse[10] = (m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15]
+                 + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5]);
+  inverse[14] = (-m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14]
+                 - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5]);
+  inverse[3] = (-m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11]
+                - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6]);
+  inverse[7] = (m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11]
+                + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6]);
+  inverse[11] = (-m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11]
+                 - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5]);
+  inverse[15] = (m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10]
+                 + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5]);
+
+  double determinant = m[0] * inverse[0] + m[1] * inverse[4] + m[2] * inverse[8]
+                       + m[3] * inverse[12];
+  if (determinant == 0 || !isfinite(determinant)) {
+    return 0;
+  }
+  double scale = 1 / determinant;
+  for (int i = 0; i < 16; ++i) {
+    result[i] = inverse[i] * scale;
+  }
+  return 1;
+}
+
+// Returns the index of the lane that MDMValueDominantComponent returns, or -1 for transforms.
+static int DominantLane(const MDMValue *value) {
+  const double *lanes = value->lanes;
+  switch (value->type) {
+    case MDMValueTypeScalar:
+      return 0;
+    case MDMValueTypePoint:
+    case MDMValueTypeSize:
+      return fabs(lanes[0]) > fabs(lanes[1]) ? 0 : 1;
+    case MDMValueTypeRect: {
+      int dominant = 0;
+      for (int i = 1; i < 4; ++i) {
+        if (fabs(lanes[i]) > fabs(lanes[dominant])) {
+          dominant = i;
+        }
+      }
+      return dominant;
+    }
+    case MDMValueTypeTransform3D:
+      return -1;
+  }
+  return -1;
+}
+
+#pragma mark - Public
+
+size_t MDMValueTypeLaneCount(MDMValueType type) {
+  switch (type) {
+    case MDMValueTypeScalar:
+      return 1;
+    case MDMValueTypePoint:
+    case MDMValueTypeSize:
+      return 2;
+    case MDMValueTypeRect:
+      return 4;
+    case MDMValueTypeTransform3D:
+      return 16;
+  }
+  return 0;
+}
+
+void MDMValueInit(MDMValue *value, MDMValueType type, const double *lanes) {
+  memset(value, 0, sizeof(MDMValue));
+  value->type = type;
+  memcpy(value->lanes, lanes, MDMValueTypeLaneCount(type) * sizeof(double));
+}
+
+void MDMValueInitAdditiveIdentity(MDMValue *value, MDMValueType type) {
+  if (type == MDMValueTypeTransform3D) {
+    MDMValueInit(value, type, kIdentity);
+  } else {
+    memset(value, 0, sizeof(MDMValue));
+    value->type = type;
+  }
+}
+
+void MDMValueAdditiveDisplacement(const MDMValue *from, const MDMValue *to, MDMValue *result) {
+  if (to->type == MDMValueTypeTransform3D) {
+    double divisor[16];
+    MDMTransform3DInvert(to->lanes, divisor);
+    MDMTransform3DConcat(from->lanes, divisor, result->lanes);
+    result->type = MDMValueTypeTransform3D;
+    return;
+  }
+  // Unused lanes are zero, so operating on every lane yields the same result as operating on the
+  // used lanes while giving the compiler a fixed trip count to vectorize.
+  for (int i = 0; i < MDMValueMaxLaneCount; ++i) {
+    result->lanes[i] = from->lanes[i] - to->lanes[i];
+  }
+  result->type = to->type;
+}
+
+void MDMValueNegate(const MDMValue *value, MDMValue *result) {
+  if (value->type == MDMValueTypeTransform3D) {
+    MDMTransform3DInvert(value->lanes, result->lanes);
+    result->type = MDMValueTypeTransform3D;
+    return;
+  }
+  for (int i = 0; i < MDMValueMaxLaneCount; ++i) {
+    result->lanes[i] = -value->lanes[i];
+  }
+  result->type = value->type;
+}
+
+double MDMValueDominantComponent(const MDMValue *value) {
+  int lane = DominantLane(value);
+  return lane < 0 ? 0 : value->lanes[lane];
+}
+
+int MDMValueNormalizeVelocity(const MDMValue *additiveDisplacement,
+                              double absoluteVelocity,
+                              double *velocity) {
+  if (additiveDisplacement->type == MDMValueTypeTransform3D) {
+    return 0;
+  }
+  // The additive displacement points from the destination back towards the origin, so the
+  // direction of travel is its negation.
+  double displacement = -MDMValueDominantComponent(additiveDisplacement);
+  if (!(fabs(displacement) > kMinimumNormalizableDisplacement)) {
+    return 0;
+  }
+  *velocity = absoluteVelocity / displacement;
+  return 1;
+}
+
+int MDMValueNormalizeVelocityValue(const MDMValue *additiveDisplacement,
+                                   const MDMValue *absoluteVelocity,
+                                   double *velocity) {
+  int lane = DominantLane(additiveDisplacement);
+  if (lane < 0 || absoluteVelocity->type != additiveDisplacement->type) {
+    return 0;
+  }
+  return MDMValueNormalizeVelocity(additiveDisplacement, absoluteVelocity->lanes[lane], velocity);
+}
+
+int MDMTransform3DInvert(const double matrix[16], double result[16]) {
+  // The determinant of an affine matrix is that of its upper 3x3 block, so the general path would
+  // fail for exactly the same matrices.
+  int inverted = IsAffine(matrix) ? InvertAffine(matrix, result) : InvertGeneral(matrix, result);
+  if (!inverted && result != matrix) {
+    memcpy(result, matrix, 16 * sizeof(double));
+  }
+  return inverted;
+}
+
+void MDMTransform3DConcat(const double a[16], const double b[16], double result[16]) {
+  double product[16];
+  for (int row = 0; row < 4; ++row) {
+    for (int column = 0; column < 4; ++column) {
+      product[row * 4 + column] = (a[row * 4] * b[column]
+                                   + a[row * 4 + 1] * b[4 + column]
+                                   + a[row * 4 + 2] * b[8 + column]
+                                   + a[row * 4 + 3] * b[12 + column]);
+    }
+  }
+  memcpy(result, product, sizeof(product));
+}
@@ -0,0 +1,102 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_VALUE_KERNELS_H
+#define MDM_VALUE_KERNELS_H
+
+// Unboxed arithmetic for the value types that MDMMotionAnimator animates additively.
+//
+// Every value is stored as a fixed-size vector of doubles so that the kernels below operate on all
+// lanes without branching on the value's type. Lanes beyond a type's lane count are kept at zero.
+// This file is free of any Apple framework dependencies so that it can be built and tested on any
+// platform.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MDMValueMaxLaneCount 16
+
+typedef enum {
+  MDMValueTypeScalar,       // 1 lane.
+  MDMValueTypePoint,        // 2 lanes: x, y.
+  MDMValueTypeSize,         // 2 lanes: width, height.
+  MDMValueTypeRect,         // 4 lanes: origin.x, origin.y, size.width, size.height.
+  MDMValueTypeTransform3D,  // 16 lanes: m11, m12, m13, m14, m21, ... m44.
+} MDMValueType;
+
+typedef struct {
+  MDMValueType type;
+  double lanes[MDMValueMaxLaneCount];
+} MDMValue;
+
+// The number of lanes used by values of the given type.
+size_t MDMValueTypeLaneCount(MDMValueType type);
+
+// Initializes `value` with the given lanes. `lanes` must hold MDMValueTypeLaneCount(type) values.
+void MDMValueInit(MDMValue *value, MDMValueType type, const double *lanes);
+
+// Initializes `value` to the identity of additive composition: zero for vector types and the
+// identity matrix for transforms.
+void MDMValueInitAdditiveIdentity(MDMValue *value, MDMValueType type);
+
+// Writes the value that, when composed with `to`, yields `from`. Vector types are subtracted
+// (from - to); transforms are concatenated with the inverse of `to` (from x to^-1). Both values
+// must be of the same type.
+//
+// This is the fromValue of an additive animation whose non-additive equivalent animates from
+// `from` to `to`.
+void MDMValueAdditiveDisplacement(const MDMValue *from, const MDMValue *to, MDMValue *result);
+
+// Writes the additive inverse of `value`: its negation for vector types and its inverse for
+// transforms. `result` may alias `value`.
+void MDMValueNegate(const MDMValue *value, MDMValue *result);
+
+// Returns the lane with the largest magnitude, which Core Animation's single-dimensional spring
+// velocity is normalized against. Points and sizes prefer their second lane on ties; rects prefer
+// their earliest lane. Returns 0 for transforms.
+double MDMValueDominantComponent(const MDMValue *value);
+
+// Converts an absolute velocity, in units per second, into Core Animation's unit coordinate system
+// for an animation with the given additive displacement. Returns 0, leaving `velocity` untouched,
+// if the displacement is too small to normalize against or the value is a transform.
+int MDMValueNormalizeVelocity(const MDMValue *additiveDisplacement,
+                              double absoluteVelocity,
+                              double *velocity);
+
+// Like MDMValueNormalizeVelocity, for a velocity of the same type as the displacement, such as the
+// rate of change of an interrupted animation's presentation value. Only the lane that the
+// displacement is normalized against contributes. Returns 0, leaving `velocity` untouched, if the
+// types differ or under the same conditions as MDMValueNormalizeVelocity.
+int MDMValueNormalizeVelocityValue(const MDMValue *additiveDisplacement,
+                                   const MDMValue *absoluteVelocity,
+                                   double *velocity);
+
+// Matches CATransform3DInvert: returns 0 and copies `matrix` into `result` if it has no inverse.
+// Affine matrices take a faster path than matrices with a perspective component. `result` may alias
+// `matrix`.
+int MDMTransform3DInvert(const double matrix[16], double result[16]);
+
+// Matches CATransform3DConcat: writes a x b. `result` may alias either operand.
+void MDMTransform3DConcat(const double a[16], const double b[16], double result[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MDM_VALUE_KERNELS_H
@@ -0,0 +1,150 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MDMAdditiveCompaction.h"
+#include "MDMPortableTest.h"
+
+static MDMEvaluatorAnimation SpringAnimation(double x, double y, double beginTime,
+                                             double initialVelocity) {
+  const double lanes[2] = {x, y};
+  MDMEvaluatorAnimation animation;
+  memset(&animation, 0, sizeof(animation));
+  MDMValueInit(&animation.fromValue, MDMValueTypePoint, lanes);
+  MDMValueInitAdditiveIdentity(&animation.toValue, MDMValueTypePoint);
+  animation.additive = 1;
+  animation.beginTime = beginTime;
+  animation.duration = 10;
+  animation.timingCurve.kind = MDMTimingCurveKindSpring;
+  MDMSpringSolverInit(&animation.timingCurve.spring, 1, 100, 12, initialVelocity);
+  return animation;
+}
+
+// Describes the fold's animations to the evaluator as if they were added at `time`.
+static size_t FoldedEvaluatorAnimations(const MDMAdditiveFold *fold, double time,
+                                        MDMEvaluatorAnimation animations[2]) {
+  for (size_t i = 0; i < fold->count; ++i) {
+    const MDMFoldedAnimation *folded = &fold->animations[i];
+    animations[i] = SpringAnimation(0, 0, time, 0);
+    animations[i].fromValue = folded->displacement;
+    MDMSpringSolverInit(&animations[i].timingCurve.spring, 1, 100, 12, folded->initialVelocity);
+  }
+  return fold->count;
+}
+
+static void AssertFoldPreservesMotion(const MDMEvaluatorAnimation *animations, size_t count,
+                                      double time, const MDMAdditiveFold *fold, double accuracy) {
+  MDMEvaluatorStack original = {{MDMValueTypePoint, {0}}, animations, count};
+  MDMValue displacement;
+  MDMValue velocity;
+  MDMAssertTrue(MDMEvaluatorEvaluate(&original, time, &displacement));
+  MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&original, time, &velocity));
+
+  MDMEvaluatorAnimation folded[2];
+  MDMEvaluatorStack replacement = {{MDMValueTypePoint, {0}}, folded, 0};
+  replacement.count = FoldedEvaluatorAnimations(fold, time, folded);
+  MDMValue foldedDisplacement;
+  MDMValue foldedVelocity;
+  MDMAssertTrue(MDMEvaluatorEvaluate(&replacement, time, &foldedDisplacement));
+  MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&replacement, time, &foldedVelocity));
+  for (int lane = 0; lane < 2; ++lane) {
+    MDMAssertEqualWithAccuracy(fold->displacement.lanes[lane], displacement.lanes[lane], 1e-9);
+    MDMAssertEqualWithAccuracy(fold->velocity.lanes[lane], velocity.lanes[lane], 1e-9);
+    MDMAssertEqualWithAccuracy(foldedDisplacement.lanes[lane], displacement.lanes[lane], 1e-9);
+    MDMAssertEqualWithAccuracy(foldedVelocity.lanes[lane], velocity.lanes[lane], accuracy);
+  }
+}
+
+static void testFoldPreservesDisplacementAndVelocity(void) {
+  // A drag retargeted in changing directions, leaving a velocity that isn't parallel to the
+  // remaining displacement.
+  MDMEvaluatorAnimation animations[4] = {
+    SpringAnimation(-100, 0, 0, 0),
+    SpringAnimation(0, -80, 0.05, 0),
+    SpringAnimation(40, -40, 0.1, 0.5),
+    SpringAnimation(-10, 60, 0.15, 0),
+  };
+  MDMAdditiveFold fold;
+  MDMAssertTrue(MDMAdditiveFoldAnimations(animations, 4, 0.2, 0.1, 1e-3, &fold));
+  MDMAssertEqual(fold.count, 2);
+  AssertFoldPreservesMotion(animations, 4, 0.2, &fold, 1e-9);
+}
+
+static void testParallelVelocityFoldsIntoASingleAnimation(void) {
+  MDMEvaluatorAnimation animations[3] = {
+    SpringAnimation(-100, -50, 0, 0),
+    SpringAnimation(-20, -10, 0.05, 0),
+    SpringAnimation(-60, -30, 0.1, 0),
+  };
+  MDMAdditiveFold fold;
+  MDMAssertTrue(MDMAdditiveFoldAnimations(animations, 3, 0.12, 0.1, 1e-3, &fold));
+  MDMAssertEqual(fold.count, 1);
+  AssertFoldPreservesMotion(animations, 3, 0.12, &fold, 1e-9);
+}
+
+static void testResidualsWithinToleranceAreDropped(void) {
+  MDMEvaluatorAnimation animations[2] = {
+    SpringAnimation(-100, 0, 0, 0),
+    SpringAnimation(0, -1, 0.05, 0),
+  };
+  MDMAdditiveFold fold;
+  MDMAssertTrue(MDMAdditiveFoldAnimations(animations, 2, 0.1, 0.1, 1e-3, &fold));
+  MDMAssertEqual(fold.count, 2);
+
+  // The residual would displace the value by about a point, so a tolerance of two points drops it
+  // at the cost of the velocity's perpendicular component.
+  MDMAssertTrue(MDMAdditiveFoldAnimations(animations, 2, 0.1, 0.1, 2, &fold));
+  MDMAssertEqual(fold.count, 1);
+  double perpendicularSpeed = fabs(fold.velocity.lanes[1]);
+  AssertFoldPreservesMotion(animations, 2, 0.1, &fold, 2 * perpendicularSpeed + 1e-9);
+}
+
+static void testSettledStacksFoldIntoNothing(void) {
+  MDMEvaluatorAnimation animation = SpringAnimation(-100, 50, 0, 0);
+  MDMAdditiveFold fold;
+  MDMAssertTrue(MDMAdditiveFoldAnimations(&animation, 1, 20, 0.1, 1e-3, &fold));
+  MDMAssertEqual(fold.count, 0);
+}
+
+static void testUnsupportedStacksAreRejected(void) {
+  MDMEvaluatorAnimation animations[2] = {
+    SpringAnimation(-100, 0, 0, 0),
+    SpringAnimation(0, -80, 0.05, 0),
+  };
+  MDMAdditiveFold fold;
+  fold.count = 42;
+  MDMAssertTrue(!MDMAdditiveFoldAnimations(animations, 0, 0.1, 0.1, 1e-3, &fold));
+  MDMAssertTrue(!MDMAdditiveFoldAnimations(animations, 2, 0.1, 0, 1e-3, &fold));
+
+  animations[1].additive = 0;
+  MDMAssertTrue(!MDMAdditiveFoldAnimations(animations, 2, 0.1, 0.1, 1e-3, &fold));
+
+  animations[1] = animations[0];
+  MDMValueInitAdditiveIdentity(&animations[1].fromValue, MDMValueTypeScalar);
+  MDMAssertTrue(!MDMAdditiveFoldAnimations(animations, 2, 0.1, 0.1, 1e-3, &fold));
+  MDMAssertEqual(fold.count, 42);
+}
+
+int main(void) {
+  MDMRunTest(testFoldPreservesDisplacementAndVelocity);
+  MDMRunTest(testParallelVelocityFoldsIntoASingleAnimation);
+  MDMRunTest(testResidualsWithinToleranceAreDropped);
+  MDMRunTest(testSettledStacksFoldIntoNothing);
+  MDMRunTest(testUnsupportedStacksAreRejected);
+  return MDMTestExitStatus();
+}
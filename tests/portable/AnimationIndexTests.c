@@ -0,0 +1,470 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MDMAnimationIndex.h"
+#include "MDMPortableTest.h"
+
+// Reference counts for fake objects, which are represented as indices into this array.
+static int sRetainCounts[4096];
+
+static const void *FakeRetain(const void *value) {
+  sRetainCounts[(uintptr_t)value]++;
+  return value;
+}
+
+static void FakeRelease(const void *value) {
+  sRetainCounts[(uintptr_t)value]--;
+}
+
+static const MDMAnimationIndexCallbacks kFakeCallbacks = {FakeRetain, FakeRelease};
+
+#define FAKE(n) ((const void *)(uintptr_t)(n))
+
+static int AllRetainCountsAreZero(void) {
+  for (size_t i = 0; i < sizeof(sRetainCounts) / sizeof(sRetainCounts[0]); ++i) {
+    if (sRetainCounts[i] != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void testIdentifiersIncreaseMonotonically(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationID first = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAnimationID second = MDMAnimationIndexAdd(index, FAKE(2), FAKE(101), NULL, 0, 0);
+  MDMAnimationIndexRemove(index, FAKE(1), first);
+  MDMAnimationID third = MDMAnimationIndexAdd(index, FAKE(1), FAKE(102), NULL, 0, 0);
+  MDMAssertTrue(first != MDMAnimationIDNone);
+  MDMAssertTrue(second > first);
+  MDMAssertTrue(third > second);
+  MDMAnimationIndexDestroy(index);
+}
+
+static void testIdentifiersAreUniqueAcrossIndices(void) {
+  MDMAnimationIndex *first = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationIndex *second = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationID a = MDMAnimationIndexAdd(first, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAnimationID b = MDMAnimationIndexAdd(second, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAnimationID c = MDMAnimationIndexAdd(first, FAKE(1), FAKE(101), NULL, 0, 0);
+  MDMAssertTrue(b > a);
+  MDMAssertTrue(c > b);
+
+  // Each index only visits its own entries.
+  size_t count;
+  MDMAnimationIndexEntriesForLayer(first, FAKE(1), &count);
+  MDMAssertEqual(count, 2);
+  MDMAssertTrue(!MDMAnimationIndexRemove(second, FAKE(1), a));
+  MDMAssertTrue(MDMAnimationIndexRemove(second, FAKE(1), b));
+  MDMAnimationIndexDestroy(first);
+  MDMAnimationIndexDestroy(second);
+}
+
+static void testEntriesAreGroupedByLayerInInsertionOrder(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationID a = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAnimationIndexAdd(index, FAKE(2), FAKE(101), NULL, 0, 0);
+  MDMAnimationID c = MDMAnimationIndexAdd(index, FAKE(1), FAKE(102), FAKE(7), 1.5, 0);
+  MDMAnimationID d = MDMAnimationIndexAdd(index, FAKE(1), FAKE(103), NULL, 0, 0);
+
+  MDMAssertEqual(MDMAnimationIndexCount(index), 4);
+  MDMAssertEqual(MDMAnimationIndexLayerCount(index), 2);
+
+  size_t count;
+  const MDMAnimationIndexEntry *entries = MDMAnimationIndexEntriesForLayer(index, FAKE(1), &count);
+  MDMAssertEqual(count, 3);
+  MDMAssertEqual(entries[0].identifier, a);
+  MDMAssertEqual(entries[1].identifier, c);
+  MDMAssertTrue(entries[1].key == FAKE(7));
+  MDMAssertEqualWithAccuracy(entries[1].beginTime, 1.5, 0);
+  MDMAssertEqual(entries[2].identifier, d);
+
+  MDMAssertTrue(MDMAnimationIndexRemove(index, FAKE(1), c));
+  entries = MDMAnimationIndexEntriesForLayer(index, FAKE(1), &count);
+  MDMAssertEqual(count, 2);
+  MDMAssertEqual(entries[0].identifier, a);
+  MDMAssertEqual(entries[1].identifier, d);
+
+  MDMAssertTrue(!MDMAnimationIndexRemove(index, FAKE(1), c));
+  MDMAssertTrue(!MDMAnimationIndexRemove(index, FAKE(2), a));
+  MDMAssertTrue(MDMAnimationIndexEntriesForLayer(index, FAKE(3), &count) == NULL);
+  MDMAssertEqual(count, 0);
+  MDMAnimationIndexDestroy(index);
+}
+
+static void testCallbacksAreBalanced(void) {
+  memset(sRetainCounts, 0, sizeof(sRetainCounts));
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(&kFakeCallbacks, &kFakeCallbacks);
+  MDMAnimationID a = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), FAKE(200), 0, 0);
+  MDMAnimationIndexAdd(index, FAKE(1), FAKE(101), NULL, 0, 0);
+  MDMAnimationIndexAdd(index, FAKE(2), FAKE(102), NULL, 0, 0);
+
+  MDMAssertEqual(sRetainCounts[1], 1);  // Layers are retained once, not once per entry.
+  MDMAssertEqual(sRetainCounts[100], 1);
+  MDMAssertEqual(sRetainCounts[200], 1);
+
+  MDMAnimationIndexRemove(index, FAKE(1), a);
+  MDMAssertEqual(sRetainCounts[100], 0);
+  MDMAssertEqual(sRetainCounts[200], 0);
+  MDMAssertEqual(sRetainCounts[1], 1);
+
+  MDMAnimationIndexRemoveAll(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+
+  MDMAnimationIndexAdd(index, FAKE(3), FAKE(103), NULL, 0, 0);
+  MDMAnimationIndexDestroy(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+static void testPooledStorageIsReusedByOtherLayers(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  for (int round = 0; round < 3; ++round) {
+    // Each round's layers inherit the entry arrays, of varying capacity, of the previous round's.
+    uintptr_t firstLayer = 1 + (uintptr_t)round * 10;
+    for (uintptr_t layer = firstLayer; layer < firstLayer + 5; ++layer) {
+      for (uintptr_t i = 0; i < layer - firstLayer + 1 + (uintptr_t)round * 3; ++i) {
+        MDMAnimationIndexAdd(index, FAKE(layer), FAKE(100 + i), NULL, 0, 0);
+      }
+    }
+    for (uintptr_t layer = firstLayer; layer < firstLayer + 5; ++layer) {
+      size_t count;
+      const MDMAnimationIndexEntry *entries =
+          MDMAnimationIndexEntriesForLayer(index, FAKE(layer), &count);
+      MDMAssertEqual(count, layer - firstLayer + 1 + (uintptr_t)round * 3);
+      for (size_t i = 0; i < count; ++i) {
+        MDMAssertTrue(entries[i].animation == FAKE(100 + i));
+      }
+    }
+    if (round == 1) {
+      MDMAnimationIndexRemoveAll(index);
+    } else {
+      for (uintptr_t layer = firstLayer; layer < firstLayer + 5; ++layer) {
+        size_t count;
+        const MDMAnimationIndexEntry *entries =
+            MDMAnimationIndexEntriesForLayer(index, FAKE(layer), &count);
+        while (count > 0) {
+          MDMAnimationIndexRemove(index, FAKE(layer), entries[0].identifier);
+          entries = MDMAnimationIndexEntriesForLayer(index, FAKE(layer), &count);
+        }
+      }
+    }
+    MDMAssertEqual(MDMAnimationIndexCount(index), 0);
+    MDMAssertEqual(MDMAnimationIndexLayerCount(index), 0);
+  }
+  MDMAnimationIndexDestroy(index);
+}
+
+static MDMAnimationIndex *sReentrantIndex;
+
+static void AddOnRelease(const void *value) {
+  if (value == FAKE(1)) {
+    MDMAnimationIndexAdd(sReentrantIndex, FAKE(2), FAKE(101), NULL, 0, 0);
+  }
+}
+
+static void testLayersAddedWhileRemovingAllAreKept(void) {
+  MDMAnimationIndexCallbacks callbacks = {NULL, AddOnRelease};
+  sReentrantIndex = MDMAnimationIndexCreate(&callbacks, NULL);
+  MDMAnimationIndexAdd(sReentrantIndex, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAnimationIndexRemoveAll(sReentrantIndex);
+
+  size_t count;
+  const MDMAnimationIndexEntry *entries =
+      MDMAnimationIndexEntriesForLayer(sReentrantIndex, FAKE(2), &count);
+  MDMAssertEqual(count, 1);
+  MDMAssertTrue(entries[0].animation == FAKE(101));
+  MDMAssertEqual(MDMAnimationIndexLayerCount(sReentrantIndex), 1);
+  MDMAnimationIndexDestroy(sReentrantIndex);
+}
+
+// Performs random operations against the index and a naive model, checking that they agree.
+static void testRandomOperationsMatchModel(void) {
+  enum { kLayers = 300, kMaximumEntries = 3000, kOperations = 50000 };
+  static MDMAnimationID modelIdentifiers[kMaximumEntries];
+  static uintptr_t modelLayers[kMaximumEntries];
+  size_t modelCount = 0;
+
+  memset(sRetainCounts, 0, sizeof(sRetainCounts));
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(&kFakeCallbacks, NULL);
+  srand(42);
+  for (int operation = 0; operation < kOperations; ++operation) {
+    if (modelCount < kMaximumEntries && (modelCount == 0 || rand() % 5 < 3)) {
+      uintptr_t layer = 1 + (uintptr_t)(rand() % kLayers);
+      modelIdentifiers[modelCount] = MDMAnimationIndexAdd(index, FAKE(layer), NULL, NULL, 0, 0);
+      modelLayers[modelCount] = layer;
+      modelCount++;
+    } else {
+      size_t victim = (size_t)rand() % modelCount;
+      MDMAssertTrue(MDMAnimationIndexRemove(index, FAKE(modelLayers[victim]),
+                                            modelIdentifiers[victim]));
+      modelCount--;
+      modelIdentifiers[victim] = modelIdentifiers[modelCount];
+      modelLayers[victim] = modelLayers[modelCount];
+    }
+  }
+  MDMAssertEqual(MDMAnimationIndexCount(index), modelCount);
+
+  size_t layerEntryCounts[kLayers + 1];
+  memset(layerEntryCounts, 0, sizeof(layerEntryCounts));
+  for (size_t i = 0; i < modelCount; ++i) {
+    layerEntryCounts[modelLayers[i]]++;
+  }
+  size_t activeLayers = 0;
+  for (uintptr_t layer = 1; layer <= kLayers; ++layer) {
+    size_t count;
+    MDMAnimationIndexEntriesForLayer(index, FAKE(layer), &count);
+    MDMAssertEqual(count, layerEntryCounts[layer]);
+    MDMAssertEqual(sRetainCounts[layer], count > 0 ? 1 : 0);
+    activeLayers += count > 0;
+  }
+  MDMAssertEqual(MDMAnimationIndexLayerCount(index), activeLayers);
+  MDMAnimationIndexDestroy(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+typedef struct {
+  MDMAnimationIndex *index;
+  size_t visitCount;
+} MutatingVisitorContext;
+
+static void MutatingVisitor(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  MutatingVisitorContext *visitorContext = context;
+  visitorContext->visitCount++;
+  MDMAnimationIndexRemove(visitorContext->index, layer, entry->identifier);
+  MDMAnimationIndexAdd(visitorContext->index, FAKE(9), FAKE(109), NULL, 0, 0);
+}
+
+static void testIterationToleratesMutation(void) {
+  memset(sRetainCounts, 0, sizeof(sRetainCounts));
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(&kFakeCallbacks, &kFakeCallbacks);
+  for (uintptr_t i = 0; i < 10; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(1 + i % 3), FAKE(100 + i), NULL, 0, 0);
+  }
+  MutatingVisitorContext context = {index, 0};
+  MDMAnimationIndexForEach(index, MutatingVisitor, &context);
+  MDMAssertEqual(context.visitCount, 10);
+  MDMAssertEqual(MDMAnimationIndexCount(index), 10);
+  MDMAssertEqual(MDMAnimationIndexLayerCount(index), 1);
+  MDMAnimationIndexDestroy(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+static void RemoveAllVisitor(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  MutatingVisitorContext *visitorContext = context;
+  visitorContext->visitCount++;
+  MDMAnimationIndexRemoveAll(visitorContext->index);
+  // Entries removed during iteration are retained until the iteration ends.
+  MDMAssertTrue(sRetainCounts[(uintptr_t)entry->animation] > 0);
+  MDMAssertTrue(sRetainCounts[(uintptr_t)layer] > 0);
+}
+
+static void testEntriesRemovedDuringIterationAreNotVisited(void) {
+  memset(sRetainCounts, 0, sizeof(sRetainCounts));
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(&kFakeCallbacks, &kFakeCallbacks);
+  for (uintptr_t i = 0; i < 10; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(1 + i % 3), FAKE(100 + i), NULL, 0, 0);
+  }
+  MutatingVisitorContext context = {index, 0};
+  MDMAnimationIndexForEach(index, RemoveAllVisitor, &context);
+  MDMAssertEqual(context.visitCount, 1);
+  MDMAssertEqual(MDMAnimationIndexCount(index), 0);
+  MDMAssertEqual(MDMAnimationIndexLayerCount(index), 0);
+  MDMAssertTrue(AllRetainCountsAreZero());
+
+  // The index remains usable once compacted.
+  MDMAnimationID identifier = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  size_t count;
+  const MDMAnimationIndexEntry *entries = MDMAnimationIndexEntriesForLayer(index, FAKE(1), &count);
+  MDMAssertEqual(count, 1);
+  MDMAssertEqual(entries[0].identifier, identifier);
+  MDMAnimationIndexDestroy(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+static void NestedVisitor(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  MutatingVisitorContext *visitorContext = context;
+  visitorContext->visitCount++;
+  if (entry->animation == FAKE(100)) {
+    // Removes every entry of the first layer, including those the outer iteration has yet to visit.
+    MDMAnimationIndexForEach(visitorContext->index, MutatingVisitor, context);
+  }
+}
+
+static void testNestedIterationDefersCompaction(void) {
+  memset(sRetainCounts, 0, sizeof(sRetainCounts));
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(&kFakeCallbacks, &kFakeCallbacks);
+  for (uintptr_t i = 0; i < 4; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(1), FAKE(100 + i), NULL, 0, 0);
+  }
+  MutatingVisitorContext context = {index, 0};
+  MDMAnimationIndexForEach(index, NestedVisitor, &context);
+  // One outer visit followed by four inner visits.
+  MDMAssertEqual(context.visitCount, 5);
+  MDMAssertEqual(MDMAnimationIndexCount(index), 4);
+  MDMAssertEqual(MDMAnimationIndexLayerCount(index), 1);
+  size_t count;
+  MDMAnimationIndexEntriesForLayer(index, FAKE(1), &count);
+  MDMAssertEqual(count, 0);
+  MDMAnimationIndexEntriesForLayer(index, FAKE(9), &count);
+  MDMAssertEqual(count, 4);
+  MDMAnimationIndexDestroy(index);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+static void testGenerationChangesOnMutation(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  uint64_t generation = MDMAnimationIndexGeneration(index);
+  MDMAnimationID identifier = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  MDMAssertTrue(MDMAnimationIndexGeneration(index) != generation);
+  generation = MDMAnimationIndexGeneration(index);
+  MDMAssertTrue(!MDMAnimationIndexRemove(index, FAKE(1), identifier + 1));
+  MDMAssertEqual(MDMAnimationIndexGeneration(index), generation);
+  MDMAssertTrue(MDMAnimationIndexRemove(index, FAKE(1), identifier));
+  MDMAssertTrue(MDMAnimationIndexGeneration(index) != generation);
+  MDMAnimationIndexDestroy(index);
+}
+
+static uint32_t NewestKeyNumber(const MDMAnimationIndex *index, const void *layer) {
+  size_t count;
+  const MDMAnimationIndexEntry *entries = MDMAnimationIndexEntriesForLayer(index, layer, &count);
+  return entries[count - 1].keyNumber;
+}
+
+static void testKeyNumbersAreReusedOnceRemoved(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationID first = MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  uint32_t firstKeyNumber = NewestKeyNumber(index, FAKE(1));
+  MDMAnimationIndexAdd(index, FAKE(2), FAKE(101), NULL, 0, 0);
+  uint32_t secondKeyNumber = NewestKeyNumber(index, FAKE(2));
+  MDMAnimationIndexAdd(index, FAKE(2), FAKE(102), FAKE(200), 0, 0);
+  MDMAssertTrue(firstKeyNumber != 0);
+  MDMAssertTrue(secondKeyNumber != firstKeyNumber);
+  // Animations added with a key don't need a key number.
+  MDMAssertEqual(NewestKeyNumber(index, FAKE(2)), 0);
+
+  MDMAnimationIndexRemove(index, FAKE(1), first);
+  MDMAnimationIndexAdd(index, FAKE(3), FAKE(103), NULL, 0, 0);
+  MDMAssertEqual(NewestKeyNumber(index, FAKE(3)), firstKeyNumber);
+
+  // Live entries never share a key number.
+  MDMAnimationIndexRemoveAll(index);
+  uint32_t keyNumbers[64];
+  for (uint32_t i = 0; i < 64; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(1 + i % 8), FAKE(100 + i), NULL, 0, 0);
+    keyNumbers[i] = NewestKeyNumber(index, FAKE(1 + i % 8));
+    for (uint32_t j = 0; j < i; ++j) {
+      MDMAssertTrue(keyNumbers[j] != keyNumbers[i]);
+    }
+  }
+  MDMAnimationIndexDestroy(index);
+}
+
+static void ReplaceEntry(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  MDMAnimationIndex *index = context;
+  uint32_t keyNumber = entry->keyNumber;
+  MDMAnimationIndexRemove(index, layer, entry->identifier);
+  MDMAnimationIndexAdd(index, layer, FAKE(101), NULL, 0, 0);
+  MDMAssertTrue(NewestKeyNumber(index, layer) != keyNumber);
+}
+
+static void testEntriesRemovedDuringIterationKeepTheirKeyNumbers(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationIndexAdd(index, FAKE(1), FAKE(100), NULL, 0, 0);
+  uint32_t keyNumber = NewestKeyNumber(index, FAKE(1));
+  MDMAnimationIndexForEach(index, ReplaceEntry, index);
+  // Compaction released the removed entry's key number.
+  MDMAnimationIndexAdd(index, FAKE(2), FAKE(102), NULL, 0, 0);
+  MDMAssertEqual(NewestKeyNumber(index, FAKE(2)), keyNumber);
+  MDMAnimationIndexDestroy(index);
+}
+
+static void testKeysAreUniqueAcrossIndices(void) {
+  MDMAnimationIndex *first = MDMAnimationIndexCreate(NULL, NULL);
+  MDMAnimationIndex *second = MDMAnimationIndexCreate(NULL, NULL);
+  char firstKey[MDMAnimationIndexKeyBufferSize];
+  char secondKey[MDMAnimationIndexKeyBufferSize];
+  size_t length = MDMAnimationIndexFormatKey(first, 1, firstKey, sizeof(firstKey));
+  MDMAssertEqual(length, strlen(firstKey));
+  MDMAssertTrue(strncmp(firstKey, "mdm.", 4) == 0);
+  MDMAnimationIndexFormatKey(second, 1, secondKey, sizeof(secondKey));
+  MDMAssertTrue(strcmp(firstKey, secondKey) != 0);
+  MDMAnimationIndexFormatKey(first, UINT32_MAX, firstKey, sizeof(firstKey));
+  MDMAssertTrue(strlen(firstKey) < sizeof(firstKey) - 1);
+  MDMAnimationIndexDestroy(first);
+  MDMAnimationIndexDestroy(second);
+}
+
+static void testDepthHistogramsGroupEntriesByLayerAndTag(void) {
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  // Layer 1 stacks three tag 2 entries on a tag 5 entry; layer 2 has a single tag 2 entry.
+  MDMAnimationIndexAdd(index, FAKE(1), NULL, NULL, 0, 5);
+  MDMAnimationID removed = MDMAnimationIndexAdd(index, FAKE(1), NULL, NULL, 0, 2);
+  for (int i = 0; i < 3; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(1), NULL, NULL, 0, 2);
+  }
+  MDMAnimationIndexAdd(index, FAKE(2), NULL, NULL, 0, 2);
+  MDMAnimationIndexRemove(index, FAKE(1), removed);
+  // Deep stacks share the last bucket, and out of range tags only count towards their layer.
+  for (int i = 0; i < 10; ++i) {
+    MDMAnimationIndexAdd(index, FAKE(3), NULL, NULL, 0, 7);
+  }
+  MDMAnimationIndexAdd(index, FAKE(4), NULL, NULL, 0, MDMAnimationIndexMaxHistogramTagCount);
+
+  MDMAssertEqual(MDMAnimationIndexCountForTag(index, FAKE(1), 2), 3);
+  MDMAssertEqual(MDMAnimationIndexCountForTag(index, FAKE(1), 5), 1);
+  MDMAssertEqual(MDMAnimationIndexCountForTag(index, FAKE(1), 7), 0);
+  MDMAssertEqual(MDMAnimationIndexCountForTag(index, FAKE(9), 2), 0);
+
+  MDMAnimationIndexDepthHistograms histograms;
+  MDMAnimationIndexComputeDepthHistograms(index, &histograms);
+  MDMAssertEqual(histograms.layers[0], 2);  // Layers 2 and 4.
+  MDMAssertEqual(histograms.layers[3], 1);  // Layer 1.
+  MDMAssertEqual(histograms.layers[MDMAnimationIndexDepthBucketCount - 1], 1);  // Layer 3.
+  MDMAssertEqual(histograms.tags[2][0], 1);
+  MDMAssertEqual(histograms.tags[2][2], 1);
+  MDMAssertEqual(histograms.tags[5][0], 1);
+  MDMAssertEqual(histograms.tags[7][MDMAnimationIndexDepthBucketCount - 1], 1);
+  uint64_t total = 0;
+  for (size_t tag = 0; tag < MDMAnimationIndexMaxHistogramTagCount; ++tag) {
+    for (size_t bucket = 0; bucket < MDMAnimationIndexDepthBucketCount; ++bucket) {
+      total += histograms.tags[tag][bucket];
+    }
+  }
+  MDMAssertEqual(total, 4);
+  MDMAnimationIndexDestroy(index);
+}
+
+int main(void) {
+  MDMRunTest(testIdentifiersIncreaseMonotonically);
+  MDMRunTest(testIdentifiersAreUniqueAcrossIndices);
+  MDMRunTest(testEntriesAreGroupedByLayerInInsertionOrder);
+  MDMRunTest(testCallbacksAreBalanced);
+  MDMRunTest(testPooledStorageIsReusedByOtherLayers);
+  MDMRunTest(testLayersAddedWhileRemovingAllAreKept);
+  MDMRunTest(testRandomOperationsMatchModel);
+  MDMRunTest(testIterationToleratesMutation);
+  MDMRunTest(testEntriesRemovedDuringIterationAreNotVisited);
+  MDMRunTest(testNestedIterationDefersCompaction);
+  MDMRunTest(testGenerationChangesOnMutation);
+  MDMRunTest(testKeyNumbersAreReusedOnceRemoved);
+  MDMRunTest(testEntriesRemovedDuringIterationKeepTheirKeyNumbers);
+  MDMRunTest(testKeysAreUniqueAcrossIndices);
+  MDMRunTest(testDepthHistogramsGroupEntriesByLayerAndTag);
+  return MDMTestExitStatus();
+}
@@ -0,0 +1,116 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "MDMCommandBuffer.h"
+#include "MDMPortableTest.h"
+
+// Reference counts for fake objects, which are represented as indices into this array.
+static int sRetainCounts[4096];
+
+static const void *FakeRetain(const void *value) {
+  sRetainCounts[(uintptr_t)value]++;
+  return value;
+}
+
+static void FakeRelease(const void *value) {
+  sRetainCounts[(uintptr_t)value]--;
+}
+
+static const MDMCommandBufferCallbacks kFakeCallbacks = {FakeRetain, FakeRelease};
+
+#define FAKE(n) ((const void *)(uintptr_t)(n))
+
+static int AllRetainCountsAreZero(void) {
+  for (size_t i = 0; i < sizeof(sRetainCounts) / sizeof(sRetainCounts[0]); ++i) {
+    if (sRetainCounts[i] != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static MDMCommand FakeCommand(size_t n) {
+  MDMCommand command = {FAKE(1 + n % 100), FAKE(1000), FAKE(1001), FAKE(2000 + n), NULL,
+                        MDMValueClassPoint};
+  return command;
+}
+
+static void testCommandsAreKeptInOrder(void) {
+  MDMCommandBuffer *buffer = MDMCommandBufferCreate(NULL);
+  for (size_t i = 0; i < 500; ++i) {
+    MDMCommand command = FakeCommand(i);
+    MDMAssertTrue(MDMCommandBufferAppend(buffer, &command));
+  }
+  size_t count = 0;
+  const MDMCommand *commands = MDMCommandBufferCommands(buffer, &count);
+  MDMAssertEqual(count, 500);
+  MDMAssertEqual(MDMCommandBufferCount(buffer), 500);
+  for (size_t i = 0; i < count; ++i) {
+    MDMAssertTrue(commands[i].layer == FAKE(1 + i % 100));
+    MDMAssertTrue(commands[i].values == FAKE(2000 + i));
+    MDMAssertTrue(commands[i].completion == NULL);
+    MDMAssertEqual(commands[i].valueClass, MDMValueClassPoint);
+  }
+  MDMCommandBufferDestroy(buffer);
+}
+
+static void testCommandsAreRetainedUntilRemoved(void) {
+  MDMCommandBuffer *buffer = MDMCommandBufferCreate(&kFakeCallbacks);
+  MDMCommand command = {FAKE(1), FAKE(2), FAKE(3), FAKE(4), FAKE(5), MDMValueClassNumber};
+  MDMCommandBufferAppend(buffer, &command);
+  MDMCommandBufferAppend(buffer, &command);
+  for (int i = 1; i <= 5; ++i) {
+    MDMAssertEqual(sRetainCounts[i], 2);
+  }
+  MDMCommand withoutCompletion = FakeCommand(0);
+  MDMCommandBufferAppend(buffer, &withoutCompletion);
+  MDMCommandBufferRemoveAll(buffer);
+  MDMAssertTrue(AllRetainCountsAreZero());
+  MDMAssertEqual(MDMCommandBufferCount(buffer), 0);
+
+  MDMCommandBufferAppend(buffer, &command);
+  MDMCommandBufferDestroy(buffer);
+  MDMAssertTrue(AllRetainCountsAreZero());
+}
+
+static void testRemovingAllCommandsKeepsTheStorage(void) {
+  MDMCommandBuffer *buffer = MDMCommandBufferCreate(NULL);
+  MDMAssertEqual(MDMCommandBufferCapacity(buffer), 0);
+  for (size_t i = 0; i < 100; ++i) {
+    MDMCommand command = FakeCommand(i);
+    MDMCommandBufferAppend(buffer, &command);
+  }
+  size_t capacity = MDMCommandBufferCapacity(buffer);
+  MDMAssertTrue(capacity >= 100);
+  MDMCommandBufferRemoveAll(buffer);
+  MDMAssertEqual(MDMCommandBufferCapacity(buffer), capacity);
+  for (size_t i = 0; i < 100; ++i) {
+    MDMCommand command = FakeCommand(i);
+    MDMCommandBufferAppend(buffer, &command);
+  }
+  MDMAssertEqual(MDMCommandBufferCapacity(buffer), capacity);
+  MDMCommandBufferDestroy(buffer);
+}
+
+int main(void) {
+  MDMRunTest(testCommandsAreKeptInOrder);
+  MDMRunTest(testCommandsAreRetainedUntilRemoved);
+  MDMRunTest(testRemovingAllCommandsKeepsTheStorage);
+  return MDMTestExitStatus();
+}
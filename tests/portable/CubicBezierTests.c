@@ -0,0 +1,178 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "MDMCubicBezier.h"
+#include "MDMPortableTest.h"
+
+typedef struct {
+  double x1, y1, x2, y2;
+} ControlPoints;
+
+static const ControlPoints kCurves[] = {
+  {0.25, 0.1, 0.25, 1},  // Core Animation's default.
+  {0.42, 0, 0.58, 1},    // Ease in ease out.
+  {0.42, 0, 1, 1},       // Ease in.
+  {0, 0, 0.58, 1},       // Ease out.
+  {0.4, 0, 0.2, 1},      // Material standard.
+  {0, 0, 0.2, 1},        // Material deceleration.
+  {0.4, 0, 1, 1},        // Material acceleration.
+  {0, 0, 1, 1},          // Linear.
+  {1, 0, 0, 1},          // x'(t) vanishes at t = 0.5.
+  {0, 1, 1, 0},          // x'(t) vanishes at both ends.
+  {0.3, -0.5, 0.7, 1.5}, // Overshoots in both directions.
+  {1, 0, 1, 0},          // Flat until the very end.
+};
+
+// Solves for t by bisecting in extended precision until the bracket stops shrinking.
+static double ReferenceSolve(double x1, double y1, double x2, double y2, double x) {
+  if (x <= 0 || x >= 1) {
+    return x <= 0 ? 0 : 1;
+  }
+  x1 = fmin(fmax(x1, 0), 1);
+  x2 = fmin(fmax(x2, 0), 1);
+  long double lower = 0;
+  long double upper = 1;
+  for (int i = 0; i < 200; ++i) {
+    long double t = (lower + upper) / 2;
+    long double u = 1 - t;
+    long double curveX = 3 * u * u * t * x1 + 3 * u * t * t * x2 + t * t * t;
+    if (curveX < x) {
+      lower = t;
+    } else {
+      upper = t;
+    }
+  }
+  long double t = (lower + upper) / 2;
+  long double u = 1 - t;
+  return (double)(3 * u * u * t * y1 + 3 * u * t * t * y2 + t * t * t);
+}
+
+// A deterministic source of control points in [-1, 2].
+static double NextRandom(uint32_t *state) {
+  *state = *state * 1664525u + 1013904223u;
+  return (double)(*state >> 8) / (double)(1u << 24) * 3 - 1;
+}
+
+static void AssertMatchesReference(double x1, double y1, double x2, double y2) {
+  MDMCubicBezier curve;
+  MDMCubicBezierInit(&curve, x1, y1, x2, y2);
+  double bound = MDMCubicBezierErrorBound(&curve);
+  for (int i = 0; i <= 2000; ++i) {
+    double x = i / 2000.0;
+    MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, x),
+                               ReferenceSolve(x1, y1, x2, y2, x), bound);
+  }
+}
+
+static void testSolveMatchesReferenceWithinErrorBound(void) {
+  for (size_t i = 0; i < sizeof(kCurves) / sizeof(kCurves[0]); ++i) {
+    AssertMatchesReference(kCurves[i].x1, kCurves[i].y1, kCurves[i].x2, kCurves[i].y2);
+  }
+}
+
+static void testRandomCurvesMatchReferenceWithinErrorBound(void) {
+  uint32_t state = 7;
+  for (int i = 0; i < 200; ++i) {
+    double x1 = NextRandom(&state);
+    double y1 = NextRandom(&state);
+    double x2 = NextRandom(&state);
+    double y2 = NextRandom(&state);
+    AssertMatchesReference(x1, y1, x2, y2);
+  }
+}
+
+static void testErrorBoundIsTight(void) {
+  MDMCubicBezier curve;
+  MDMCubicBezierInit(&curve, 0.4, 0, 0.2, 1);
+  MDMAssertTrue(MDMCubicBezierErrorBound(&curve) < 1e-6);
+}
+
+static void testEndpointsAndOutOfRangeTimes(void) {
+  MDMCubicBezier curve;
+  MDMCubicBezierInit(&curve, 0.3, -0.5, 0.7, 1.5);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, 0), 0, 0);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, 1), 1, 0);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, -3), 0, 0);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, 4), 1, 0);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSolve(&curve, NAN), 0, 0);
+}
+
+static void testSlopeMatchesFiniteDifferences(void) {
+  // The first seven curves have well-conditioned slopes away from their ends.
+  for (size_t c = 0; c < 7; ++c) {
+    MDMCubicBezier curve;
+    MDMCubicBezierInit(&curve, kCurves[c].x1, kCurves[c].y1, kCurves[c].x2, kCurves[c].y2);
+    for (int i = 1; i < 100; ++i) {
+      double x = i / 100.0;
+      double h = 1e-5;
+      double expected = (ReferenceSolve(kCurves[c].x1, kCurves[c].y1, kCurves[c].x2, kCurves[c].y2,
+                                        x + h)
+                         - ReferenceSolve(kCurves[c].x1, kCurves[c].y1, kCurves[c].x2,
+                                          kCurves[c].y2, x - h)) / (2 * h);
+      MDMAssertEqualWithAccuracy(MDMCubicBezierSlope(&curve, x), expected, 1e-4);
+    }
+  }
+
+  MDMCubicBezier linear;
+  MDMCubicBezierInit(&linear, 0, 0, 1, 1);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSlope(&linear, -1), 1, 1e-9);
+  MDMAssertEqualWithAccuracy(MDMCubicBezierSlope(&linear, 2), 1, 1e-9);
+}
+
+static void testBatchMatchesSolve(void) {
+  enum { kCount = 1000 + 5 };  // Not a multiple of the batch width.
+  double x[kCount];
+  double y[kCount];
+  double inPlace[kCount];
+  for (size_t i = 0; i < kCount; ++i) {
+    x[i] = (double)i / (kCount - 1) * 1.2 - 0.1;
+    inPlace[i] = x[i];
+  }
+  for (size_t c = 0; c < sizeof(kCurves) / sizeof(kCurves[0]); ++c) {
+    MDMCubicBezier curve;
+    MDMCubicBezierInit(&curve, kCurves[c].x1, kCurves[c].y1, kCurves[c].x2, kCurves[c].y2);
+    double bound = MDMCubicBezierErrorBound(&curve);
+    MDMCubicBezierSolveBatch(&curve, x, y, kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+      MDMAssertEqualWithAccuracy(y[i], ReferenceSolve(kCurves[c].x1, kCurves[c].y1,
+                                                      kCurves[c].x2, kCurves[c].y2,
+                                                      fmin(fmax(x[i], 0), 1)),
+                                 bound);
+      MDMAssertEqualWithAccuracy(y[i], MDMCubicBezierSolve(&curve, x[i]), 2 * bound);
+    }
+  }
+
+  MDMCubicBezier curve;
+  MDMCubicBezierInit(&curve, 0.4, 0, 0.2, 1);
+  MDMCubicBezierSolveBatch(&curve, inPlace, inPlace, kCount);
+  for (size_t i = 0; i < kCount; ++i) {
+    MDMAssertEqualWithAccuracy(inPlace[i], MDMCubicBezierSolve(&curve, x[i]),
+                               2 * MDMCubicBezierErrorBound(&curve));
+  }
+}
+
+int main(void) {
+  MDMRunTest(testSolveMatchesReferenceWithinErrorBound);
+  MDMRunTest(testRandomCurvesMatchReferenceWithinErrorBound);
+  MDMRunTest(testErrorBoundIsTight);
+  MDMRunTest(testEndpointsAndOutOfRangeTimes);
+  MDMRunTest(testSlopeMatchesFiniteDifferences);
+  MDMRunTest(testBatchMatchesSolve);
+  return MDMTestExitStatus();
+}
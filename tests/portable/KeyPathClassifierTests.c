@@ -0,0 +1,70 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <string.h>
+
+#include "MDMKeyPathClassifier.h"
+#include "MDMPortableTest.h"
+
+static MDMAnimatableKeyPathKind Classify(const char *keyPath) {
+  return MDMClassifyKeyPath(keyPath, strlen(keyPath));
+}
+
+static void testEveryAnimatableKeyPathIsClassified(void) {
+  size_t maxLength = 0;
+  for (int kind = MDMAnimatableKeyPathKindNone + 1; kind < MDMAnimatableKeyPathKindCount; ++kind) {
+    const char *keyPath = MDMAnimatableKeyPathKindGetKeyPath((MDMAnimatableKeyPathKind)kind);
+    MDMAssertTrue(keyPath != NULL);
+    MDMAssertEqual((int)Classify(keyPath), kind);
+    maxLength = strlen(keyPath) > maxLength ? strlen(keyPath) : maxLength;
+  }
+  MDMAssertEqual(maxLength, MDMAnimatableKeyPathMaxLength);
+}
+
+static void testKindsMatchPublicKeyPaths(void) {
+  MDMAssertEqual(Classify("anchorPoint"), MDMAnimatableKeyPathKindAnchorPoint);
+  MDMAssertEqual(Classify("bounds.size.height"), MDMAnimatableKeyPathKindHeight);
+  MDMAssertEqual(Classify("transform.rotation.z"), MDMAnimatableKeyPathKindRotation);
+  MDMAssertEqual(Classify("position.y"), MDMAnimatableKeyPathKindY);
+  MDMAssertEqual(Classify("zPosition"), MDMAnimatableKeyPathKindZ);
+}
+
+static void testOtherKeyPathsAreRejected(void) {
+  const char *keyPaths[] = {
+    "", "p", "frame", "hidden", "contents", "sublayers", "position.z", "Position", "positio",
+    "positionx", "bounds.size", "transform.rotation", "transform.scale.x", "shadowPath",
+    "borderWidth ", "onOrderIn", "zPositions", "transform.rotation.zz",
+  };
+  for (size_t i = 0; i < sizeof(keyPaths) / sizeof(keyPaths[0]); ++i) {
+    MDMAssertEqual(Classify(keyPaths[i]), MDMAnimatableKeyPathKindNone);
+  }
+  MDMAssertTrue(MDMAnimatableKeyPathKindGetKeyPath(MDMAnimatableKeyPathKindNone) == NULL);
+  MDMAssertTrue(MDMAnimatableKeyPathKindGetKeyPath(MDMAnimatableKeyPathKindCount) == NULL);
+}
+
+static void testKeyPathsNeedNotBeTerminated(void) {
+  const char *buffer = "opacityXYZ";
+  MDMAssertEqual(MDMClassifyKeyPath(buffer, 7), MDMAnimatableKeyPathKindOpacity);
+  MDMAssertEqual(MDMClassifyKeyPath(buffer, 8), MDMAnimatableKeyPathKindNone);
+}
+
+int main(void) {
+  MDMRunTest(testEveryAnimatableKeyPathIsClassified);
+  MDMRunTest(testKindsMatchPublicKeyPaths);
+  MDMRunTest(testOtherKeyPathsAreRejected);
+  MDMRunTest(testKeyPathsNeedNotBeTerminated);
+  return MDMTestExitStatus();
+}
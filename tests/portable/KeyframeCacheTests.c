@@ -0,0 +1,148 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "MDMKeyframeCache.h"
+#include "MDMPortableTest.h"
+
+static MDMTimingCurve SpringCurve(double tension) {
+  MDMTimingCurve curve;
+  memset(&curve, 0, sizeof(curve));
+  curve.kind = MDMTimingCurveKindSpring;
+  MDMSpringSolverInit(&curve.spring, 1, tension, 20, 0);
+  return curve;
+}
+
+static void testLookupsMatchTheSampler(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(16);
+  MDMTimingCurve curve = SpringCurve(300);
+  MDMKeyframe expected[512];
+  size_t expectedCount = MDMKeyframeSamplerSample(&curve, 0.6, 1e-3, expected, 512);
+  for (int i = 0; i < 2; ++i) {
+    MDMKeyframe keyframes[512];
+    MDMAssertEqual(MDMKeyframeCacheLookup(cache, &curve, 0.6, 1e-3, keyframes, 512),
+                   expectedCount);
+    MDMAssertTrue(memcmp(keyframes, expected, expectedCount * sizeof(MDMKeyframe)) == 0);
+  }
+  MDMKeyframeCacheStatistics statistics = MDMKeyframeCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.misses, 1);
+  MDMAssertEqual(statistics.hits, 1);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+static void testEntriesAreKeyedByCurveDurationAndError(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(16);
+  MDMTimingCurve spring = SpringCurve(300);
+  MDMTimingCurve otherSpring = SpringCurve(400);
+  MDMTimingCurve bezier;
+  memset(&bezier, 0, sizeof(bezier));
+  bezier.kind = MDMTimingCurveKindCubicBezier;
+  MDMCubicBezierInit(&bezier.bezier, 0.4, 0, 0.2, 1);
+
+  MDMKeyframeCacheLookup(cache, &spring, 0.6, 1e-3, NULL, 0);
+  MDMKeyframeCacheLookup(cache, &otherSpring, 0.6, 1e-3, NULL, 0);
+  MDMKeyframeCacheLookup(cache, &spring, 0.7, 1e-3, NULL, 0);
+  MDMKeyframeCacheLookup(cache, &spring, 0.6, 1e-2, NULL, 0);
+  MDMKeyframeCacheLookup(cache, &bezier, 0.6, 1e-3, NULL, 0);
+  MDMKeyframeCacheLookup(cache, &spring, 0.6, 1e-3, NULL, 0);
+  MDMKeyframeCacheStatistics statistics = MDMKeyframeCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.misses, 5);
+  MDMAssertEqual(statistics.hits, 1);
+  MDMAssertEqual(statistics.count, 5);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+static void testCacheIsBounded(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(4);
+  for (int i = 0; i < 100; ++i) {
+    MDMTimingCurve curve = SpringCurve(100 + i);
+    MDMKeyframeCacheLookup(cache, &curve, 1, 1e-3, NULL, 0);
+  }
+  MDMKeyframeCacheStatistics statistics = MDMKeyframeCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.capacity, 4);
+  MDMAssertTrue(statistics.count <= 4);
+  MDMAssertEqual(statistics.evictions, 100 - statistics.count);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+static void testInvalidConfigurationsAreNotCached(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(4);
+  MDMTimingCurve curve = SpringCurve(100);
+  MDMKeyframe keyframes[4];
+  MDMAssertEqual(MDMKeyframeCacheLookup(cache, &curve, 0, 1e-3, keyframes, 4), 0);
+  MDMAssertEqual(MDMKeyframeCacheGetStatistics(cache).count, 0);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+static void testRemoveAllResetsTheCache(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(16);
+  MDMTimingCurve curve = SpringCurve(100);
+  MDMKeyframeCacheLookup(cache, &curve, 1, 1e-3, NULL, 0);
+  MDMKeyframeCacheRemoveAll(cache);
+  MDMKeyframeCacheStatistics statistics = MDMKeyframeCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.count, 0);
+  MDMAssertEqual(statistics.misses, 0);
+  MDMKeyframeCacheLookup(cache, &curve, 1, 1e-3, NULL, 0);
+  MDMAssertEqual(MDMKeyframeCacheGetStatistics(cache).misses, 1);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+#define kThreadCount 4
+#define kLookupsPerThread 2000
+
+static void *HammerCache(void *context) {
+  MDMKeyframeCache *cache = context;
+  for (int i = 0; i < kLookupsPerThread; ++i) {
+    MDMTimingCurve curve = SpringCurve(100 + i % 8);
+    MDMKeyframe keyframes[8];
+    MDMKeyframeCacheLookup(cache, &curve, 1, 1e-3, keyframes, 8);
+  }
+  return NULL;
+}
+
+static void testConcurrentLookups(void) {
+  MDMKeyframeCache *cache = MDMKeyframeCacheCreate(64);
+  pthread_t threads[kThreadCount];
+  for (int i = 0; i < kThreadCount; ++i) {
+    pthread_create(&threads[i], NULL, HammerCache, cache);
+  }
+  for (int i = 0; i < kThreadCount; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  MDMKeyframeCacheStatistics statistics = MDMKeyframeCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.hits + statistics.misses, kThreadCount * kLookupsPerThread);
+  MDMAssertEqual(statistics.count, 8);
+  MDMAssertTrue(statistics.misses <= 8 * kThreadCount);
+  MDMKeyframeCacheDestroy(cache);
+}
+
+static void testSharedCacheIsASingleton(void) {
+  MDMAssertTrue(MDMKeyframeCacheShared() != NULL);
+  MDMAssertTrue(MDMKeyframeCacheShared() == MDMKeyframeCacheShared());
+}
+
+int main(void) {
+  MDMRunTest(testLookupsMatchTheSampler);
+  MDMRunTest(testEntriesAreKeyedByCurveDurationAndError);
+  MDMRunTest(testCacheIsBounded);
+  MDMRunTest(testInvalidConfigurationsAreNotCached);
+  MDMRunTest(testRemoveAllResetsTheCache);
+  MDMRunTest(testConcurrentLookups);
+  MDMRunTest(testSharedCacheIsASingleton);
+  return MDMTestExitStatus();
+}
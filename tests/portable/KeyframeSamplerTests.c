@@ -0,0 +1,139 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MDMKeyframeSampler.h"
+#include "MDMPortableTest.h"
+
+static MDMTimingCurve SpringCurve(double mass, double tension, double friction) {
+  MDMTimingCurve curve;
+  memset(&curve, 0, sizeof(curve));
+  curve.kind = MDMTimingCurveKindSpring;
+  MDMSpringSolverInit(&curve.spring, mass, tension, friction, 0);
+  return curve;
+}
+
+static MDMTimingCurve BezierCurve(double x1, double y1, double x2, double y2) {
+  MDMTimingCurve curve;
+  memset(&curve, 0, sizeof(curve));
+  curve.kind = MDMTimingCurveKindCubicBezier;
+  MDMCubicBezierInit(&curve.bezier, x1, y1, x2, y2);
+  return curve;
+}
+
+// Linearly interpolates the keyframes at the fraction of time `time`.
+static double Interpolate(const MDMKeyframe *keyframes, size_t count, double time) {
+  for (size_t i = 1; i < count; ++i) {
+    if (time <= keyframes[i].time) {
+      double span = keyframes[i].time - keyframes[i - 1].time;
+      double fraction = (time - keyframes[i - 1].time) / span;
+      return keyframes[i - 1].progress
+             + (keyframes[i].progress - keyframes[i - 1].progress) * fraction;
+    }
+  }
+  return keyframes[count - 1].progress;
+}
+
+static size_t AssertKeyframesApproximate(const MDMTimingCurve *curve, double duration,
+                                         double maximumError) {
+  MDMKeyframe keyframes[512];
+  size_t count = MDMKeyframeSamplerSample(curve, duration, maximumError, keyframes, 512);
+  MDMAssertTrue(count >= 2 && count <= 512);
+  MDMAssertEqualWithAccuracy(keyframes[0].time, 0, 0);
+  MDMAssertEqualWithAccuracy(keyframes[count - 1].time, 1, 0);
+  for (size_t i = 1; i < count; ++i) {
+    MDMAssertTrue(keyframes[i].time > keyframes[i - 1].time);
+  }
+
+  // The error is bounded on the sampling grid. Between its samples the chords may additionally
+  // deviate by the curvature of the curve over a millisecond.
+  size_t gridCount = (size_t)ceil(duration * MDMKeyframeSamplerSamplesPerSecond);
+  for (size_t i = 0; i <= gridCount * 10; ++i) {
+    double time = (double)i / (double)(gridCount * 10);
+    double expected = MDMTimingCurveProgress(curve, time * duration, duration);
+    double accuracy = (i % 10 == 0) ? maximumError * (1 + 1e-6) : maximumError + 1e-4;
+    MDMAssertEqualWithAccuracy(Interpolate(keyframes, count, time), expected, accuracy);
+  }
+  return count;
+}
+
+static void testSpringsAreApproximatedWithinTheError(void) {
+  MDMTimingCurve underdamped = SpringCurve(1, 300, 10);
+  double duration = MDMSpringSolverSettlingDuration(&underdamped.spring,
+                                                    MDMSpringSolverDefaultSettlingThreshold);
+  AssertKeyframesApproximate(&underdamped, duration, 1e-3);
+
+  MDMTimingCurve critical = SpringCurve(1, 100, 20);
+  duration = MDMSpringSolverSettlingDuration(&critical.spring,
+                                             MDMSpringSolverDefaultSettlingThreshold);
+  AssertKeyframesApproximate(&critical, duration, 1e-3);
+}
+
+static void testBeziersAreApproximatedWithinTheError(void) {
+  MDMTimingCurve standard = BezierCurve(0.4, 0, 0.2, 1);
+  AssertKeyframesApproximate(&standard, 0.3, 1e-3);
+  MDMTimingCurve overshoot = BezierCurve(0.3, -0.5, 0.7, 1.5);
+  AssertKeyframesApproximate(&overshoot, 1, 1e-4);
+}
+
+static void testLinearCurvesNeedTwoKeyframes(void) {
+  MDMTimingCurve linear;
+  memset(&linear, 0, sizeof(linear));
+  linear.kind = MDMTimingCurveKindLinear;
+  MDMAssertEqual(AssertKeyframesApproximate(&linear, 2, 1e-6), 2);
+}
+
+static void testLargerErrorsNeedFewerKeyframes(void) {
+  MDMTimingCurve spring = SpringCurve(1, 300, 10);
+  double duration = MDMSpringSolverSettlingDuration(&spring.spring,
+                                                    MDMSpringSolverDefaultSettlingThreshold);
+  size_t fine = AssertKeyframesApproximate(&spring, duration, 1e-4);
+  size_t coarse = AssertKeyframesApproximate(&spring, duration, 1e-2);
+  MDMAssertTrue(coarse < fine);
+  // Fewer than a keyframe per frame at 60 frames per second.
+  MDMAssertTrue(AssertKeyframesApproximate(&spring, duration, 1e-3) < duration * 60);
+}
+
+static void testCapacityLimitsTheKeyframesWritten(void) {
+  MDMTimingCurve curve = BezierCurve(0.4, 0, 0.2, 1);
+  MDMKeyframe all[512];
+  size_t count = MDMKeyframeSamplerSample(&curve, 0.3, 1e-3, all, 512);
+  MDMKeyframe some[3] = {{-1, -1}, {-1, -1}, {-1, -1}};
+  MDMAssertEqual(MDMKeyframeSamplerSample(&curve, 0.3, 1e-3, some, 2), count);
+  MDMAssertEqualWithAccuracy(some[1].time, all[1].time, 0);
+  MDMAssertEqualWithAccuracy(some[2].time, -1, 0);
+  MDMAssertEqual(MDMKeyframeSamplerSample(&curve, 0.3, 1e-3, NULL, 0), count);
+}
+
+static void testInvalidArgumentsProduceNoKeyframes(void) {
+  MDMTimingCurve curve = BezierCurve(0.4, 0, 0.2, 1);
+  MDMKeyframe keyframes[4];
+  MDMAssertEqual(MDMKeyframeSamplerSample(&curve, 0, 1e-3, keyframes, 4), 0);
+  MDMAssertEqual(MDMKeyframeSamplerSample(&curve, INFINITY, 1e-3, keyframes, 4), 0);
+  MDMAssertEqual(MDMKeyframeSamplerSample(&curve, 1, 0, keyframes, 4), 0);
+}
+
+int main(void) {
+  MDMRunTest(testSpringsAreApproximatedWithinTheError);
+  MDMRunTest(testBeziersAreApproximatedWithinTheError);
+  MDMRunTest(testLinearCurvesNeedTwoKeyframes);
+  MDMRunTest(testLargerErrorsNeedFewerKeyframes);
+  MDMRunTest(testCapacityLimitsTheKeyframesWritten);
+  MDMRunTest(testInvalidArgumentsProduceNoKeyframes);
+  return MDMTestExitStatus();
+}
@@ -0,0 +1,58 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_PORTABLE_TEST_H
+#define MDM_PORTABLE_TEST_H
+
+// A minimal assertion harness for the portable C tests. Each test binary defines its test cases as
+// functions and lists them in main() via MDMRunTest.
+
+#include <math.h>
+#include <stdio.h>
+
+static int sMDMTestFailureCount = 0;
+
+#define MDMAssertTrue(expression)                                                   \
+  do {                                                                              \
+    if (!(expression)) {                                                            \
+      fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #expression); \
+      sMDMTestFailureCount++;                                                       \
+    }                                                                               \
+  } while (0)
+
+#define MDMAssertEqual(actual, expected) MDMAssertTrue((actual) == (expected))
+
+#define MDMAssertEqualWithAccuracy(actual, expected, accuracy)                          \
+  do {                                                                                  \
+    double mdm_actual = (double)(actual);                                               \
+    double mdm_expected = (double)(expected);                                           \
+    if (!(fabs(mdm_actual - mdm_expected) <= (double)(accuracy))) {                     \
+      fprintf(stderr, "%s:%d: %s = %.9g, expected %.9g (+/- %g)\n", __FILE__, __LINE__, \
+              #actual, mdm_actual, mdm_expected, (double)(accuracy));                   \
+      sMDMTestFailureCount++;                                                           \
+    }                                                                                   \
+  } while (0)
+
+#define MDMRunTest(test)                    \
+  do {                                      \
+    int mdm_failures = sMDMTestFailureCount; \
+    test();                                 \
+    printf("%s %s\n", sMDMTestFailureCount == mdm_failures ? "PASS" : "FAIL", #test); \
+  } while (0)
+
+#define MDMTestExitStatus() (sMDMTestFailureCount == 0 ? 0 : 1)
+
+#endif  // MDM_PORTABLE_TEST_H
@@ -0,0 +1,142 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "MDMMotionSpecTable.h"
+#include "MDMPortableTest.h"
+
+static const MDMMotionSpecCurve kCurves[] = {
+  MDMMotionSpecCubicBezier(0.4, 0, 0.2, 1),
+  MDMMotionSpecCubicBezier(0, 0, 1, 1),
+  MDMMotionSpecSpring(1, 100, 10, 0),
+};
+
+static const MDMMotionSpecEntry kEntries[] = {
+  MDMMotionSpecEntryMake(0.000, 0.285, 0),
+  MDMMotionSpecEntryMake(0.015, 0.360, 0),
+  MDMMotionSpecEntryMake(0.075, 0.150, 1),
+  MDMMotionSpecEntryMake(0.000, 0.500, 2),
+};
+
+static const MDMMotionSpecTable kTable = MDMMotionSpecTableMake(kCurves, kEntries);
+
+// Serialized tables are used in place, so the buffer must be suitably aligned.
+typedef union {
+  unsigned char bytes[512];
+  double alignment;
+} Buffer;
+
+static void testTableMacros(void) {
+  MDMAssertEqual(kTable.curveCount, 3);
+  MDMAssertEqual(kTable.entryCount, 4);
+  MDMAssertTrue(MDMMotionSpecTableValidate(&kTable));
+}
+
+static void testValidationRejectsInvalidEntries(void) {
+  MDMMotionSpecEntry entries[] = {MDMMotionSpecEntryMake(0, 0.3, 3)};
+  MDMMotionSpecTable table = MDMMotionSpecTableMake(kCurves, entries);
+  MDMAssertTrue(!MDMMotionSpecTableValidate(&table));
+
+  entries[0] = (MDMMotionSpecEntry)MDMMotionSpecEntryMake(-0.1, 0.3, 0);
+  MDMAssertTrue(!MDMMotionSpecTableValidate(&table));
+
+  MDMMotionSpecCurve curves[] = {MDMMotionSpecCubicBezier(0.4, 0, 0.2, 1)};
+  curves[0].kind = 7;
+  entries[0] = (MDMMotionSpecEntry)MDMMotionSpecEntryMake(0, 0.3, 0);
+  MDMMotionSpecTable badCurve = MDMMotionSpecTableMake(curves, entries);
+  MDMAssertTrue(!MDMMotionSpecTableValidate(&badCurve));
+}
+
+static void testRoundTripIsZeroCopy(void) {
+  Buffer buffer;
+  size_t size = MDMMotionSpecTableSerializedSize(&kTable);
+  MDMAssertEqual(size, 24 + 3 * 40 + 4 * 24);
+  MDMAssertEqual(MDMMotionSpecTableSerialize(&kTable, buffer.bytes, sizeof(buffer.bytes)), size);
+
+  MDMMotionSpecTable table;
+  MDMAssertTrue(MDMMotionSpecTableInitWithBytes(&table, buffer.bytes, size));
+  MDMAssertTrue(MDMMotionSpecTableEqual(&table, &kTable));
+  MDMAssertEqual(MDMMotionSpecTableHash(&table), MDMMotionSpecTableHash(&kTable));
+  MDMAssertTrue((const void *)table.curves == (const void *)(buffer.bytes + 24));
+  MDMAssertEqualWithAccuracy(table.entries[1].duration, 0.360, 0);
+}
+
+static void testSerializationRejectsSmallBuffers(void) {
+  Buffer buffer;
+  size_t size = MDMMotionSpecTableSerializedSize(&kTable);
+  MDMAssertEqual(MDMMotionSpecTableSerialize(&kTable, buffer.bytes, size - 1), 0);
+}
+
+static void testInitRejectsMalformedBytes(void) {
+  Buffer buffer;
+  size_t size = MDMMotionSpecTableSerialize(&kTable, buffer.bytes, sizeof(buffer.bytes));
+  MDMMotionSpecTable table;
+
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, buffer.bytes, size - 1));
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, buffer.bytes, 10));
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, NULL, size));
+
+  Buffer shifted;
+  memcpy(shifted.bytes + 4, buffer.bytes, size);
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, shifted.bytes + 4, size));
+
+  Buffer corrupted = buffer;
+  corrupted.bytes[0] = 'X';
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, corrupted.bytes, size));
+
+  // A byte-swapped byte order mark.
+  corrupted = buffer;
+  uint32_t swapped = 0x04030201;
+  memcpy(corrupted.bytes + 4, &swapped, sizeof(swapped));
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, corrupted.bytes, size));
+
+  // A count that would overflow the size computation.
+  corrupted = buffer;
+  uint32_t hugeCount = UINT32_MAX;
+  memcpy(corrupted.bytes + 12, &hugeCount, sizeof(hugeCount));
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, corrupted.bytes, size));
+
+  // An entry referring to a curve that doesn't exist.
+  corrupted = buffer;
+  uint32_t curveIndex = 9;
+  memcpy(corrupted.bytes + 24 + 3 * 40 + 16, &curveIndex, sizeof(curveIndex));
+  MDMAssertTrue(!MDMMotionSpecTableInitWithBytes(&table, corrupted.bytes, size));
+}
+
+static void testEqualityAndHash(void) {
+  MDMMotionSpecEntry entries[sizeof(kEntries) / sizeof(kEntries[0])];
+  memcpy(entries, kEntries, sizeof(kEntries));
+  entries[0].reserved = 42;  // Not part of the table's contents.
+  MDMMotionSpecTable table = MDMMotionSpecTableMake(kCurves, entries);
+  MDMAssertTrue(MDMMotionSpecTableEqual(&table, &kTable));
+  MDMAssertEqual(MDMMotionSpecTableHash(&table), MDMMotionSpecTableHash(&kTable));
+
+  entries[2].duration = 0.151;
+  MDMAssertTrue(!MDMMotionSpecTableEqual(&table, &kTable));
+  MDMAssertTrue(MDMMotionSpecTableHash(&table) != MDMMotionSpecTableHash(&kTable));
+}
+
+int main(void) {
+  MDMRunTest(testTableMacros);
+  MDMRunTest(testValidationRejectsInvalidEntries);
+  MDMRunTest(testRoundTripIsZeroCopy);
+  MDMRunTest(testSerializationRejectsSmallBuffers);
+  MDMRunTest(testInitRejectsMalformedBytes);
+  MDMRunTest(testEqualityAndHash);
+  return MDMTestExitStatus();
+}
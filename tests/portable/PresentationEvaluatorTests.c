@@ -0,0 +1,232 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MDMPortableTest.h"
+#include "MDMPresentationEvaluator.h"
+
+static MDMValue Scalar(double lane) {
+  MDMValue value;
+  MDMValueInit(&value, MDMValueTypeScalar, &lane);
+  return value;
+}
+
+static MDMEvaluatorAnimation LinearAnimation(double from, double to, int additive,
+                                             double beginTime, double duration) {
+  MDMEvaluatorAnimation animation;
+  memset(&animation, 0, sizeof(animation));
+  animation.fromValue = Scalar(from);
+  animation.toValue = Scalar(to);
+  animation.additive = additive;
+  animation.beginTime = beginTime;
+  animation.duration = duration;
+  animation.fillMode = MDMFillModeRemoved;
+  animation.timingCurve.kind = MDMTimingCurveKindLinear;
+  return animation;
+}
+
+static double EvaluateScalar(double model, const MDMEvaluatorAnimation *animations, size_t count,
+                             double time) {
+  MDMEvaluatorStack stack = {Scalar(model), animations, count};
+  MDMValue result;
+  MDMAssertTrue(MDMEvaluatorEvaluate(&stack, time, &result));
+  return result.lanes[0];
+}
+
+// Finds y for x by densely sampling the curve's parameter.
+static double ReferenceBezierProgress(const double controlPoints[4], double x) {
+  double bestT = 0;
+  double bestError = INFINITY;
+  for (int i = 0; i <= 200000; ++i) {
+    double t = i / 200000.0;
+    double u = 1 - t;
+    double curveX = 3 * u * u * t * controlPoints[0] + 3 * u * t * t * controlPoints[2] + t * t * t;
+    if (fabs(curveX - x) < bestError) {
+      bestError = fabs(curveX - x);
+      bestT = t;
+    }
+  }
+  double u = 1 - bestT;
+  return (3 * u * u * bestT * controlPoints[1] + 3 * u * bestT * bestT * controlPoints[3]
+          + bestT * bestT * bestT);
+}
+
+static void testAdditiveAnimationsAreSummedOntoTheModelValue(void) {
+  // Animating from 50 to 100 and then, halfway through, retargeting to 200.
+  MDMEvaluatorAnimation animations[2] = {
+    LinearAnimation(-50, 0, 1, 0, 1),
+    LinearAnimation(-100, 0, 1, 0.5, 1),
+  };
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, animations, 1, 0.5), 75, 1e-12);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(200, animations, 2, 0.5), 75, 1e-12);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(200, animations, 2, 1), 150, 1e-12);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(200, animations, 2, 2), 200, 1e-12);
+}
+
+static void testNonAdditiveAnimationsReplaceTheValueBelowThem(void) {
+  MDMEvaluatorAnimation animations[3] = {
+    LinearAnimation(-50, 0, 1, 0, 1),
+    LinearAnimation(0, 10, 0, 0, 1),
+    LinearAnimation(4, 0, 1, 0, 1),
+  };
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, animations, 3, 0.5), 5 + 2, 1e-12);
+}
+
+static void testFillModes(void) {
+  MDMEvaluatorAnimation animation = LinearAnimation(-50, 0, 1, 1, 1);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, &animation, 1, 0.5), 100, 0);
+  animation.fillMode = MDMFillModeBackwards;
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, &animation, 1, 0.5), 50, 0);
+
+  animation = LinearAnimation(0, 10, 0, 0, 1);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, &animation, 1, 1.5), 100, 0);
+  animation.fillMode = MDMFillModeForwards;
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, &animation, 1, 1.5), 10, 0);
+}
+
+static void testZeroDurationDefaultsToAQuarterSecond(void) {
+  MDMEvaluatorAnimation animation = LinearAnimation(0, 1, 0, 0, 0);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(5, &animation, 1, 0.125), 0.5, 1e-12);
+}
+
+static void testCubicBezierMatchesReference(void) {
+  const double curves[][4] = {
+    {0.42, 0, 0.58, 1},
+    {0.4, 0, 0.2, 1},
+    {0.0, 0, 0.2, 1},
+    {0.4, 0, 1, 1},
+    {0.25, 0.1, 0.25, 1},
+    {0.5, -0.5, 0.5, 1.5},
+  };
+  for (size_t c = 0; c < sizeof(curves) / sizeof(curves[0]); ++c) {
+    MDMTimingCurve curve;
+    memset(&curve, 0, sizeof(curve));
+    curve.kind = MDMTimingCurveKindCubicBezier;
+    MDMCubicBezierInit(&curve.bezier, curves[c][0], curves[c][1], curves[c][2], curves[c][3]);
+    for (int i = 0; i <= 20; ++i) {
+      double fraction = i / 20.0;
+      MDMAssertEqualWithAccuracy(MDMTimingCurveProgress(&curve, fraction, 2),
+                                 ReferenceBezierProgress(curves[c], fraction / 2), 1e-4);
+    }
+  }
+}
+
+static void testSpringsProgressInElapsedTime(void) {
+  MDMEvaluatorAnimation animation = LinearAnimation(-100, 0, 1, 0, 2);
+  animation.timingCurve.kind = MDMTimingCurveKindSpring;
+  MDMSpringSolverInit(&animation.timingCurve.spring, 1, 200, 20, 0);
+  double expected = 100 - 100 + 100 * MDMSpringSolverPosition(&animation.timingCurve.spring, 0.3);
+  MDMAssertEqualWithAccuracy(EvaluateScalar(100, &animation, 1, 0.3), expected, 1e-12);
+}
+
+static void testVelocityMatchesFiniteDifferences(void) {
+  MDMEvaluatorAnimation animations[3] = {
+    LinearAnimation(-50, 0, 1, 0, 1),
+    LinearAnimation(-100, 0, 1, 0.25, 1),
+    LinearAnimation(30, 0, 1, 0.1, 2),
+  };
+  animations[1].timingCurve.kind = MDMTimingCurveKindCubicBezier;
+  MDMCubicBezierInit(&animations[1].timingCurve.bezier, 0.4, 0, 0.2, 1);
+  animations[2].timingCurve.kind = MDMTimingCurveKindSpring;
+  MDMSpringSolverInit(&animations[2].timingCurve.spring, 1, 200, 10, 3);
+
+  for (int i = 0; i < 20; ++i) {
+    double time = 0.013 + i * 0.061;  // Away from the animations' discontinuities.
+    MDMEvaluatorStack stack = {Scalar(100), animations, 3};
+    MDMValue velocity;
+    MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&stack, time, &velocity));
+    double h = 1e-6;
+    double expected = (EvaluateScalar(100, animations, 3, time + h)
+                       - EvaluateScalar(100, animations, 3, time - h)) / (2 * h);
+    MDMAssertEqualWithAccuracy(velocity.lanes[0], expected, 1e-3);
+  }
+
+  // Animations outside of their active duration don't move.
+  MDMEvaluatorAnimation animation = LinearAnimation(0, 10, 0, 1, 1);
+  animation.fillMode = MDMFillModeBoth;
+  MDMEvaluatorStack stack = {Scalar(100), &animation, 1};
+  MDMValue velocity;
+  MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&stack, 0.5, &velocity));
+  MDMAssertEqualWithAccuracy(velocity.lanes[0], 0, 0);
+  MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&stack, 1.5, &velocity));
+  MDMAssertEqualWithAccuracy(velocity.lanes[0], 10, 1e-12);
+  MDMAssertTrue(MDMEvaluatorEvaluateVelocity(&stack, 2.5, &velocity));
+  MDMAssertEqualWithAccuracy(velocity.lanes[0], 0, 0);
+}
+
+static void testVectorTypes(void) {
+  const double fromLanes[4] = {-10, -20, -30, -40};
+  const double modelLanes[4] = {100, 200, 300, 400};
+  MDMEvaluatorAnimation animation = LinearAnimation(0, 0, 1, 0, 1);
+  MDMValueInit(&animation.fromValue, MDMValueTypeRect, fromLanes);
+  MDMValueInitAdditiveIdentity(&animation.toValue, MDMValueTypeRect);
+  MDMEvaluatorStack stack = {{MDMValueTypeRect, {0}}, &animation, 1};
+  MDMValueInit(&stack.modelValue, MDMValueTypeRect, modelLanes);
+  MDMValue result;
+  MDMAssertTrue(MDMEvaluatorEvaluate(&stack, 0.25, &result));
+  MDMAssertEqual(result.type, MDMValueTypeRect);
+  for (int lane = 0; lane < 4; ++lane) {
+    MDMAssertEqualWithAccuracy(result.lanes[lane], modelLanes[lane] + fromLanes[lane] * 0.75,
+                               1e-12);
+  }
+}
+
+static void testUnsupportedStacksAreRejected(void) {
+  MDMEvaluatorAnimation animation = LinearAnimation(0, 1, 0, 0, 1);
+  MDMEvaluatorStack stack = {Scalar(3), &animation, 1};
+  MDMValueInitAdditiveIdentity(&stack.modelValue, MDMValueTypePoint);
+  MDMValue result = Scalar(42);
+  MDMAssertTrue(!MDMEvaluatorEvaluate(&stack, 0.5, &result));
+  MDMAssertEqualWithAccuracy(result.lanes[0], 42, 0);
+
+  MDMValueInitAdditiveIdentity(&stack.modelValue, MDMValueTypeTransform3D);
+  stack.count = 0;
+  MDMAssertTrue(!MDMEvaluatorEvaluate(&stack, 0.5, &result));
+}
+
+static void testBatchEvaluation(void) {
+  MDMEvaluatorAnimation animation = LinearAnimation(-10, 0, 1, 0, 1);
+  MDMEvaluatorStack stacks[3] = {
+    {Scalar(1), &animation, 1},
+    {Scalar(2), &animation, 1},
+    {Scalar(3), &animation, 1},
+  };
+  MDMValueInitAdditiveIdentity(&stacks[1].modelValue, MDMValueTypeTransform3D);
+  MDMValue results[3];
+  int statuses[3];
+  MDMAssertEqual(MDMEvaluatorEvaluateBatch(stacks, 3, 0.5, results, statuses), 2);
+  MDMAssertEqual(statuses[0], 1);
+  MDMAssertEqual(statuses[1], 0);
+  MDMAssertEqual(statuses[2], 1);
+  MDMAssertEqualWithAccuracy(results[0].lanes[0], -4, 1e-12);
+  MDMAssertEqualWithAccuracy(results[2].lanes[0], -2, 1e-12);
+}
+
+int main(void) {
+  MDMRunTest(testAdditiveAnimationsAreSummedOntoTheModelValue);
+  MDMRunTest(testNonAdditiveAnimationsReplaceTheValueBelowThem);
+  MDMRunTest(testFillModes);
+  MDMRunTest(testZeroDurationDefaultsToAQuarterSecond);
+  MDMRunTest(testCubicBezierMatchesReference);
+  MDMRunTest(testSpringsProgressInElapsedTime);
+  MDMRunTest(testVelocityMatchesFiniteDifferences);
+  MDMRunTest(testVectorTypes);
+  MDMRunTest(testUnsupportedStacksAreRejected);
+  MDMRunTest(testBatchEvaluation);
+  return MDMTestExitStatus();
+}
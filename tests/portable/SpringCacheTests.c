@@ -0,0 +1,200 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <pthread.h>
+
+#include "MDMPortableTest.h"
+#include "MDMSpringCache.h"
+
+typedef struct {
+  int invocationCount;
+} ResolverContext;
+
+static int CountingResolver(void *context, double coefficients[4]) {
+  ((ResolverContext *)context)->invocationCount++;
+  coefficients[0] = 1;
+  coefficients[1] = 200;
+  coefficients[2] = 20;
+  coefficients[3] = 0;
+  return 1;
+}
+
+static void testSolutionMatchesSolver(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  MDMSpringCacheSolution solution;
+  MDMAssertTrue(MDMSpringCacheSolve(cache, 1, 100, 10, 0.5, &solution));
+
+  MDMSpringSolver solver;
+  MDMSpringSolverInit(&solver, 1, 100, 10, 0.5);
+  MDMAssertEqualWithAccuracy(solution.settlingDuration,
+                             MDMSpringSolverSettlingDuration(&solver,
+                                                             MDMSpringSolverDefaultSettlingThreshold),
+                             0);
+  MDMAssertEqualWithAccuracy(MDMSpringSolverPosition(&solution.solver, 0.3),
+                             MDMSpringSolverPosition(&solver, 0.3), 0);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testRepeatedConfigurationsAreSolvedOnce(void) {
+  // Simulates a list of 200 springing cells that share three spring configurations.
+  MDMSpringCache *cache = MDMSpringCacheCreate(64);
+  const double tensions[] = {100, 300, 500};
+  for (int cell = 0; cell < 200; ++cell) {
+    MDMSpringCacheSolution solution;
+    MDMSpringCacheSolve(cache, 1, tensions[cell % 3], 20, 0, &solution);
+  }
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.misses, 3);
+  MDMAssertEqual(statistics.hits, 197);
+  MDMAssertEqual(statistics.count, 3);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testKeysAreQuantized(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  MDMSpringCacheSolution solution;
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0.25, &solution);
+  MDMSpringCacheSolve(cache, 1 + 1e-9, 100 - 1e-9, 10, 0.25 + 1e-7, &solution);
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0.26, &solution);
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.hits, 1);
+  MDMAssertEqual(statistics.misses, 2);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testCacheIsBounded(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(4);
+  for (int i = 0; i < 100; ++i) {
+    MDMSpringCacheSolution solution;
+    MDMSpringCacheSolve(cache, 1, 100 + i, 10, 0, &solution);
+  }
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.capacity, 4);
+  MDMAssertTrue(statistics.count <= 4);
+  MDMAssertEqual(statistics.evictions, 100 - statistics.count);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testLeastRecentlyUsedEntryIsEvicted(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(2);
+  MDMSpringCacheSolution solution;
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0, &solution);
+  MDMSpringCacheSolve(cache, 1, 200, 10, 0, &solution);
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0, &solution);  // Hit; 200 is now least recently used.
+  MDMSpringCacheSolve(cache, 1, 300, 10, 0, &solution);  // Evicts 200.
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0, &solution);  // Hit.
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.hits, 2);
+  MDMAssertEqual(statistics.misses, 3);
+  MDMAssertEqual(statistics.evictions, 1);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testInvalidSpringsAreCached(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  MDMSpringCacheSolution solution;
+  MDMAssertTrue(!MDMSpringCacheSolve(cache, 0, 100, 10, 0, &solution));
+  MDMAssertTrue(!MDMSpringCacheSolve(cache, 0, 100, 10, 0, &solution));
+  MDMAssertEqual(MDMSpringCacheGetStatistics(cache).hits, 1);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testNonFiniteKeysBypassTheCache(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  MDMSpringCacheSolution solution;
+  MDMAssertTrue(!MDMSpringCacheSolve(cache, 1, 100, 10, INFINITY, &solution));
+  MDMAssertEqual(MDMSpringCacheGetStatistics(cache).count, 0);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testGeneratorsAreResolvedOncePerConfiguration(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  ResolverContext context = {0};
+  double coefficients[4];
+  for (int i = 0; i < 50; ++i) {
+    MDMAssertTrue(MDMSpringCacheResolveGenerator(cache, 0.5, 0.8, 0, CountingResolver, &context,
+                                                 coefficients));
+  }
+  MDMAssertEqual(context.invocationCount, 1);
+  MDMAssertEqualWithAccuracy(coefficients[1], 200, 0);
+
+  // Generator and spring keys live in separate namespaces.
+  MDMSpringCacheSolution solution;
+  MDMSpringCacheSolve(cache, 0.5, 0.8, 0, 0, &solution);
+  MDMAssertEqual(MDMSpringCacheGetStatistics(cache).misses, 2);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testRemoveAllResetsTheCache(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(16);
+  MDMSpringCacheSolution solution;
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0, &solution);
+  MDMSpringCacheRemoveAll(cache);
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.count, 0);
+  MDMAssertEqual(statistics.misses, 0);
+  MDMSpringCacheSolve(cache, 1, 100, 10, 0, &solution);
+  MDMAssertEqual(MDMSpringCacheGetStatistics(cache).misses, 1);
+  MDMSpringCacheDestroy(cache);
+}
+
+#define kThreadCount 4
+#define kLookupsPerThread 10000
+
+static void *HammerCache(void *context) {
+  MDMSpringCache *cache = context;
+  for (int i = 0; i < kLookupsPerThread; ++i) {
+    MDMSpringCacheSolution solution;
+    MDMSpringCacheSolve(cache, 1, 100 + i % 16, 10, 0, &solution);
+  }
+  return NULL;
+}
+
+static void testConcurrentLookups(void) {
+  MDMSpringCache *cache = MDMSpringCacheCreate(64);
+  pthread_t threads[kThreadCount];
+  for (int i = 0; i < kThreadCount; ++i) {
+    pthread_create(&threads[i], NULL, HammerCache, cache);
+  }
+  for (int i = 0; i < kThreadCount; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  MDMSpringCacheStatistics statistics = MDMSpringCacheGetStatistics(cache);
+  MDMAssertEqual(statistics.hits + statistics.misses, kThreadCount * kLookupsPerThread);
+  MDMAssertEqual(statistics.count, 16);
+  MDMAssertTrue(statistics.misses <= 16 * kThreadCount);
+  MDMSpringCacheDestroy(cache);
+}
+
+static void testSharedCacheIsASingleton(void) {
+  MDMAssertTrue(MDMSpringCacheShared() != NULL);
+  MDMAssertTrue(MDMSpringCacheShared() == MDMSpringCacheShared());
+}
+
+int main(void) {
+  MDMRunTest(testSolutionMatchesSolver);
+  MDMRunTest(testRepeatedConfigurationsAreSolvedOnce);
+  MDMRunTest(testKeysAreQuantized);
+  MDMRunTest(testCacheIsBounded);
+  MDMRunTest(testLeastRecentlyUsedEntryIsEvicted);
+  MDMRunTest(testInvalidSpringsAreCached);
+  MDMRunTest(testNonFiniteKeysBypassTheCache);
+  MDMRunTest(testGeneratorsAreResolvedOncePerConfiguration);
+  MDMRunTest(testRemoveAllResetsTheCache);
+  MDMRunTest(testConcurrentLookups);
+  MDMRunTest(testSharedCacheIsASingleton);
+  return MDMTestExitStatus();
+}
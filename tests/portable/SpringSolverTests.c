@@ -0,0 +1,164 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMPortableTest.h"
+#include "MDMSpringSolver.h"
+
+typedef struct {
+  double mass;
+  double tension;
+  double friction;
+  double initialVelocity;
+} SpringCoefficients;
+
+static const SpringCoefficients kSprings[] = {
+  {1, 100, 10, 0},    // Underdamped, Core Animation's defaults.
+  {1, 100, 10, 5},    // Underdamped, moving towards the destination.
+  {1, 100, 10, -5},   // Underdamped, moving away from the destination.
+  {1, 100, 20, 0},    // Critically damped.
+  {1, 100, 20, 12},   // Critically damped with overshoot.
+  {1, 100, 50, 0},    // Overdamped.
+  {2, 250, 60, -3},   // Overdamped, moving away from the destination.
+  {1, 1, 1, 0.5},     // The coefficients used by InitialVelocityTests.swift.
+};
+static const size_t kSpringCount = sizeof(kSprings) / sizeof(kSprings[0]);
+
+// Reference solution: integrates m x'' + c x' + k x = 0 with fourth-order Runge-Kutta.
+static void IntegrateSpring(SpringCoefficients spring, double duration, double *position,
+                            double *velocity) {
+  const double dt = 1e-4;
+  double x = 1;
+  double v = -spring.initialVelocity;
+  for (double t = 0; t < duration - dt / 2; t += dt) {
+#define ACCELERATION(px, pv) (-(spring.tension * (px) + spring.friction * (pv)) / spring.mass)
+    double k1x = v;
+    double k1v = ACCELERATION(x, v);
+    double k2x = v + k1v * dt / 2;
+    double k2v = ACCELERATION(x + k1x * dt / 2, v + k1v * dt / 2);
+    double k3x = v + k2v * dt / 2;
+    double k3v = ACCELERATION(x + k2x * dt / 2, v + k2v * dt / 2);
+    double k4x = v + k3v * dt;
+    double k4v = ACCELERATION(x + k3x * dt, v + k3v * dt);
+#undef ACCELERATION
+    x += (k1x + 2 * k2x + 2 * k3x + k4x) * dt / 6;
+    v += (k1v + 2 * k2v + 2 * k3v + k4v) * dt / 6;
+  }
+  *position = 1 - x;
+  *velocity = -v;
+}
+
+static void testInitialConditions(void) {
+  for (size_t i = 0; i < kSpringCount; ++i) {
+    SpringCoefficients spring = kSprings[i];
+    MDMSpringSolver solver;
+    MDMAssertTrue(MDMSpringSolverInit(&solver, spring.mass, spring.tension, spring.friction,
+                                      spring.initialVelocity));
+    MDMAssertEqualWithAccuracy(MDMSpringSolverPosition(&solver, 0), 0, 1e-12);
+    MDMAssertEqualWithAccuracy(MDMSpringSolverVelocity(&solver, 0), spring.initialVelocity, 1e-9);
+  }
+}
+
+static void testRegimes(void) {
+  MDMSpringSolver solver;
+  MDMSpringSolverInit(&solver, 1, 100, 10, 0);
+  MDMAssertEqual(solver.regime, MDMSpringSolverRegimeUnderdamped);
+  MDMAssertEqualWithAccuracy(solver.dampingRatio, 0.5, 1e-12);
+
+  MDMSpringSolverInit(&solver, 1, 100, 20, 0);
+  MDMAssertEqual(solver.regime, MDMSpringSolverRegimeCriticallyDamped);
+
+  MDMSpringSolverInit(&solver, 1, 100, 50, 0);
+  MDMAssertEqual(solver.regime, MDMSpringSolverRegimeOverdamped);
+}
+
+static void testPositionAndVelocityMatchNumericalIntegration(void) {
+  const double times[] = {0.05, 0.1, 0.25, 0.5, 1.0};
+  for (size_t i = 0; i < kSpringCount; ++i) {
+    SpringCoefficients spring = kSprings[i];
+    MDMSpringSolver solver;
+    MDMSpringSolverInit(&solver, spring.mass, spring.tension, spring.friction,
+                        spring.initialVelocity);
+    for (size_t j = 0; j < sizeof(times) / sizeof(times[0]); ++j) {
+      double position;
+      double velocity;
+      IntegrateSpring(spring, times[j], &position, &velocity);
+      MDMAssertEqualWithAccuracy(MDMSpringSolverPosition(&solver, times[j]), position, 1e-6);
+      MDMAssertEqualWithAccuracy(MDMSpringSolverVelocity(&solver, times[j]), velocity, 1e-5);
+    }
+  }
+}
+
+static void testSpringStaysSettledAfterSettlingDuration(void) {
+  const double threshold = MDMSpringSolverDefaultSettlingThreshold;
+  for (size_t i = 0; i < kSpringCount; ++i) {
+    SpringCoefficients spring = kSprings[i];
+    MDMSpringSolver solver;
+    MDMSpringSolverInit(&solver, spring.mass, spring.tension, spring.friction,
+                        spring.initialVelocity);
+    double settlingDuration = MDMSpringSolverSettlingDuration(&solver, threshold);
+    MDMAssertTrue(settlingDuration > 0 && isfinite(settlingDuration));
+    for (int step = 0; step <= 1000; ++step) {
+      double t = settlingDuration * (1 + step / 100.0);
+      MDMAssertTrue(fabs(1 - MDMSpringSolverPosition(&solver, t)) <= threshold + 1e-12);
+    }
+  }
+}
+
+static void testUnderdampedSettlingDurationIsClosedForm(void) {
+  MDMSpringSolver solver;
+  MDMSpringSolverInit(&solver, 1, 100, 10, 0);
+  // x(t) = e^(-5t) (cos(wt) + (5 / w) sin(wt)), amplitude = 1 / sqrt(1 - 0.25).
+  double amplitude = 1 / sqrt(0.75);
+  MDMAssertEqualWithAccuracy(MDMSpringSolverSettlingDuration(&solver, 0.001),
+                             log(amplitude / 0.001) / 5, 1e-12);
+}
+
+static void testVelocityInfluencesSettlingDuration(void) {
+  MDMSpringSolver towards;
+  MDMSpringSolver away;
+  MDMSpringSolverInit(&towards, 1, 100, 50, 0);
+  MDMSpringSolverInit(&away, 1, 100, 50, -10);
+  MDMAssertTrue(MDMSpringSolverSettlingDuration(&away, 0.001)
+                > MDMSpringSolverSettlingDuration(&towards, 0.001));
+}
+
+static void testUndampedSpringNeverSettles(void) {
+  MDMSpringSolver solver;
+  MDMAssertTrue(MDMSpringSolverInit(&solver, 1, 100, 0, 0));
+  MDMAssertTrue(isinf(MDMSpringSolverSettlingDuration(&solver, 0.001)));
+}
+
+static void testInvalidCoefficientsAreRejected(void) {
+  MDMSpringSolver solver;
+  MDMAssertTrue(!MDMSpringSolverInit(&solver, 0, 100, 10, 0));
+  MDMAssertTrue(!MDMSpringSolverInit(&solver, 1, -1, 10, 0));
+  MDMAssertTrue(!MDMSpringSolverInit(&solver, 1, 100, -10, 0));
+  MDMAssertTrue(!MDMSpringSolverInit(&solver, 1, 100, 10, NAN));
+  MDMAssertEqualWithAccuracy(MDMSpringSolverPosition(&solver, 0.5), 1, 0);
+  MDMAssertEqualWithAccuracy(MDMSpringSolverVelocity(&solver, 0.5), 0, 0);
+}
+
+int main(void) {
+  MDMRunTest(testInitialConditions);
+  MDMRunTest(testRegimes);
+  MDMRunTest(testPositionAndVelocityMatchNumericalIntegration);
+  MDMRunTest(testSpringStaysSettledAfterSettlingDuration);
+  MDMRunTest(testUnderdampedSettlingDurationIsClosedForm);
+  MDMRunTest(testVelocityInfluencesSettlingDuration);
+  MDMRunTest(testUndampedSpringNeverSettles);
+  MDMRunTest(testInvalidCoefficientsAreRejected);
+  return MDMTestExitStatus();
+}
@@ -0,0 +1,84 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMPortableTest.h"
+#include "MDMStaggerTiming.h"
+
+static void testLinearStaggersSeparateElementsByTheInterval(void) {
+  MDMStaggerTiming timing;
+  MDMStaggerTimingInitLinear(&timing, 0.05);
+  double delays[1000];
+  MDMStaggerTimingComputeDelays(&timing, 1000, delays);
+  for (size_t i = 0; i < 1000; ++i) {
+    MDMAssertEqualWithAccuracy(delays[i], (double)i * 0.05, 1e-12);
+  }
+}
+
+static void testEasedStaggersFollowTheCurve(void) {
+  MDMStaggerTiming timing;
+  MDMStaggerTimingInitEased(&timing, 0.5, 0.4, 0, 0.2, 1);
+  MDMCubicBezier curve;
+  MDMCubicBezierInit(&curve, 0.4, 0, 0.2, 1);
+
+  double delays[11];
+  MDMStaggerTimingComputeDelays(&timing, 11, delays);
+  MDMAssertEqualWithAccuracy(delays[0], 0, 1e-9);
+  MDMAssertEqualWithAccuracy(delays[10], 0.5, 1e-9);
+  for (size_t i = 0; i < 11; ++i) {
+    MDMAssertEqualWithAccuracy(delays[i], 0.5 * MDMCubicBezierSolve(&curve, (double)i / 10), 1e-9);
+    if (i > 0) {
+      MDMAssertTrue(delays[i] >= delays[i - 1]);
+    }
+  }
+}
+
+static void testLinearEasingMatchesALinearStagger(void) {
+  MDMStaggerTiming eased;
+  MDMStaggerTimingInitEased(&eased, 0.9, 0, 0, 1, 1);
+  MDMStaggerTiming linear;
+  MDMStaggerTimingInitLinear(&linear, 0.1);
+  double easedDelays[10];
+  double linearDelays[10];
+  MDMStaggerTimingComputeDelays(&eased, 10, easedDelays);
+  MDMStaggerTimingComputeDelays(&linear, 10, linearDelays);
+  for (size_t i = 0; i < 10; ++i) {
+    MDMAssertEqualWithAccuracy(easedDelays[i], linearDelays[i], 1e-6);
+  }
+}
+
+static void testSingleElementsAreNotDelayed(void) {
+  MDMStaggerTiming timing;
+  MDMStaggerTimingInitEased(&timing, 0.5, 0.4, 0, 0.2, 1);
+  double delay = -1;
+  MDMStaggerTimingComputeDelays(&timing, 1, &delay);
+  MDMAssertEqualWithAccuracy(delay, 0, 0);
+
+  MDMStaggerTimingInitLinear(&timing, 0.5);
+  delay = -1;
+  MDMStaggerTimingComputeDelays(&timing, 1, &delay);
+  MDMAssertEqualWithAccuracy(delay, 0, 0);
+
+  // Nothing is written for empty groups.
+  MDMStaggerTimingComputeDelays(&timing, 0, NULL);
+}
+
+int main(void) {
+  MDMRunTest(testLinearStaggersSeparateElementsByTheInterval);
+  MDMRunTest(testEasedStaggersFollowTheCurve);
+  MDMRunTest(testLinearEasingMatchesALinearStagger);
+  MDMRunTest(testSingleElementsAreNotDelayed);
+  return MDMTestExitStatus();
+}
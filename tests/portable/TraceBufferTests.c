@@ -0,0 +1,173 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MDMKeyPathClassifier.h"
+#include "MDMPortableTest.h"
+#include "MDMTraceBuffer.h"
+
+typedef struct {
+  char bytes[4096];
+  size_t length;
+} StringWriter;
+
+static void WriteToString(void *context, const char *bytes, size_t length) {
+  StringWriter *writer = context;
+  if (writer->length + length < sizeof(writer->bytes)) {
+    memcpy(writer->bytes + writer->length, bytes, length);
+    writer->length += length;
+    writer->bytes[writer->length] = '\0';
+  }
+}
+
+static MDMTraceEvent Event(uint64_t start, uint32_t detail) {
+  MDMTraceEvent event = {start, 10, 0, MDMTraceEventKindConfigureAnimation, detail};
+  return event;
+}
+
+static void testNothingIsRecordedWithoutAnActiveBuffer(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(4);
+  MDMAssertEqual(MDMTraceBegin(), 0);
+  MDMTraceEnd(MDMTraceEventKindConfigureAnimation, 1, NULL, 0);
+  MDMTraceInstant(MDMTraceEventKindCompletion, NULL, 1);
+  MDMAssertEqual(MDMTraceBufferCount(buffer), 0);
+  MDMTraceBufferDestroy(buffer);
+}
+
+static void testActiveBufferRecordsIntervalsAndInstants(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(4);
+  MDMTraceBufferSetActive(buffer);
+  int layer = 0;
+
+  uint64_t start = MDMTraceBegin();
+  MDMAssertTrue(start != 0);
+  MDMTraceEnd(MDMTraceEventKindRegisterAnimation, start, &layer, MDMAnimatableKeyPathKindOpacity);
+  MDMTraceInstant(MDMTraceEventKindCompletion, &layer, 1);
+
+  MDMTraceEvent events[4];
+  MDMAssertEqual(MDMTraceBufferCopyEvents(buffer, events, 4), 2);
+  MDMAssertEqual(events[0].kind, MDMTraceEventKindRegisterAnimation);
+  MDMAssertEqual(events[0].start, start);
+  MDMAssertEqual(events[0].object, (uint64_t)(uintptr_t)&layer);
+  MDMAssertEqual(events[0].detail, MDMAnimatableKeyPathKindOpacity);
+  MDMAssertEqual(events[1].kind, MDMTraceEventKindCompletion);
+  MDMAssertEqual(events[1].duration, 0);
+  MDMAssertTrue(events[1].start >= events[0].start + events[0].duration);
+
+  MDMTraceBufferSetActive(NULL);
+  MDMTraceInstant(MDMTraceEventKindCompletion, &layer, 1);
+  MDMAssertEqual(MDMTraceBufferCount(buffer), 2);
+  MDMTraceBufferDestroy(buffer);
+}
+
+static void testFullBufferOverwritesTheOldestEvents(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(3);
+  for (uint64_t i = 1; i <= 5; ++i) {
+    MDMTraceEvent event = Event(i, 0);
+    MDMTraceBufferRecord(buffer, &event);
+  }
+  MDMAssertEqual(MDMTraceBufferCount(buffer), 3);
+  MDMAssertEqual(MDMTraceBufferDroppedCount(buffer), 2);
+
+  MDMTraceEvent events[3];
+  MDMAssertEqual(MDMTraceBufferCopyEvents(buffer, events, 3), 3);
+  MDMAssertEqual(events[0].start, 3);
+  MDMAssertEqual(events[1].start, 4);
+  MDMAssertEqual(events[2].start, 5);
+
+  // Copies are truncated to the destination's capacity, keeping the oldest events.
+  MDMAssertEqual(MDMTraceBufferCopyEvents(buffer, events, 2), 2);
+  MDMAssertEqual(events[0].start, 3);
+
+  MDMTraceBufferRemoveAll(buffer);
+  MDMAssertEqual(MDMTraceBufferCount(buffer), 0);
+  MDMAssertEqual(MDMTraceBufferDroppedCount(buffer), 0);
+  MDMTraceBufferDestroy(buffer);
+}
+
+static void testDestroyingTheActiveBufferStopsRecording(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(2);
+  MDMTraceBufferSetActive(buffer);
+  MDMTraceBufferDestroy(buffer);
+  MDMAssertTrue(MDMTraceActiveBuffer == NULL);
+  MDMAssertEqual(MDMTraceBegin(), 0);
+}
+
+static void testZeroCapacityIsRejected(void) {
+  MDMAssertTrue(MDMTraceBufferCreate(0) == NULL);
+}
+
+static void testChromeJSONExport(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(8);
+  MDMTraceEvent interval = {1234567, 2500, 0xabc, MDMTraceEventKindConfigureAnimation,
+                            MDMAnimatableKeyPathKindPosition};
+  MDMTraceEvent capture = {1240000, 1000, 0, MDMTraceEventKindCaptureImplicitActions, 3};
+  MDMTraceEvent completion = {2000000, 0, 0xabc, MDMTraceEventKindCompletion, 0};
+  MDMTraceBufferRecord(buffer, &interval);
+  MDMTraceBufferRecord(buffer, &capture);
+  MDMTraceBufferRecord(buffer, &completion);
+
+  StringWriter writer = {{0}, 0};
+  MDMTraceBufferWriteChromeJSON(buffer, WriteToString, &writer);
+  const char *expected =
+      "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":0},\"traceEvents\":[\n"
+      "{\"name\":\"ConfigureAnimation\",\"cat\":\"MotionAnimator\",\"pid\":1,\"tid\":1,"
+      "\"ph\":\"X\",\"ts\":1234.567,\"dur\":2.500,"
+      "\"args\":{\"layer\":\"0xabc\",\"keyPath\":\"position\"}},\n"
+      "{\"name\":\"CaptureImplicitActions\",\"cat\":\"MotionAnimator\",\"pid\":1,\"tid\":1,"
+      "\"ph\":\"X\",\"ts\":1240.000,\"dur\":1.000,\"args\":{\"actionCount\":3}},\n"
+      "{\"name\":\"Completion\",\"cat\":\"MotionAnimator\",\"pid\":1,\"tid\":1,"
+      "\"ph\":\"i\",\"s\":\"t\",\"ts\":2000.000,"
+      "\"args\":{\"layer\":\"0xabc\",\"finished\":false}}\n"
+      "]}\n";
+  MDMAssertTrue(strcmp(writer.bytes, expected) == 0);
+  if (strcmp(writer.bytes, expected) != 0) {
+    fprintf(stderr, "%s", writer.bytes);
+  }
+  MDMTraceBufferDestroy(buffer);
+}
+
+static void testEmptyBufferExportsAnEmptyTrace(void) {
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(1);
+  StringWriter writer = {{0}, 0};
+  MDMTraceBufferWriteChromeJSON(buffer, WriteToString, &writer);
+  MDMAssertTrue(strcmp(writer.bytes, "{\"displayTimeUnit\":\"ns\",\"otherData\":"
+                                     "{\"droppedEvents\":0},\"traceEvents\":[\n]}\n") == 0);
+  MDMTraceBufferDestroy(buffer);
+}
+
+static void testTimestampsAreMonotonic(void) {
+  uint64_t previous = MDMTraceNow();
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t now = MDMTraceNow();
+    MDMAssertTrue(now >= previous);
+    previous = now;
+  }
+}
+
+int main(void) {
+  MDMRunTest(testNothingIsRecordedWithoutAnActiveBuffer);
+  MDMRunTest(testActiveBufferRecordsIntervalsAndInstants);
+  MDMRunTest(testFullBufferOverwritesTheOldestEvents);
+  MDMRunTest(testDestroyingTheActiveBufferStopsRecording);
+  MDMRunTest(testZeroCapacityIsRejected);
+  MDMRunTest(testChromeJSONExport);
+  MDMRunTest(testEmptyBufferExportsAnEmptyTrace);
+  MDMRunTest(testTimestampsAreMonotonic);
+  return MDMTestExitStatus();
+}
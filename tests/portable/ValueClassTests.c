@@ -0,0 +1,98 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMPortableTest.h"
+#include "MDMValueClass.h"
+
+// The encodings of the 64-bit Apple platforms, on which CGFloat is a double.
+static const char *const kPointEncoding = "{CGPoint=dd}";
+static const char *const kSizeEncoding = "{CGSize=dd}";
+static const char *const kRectEncoding = "{CGRect={CGPoint=dd}{CGSize=dd}}";
+static const char *const kTransform3DEncoding = "{CATransform3D=dddddddddddddddd}";
+static const char *const kAffineTransformEncoding = "{CGAffineTransform=dddddd}";
+
+static void testStructEncodingsAreClassified(void) {
+  MDMAssertEqual(MDMValueClassOfObjCType(kPointEncoding), MDMValueClassPoint);
+  MDMAssertEqual(MDMValueClassOfObjCType(kSizeEncoding), MDMValueClassSize);
+  MDMAssertEqual(MDMValueClassOfObjCType(kRectEncoding), MDMValueClassRect);
+  MDMAssertEqual(MDMValueClassOfObjCType(kTransform3DEncoding), MDMValueClassTransform3D);
+  MDMAssertEqual(MDMValueClassOfObjCType(kAffineTransformEncoding),
+                 MDMValueClassAffineTransform);
+}
+
+static void testFloatEncodingsAreClassified(void) {
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPoint=ff}"), MDMValueClassPoint);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGRect={CGPoint=ff}{CGSize=ff}}"), MDMValueClassRect);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGAffineTransform=ffffff}"),
+                 MDMValueClassAffineTransform);
+  // CGFloat is either a float or a double, never both.
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPoint=df}"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGRect={CGPoint=dd}{CGSize=ff}}"),
+                 MDMValueClassUnknown);
+}
+
+static void testEncodingsAreMatchedByPrefix(void) {
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPoint=dd}extra"), MDMValueClassPoint);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPoint=d"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPoint="), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CATransform3D=ddd}"), MDMValueClassUnknown);
+}
+
+static void testOtherEncodingsAreUnknown(void) {
+  MDMAssertEqual(MDMValueClassOfObjCType(NULL), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType(""), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{C"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("d"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("q"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGVector=dd}"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CGPointer=dd}"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{UIEdgeInsets=dddd}"), MDMValueClassUnknown);
+  MDMAssertEqual(MDMValueClassOfObjCType("{CATransform3D=qqqqqqqqqqqqqqqq}"),
+                 MDMValueClassUnknown);
+}
+
+static void testCoercedClasses(void) {
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassColor), MDMValueClassCGColor);
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassBezierPath), MDMValueClassCGPath);
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassAffineTransform), MDMValueClassTransform3D);
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassPoint), MDMValueClassPoint);
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassCGColor), MDMValueClassCGColor);
+  MDMAssertEqual(MDMValueClassCoerced(MDMValueClassUnknown), MDMValueClassUnknown);
+}
+
+static void testAdditiveClasses(void) {
+  MDMAssertTrue(MDMValueClassIsAdditive(MDMValueClassNumber));
+  MDMAssertTrue(MDMValueClassIsAdditive(MDMValueClassPoint));
+  MDMAssertTrue(MDMValueClassIsAdditive(MDMValueClassSize));
+  MDMAssertTrue(MDMValueClassIsAdditive(MDMValueClassTransform3D));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassRect));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassAffineTransform));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassColor));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassCGColor));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassBezierPath));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassCGPath));
+  MDMAssertTrue(!MDMValueClassIsAdditive(MDMValueClassUnknown));
+}
+
+int main(void) {
+  MDMRunTest(testStructEncodingsAreClassified);
+  MDMRunTest(testFloatEncodingsAreClassified);
+  MDMRunTest(testEncodingsAreMatchedByPrefix);
+  MDMRunTest(testOtherEncodingsAreUnknown);
+  MDMRunTest(testCoercedClasses);
+  MDMRunTest(testAdditiveClasses);
+  return MDMTestExitStatus();
+}
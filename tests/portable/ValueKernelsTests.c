@@ -0,0 +1,368 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MDMPortableTest.h"
+#include "MDMValueKernels.h"
+
+// Reference implementations transcribed from MDMConfigureAnimation's original per-type branches.
+
+static double ReferencePairVelocity(double fromA, double fromB, double toA, double toB,
+                                    double absoluteVelocity) {
+  double deltaA = fromA - toA;
+  double deltaB = fromB - toB;
+  double biggestDelta;
+  if (fabs(deltaA) > fabs(deltaB)) {
+    biggestDelta = deltaA;
+  } else {
+    biggestDelta = deltaB;
+  }
+  return absoluteVelocity / -biggestDelta;
+}
+
+static double ReferenceRectVelocity(const double from[4], const double to[4],
+                                    double absoluteVelocity) {
+  double biggestDelta = from[0] - to[0];
+  for (int i = 1; i < 4; ++i) {
+    if (fabs(from[i] - to[i]) > fabs(biggestDelta)) {
+      biggestDelta = from[i] - to[i];
+    }
+  }
+  return absoluteVelocity / -biggestDelta;
+}
+
+static void ReferenceMultiply(const double a[16], const double b[16], double result[16]) {
+  for (int row = 0; row < 4; ++row) {
+    for (int column = 0; column < 4; ++column) {
+      double sum = 0;
+      for (int k = 0; k < 4; ++k) {
+        sum += a[row * 4 + k] * b[k * 4 + column];
+      }
+      result[row * 4 + column] = sum;
+    }
+  }
+}
+
+static void AssertIdentity(const double m[16], double accuracy) {
+  for (int i = 0; i < 16; ++i) {
+    MDMAssertEqualWithAccuracy(m[i], i % 5 == 0 ? 1 : 0, accuracy);
+  }
+}
+
+static double RandomInRange(double lower, double upper) {
+  return lower + (upper - lower) * ((double)rand() / RAND_MAX);
+}
+
+static void testLaneCounts(void) {
+  MDMAssertEqual(MDMValueTypeLaneCount(MDMValueTypeScalar), 1);
+  MDMAssertEqual(MDMValueTypeLaneCount(MDMValueTypePoint), 2);
+  MDMAssertEqual(MDMValueTypeLaneCount(MDMValueTypeSize), 2);
+  MDMAssertEqual(MDMValueTypeLaneCount(MDMValueTypeRect), 4);
+  MDMAssertEqual(MDMValueTypeLaneCount(MDMValueTypeTransform3D), 16);
+}
+
+static void testScalarMatchesReference(void) {
+  MDMValue from, to, displacement;
+  const double fromLane = 50;
+  const double toLane = 100;
+  MDMValueInit(&from, MDMValueTypeScalar, &fromLane);
+  MDMValueInit(&to, MDMValueTypeScalar, &toLane);
+  MDMValueAdditiveDisplacement(&from, &to, &displacement);
+  MDMAssertEqual(displacement.type, MDMValueTypeScalar);
+  MDMAssertEqualWithAccuracy(displacement.lanes[0], -50, 0);
+
+  double velocity = 0;
+  MDMAssertTrue(MDMValueNormalizeVelocity(&displacement, 200, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 200 / (toLane - fromLane), 0);
+}
+
+static void testPairsMatchReference(void) {
+  srand(3);
+  for (int i = 0; i < 10000; ++i) {
+    double from[2] = {RandomInRange(-500, 500), RandomInRange(-500, 500)};
+    double to[2] = {RandomInRange(-500, 500), RandomInRange(-500, 500)};
+    if (i % 10 == 0) {
+      // Exercise ties.
+      to[1] = from[1] + (from[0] - to[0]);
+    }
+    double absoluteVelocity = RandomInRange(-1000, 1000);
+    MDMValueType type = i % 2 ? MDMValueTypePoint : MDMValueTypeSize;
+
+    MDMValue fromValue, toValue, displacement;
+    MDMValueInit(&fromValue, type, from);
+    MDMValueInit(&toValue, type, to);
+    MDMValueAdditiveDisplacement(&fromValue, &toValue, &displacement);
+    MDMAssertEqualWithAccuracy(displacement.lanes[0], from[0] - to[0], 0);
+    MDMAssertEqualWithAccuracy(displacement.lanes[1], from[1] - to[1], 0);
+
+    double velocity = 0;
+    MDMAssertTrue(MDMValueNormalizeVelocity(&displacement, absoluteVelocity, &velocity));
+    MDMAssertEqualWithAccuracy(velocity,
+                               ReferencePairVelocity(from[0], from[1], to[0], to[1],
+                                                     absoluteVelocity), 0);
+  }
+}
+
+static void testRectsMatchReference(void) {
+  srand(5);
+  for (int i = 0; i < 10000; ++i) {
+    double from[4];
+    double to[4];
+    for (int lane = 0; lane < 4; ++lane) {
+      from[lane] = RandomInRange(-500, 500);
+      to[lane] = RandomInRange(-500, 500);
+    }
+    if (i % 10 == 0) {
+      // Exercise ties between the first and last lanes.
+      to[3] = from[3] + (from[0] - to[0]);
+    }
+    double absoluteVelocity = RandomInRange(-1000, 1000);
+
+    MDMValue fromValue, toValue, displacement;
+    MDMValueInit(&fromValue, MDMValueTypeRect, from);
+    MDMValueInit(&toValue, MDMValueTypeRect, to);
+    MDMValueAdditiveDisplacement(&fromValue, &toValue, &displacement);
+    for (int lane = 0; lane < 4; ++lane) {
+      MDMAssertEqualWithAccuracy(displacement.lanes[lane], from[lane] - to[lane], 0);
+    }
+
+    double velocity = 0;
+    MDMAssertTrue(MDMValueNormalizeVelocity(&displacement, absoluteVelocity, &velocity));
+    MDMAssertEqualWithAccuracy(velocity, ReferenceRectVelocity(from, to, absoluteVelocity), 0);
+  }
+}
+
+static void testDominantComponentTieBreaking(void) {
+  const double pair[2] = {-3, 3};
+  const double rect[4] = {-3, 1, 2, 3};
+  MDMValue value;
+  MDMValueInit(&value, MDMValueTypePoint, pair);
+  MDMAssertEqualWithAccuracy(MDMValueDominantComponent(&value), 3, 0);
+  MDMValueInit(&value, MDMValueTypeSize, pair);
+  MDMAssertEqualWithAccuracy(MDMValueDominantComponent(&value), 3, 0);
+  MDMValueInit(&value, MDMValueTypeRect, rect);
+  MDMAssertEqualWithAccuracy(MDMValueDominantComponent(&value), -3, 0);
+}
+
+static void testTinyDisplacementsAreNotNormalized(void) {
+  const double lanes[4] = {0.000001, -0.000001, 0, 0};
+  MDMValue value;
+  MDMValueInit(&value, MDMValueTypeRect, lanes);
+  double velocity = 42;
+  MDMAssertTrue(!MDMValueNormalizeVelocity(&value, 100, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 42, 0);
+}
+
+static void testVelocityValuesAreNormalizedAlongTheDominantLane(void) {
+  // Travelling from (0, 0) to (10, -100) while moving at (50, -200) units per second.
+  const double displacementLanes[2] = {-10, 100};
+  const double velocityLanes[2] = {50, -200};
+  MDMValue displacement;
+  MDMValue absoluteVelocity;
+  MDMValueInit(&displacement, MDMValueTypePoint, displacementLanes);
+  MDMValueInit(&absoluteVelocity, MDMValueTypePoint, velocityLanes);
+  double velocity = 0;
+  MDMAssertTrue(MDMValueNormalizeVelocityValue(&displacement, &absoluteVelocity, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 2, 1e-12);
+
+  // Mismatched types and transforms are not normalized.
+  const double scalar = 5;
+  MDMValueInit(&absoluteVelocity, MDMValueTypeScalar, &scalar);
+  velocity = 42;
+  MDMAssertTrue(!MDMValueNormalizeVelocityValue(&displacement, &absoluteVelocity, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 42, 0);
+  MDMValueInitAdditiveIdentity(&displacement, MDMValueTypeTransform3D);
+  MDMValueInitAdditiveIdentity(&absoluteVelocity, MDMValueTypeTransform3D);
+  MDMAssertTrue(!MDMValueNormalizeVelocityValue(&displacement, &absoluteVelocity, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 42, 0);
+}
+
+static void testNegation(void) {
+  const double lanes[4] = {1, -2, 3, -4};
+  MDMValue value;
+  MDMValueInit(&value, MDMValueTypeRect, lanes);
+  MDMValueNegate(&value, &value);
+  for (int lane = 0; lane < 4; ++lane) {
+    MDMAssertEqualWithAccuracy(value.lanes[lane], -lanes[lane], 0);
+  }
+  for (int lane = 4; lane < MDMValueMaxLaneCount; ++lane) {
+    MDMAssertEqualWithAccuracy(value.lanes[lane], 0, 0);
+  }
+}
+
+static void testAdditiveIdentity(void) {
+  MDMValue value;
+  MDMValueInitAdditiveIdentity(&value, MDMValueTypePoint);
+  MDMAssertEqual(value.type, MDMValueTypePoint);
+  MDMAssertEqualWithAccuracy(value.lanes[0], 0, 0);
+  MDMAssertEqualWithAccuracy(value.lanes[1], 0, 0);
+  MDMValueInitAdditiveIdentity(&value, MDMValueTypeTransform3D);
+  AssertIdentity(value.lanes, 0);
+}
+
+static void testAffineInverse(void) {
+  // Rotation about z by 30 degrees, scaled by 2 and translated.
+  const double c = cos(M_PI / 6);
+  const double s = sin(M_PI / 6);
+  const double m[16] = {
+    2 * c, 2 * s, 0, 0,
+    -2 * s, 2 * c, 0, 0,
+    0, 0, 2, 0,
+    10, -20, 5, 1,
+  };
+  double inverse[16];
+  MDMAssertTrue(MDMTransform3DInvert(m, inverse));
+  double product[16];
+  ReferenceMultiply(m, inverse, product);
+  AssertIdentity(product, 1e-12);
+  ReferenceMultiply(inverse, m, product);
+  AssertIdentity(product, 1e-12);
+}
+
+static void testPerspectiveInverse(void) {
+  const double m[16] = {
+    1, 0.2, 0, 0,
+    0, 1, 0.3, 0,
+    0.1, 0, 1, -1.0 / 500,
+    4, 5, 6, 1,
+  };
+  double inverse[16];
+  MDMAssertTrue(MDMTransform3DInvert(m, inverse));
+  double product[16];
+  ReferenceMultiply(m, inverse, product);
+  AssertIdentity(product, 1e-12);
+}
+
+static void testRandomAffineInversesMatchGeneralInverse(void) {
+  srand(11);
+  for (int i = 0; i < 1000; ++i) {
+    double m[16];
+    for (int j = 0; j < 16; ++j) {
+      m[j] = RandomInRange(-2, 2);
+    }
+    m[3] = m[7] = m[11] = 0;
+    m[15] = 1;
+    double determinant = (m[0] * (m[5] * m[10] - m[6] * m[9])
+                          - m[1] * (m[4] * m[10] - m[6] * m[8])
+                          + m[2] * (m[4] * m[9] - m[5] * m[8]));
+    if (fabs(determinant) < 0.1) {
+      continue;  // Too ill-conditioned for a tight comparison.
+    }
+    double affineInverse[16];
+    MDMAssertTrue(MDMTransform3DInvert(m, affineInverse));
+    double product[16];
+    ReferenceMultiply(m, affineInverse, product);
+    AssertIdentity(product, 1e-9);
+
+    // A negligible perspective component forces the general path for an equivalent matrix.
+    m[3] = 1e-300;
+    double generalInverse[16];
+    MDMAssertTrue(MDMTransform3DInvert(m, generalInverse));
+    for (int j = 0; j < 16; ++j) {
+      MDMAssertEqualWithAccuracy(affineInverse[j], generalInverse[j], 1e-9);
+    }
+  }
+}
+
+static void testSingularMatricesAreReturnedUnchanged(void) {
+  double m[16] = {
+    1, 2, 3, 0,
+    2, 4, 6, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1,
+  };
+  double result[16];
+  MDMAssertTrue(!MDMTransform3DInvert(m, result));
+  MDMAssertTrue(memcmp(m, result, sizeof(m)) == 0);
+
+  m[15] = 0.5;  // Non-affine and still singular.
+  MDMAssertTrue(!MDMTransform3DInvert(m, result));
+  MDMAssertTrue(memcmp(m, result, sizeof(m)) == 0);
+}
+
+static void testConcatMatchesReference(void) {
+  srand(13);
+  double a[16];
+  double b[16];
+  for (int i = 0; i < 16; ++i) {
+    a[i] = RandomInRange(-3, 3);
+    b[i] = RandomInRange(-3, 3);
+  }
+  double expected[16];
+  double actual[16];
+  ReferenceMultiply(a, b, expected);
+  MDMTransform3DConcat(a, b, actual);
+  for (int i = 0; i < 16; ++i) {
+    MDMAssertEqualWithAccuracy(actual[i], expected[i], 1e-12);
+  }
+  // Aliasing the result with an operand.
+  MDMTransform3DConcat(a, b, a);
+  for (int i = 0; i < 16; ++i) {
+    MDMAssertEqualWithAccuracy(a[i], expected[i], 1e-12);
+  }
+}
+
+static void testTransformDisplacementComposesBackToOrigin(void) {
+  const double from[16] = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1,
+  };
+  const double to[16] = {
+    0.5, 0, 0, 0,
+    0, 0.5, 0, 0,
+    0, 0, 1, 0,
+    30, 40, 0, 1,
+  };
+  MDMValue fromValue, toValue, displacement;
+  MDMValueInit(&fromValue, MDMValueTypeTransform3D, from);
+  MDMValueInit(&toValue, MDMValueTypeTransform3D, to);
+  MDMValueAdditiveDisplacement(&fromValue, &toValue, &displacement);
+  MDMAssertEqual(displacement.type, MDMValueTypeTransform3D);
+
+  double composed[16];
+  MDMTransform3DConcat(displacement.lanes, to, composed);
+  for (int i = 0; i < 16; ++i) {
+    MDMAssertEqualWithAccuracy(composed[i], from[i], 1e-12);
+  }
+
+  double velocity = 7;
+  MDMAssertTrue(!MDMValueNormalizeVelocity(&displacement, 100, &velocity));
+  MDMAssertEqualWithAccuracy(velocity, 7, 0);
+}
+
+int main(void) {
+  MDMRunTest(testLaneCounts);
+  MDMRunTest(testScalarMatchesReference);
+  MDMRunTest(testPairsMatchReference);
+  MDMRunTest(testRectsMatchReference);
+  MDMRunTest(testDominantComponentTieBreaking);
+  MDMRunTest(testTinyDisplacementsAreNotNormalized);
+  MDMRunTest(testVelocityValuesAreNormalizedAlongTheDominantLane);
+  MDMRunTest(testNegation);
+  MDMRunTest(testAdditiveIdentity);
+  MDMRunTest(testAffineInverse);
+  MDMRunTest(testPerspectiveInverse);
+  MDMRunTest(testRandomAffineInversesMatchGeneralInverse);
+  MDMRunTest(testSingularMatricesAreReturnedUnchanged);
+  MDMRunTest(testConcatMatchesReference);
+  MDMRunTest(testTransformDisplacementComposesBackToOrigin);
+  return MDMTestExitStatus();
+}
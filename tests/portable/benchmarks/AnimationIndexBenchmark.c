@@ -0,0 +1,119 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Registers, iterates and removes animations spread across layers at several index sizes. The
+// largest size approximates retargeting a drag gesture across a large collection every frame.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MDMAnimationIndex.h"
+#include "MDMPortableBenchmark.h"
+
+enum {
+  kMaxAnimationCount = 100000,
+  // Each size performs roughly this many operations of each kind.
+  kOperationsPerSize = 2000000,
+  kAnimationsPerLayer = 5,
+};
+
+static uintptr_t sLayers[kMaxAnimationCount];
+static MDMAnimationID sIdentifiers[kMaxAnimationCount];
+static size_t sRemovalOrder[kMaxAnimationCount];
+
+static void CountEntry(void *context, const void *layer, const MDMAnimationIndexEntry *entry) {
+  *(uint64_t *)context += entry->identifier;
+}
+
+static uint64_t MeasureSize(size_t animationCount) {
+  size_t layerCount = (animationCount + kAnimationsPerLayer - 1) / kAnimationsPerLayer;
+  for (size_t i = 0; i < animationCount; ++i) {
+    // Fake, suitably aligned layer addresses.
+    sLayers[i] = (1 + (uintptr_t)((size_t)rand() % layerCount)) * 64;
+    sRemovalOrder[i] = i;
+  }
+  for (size_t i = animationCount - 1; i > 0; --i) {
+    size_t j = (size_t)rand() % (i + 1);
+    size_t swap = sRemovalOrder[i];
+    sRemovalOrder[i] = sRemovalOrder[j];
+    sRemovalOrder[j] = swap;
+  }
+
+  // The index is reused across rounds, which is how the registrar uses it.
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  MDMBenchmarkMeasurement add = {0};
+  MDMBenchmarkMeasurement iterate = {0};
+  MDMBenchmarkMeasurement remove = {0};
+  uint64_t checksum = 0;
+  size_t rounds = kOperationsPerSize / animationCount;
+  for (size_t round = 0; round < rounds; ++round) {
+    MDMBenchmarkBegin(&add);
+    for (size_t i = 0; i < animationCount; ++i) {
+      sIdentifiers[i] = MDMAnimationIndexAdd(index, (const void *)sLayers[i], NULL, NULL, 0, 0);
+    }
+    MDMBenchmarkEnd(&add);
+
+    MDMBenchmarkBegin(&iterate);
+    MDMAnimationIndexForEach(index, CountEntry, &checksum);
+    MDMBenchmarkEnd(&iterate);
+
+    MDMBenchmarkBegin(&remove);
+    for (size_t i = 0; i < animationCount; ++i) {
+      size_t victim = sRemovalOrder[i];
+      MDMAnimationIndexRemove(index, (const void *)sLayers[victim], sIdentifiers[victim]);
+    }
+    MDMBenchmarkEnd(&remove);
+  }
+  MDMAnimationIndexDestroy(index);
+
+  const double operations = (double)animationCount * (double)rounds;
+  char name[64];
+  snprintf(name, sizeof(name), "MDMAnimationIndexAdd (%zu entries)", animationCount);
+  MDMBenchmarkReport(name, &add, operations);
+  snprintf(name, sizeof(name), "MDMAnimationIndexForEach (%zu entries)", animationCount);
+  MDMBenchmarkReport(name, &iterate, operations);
+  snprintf(name, sizeof(name), "MDMAnimationIndexRemove (%zu entries)", animationCount);
+  MDMBenchmarkReport(name, &remove, operations);
+  return checksum;
+}
+
+static size_t MeasureFormatKey(void) {
+  enum { kKeyCount = 1000000 };
+  MDMAnimationIndex *index = MDMAnimationIndexCreate(NULL, NULL);
+  size_t keyLengths = 0;
+  char buffer[MDMAnimationIndexKeyBufferSize];
+  MDMBenchmarkMeasurement format = {0};
+  MDMBenchmarkBegin(&format);
+  for (uint32_t keyNumber = 1; keyNumber <= kKeyCount; ++keyNumber) {
+    keyLengths += MDMAnimationIndexFormatKey(index, keyNumber, buffer, sizeof(buffer));
+  }
+  MDMBenchmarkEnd(&format);
+  MDMAnimationIndexDestroy(index);
+  MDMBenchmarkReport("MDMAnimationIndexFormatKey", &format, kKeyCount);
+  return keyLengths;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  srand(7);
+  uint64_t checksum = 0;
+  checksum += MeasureSize(10);
+  checksum += MeasureSize(1000);
+  checksum += MeasureSize(kMaxAnimationCount);
+  checksum += MeasureFormatKey();
+  return checksum == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
@@ -0,0 +1,105 @@
+# Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Runs a portable benchmark and compares its results against a baseline file.
+#
+#   cmake -DBENCHMARK=<executable> -DBASELINE=<baseline.json> -DRESULTS=<results.json> \
+#         -P CheckBenchmark.cmake
+#
+# The baseline lists, for each suite and benchmark, the recorded cost of one operation and the
+# thresholds beyond which the benchmark is considered to have regressed:
+#
+#   "suites": {
+#     "<suite>": {
+#       "<benchmark>": {
+#         "ns_per_op": 10.0, "max_ns_per_op": 15.0,
+#         "allocations_per_op": 0, "max_allocations_per_op": 0
+#       }
+#     }
+#   }
+#
+# Allocation thresholds are skipped on platforms where the harness cannot count allocations.
+
+cmake_minimum_required(VERSION 3.19)
+
+foreach(variable BENCHMARK BASELINE RESULTS)
+  if(NOT DEFINED ${variable})
+    message(FATAL_ERROR "${variable} must be defined.")
+  endif()
+endforeach()
+
+execute_process(COMMAND ${BENCHMARK} --json ${RESULTS} RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+  message(FATAL_ERROR "${BENCHMARK} failed: ${status}")
+endif()
+
+file(READ ${BASELINE} baseline)
+file(READ ${RESULTS} results)
+string(JSON suite GET "${results}" suite)
+string(JSON expectations ERROR_VARIABLE error GET "${baseline}" suites "${suite}")
+if(error)
+  message(FATAL_ERROR "${BASELINE} has no baseline for ${suite}.")
+endif()
+
+set(failures 0)
+
+string(JSON count LENGTH "${expectations}")
+if(count GREATER 0)
+  math(EXPR last "${count} - 1")
+  foreach(i RANGE ${last})
+    string(JSON name MEMBER "${expectations}" ${i})
+    string(JSON result ERROR_VARIABLE error GET "${results}" results "${name}")
+    if(error)
+      message(SEND_ERROR "${suite}: \"${name}\" was not reported.")
+      math(EXPR failures "${failures} + 1")
+      continue()
+    endif()
+
+    string(JSON nanoseconds GET "${result}" ns_per_op)
+    string(JSON maxNanoseconds GET "${expectations}" "${name}" max_ns_per_op)
+    if(nanoseconds GREATER maxNanoseconds)
+      message(SEND_ERROR
+        "${suite}: \"${name}\" took ${nanoseconds} ns/op; the threshold is ${maxNanoseconds}.")
+      math(EXPR failures "${failures} + 1")
+    endif()
+
+    string(JSON allocationsType TYPE "${result}" allocations_per_op)
+    if(NOT allocationsType STREQUAL "NULL")
+      string(JSON allocations GET "${result}" allocations_per_op)
+      string(JSON maxAllocations GET "${expectations}" "${name}" max_allocations_per_op)
+      if(allocations GREATER maxAllocations)
+        message(SEND_ERROR "${suite}: \"${name}\" performed ${allocations} allocations/op; "
+                           "the threshold is ${maxAllocations}.")
+        math(EXPR failures "${failures} + 1")
+      endif()
+    endif()
+  endforeach()
+endif()
+
+# New benchmarks don't fail the check, but they should be added to the baseline.
+string(JSON resultCount LENGTH "${results}" results)
+if(resultCount GREATER 0)
+  math(EXPR last "${resultCount} - 1")
+  foreach(i RANGE ${last})
+    string(JSON name MEMBER "${results}" results ${i})
+    string(JSON ignored ERROR_VARIABLE error GET "${expectations}" "${name}")
+    if(error)
+      message(WARNING "${suite}: \"${name}\" has no baseline in ${BASELINE}.")
+    endif()
+  endforeach()
+endif()
+
+if(failures GREATER 0)
+  message(FATAL_ERROR "${suite}: ${failures} regression(s).")
+endif()
@@ -0,0 +1,79 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Measures recording explicit animation requests into a command buffer, both while the buffer grows
+// and once its storage is reused for every subsequent recording, as it is by the animator.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "MDMCommandBuffer.h"
+#include "MDMPortableBenchmark.h"
+
+enum {
+  kCommandsPerRecording = 500,
+  kRecordings = 20000,
+};
+
+static const void *IdentityRetain(const void *value) {
+  return value;
+}
+
+static void IgnoreRelease(const void *value) {
+}
+
+static const MDMCommandBufferCallbacks kCallbacks = {IdentityRetain, IgnoreRelease};
+
+static uintptr_t Record(MDMCommandBuffer *buffer, uint32_t recording) {
+  uintptr_t checksum = 0;
+  for (uintptr_t i = 0; i < kCommandsPerRecording; ++i) {
+    MDMCommand command = {(const void *)(i + 1), (const void *)0x10, (const void *)0x20,
+                          (const void *)(i + recording), NULL, MDMValueClassNumber};
+    checksum += (uintptr_t)MDMCommandBufferAppend(buffer, &command);
+  }
+  return checksum;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  uintptr_t checksum = 0;
+
+  MDMBenchmarkMeasurement growing = {0};
+  for (uint32_t recording = 0; recording < kRecordings / 10; ++recording) {
+    MDMCommandBuffer *buffer = MDMCommandBufferCreate(&kCallbacks);
+    MDMBenchmarkBegin(&growing);
+    checksum += Record(buffer, recording);
+    MDMBenchmarkEnd(&growing);
+    MDMCommandBufferDestroy(buffer);
+  }
+  MDMBenchmarkReport("MDMCommandBufferAppend (new buffer, 500 commands)", &growing,
+                     (double)kRecordings / 10 * kCommandsPerRecording);
+
+  MDMCommandBuffer *buffer = MDMCommandBufferCreate(&kCallbacks);
+  checksum += Record(buffer, 0);
+  MDMCommandBufferRemoveAll(buffer);
+  MDMBenchmarkMeasurement reused = {0};
+  MDMBenchmarkBegin(&reused);
+  for (uint32_t recording = 0; recording < kRecordings; ++recording) {
+    checksum += Record(buffer, recording);
+    MDMCommandBufferRemoveAll(buffer);
+  }
+  MDMBenchmarkEnd(&reused);
+  MDMBenchmarkReport("MDMCommandBufferAppend + RemoveAll (reused buffer, 500 commands)", &reused,
+                     (double)kRecordings * kCommandsPerRecording);
+  MDMCommandBufferDestroy(buffer);
+  return checksum == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
@@ -0,0 +1,109 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Measures solving cubic bezier timing curves for their progress, one value at a time and in
+// batches, against a plain bisection solver.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "MDMCubicBezier.h"
+#include "MDMPortableBenchmark.h"
+
+enum {
+  kValueCount = 1024,
+  kRounds = 2000,
+};
+
+static double sTimes[kValueCount];
+static double sProgress[kValueCount];
+
+// What a solver without a sample table or Newton refinement does.
+static double BisectionSolve(const MDMCubicBezier *curve, double x) {
+  double lower = 0;
+  double upper = 1;
+  while (upper - lower > 2 * MDMCubicBezierParameterTolerance) {
+    double t = (lower + upper) / 2;
+    if (((curve->ax * t + curve->bx) * t + curve->cx) * t < x) {
+      lower = t;
+    } else {
+      upper = t;
+    }
+  }
+  double t = (lower + upper) / 2;
+  return ((curve->ay * t + curve->by) * t + curve->cy) * t;
+}
+
+static double MeasureSolve(const char *name, const MDMCubicBezier *curve) {
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kValueCount; ++i) {
+      checksum += MDMCubicBezierSolve(curve, sTimes[i]);
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kValueCount);
+  return checksum;
+}
+
+static double MeasureBatch(const char *name, const MDMCubicBezier *curve) {
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    MDMCubicBezierSolveBatch(curve, sTimes, sProgress, kValueCount);
+    checksum += sProgress[round % kValueCount];
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kValueCount);
+  return checksum;
+}
+
+static double MeasureBisection(const char *name, const MDMCubicBezier *curve) {
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kValueCount; ++i) {
+      checksum += BisectionSolve(curve, sTimes[i]);
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kValueCount);
+  return checksum;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  for (size_t i = 0; i < kValueCount; ++i) {
+    sTimes[i] = (double)i / (kValueCount - 1);
+  }
+  MDMCubicBezier standard;
+  MDMCubicBezierInit(&standard, 0.4, 0, 0.2, 1);
+  MDMCubicBezier easeInEaseOut;
+  MDMCubicBezierInit(&easeInEaseOut, 0.42, 0, 0.58, 1);
+
+  double checksum = 0;
+  checksum += MeasureSolve("MDMCubicBezierSolve (standard)", &standard);
+  checksum += MeasureBatch("MDMCubicBezierSolveBatch (standard)", &standard);
+  checksum += MeasureBisection("Bisection (standard)", &standard);
+  checksum += MeasureSolve("MDMCubicBezierSolve (ease in ease out)", &easeInEaseOut);
+  checksum += MeasureBatch("MDMCubicBezierSolveBatch (ease in ease out)", &easeInEaseOut);
+  checksum += MeasureBisection("Bisection (ease in ease out)", &easeInEaseOut);
+  return isfinite(checksum) ? MDMBenchmarkFinish() : EXIT_FAILURE;
+}
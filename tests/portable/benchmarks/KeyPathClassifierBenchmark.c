@@ -0,0 +1,56 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Classifies the action keys that UIKit and Core Animation typically ask a layer about when a view's
+// frame, alpha and colors change, which is the work performed for every intercepted property set.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MDMKeyPathClassifier.h"
+#include "MDMPortableBenchmark.h"
+
+enum {
+  kRounds = 2000000,
+};
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  static const char *const kEvents[] = {
+    "position", "bounds", "opacity", "backgroundColor", "onOrderIn", "sublayers", "contents",
+    "transform", "hidden", "cornerRadius", "shadowPath", "bounds.size.width",
+  };
+  enum { kEventCount = sizeof(kEvents) / sizeof(kEvents[0]) };
+  size_t lengths[kEventCount];
+  for (size_t i = 0; i < kEventCount; ++i) {
+    lengths[i] = strlen(kEvents[i]);
+  }
+
+  // Summing the results keeps the classifications from being optimized away.
+  unsigned long animatableCount = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kEventCount; ++i) {
+      animatableCount += MDMClassifyKeyPath(kEvents[i], lengths[i]) != MDMAnimatableKeyPathKindNone;
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+
+  MDMBenchmarkReport("MDMClassifyKeyPath (UIKit action keys)", &measurement,
+                     (double)kRounds * kEventCount);
+  return animatableCount == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
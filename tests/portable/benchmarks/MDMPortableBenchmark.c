@@ -0,0 +1,182 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "MDMPortableBenchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+  kMaxResultCount = 64,
+  kMaxNameLength = 96,
+};
+
+typedef struct {
+  char name[kMaxNameLength];
+  double nanosecondsPerOperation;
+  double allocationsPerOperation;
+} Result;
+
+static const char *sSuite = "";
+static const char *sJSONPath = NULL;
+static Result sResults[kMaxResultCount];
+static size_t sResultCount = 0;
+
+// The benchmarks are single threaded, so a plain counter suffices.
+static uint64_t sAllocationCount = 0;
+
+#pragma mark - Allocation counting
+
+#if defined(MDM_BENCHMARK_WRAPS_ALLOCATORS)
+
+// Resolved by the linker's --wrap option; see CMakeLists.txt.
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  ++sAllocationCount;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  ++sAllocationCount;
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+  ++sAllocationCount;
+  return __real_realloc(pointer, size);
+}
+
+#endif
+
+#pragma mark - Private
+
+static void WriteJSONString(FILE *file, const char *string) {
+  fputc('"', file);
+  for (const char *c = string; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', file);
+    }
+    fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+static int WriteJSON(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Unable to open %s for writing.\n", path);
+    return 0;
+  }
+  fprintf(file, "{\n  \"suite\": ");
+  WriteJSONString(file, sSuite);
+  fprintf(file, ",\n  \"results\": {");
+  for (size_t i = 0; i < sResultCount; ++i) {
+    const Result *result = &sResults[i];
+    fprintf(file, "%s\n    ", i == 0 ? "" : ",");
+    WriteJSONString(file, result->name);
+    fprintf(file, ": { \"ns_per_op\": %.2f, \"allocations_per_op\": ",
+            result->nanosecondsPerOperation);
+    if (MDMBenchmarkCountsAllocations()) {
+      fprintf(file, "%.4f }", result->allocationsPerOperation);
+    } else {
+      fprintf(file, "null }");
+    }
+  }
+  fprintf(file, "\n  }\n}\n");
+  return fclose(file) == 0;
+}
+
+#pragma mark - Public
+
+void MDMBenchmarkInit(int argc, char **argv) {
+  if (argc > 0) {
+    const char *slash = strrchr(argv[0], '/');
+    sSuite = slash != NULL ? slash + 1 : argv[0];
+  }
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      sJSONPath = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [--json <path>]\n", sSuite);
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+double MDMBenchmarkNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+uint64_t MDMBenchmarkAllocationCount(void) {
+  return sAllocationCount;
+}
+
+int MDMBenchmarkCountsAllocations(void) {
+#if defined(MDM_BENCHMARK_WRAPS_ALLOCATORS)
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+void MDMBenchmarkBegin(MDMBenchmarkMeasurement *measurement) {
+  measurement->startAllocations = sAllocationCount;
+  measurement->startTime = MDMBenchmarkNow();
+}
+
+void MDMBenchmarkEnd(MDMBenchmarkMeasurement *measurement) {
+  double now = MDMBenchmarkNow();
+  measurement->seconds += now - measurement->startTime;
+  measurement->allocations += sAllocationCount - measurement->startAllocations;
+}
+
+void MDMBenchmarkReport(const char *name,
+                        const MDMBenchmarkMeasurement *measurement,
+                        double operations) {
+  double nanoseconds = measurement->seconds * 1e9 / operations;
+  double allocations = (double)measurement->allocations / operations;
+  if (MDMBenchmarkCountsAllocations()) {
+    printf("%-48s %12.1f ns/op %12.4f allocs/op\n", name, nanoseconds, allocations);
+  } else {
+    printf("%-48s %12.1f ns/op %12s allocs/op\n", name, nanoseconds, "n/a");
+  }
+
+  if (sResultCount == kMaxResultCount) {
+    fprintf(stderr, "Too many results; %s will not be recorded.\n", name);
+    return;
+  }
+  Result *result = &sResults[sResultCount++];
+  snprintf(result->name, sizeof(result->name), "%s", name);
+  result->nanosecondsPerOperation = nanoseconds;
+  result->allocationsPerOperation = allocations;
+}
+
+int MDMBenchmarkFinish(void) {
+  if (sJSONPath != NULL && !WriteJSON(sJSONPath)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef MDM_PORTABLE_BENCHMARK_H
+#define MDM_PORTABLE_BENCHMARK_H
+
+// A minimal timing and allocation counting harness for the portable C benchmarks.
+//
+// Every benchmark executable accepts an optional `--json <path>` argument, in which case its results
+// are also written to `path` in the format consumed by CheckBenchmark.cmake.
+//
+// Heap allocations are counted by wrapping malloc, calloc and realloc at link time. Only calls made
+// from the benchmarks and the portable sources are counted. Linkers that don't support wrapping
+// symbols report allocations as unavailable.
+
+#include <stdint.h>
+
+// The cost of a benchmarked operation, accumulated across one or more Begin/End pairs.
+typedef struct {
+  double seconds;
+  uint64_t allocations;
+  double startTime;
+  uint64_t startAllocations;
+} MDMBenchmarkMeasurement;
+
+// Parses the benchmark's command line arguments. Must be called before any other function.
+void MDMBenchmarkInit(int argc, char **argv);
+
+// Returns a monotonic timestamp in seconds.
+double MDMBenchmarkNow(void);
+
+// Returns the number of heap allocations performed so far, or 0 if allocations aren't counted.
+uint64_t MDMBenchmarkAllocationCount(void);
+
+// Returns nonzero if MDMBenchmarkAllocationCount is meaningful on this platform.
+int MDMBenchmarkCountsAllocations(void);
+
+void MDMBenchmarkBegin(MDMBenchmarkMeasurement *measurement);
+void MDMBenchmarkEnd(MDMBenchmarkMeasurement *measurement);
+
+// Prints and records the average cost of one operation.
+void MDMBenchmarkReport(const char *name,
+                        const MDMBenchmarkMeasurement *measurement,
+                        double operations);
+
+// Writes the recorded results if requested. Returns a process exit status.
+int MDMBenchmarkFinish(void);
+
+#endif  // MDM_PORTABLE_BENCHMARK_H
@@ -0,0 +1,121 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Measures the spring math performed for every spring animation: solving a spring's equation of
+// motion and its settling duration in each damping regime, sampling it, and looking it up in the
+// spring cache.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "MDMPortableBenchmark.h"
+#include "MDMSpringCache.h"
+#include "MDMSpringSolver.h"
+
+enum {
+  kSpringCount = 1024,
+  kRounds = 500,
+};
+
+// Mass, tension and friction for each spring.
+static double sCoefficients[kSpringCount][3];
+static double sVelocities[kSpringCount];
+
+static void FillSprings(double dampingRatio) {
+  for (size_t i = 0; i < kSpringCount; ++i) {
+    double mass = 1;
+    double tension = 100 + (double)(rand() % 900);
+    sCoefficients[i][0] = mass;
+    sCoefficients[i][1] = tension;
+    sCoefficients[i][2] = dampingRatio * 2 * sqrt(tension * mass);
+    sVelocities[i] = (double)(rand() % 200 - 100) / 10;
+  }
+}
+
+static double MeasureSettling(const char *name, double dampingRatio) {
+  FillSprings(dampingRatio);
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kSpringCount; ++i) {
+      MDMSpringSolver solver;
+      MDMSpringSolverInit(&solver, sCoefficients[i][0], sCoefficients[i][1], sCoefficients[i][2],
+                          sVelocities[i]);
+      checksum += MDMSpringSolverSettlingDuration(&solver, MDMSpringSolverDefaultSettlingThreshold);
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kSpringCount);
+  return checksum;
+}
+
+static double MeasureSampling(const char *name, double dampingRatio) {
+  FillSprings(dampingRatio);
+  static MDMSpringSolver solvers[kSpringCount];
+  for (size_t i = 0; i < kSpringCount; ++i) {
+    MDMSpringSolverInit(&solvers[i], sCoefficients[i][0], sCoefficients[i][1], sCoefficients[i][2],
+                        sVelocities[i]);
+  }
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    double t = (double)round / kRounds;
+    for (size_t i = 0; i < kSpringCount; ++i) {
+      checksum += MDMSpringSolverPosition(&solvers[i], t) + MDMSpringSolverVelocity(&solvers[i], t);
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kSpringCount);
+  return checksum;
+}
+
+// Motion specs reuse a handful of springs, so nearly every lookup is a hit.
+static double MeasureCache(const char *name) {
+  enum { kDistinctSpringCount = 16 };
+  FillSprings(0.8);
+  MDMSpringCache *cache = MDMSpringCacheCreate(64);
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kSpringCount; ++i) {
+      size_t spring = i % kDistinctSpringCount;
+      MDMSpringCacheSolution solution;
+      MDMSpringCacheSolve(cache, sCoefficients[spring][0], sCoefficients[spring][1],
+                          sCoefficients[spring][2], sVelocities[spring], &solution);
+      checksum += solution.settlingDuration;
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMSpringCacheDestroy(cache);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kSpringCount);
+  return checksum;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  srand(11);
+  double checksum = 0;
+  checksum += MeasureSettling("Solve + settling duration (underdamped)", 0.6);
+  checksum += MeasureSettling("Solve + settling duration (critically damped)", 1);
+  checksum += MeasureSettling("Solve + settling duration (overdamped)", 1.8);
+  checksum += MeasureSampling("Position + velocity (underdamped)", 0.6);
+  checksum += MeasureSampling("Position + velocity (overdamped)", 1.8);
+  checksum += MeasureCache("MDMSpringCacheSolve (16 recurring springs)");
+  return isfinite(checksum) ? MDMBenchmarkFinish() : EXIT_FAILURE;
+}
@@ -0,0 +1,54 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Measures the cost of the trace instrumentation around each of the animator's hot paths, both
+// while no trace buffer is active and while one is recording.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "MDMPortableBenchmark.h"
+#include "MDMTraceBuffer.h"
+
+enum {
+  kRounds = 2000000,
+};
+
+static uint64_t MeasureInterval(const char *name) {
+  static int layer;
+  uint64_t checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (uint32_t round = 0; round < kRounds; ++round) {
+    uint64_t start = MDMTraceBegin();
+    checksum += start + round;
+    MDMTraceEnd(MDMTraceEventKindConfigureAnimation, start, &layer, round);
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, kRounds);
+  return checksum;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  uint64_t checksum = MeasureInterval("MDMTraceBegin + MDMTraceEnd (inactive)");
+
+  MDMTraceBuffer *buffer = MDMTraceBufferCreate(4096);
+  MDMTraceBufferSetActive(buffer);
+  checksum += MeasureInterval("MDMTraceBegin + MDMTraceEnd (recording)");
+  MDMTraceBufferDestroy(buffer);
+  return checksum == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
@@ -0,0 +1,111 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Compares the type probes that a single additive animation used to make of its values against the
+// single classification that replaces them. Previously, coercion, the additivity check and the
+// unboxing of the animation's toValue and fromValue each compared the value's type encoding against
+// every candidate struct encoding in turn. On Apple platforms each of those probes was additionally
+// preceded by -isKindOfClass: and -objCType messages, which this benchmark doesn't measure.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MDMPortableBenchmark.h"
+#include "MDMValueClass.h"
+
+enum {
+  kRounds = 1000000,
+};
+
+static const char *const kPointEncoding = "{CGPoint=dd}";
+static const char *const kSizeEncoding = "{CGSize=dd}";
+static const char *const kRectEncoding = "{CGRect={CGPoint=dd}{CGSize=dd}}";
+static const char *const kTransform3DEncoding = "{CATransform3D=dddddddddddddddd}";
+static const char *const kAffineTransformEncoding = "{CGAffineTransform=dddddd}";
+
+// Read through a volatile array so that the probes of each encoding can't be folded.
+static const char *volatile sEncodings[] = {
+  "d", "{CGPoint=dd}", "{CGSize=dd}", "{CGRect={CGPoint=dd}{CGSize=dd}}",
+  "{CATransform3D=dddddddddddddddd}",
+};
+enum { kEncodingCount = sizeof(sEncodings) / sizeof(sEncodings[0]) };
+
+static int ObjCTypeMatches(const char *objCType, const char *encoding) {
+  return strncmp(objCType, encoding, strlen(encoding)) == 0;
+}
+
+// Returns the lane count of the value, or 0 if it can't be unboxed.
+static int Unbox(const char *objCType, int isNumber) {
+  if (isNumber) {
+    return 1;
+  }
+  if (ObjCTypeMatches(objCType, kSizeEncoding) || ObjCTypeMatches(objCType, kPointEncoding)) {
+    return 2;
+  }
+  if (ObjCTypeMatches(objCType, kRectEncoding)) {
+    return 4;
+  }
+  return ObjCTypeMatches(objCType, kTransform3DEncoding) ? 16 : 0;
+}
+
+static int ProbeAnimation(const char *objCType) {
+  // Stands in for -isKindOfClass:[NSNumber class], whose type encodings are a single character.
+  int isNumber = objCType[0] != '{';
+  int coerced = ObjCTypeMatches(objCType, kAffineTransformEncoding);
+  int additive = (isNumber
+                  || ObjCTypeMatches(objCType, kSizeEncoding)
+                  || ObjCTypeMatches(objCType, kPointEncoding)
+                  || ObjCTypeMatches(objCType, kTransform3DEncoding));
+  int toLanes = Unbox(objCType, isNumber);
+  int fromLanes = Unbox(objCType, isNumber);
+  return coerced + additive + toLanes + fromLanes;
+}
+
+static int ClassifyAnimation(const char *objCType) {
+  MDMValueClass valueClass = (objCType[0] != '{') ? MDMValueClassNumber
+                                                  : MDMValueClassOfObjCType(objCType);
+  return (int)MDMValueClassCoerced(valueClass) + MDMValueClassIsAdditive(valueClass);
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+
+  // Summing the results keeps the probes from being optimized away.
+  unsigned long checksum = 0;
+  MDMBenchmarkMeasurement probes = {0};
+  MDMBenchmarkBegin(&probes);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kEncodingCount; ++i) {
+      checksum += (unsigned long)ProbeAnimation(sEncodings[i]);
+    }
+  }
+  MDMBenchmarkEnd(&probes);
+  MDMBenchmarkReport("Repeated type probes (per animation)", &probes,
+                     (double)kRounds * kEncodingCount);
+
+  MDMBenchmarkMeasurement classification = {0};
+  MDMBenchmarkBegin(&classification);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kEncodingCount; ++i) {
+      checksum += (unsigned long)ClassifyAnimation(sEncodings[i]);
+    }
+  }
+  MDMBenchmarkEnd(&classification);
+  MDMBenchmarkReport("MDMValueClassOfObjCType (per animation)", &classification,
+                     (double)kRounds * kEncodingCount);
+
+  return checksum == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
@@ -0,0 +1,106 @@
+/*
+ Copyright 2017-present The Material Motion Authors. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Measures the additive displacement and velocity normalization performed by
+// MDMConfigureAnimation for each value type, along with transform inversion.
+
+#include <stdlib.h>
+
+#include "MDMPortableBenchmark.h"
+#include "MDMValueKernels.h"
+
+enum {
+  kValueCount = 1024,
+  kRounds = 2000,
+};
+
+static MDMValue sFrom[kValueCount];
+static MDMValue sTo[kValueCount];
+
+static void FillValues(MDMValueType type, int perspective) {
+  for (size_t i = 0; i < kValueCount; ++i) {
+    double from[MDMValueMaxLaneCount];
+    double to[MDMValueMaxLaneCount];
+    for (size_t lane = 0; lane < MDMValueMaxLaneCount; ++lane) {
+      from[lane] = (double)(rand() % 1000) / 10;
+      to[lane] = (double)(rand() % 1000) / 10;
+    }
+    if (type == MDMValueTypeTransform3D) {
+      // Diagonally dominant so that every matrix is invertible.
+      for (size_t lane = 0; lane < 16; lane += 5) {
+        to[lane] += 1000;
+      }
+      if (!perspective) {
+        to[3] = to[7] = to[11] = 0;
+        to[15] = 1;
+      }
+    }
+    MDMValueInit(&sFrom[i], type, from);
+    MDMValueInit(&sTo[i], type, to);
+  }
+}
+
+static double MeasureDisplacement(const char *name, MDMValueType type, int perspective) {
+  FillValues(type, perspective);
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kValueCount; ++i) {
+      MDMValue displacement;
+      MDMValueAdditiveDisplacement(&sFrom[i], &sTo[i], &displacement);
+      double velocity = 0;
+      MDMValueNormalizeVelocity(&displacement, 100, &velocity);
+      checksum += velocity + displacement.lanes[0];
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kValueCount);
+  return checksum;
+}
+
+static double MeasureInversion(const char *name, int perspective) {
+  FillValues(MDMValueTypeTransform3D, perspective);
+  double checksum = 0;
+  MDMBenchmarkMeasurement measurement = {0};
+  MDMBenchmarkBegin(&measurement);
+  for (int round = 0; round < kRounds; ++round) {
+    for (size_t i = 0; i < kValueCount; ++i) {
+      double inverse[16];
+      MDMTransform3DInvert(sTo[i].lanes, inverse);
+      checksum += inverse[0];
+    }
+  }
+  MDMBenchmarkEnd(&measurement);
+  MDMBenchmarkReport(name, &measurement, (double)kRounds * kValueCount);
+  return checksum;
+}
+
+int main(int argc, char **argv) {
+  MDMBenchmarkInit(argc, argv);
+  srand(17);
+  double checksum = 0;
+  checksum += MeasureDisplacement("Displacement + velocity (scalar)", MDMValueTypeScalar, 0);
+  checksum += MeasureDisplacement("Displacement + velocity (point)", MDMValueTypePoint, 0);
+  checksum += MeasureDisplacement("Displacement + velocity (size)", MDMValueTypeSize, 0);
+  checksum += MeasureDisplacement("Displacement + velocity (rect)", MDMValueTypeRect, 0);
+  checksum += MeasureDisplacement("Displacement (affine transform)", MDMValueTypeTransform3D, 0);
+  checksum += MeasureDisplacement("Displacement (perspective transform)",
+                                  MDMValueTypeTransform3D, 1);
+  checksum += MeasureInversion("MDMTransform3DInvert (affine)", 0);
+  checksum += MeasureInversion("MDMTransform3DInvert (perspective)", 1);
+  return checksum == 0 ? EXIT_FAILURE : MDMBenchmarkFinish();
+}
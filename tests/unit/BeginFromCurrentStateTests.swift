@@ -22,6 +22,23 @@ import MotionAnimator
 import MotionAnimator
 #endif
 
+// Counts the number of times its presentation layer is requested.
+private class PresentationCountingLayer: CALayer {
+  var presentationCount = 0
+
+  override func presentation() -> Self? {
+    presentationCount += 1
+    return super.presentation()
+  }
+}
+
+// Backs a view with a PresentationCountingLayer.
+private class PresentationCountingView: UIView {
+  override class var layerClass: AnyClass {
+    return PresentationCountingLayer.self
+  }
+}
+
 class BeginFromCurrentStateTests: XCTestCase {
   var animator: MotionAnimator!
   var traits: MDMAnimationTraits!
@@ -240,8 +257,69 @@ class BeginFromCurrentStateTests: XCTestCase {
       let animation = addedAnimations.last as! CABasicAnimation
       XCTAssertFalse(animation.isAdditive)
       XCTAssertEqual(animation.keyPath, AnimatableKeyPath.opacity.rawValue)
-      XCTAssertEqual(animation.fromValue as! Float, initialValue)
+      XCTAssertEqual(animation.fromValue as! Float, initialValue, accuracy: 0.001)
       XCTAssertEqual(animation.toValue as! CGFloat, 1.0, accuracy: 0.0001)
     }
   }
+
+  func testPresentationLayerIsCapturedOncePerLayer() {
+    let countingView = PresentationCountingView()
+    view.addSubview(countingView)
+    CATransaction.flush()
+    let layer = countingView.layer as! PresentationCountingLayer
+    layer.presentationCount = 0
+
+    animator.additive = false
+
+    animator.animate(with: traits) {
+      countingView.frame = CGRect(x: 10, y: 20, width: 30, height: 40)
+      countingView.alpha = 0.5
+      countingView.backgroundColor = .red
+    }
+
+    XCTAssertGreaterThan(addedAnimations.count, 1)
+    XCTAssertEqual(layer.presentationCount, 1)
+  }
+
+  func testInterruptionsAreEvaluatedWithoutThePresentationLayer() {
+    let countingView = PresentationCountingView()
+    view.addSubview(countingView)
+    CATransaction.flush()
+    let layer = countingView.layer as! PresentationCountingLayer
+
+    animator.additive = false
+
+    animator.animate(with: traits, between: [0, 1], layer: layer, keyPath: .opacity)
+    RunLoop.main.run(until: .init(timeIntervalSinceNow: 0.01))
+
+    let initialValue = layer.presentation()!.opacity
+    layer.presentationCount = 0
+
+    animator.animate(with: traits, between: [0, 0.5], layer: layer, keyPath: .opacity)
+
+    XCTAssertEqual(layer.presentationCount, 0)
+    XCTAssertEqual(addedAnimations.count, 2)
+    if addedAnimations.count == 2 {
+      let animation = addedAnimations.last as! CABasicAnimation
+      XCTAssertEqual(animation.fromValue as! Float, initialValue, accuracy: 0.001)
+    }
+  }
+
+  func testAdditiveAnimationsDoNotCapturePresentationLayers() {
+    let countingView = PresentationCountingView()
+    view.addSubview(countingView)
+    CATransaction.flush()
+    let layer = countingView.layer as! PresentationCountingLayer
+    layer.presentationCount = 0
+
+    animator.additive = true
+
+    animator.animate(with: traits) {
+      countingView.center = CGPoint(x: 50, y: 60)
+      countingView.alpha = 0.5
+    }
+
+    XCTAssertEqual(addedAnimations.count, 2)
+    XCTAssertEqual(layer.presentationCount, 0)
+  }
 }
@@ -147,6 +147,33 @@ class ImplicitAnimationTests: XCTestCase {
     }
   }
 
+  func testRepeatedActionsAreCoalesced() {
+    animator.animate(with: traits) {
+      self.view.alpha = 0.5
+      self.view.center = .init(x: 10, y: 10)
+      self.view.alpha = 0.2
+      self.view.center = .init(x: 50, y: 50)
+    }
+
+    XCTAssertEqual(addedAnimations.count, 2)
+    XCTAssertEqual(animator.interceptedActionCount, 4)
+    XCTAssertEqual(animator.coalescedActionCount, 2)
+    guard addedAnimations.count == 2 else {
+      return
+    }
+
+    // Each animation begins from the value prior to the first change and ends at the final value.
+    let opacityAnimation = addedAnimations[0] as! CABasicAnimation
+    XCTAssertEqual(opacityAnimation.keyPath, AnimatableKeyPath.opacity.rawValue)
+    XCTAssertEqual(opacityAnimation.fromValue as! CGFloat, 1)
+    XCTAssertEqual(opacityAnimation.toValue as! CGFloat, 0.2, accuracy: 0.0001)
+
+    let positionAnimation = addedAnimations[1] as! CABasicAnimation
+    XCTAssertEqual(positionAnimation.keyPath, AnimatableKeyPath.position.rawValue)
+    XCTAssertEqual(positionAnimation.fromValue as! CGPoint, .init(x: 0, y: 0))
+    XCTAssertEqual(positionAnimation.toValue as! CGPoint, .init(x: 50, y: 50))
+  }
+
   func testFrameActionAddsTwoAnimations() {
     animator.animate(with: traits) {
       self.view.frame = .init(x: 0, y: 0, width: 100, height: 100)
@@ -255,6 +282,30 @@ class ImplicitAnimationTests: XCTestCase {
     XCTAssertEqual(view.alpha, 0)
   }
 
+  func testCompletionIsInvokedOnceForAllAnimatedLayers() {
+    let traits = MDMAnimationTraits(duration: 0.05)
+    let views = (0..<40).map { _ -> UIView in
+      let subview = UIView()
+      view.addSubview(subview)
+      return subview
+    }
+    CATransaction.flush()
+
+    let didComplete = expectation(description: "Did complete")
+    var completionCount = 0
+    animator.animate(with: traits, animations: {
+      views.forEach { $0.alpha = 0 }
+    }, completion: { _ in
+      completionCount += 1
+      didComplete.fulfill()
+    })
+
+    XCTAssertEqual(addedAnimations.count, views.count)
+
+    waitForExpectations(timeout: 1)
+    XCTAssertEqual(completionCount, 1)
+  }
+
   func testUnsupportedAnimationKeyIsNotAnimated() {
     animator.animate(with: traits) {
       self.view.layer.sublayers = []
@@ -14,9 +14,55 @@
  limitations under the License.
  */
 
+#import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
+#import <pthread.h>
 #import "MotionAnimator.h"
 
+// The allocator's logging hook, which is what malloc stack logging is built on. Exported by
+// libsystem_malloc but not declared in its public headers.
+typedef void(MallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3,
+                           uintptr_t result, uint32_t numberOfHotFramesToSkip);
+extern MallocLogger *malloc_logger;
+
+// The malloc logger's event type flags.
+static const uint32_t kMallocLoggerTypeAlloc = 2;
+static const uint32_t kMallocLoggerTypeVMAllocate = 16;
+
+static MallocLogger *sPreviousMallocLogger = NULL;
+static uint64_t sMainThreadAllocationCount = 0;
+
+static void CountMainThreadAllocation(uint32_t type,
+                                      uintptr_t arg1,
+                                      uintptr_t arg2,
+                                      uintptr_t arg3,
+                                      uintptr_t result,
+                                      uint32_t numberOfHotFramesToSkip) {
+  if ((type & kMallocLoggerTypeAlloc) && !(type & kMallocLoggerTypeVMAllocate)
+      && pthread_main_np()) {
+    sMainThreadAllocationCount++;
+  }
+  if (sPreviousMallocLogger != NULL) {
+    sPreviousMallocLogger(type, arg1, arg2, arg3, result, numberOfHotFramesToSkip + 1);
+  }
+}
+
+// Returns the number of heap allocations the main thread makes while running `block`.
+static uint64_t MainThreadAllocationCount(void (^block)(void)) {
+  sPreviousMallocLogger = malloc_logger;
+  malloc_logger = CountMainThreadAllocation;
+  uint64_t startCount = sMainThreadAllocationCount;
+  block();
+  uint64_t count = sMainThreadAllocationCount - startCount;
+  malloc_logger = sPreviousMallocLogger;
+  sPreviousMallocLogger = NULL;
+  return count;
+}
+
+// The most heap allocations the animator may make per animation in its steady state, beyond those
+// Core Animation makes to add the same animation and write the same model value on its own.
+static const double kMaximumAnimatorAllocationsPerAnimation = 2;
+
 @interface MotionAnimatorTests : XCTestCase
 @end
 
@@ -143,7 +189,10 @@
     XCTAssertEqual(springAnimation.keyPath, keyPath);
 
     if ([springAnimation respondsToSelector:@selector(settlingDuration)]) {
-      XCTAssertEqual(springAnimation.duration, springAnimation.settlingDuration);
+      // The animator solves for the settling duration analytically rather than using Core
+      // Animation's simulated estimate. This overdamped spring's envelope stays within 0.1% of the
+      // total displacement after 7.6011524 seconds.
+      XCTAssertEqualWithAccuracy(springAnimation.duration, 7.6011524, 1e-5);
     } else {
       XCTAssertEqual(springAnimation.duration, traits.duration);
     }
@@ -166,6 +215,79 @@
   XCTAssertTrue(didAddAnimation);
 }
 
+- (void)testRepeatedTraitsProduceDistinctAnimations {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  CALayer *layer = [[CALayer alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+
+  NSMutableArray<CAAnimation *> *addedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *layer, CAAnimation *animation) {
+    [addedAnimations addObject:animation];
+  }];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"cornerRadius"];
+  [animator animateWithTraits:traits between:@[ @1, @4 ] layer:layer keyPath:@"cornerRadius"];
+
+  XCTAssertEqual(addedAnimations.count, 2);
+  CABasicAnimation *first = (CABasicAnimation *)addedAnimations[0];
+  CABasicAnimation *second = (CABasicAnimation *)addedAnimations[1];
+  XCTAssertNotEqual(first, second);
+  XCTAssertEqual(first.duration, 0.5);
+  XCTAssertEqual(second.duration, 0.5);
+  XCTAssertEqual([first.fromValue doubleValue], -1);
+  XCTAssertEqual([second.fromValue doubleValue], -3);
+}
+
+- (void)testMutatedTraitsAreReflectedInSubsequentAnimations {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  CALayer *layer = [[CALayer alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+
+  NSMutableArray<CAAnimation *> *addedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *layer, CAAnimation *animation) {
+    [addedAnimations addObject:animation];
+  }];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"cornerRadius"];
+  traits.duration = 0.25;
+  traits.timingCurve = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"cornerRadius"];
+
+  XCTAssertEqual(addedAnimations.count, 2);
+  CABasicAnimation *second = (CABasicAnimation *)addedAnimations[1];
+  XCTAssertEqual(second.duration, 0.25);
+  float point1[2];
+  [second.timingFunction getControlPointAtIndex:1 values:point1];
+  XCTAssertEqualWithAccuracy(point1[0], 0, 0.00001);
+  XCTAssertEqualWithAccuracy(point1[1], 0, 0.00001);
+}
+
+- (void)testMutatedTimingCurvesAreReflectedInSubsequentAnimations {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  CALayer *layer = [[CALayer alloc] init];
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:20];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:0.5
+                                                             timingCurve:springCurve];
+
+  NSMutableArray<CAAnimation *> *addedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *layer, CAAnimation *animation) {
+    [addedAnimations addObject:animation];
+  }];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"cornerRadius"];
+  // Prototypes are cached per timing curve object, so the same curve must be re-read.
+  springCurve.tension = 500;
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"cornerRadius"];
+
+  XCTAssertEqual(addedAnimations.count, 2);
+  CASpringAnimation *first = (CASpringAnimation *)addedAnimations[0];
+  CASpringAnimation *second = (CASpringAnimation *)addedAnimations[1];
+  XCTAssertEqualWithAccuracy(first.stiffness, 300, 0.00001);
+  XCTAssertEqualWithAccuracy(second.stiffness, 500, 0.00001);
+}
+
 #pragma mark - Legacy API
 
 - (void)testAnimationWithTimingNilCompletion {
@@ -209,4 +331,919 @@
   XCTAssertEqualWithAccuracy(layer.opacity, 1, 0.0001);
 }
 
+#pragma mark - Motion specs
+
+- (void)testCompiledSpecsAreInternedAndServeSharedTraits {
+  static const MDMMotionSpecCurve curves[] = {
+    MDMMotionSpecCubicBezier(0.4, 0, 0.2, 1),
+    MDMMotionSpecSpring(1, 100, 10, 0),
+  };
+  static const MDMMotionSpecEntry entries[] = {
+    MDMMotionSpecEntryMake(0.015, 0.36, 0),
+    MDMMotionSpecEntryMake(0, 0.5, 1),
+  };
+  static const MDMMotionSpecTable table = MDMMotionSpecTableMake(curves, entries);
+
+  MDMCompiledMotionSpec *spec = [MDMCompiledMotionSpec specWithTable:&table];
+  XCTAssertNotNil(spec);
+  XCTAssertEqual(spec.count, 2u);
+  XCTAssertEqual([MDMCompiledMotionSpec specWithData:spec.serializedData], spec);
+
+  MDMAnimationTraits *traits = spec[0];
+  XCTAssertEqual(spec[0], traits);
+  XCTAssertEqualWithAccuracy(traits.delay, 0.015, 0.0001);
+  XCTAssertEqualWithAccuracy(traits.duration, 0.36, 0.0001);
+  XCTAssertTrue([traits.timingCurve isKindOfClass:[CAMediaTimingFunction class]]);
+  XCTAssertTrue([spec[1].timingCurve isKindOfClass:[MDMSpringTimingCurve class]]);
+
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  CALayer *layer = [[CALayer alloc] init];
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"opacity"];
+  XCTAssertEqual(layer.opacity, 1);
+}
+
+#pragma mark - Tracing
+
+- (void)testTraceRecorderRecordsAnimationsAsChromeTraceEvents {
+  MDMAnimationTraceRecorder *recorder = [[MDMAnimationTraceRecorder alloc] initWithCapacity:64];
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"opacity"];
+  XCTAssertEqual(recorder.eventCount, 0u);
+
+  [recorder startRecording];
+  XCTAssertTrue(recorder.isRecording);
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:@"opacity"];
+  [recorder stopRecording];
+  XCTAssertFalse(recorder.isRecording);
+
+  NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[recorder chromeTraceData]
+                                                        options:0
+                                                          error:nil];
+  NSArray<NSDictionary *> *events = trace[@"traceEvents"];
+  XCTAssertEqual(events.count, recorder.eventCount);
+  NSArray *names = [events valueForKey:@"name"];
+  XCTAssertTrue([names containsObject:@"AnimationFromTraits"]);
+  XCTAssertTrue([names containsObject:@"ConfigureAnimation"]);
+  XCTAssertTrue([names containsObject:@"RegisterAnimation"]);
+  XCTAssertEqualObjects(events.firstObject[@"args"][@"keyPath"], @"opacity");
+
+  [recorder removeAllEvents];
+  XCTAssertEqual(recorder.eventCount, 0u);
+}
+
+#pragma mark - Metrics
+
+- (void)testMetricsTrackStacksAndEarlyExits {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  for (NSInteger i = 0; i < 3; ++i) {
+    [animator animateWithTraits:traits
+                        between:@[ [NSValue valueWithCGPoint:CGPointZero],
+                                   [NSValue valueWithCGPoint:CGPointMake(10 * (i + 1), 0)] ]
+                          layer:layer
+                        keyPath:MDMKeyPathPosition];
+  }
+  animator.timeScaleFactor = 0;
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  MDMMotionAnimatorMetrics *metrics = [animator currentMetrics];
+  XCTAssertEqual(metrics.activeAnimationCount, 3u);
+  XCTAssertEqual(metrics.peakActiveAnimationCount, 3u);
+  XCTAssertEqual(metrics.additiveAnimationCount, 3u);
+  XCTAssertEqual(metrics.nonAdditiveAnimationCount, 0u);
+  XCTAssertEqual(metrics.earlyExitCount, 1u);
+  XCTAssertGreaterThan(metrics.mainThreadTime, 0);
+  XCTAssertEqual([metrics numberOfLayersWithAnimationCount:3], 1u);
+  XCTAssertEqual([metrics numberOfStacksWithDepth:3 forKeyPath:MDMKeyPathPosition], 1u);
+  XCTAssertEqual([metrics numberOfStacksWithDepth:1 forKeyPath:MDMKeyPathOpacity], 0u);
+  XCTAssertEqual([metrics peakStackDepthForKeyPath:MDMKeyPathPosition], 3u);
+
+  [animator removeAllAnimations];
+  [animator resetMetrics];
+  metrics = [animator currentMetrics];
+  XCTAssertEqual(metrics.activeAnimationCount, 0u);
+  XCTAssertEqual(metrics.peakActiveAnimationCount, 0u);
+  XCTAssertEqual(metrics.additiveAnimationCount, 0u);
+  XCTAssertEqual(metrics.earlyExitCount, 0u);
+  XCTAssertEqual([metrics peakStackDepthForKeyPath:MDMKeyPathPosition], 0u);
+}
+
+#pragma mark - Additive stack compaction
+
+- (void)testCompactionBoundsAdditiveStacks {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.maximumAdditiveStackDepth = 4;
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:30];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:0.5
+                                                             timingCurve:springCurve];
+  CALayer *layer = [[CALayer alloc] init];
+
+  // A drag that retargets in a different direction every time.
+  for (NSInteger i = 0; i < 20; ++i) {
+    CGPoint destination = CGPointMake(10 * i, (i % 2) ? 50 : -50);
+    [animator animateWithTraits:traits
+                        between:@[ [NSValue valueWithCGPoint:layer.position],
+                                   [NSValue valueWithCGPoint:destination] ]
+                          layer:layer
+                        keyPath:MDMKeyPathPosition];
+    XCTAssertLessThanOrEqual(layer.animationKeys.count, 4u);
+  }
+  for (NSString *key in layer.animationKeys) {
+    CABasicAnimation *animation = (CABasicAnimation *)[layer animationForKey:key];
+    XCTAssertTrue(animation.additive);
+    XCTAssertEqualObjects(animation.keyPath, MDMKeyPathPosition);
+  }
+
+  MDMMotionAnimatorMetrics *metrics = [animator currentMetrics];
+  XCTAssertEqual(metrics.activeAnimationCount, layer.animationKeys.count);
+  XCTAssertGreaterThan(metrics.foldedAnimationCount, 0u);
+  XCTAssertLessThanOrEqual([metrics peakStackDepthForKeyPath:MDMKeyPathPosition], 5u);
+
+  animator.maximumAdditiveStackDepth = 0;
+  [animator animateWithTraits:traits
+                      between:@[ [NSValue valueWithCGPoint:layer.position],
+                                 [NSValue valueWithCGPoint:CGPointZero] ]
+                        layer:layer
+                      keyPath:MDMKeyPathPosition];
+  XCTAssertEqual([animator currentMetrics].foldedAnimationCount, metrics.foldedAnimationCount);
+}
+
+#pragma mark - Keyframe mode
+
+- (void)testKeyframeModeAddsKeyframeAnimationsWithinTolerance {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.usesKeyframeAnimations = YES;
+  animator.keyframeTolerance = 0.001;
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:20];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:0.5
+                                                             timingCurve:springCurve];
+  CALayer *layer = [[CALayer alloc] init];
+  NSMutableArray<CAAnimation *> *tracedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    [tracedAnimations addObject:animation];
+  }];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  XCTAssertEqual(layer.animationKeys.count, 1u);
+  CAKeyframeAnimation *animation =
+      (CAKeyframeAnimation *)[layer animationForKey:layer.animationKeys.firstObject];
+  XCTAssertTrue([animation isKindOfClass:[CAKeyframeAnimation class]]);
+  XCTAssertEqualObjects(tracedAnimations.firstObject, animation);
+  XCTAssertEqual(animation.values.count, animation.keyTimes.count);
+  XCTAssertGreaterThan(animation.values.count, 2u);
+  XCTAssertEqualWithAccuracy([animation.values.firstObject doubleValue], 0, 0.001);
+  XCTAssertEqualWithAccuracy([animation.values.lastObject doubleValue], 1, 0.001);
+  XCTAssertEqualWithAccuracy([animation.keyTimes.lastObject doubleValue], 1, 1e-9);
+
+  // A looser tolerance needs fewer keyframes for the same spring.
+  animator.keyframeTolerance = 0.01;
+  [layer removeAllAnimations];
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  CAKeyframeAnimation *looserAnimation =
+      (CAKeyframeAnimation *)[layer animationForKey:layer.animationKeys.firstObject];
+  XCTAssertLessThan(looserAnimation.values.count, animation.values.count);
+
+  // Disabling the mode adds the spring as-is.
+  animator.usesKeyframeAnimations = NO;
+  [layer removeAllAnimations];
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  XCTAssertFalse([[layer animationForKey:layer.animationKeys.firstObject]
+                     isKindOfClass:[CAKeyframeAnimation class]]);
+}
+
+#pragma mark - Animation plans
+
+- (void)testPlansBuiltOffTheMainThreadAreAppliedInOneStep {
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDelay:0.1 duration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+  CALayer *otherLayer = [[CALayer alloc] init];
+
+  __block MDMAnimationPlan *plan = nil;
+  XCTestExpectation *built = [self expectationWithDescription:@"built"];
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    MDMAnimationPlanBuilder *builder = [[MDMAnimationPlanBuilder alloc] init];
+    builder.timeScaleFactor = 2;
+    [builder animateWithTraits:traits
+                       between:@[ @0, @10 ]
+                         layer:layer
+                       keyPath:MDMKeyPathCornerRadius];
+    [builder animateWithTraits:traits
+                       between:@[ @0, @1 ]
+                         layer:otherLayer
+                       keyPath:MDMKeyPathOpacity];
+    plan = [builder build];
+    XCTAssertEqual(builder.count, 0u);
+    [built fulfill];
+  });
+  [self waitForExpectationsWithTimeout:1 handler:nil];
+  XCTAssertEqual(plan.count, 2u);
+  // Building doesn't touch the layers.
+  XCTAssertEqual(layer.animationKeys.count, 0u);
+  XCTAssertEqualWithAccuracy(layer.cornerRadius, 0, 0.0001);
+
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.timeScaleFactor = 5;
+  NSUInteger activeAnimationCountBefore = [animator currentMetrics].activeAnimationCount;
+  [animator applyPlan:plan completion:nil];
+
+  XCTAssertEqualWithAccuracy(layer.cornerRadius, 10, 0.0001);
+  XCTAssertEqualWithAccuracy(otherLayer.opacity, 1, 0.0001);
+  XCTAssertEqual([animator currentMetrics].activeAnimationCount, activeAnimationCountBefore + 2);
+
+  CABasicAnimation *animation =
+      (CABasicAnimation *)[layer animationForKey:layer.animationKeys.firstObject];
+  XCTAssertTrue(animation.additive);
+  XCTAssertEqualWithAccuracy([animation.fromValue doubleValue], -10, 0.0001);
+  // The builder's time scale factor applies rather than the animator's.
+  XCTAssertEqualWithAccuracy(animation.duration, 1, 0.0001);
+  XCTAssertEqualObjects(animation.fillMode, kCAFillModeBackwards);
+  CFTimeInterval now = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+  XCTAssertEqualWithAccuracy(animation.beginTime, now + 0.2, 0.05);
+
+  // Plans are immutable and can be applied again.
+  [animator applyPlan:plan completion:nil];
+  XCTAssertEqual(layer.animationKeys.count, 2u);
+}
+
+#pragma mark - Recorded animations
+
+- (void)testRecordedAnimationsAreSubmittedTogether {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 10; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  __block NSUInteger tracedCount = 0;
+  [animator addCoreAnimationTracer:^(CALayer *layer, CAAnimation *animation) {
+    tracedCount++;
+  }];
+
+  __block BOOL didComplete = NO;
+  [animator recordAnimations:^{
+    for (CALayer *layer in layers) {
+      [animator animateWithTraits:traits
+                          between:@[ @0, @1 ]
+                            layer:layer
+                          keyPath:MDMKeyPathOpacity];
+    }
+    // Nothing is performed until the block returns.
+    XCTAssertEqual(layers.firstObject.animationKeys.count, 0u);
+    XCTAssertEqual(tracedCount, 0u);
+  } completion:^(BOOL finished) {
+    didComplete = YES;
+  }];
+
+  XCTAssertEqual(tracedCount, layers.count);
+  for (CALayer *layer in layers) {
+    XCTAssertEqual(layer.animationKeys.count, 1u);
+    XCTAssertEqualWithAccuracy(layer.opacity, 1, 0.0001);
+  }
+  XCTAssertEqual([animator currentMetrics].activeAnimationCount, layers.count);
+  XCTAssertFalse(didComplete);
+  // The model values of the whole recording were written in a single transaction.
+  XCTAssertEqual([animator currentMetrics].avoidedTransactionCount, layers.count - 1);
+}
+
+- (void)testRecordedAnimationsBeginFromEarlierRecordedDestinations {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  [animator recordAnimations:^{
+    [animator animateWithTraits:traits
+                        between:@[ @0, @5 ]
+                          layer:layer
+                        keyPath:MDMKeyPathCornerRadius];
+    [animator animateWithTraits:traits
+                        between:@[ @0, @8 ]
+                          layer:layer
+                        keyPath:MDMKeyPathCornerRadius];
+  } completion:nil];
+
+  // As if performed one by one, the second additive animation begins from the first's destination.
+  XCTAssertEqual(layer.animationKeys.count, 2u);
+  CABasicAnimation *animation =
+      (CABasicAnimation *)[layer animationForKey:layer.animationKeys.lastObject];
+  XCTAssertEqualWithAccuracy([animation.fromValue doubleValue], 5 - 8, 0.0001);
+  XCTAssertEqualWithAccuracy(layer.cornerRadius, 8, 0.0001);
+}
+
+- (void)testTraitsModifiedWithinARecordingApplyOnlyToLaterRequests {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CABasicAnimation *> *animations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *layer, CAAnimation *animation) {
+    [animations addObject:(CABasicAnimation *)animation];
+  }];
+
+  [animator recordAnimations:^{
+    for (NSInteger i = 0; i < 3; ++i) {
+      traits.duration = 0.5 * (i + 1);
+      traits.delay = 0.1 * i;
+      [animator animateWithTraits:traits
+                          between:@[ @0, @1 ]
+                            layer:[[CALayer alloc] init]
+                          keyPath:MDMKeyPathOpacity];
+    }
+  } completion:nil];
+
+  XCTAssertEqual(animations.count, 3u);
+  for (NSUInteger i = 0; i < animations.count; ++i) {
+    XCTAssertEqualWithAccuracy(animations[i].duration, 0.5 * (i + 1), 0.0001);
+  }
+  XCTAssertLessThan(animations[0].beginTime, animations[2].beginTime);
+}
+
+#pragma mark - Model layer writes
+
+- (void)testExplicitAnimationsWithinImplicitBlocksDoNotOpenModelTransactions {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  [animator animateWithTraits:traits animations:^{
+    [animator animateWithTraits:traits
+                        between:@[ @0, @4 ]
+                          layer:layer
+                        keyPath:MDMKeyPathCornerRadius];
+    layer.opacity = 0.5;
+  }];
+
+  XCTAssertEqualWithAccuracy(layer.cornerRadius, 4, 0.0001);
+  XCTAssertEqualWithAccuracy(layer.opacity, 0.5, 0.0001);
+  // One explicit corner radius animation and one implicit opacity animation. Writing the corner
+  // radius did not add an implicit animation of its own.
+  XCTAssertEqual(layer.animationKeys.count, 2u);
+  XCTAssertEqual([animator currentMetrics].avoidedTransactionCount, 1u);
+}
+
+#pragma mark - Value classification
+
+- (void)testValuesAreClassifiedForCoercionAndAdditivity {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+  NSMutableDictionary<NSString *, CABasicAnimation *> *animations =
+      [NSMutableDictionary dictionary];
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    CABasicAnimation *basicAnimation = (CABasicAnimation *)animation;
+    animations[basicAnimation.keyPath] = basicAnimation;
+  }];
+
+  [animator animateWithTraits:traits
+                      between:@[ UIColor.redColor, UIColor.blueColor ]
+                        layer:layer
+                      keyPath:MDMKeyPathBackgroundColor];
+  [animator animateWithTraits:traits
+                      between:@[ [UIBezierPath bezierPathWithRect:CGRectMake(0, 0, 1, 1)],
+                                 [UIBezierPath bezierPathWithRect:CGRectMake(0, 0, 2, 2)] ]
+                        layer:layer
+                      keyPath:@"shadowPath"];
+  [animator animateWithTraits:traits
+                      between:@[ [NSValue valueWithCGPoint:CGPointMake(10, 20)],
+                                 [NSValue valueWithCGPoint:CGPointMake(30, 60)] ]
+                        layer:layer
+                      keyPath:MDMKeyPathPosition];
+  [animator animateWithTraits:traits
+                      between:@[ [NSValue valueWithCGAffineTransform:CGAffineTransformIdentity],
+                                 [NSValue valueWithCGAffineTransform:
+                                     CGAffineTransformMakeTranslation(5, 0)] ]
+                        layer:layer
+                      keyPath:MDMKeyPathTransform];
+
+  // Colors and paths are coerced and never additive.
+  CABasicAnimation *colorAnimation = animations[MDMKeyPathBackgroundColor];
+  XCTAssertFalse(colorAnimation.additive);
+  XCTAssertEqual(CFGetTypeID((__bridge CFTypeRef)colorAnimation.toValue), CGColorGetTypeID());
+  CABasicAnimation *pathAnimation = animations[@"shadowPath"];
+  XCTAssertFalse(pathAnimation.additive);
+  XCTAssertEqual(CFGetTypeID((__bridge CFTypeRef)pathAnimation.toValue), CGPathGetTypeID());
+
+  // Points and coerced affine transforms are additive and animate from their displacement.
+  CABasicAnimation *positionAnimation = animations[MDMKeyPathPosition];
+  XCTAssertTrue(positionAnimation.additive);
+  XCTAssertTrue(CGPointEqualToPoint([positionAnimation.fromValue CGPointValue],
+                                    CGPointMake(-20, -40)));
+  XCTAssertTrue(CGPointEqualToPoint([positionAnimation.toValue CGPointValue], CGPointZero));
+  CABasicAnimation *transformAnimation = animations[MDMKeyPathTransform];
+  XCTAssertTrue(transformAnimation.additive);
+  CATransform3D displacement = [transformAnimation.fromValue CATransform3DValue];
+  XCTAssertEqualWithAccuracy(displacement.m41, -5, 1e-9);
+  XCTAssertTrue(CATransform3DIsIdentity([transformAnimation.toValue CATransform3DValue]));
+}
+
+#pragma mark - Staggered groups
+
+- (void)testStaggeredGroupsDelayEachLayerFromASharedMoment {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDelay:0.1 duration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 10; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  NSMutableArray<CABasicAnimation *> *tracedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    [tracedAnimations addObject:(CABasicAnimation *)animation];
+  }];
+
+  __block NSInteger completionCount = 0;
+  [animator animateWithTraits:traits
+                      stagger:[MDMStagger linearStaggerWithInterval:0.05]
+                      between:@[ @0, @1 ]
+                       layers:layers
+                      keyPath:MDMKeyPathOpacity
+                   completion:^(BOOL finished) {
+                     completionCount++;
+                   }];
+
+  XCTAssertEqual(tracedAnimations.count, layers.count);
+  for (NSUInteger i = 0; i < layers.count; ++i) {
+    XCTAssertEqualWithAccuracy(layers[i].opacity, 1, 0.0001);
+    XCTAssertEqual(layers[i].animationKeys.count, 1u);
+    CABasicAnimation *animation = tracedAnimations[i];
+    XCTAssertEqualObjects(animation.fillMode, kCAFillModeBackwards);
+    XCTAssertEqualWithAccuracy([animation.fromValue doubleValue], -1, 0.0001);
+    // Standalone layers share the media timespace, so delays are relative to the first layer's.
+    XCTAssertEqualWithAccuracy(animation.beginTime - tracedAnimations[0].beginTime, i * 0.05,
+                               1e-9);
+  }
+  XCTAssertEqual([animator currentMetrics].activeAnimationCount, layers.count);
+  XCTAssertEqual([animator currentMetrics].avoidedTransactionCount, layers.count - 1);
+  XCTAssertEqual(completionCount, 0);
+}
+
+- (void)testAnimationsOfAGroupRemainActiveUntilTheWholeGroupCompletes {
+  UIWindow *window = [[UIWindow alloc] init];
+  [window makeKeyAndVisible];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 2; ++i) {
+    UIView *view = [[UIView alloc] init];
+    [window addSubview:view];
+    [layers addObject:view.layer];
+  }
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.05];
+
+  // The first layer's animation finishes at 0.05 seconds, the second's at 0.55 seconds.
+  XCTestExpectation *didComplete = [self expectationWithDescription:@"Did complete"];
+  [animator animateWithTraits:traits
+                      stagger:[MDMStagger linearStaggerWithInterval:0.5]
+                      between:@[ @0, @1 ]
+                       layers:layers
+                      keyPath:MDMKeyPathOpacity
+                   completion:^(BOOL finished) {
+                     [didComplete fulfill];
+                   }];
+  XCTAssertEqual([animator currentMetrics].activeAnimationCount, 2u);
+
+  XCTestExpectation *firstDidFinish = [self expectationWithDescription:@"First did finish"];
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)),
+                 dispatch_get_main_queue(), ^{
+    // Core Animation has removed the first animation, but the group shares one completion.
+    XCTAssertEqual(layers[0].animationKeys.count, 0u);
+    XCTAssertEqual(layers[1].animationKeys.count, 1u);
+    XCTAssertEqual([animator currentMetrics].activeAnimationCount, 2u);
+    [firstDidFinish fulfill];
+  });
+  [self waitForExpectations:@[ firstDidFinish ] timeout:1];
+
+  [self waitForExpectations:@[ didComplete ] timeout:2];
+  XCTAssertEqual([animator currentMetrics].activeAnimationCount, 0u);
+}
+
+- (void)testEasedAndCustomStaggers {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSArray<CALayer *> *layers = @[ [[CALayer alloc] init], [[CALayer alloc] init],
+                                  [[CALayer alloc] init] ];
+  NSMutableArray<CAAnimation *> *tracedAnimations = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    [tracedAnimations addObject:animation];
+  }];
+
+  CAMediaTimingFunction *linear =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  [animator animateWithTraits:traits
+                      stagger:[MDMStagger easedStaggerWithDuration:0.2 timingFunction:linear]
+                      between:@[ @0, @1 ]
+                       layers:layers
+                      keyPath:MDMKeyPathOpacity
+                   completion:nil];
+  XCTAssertEqualWithAccuracy(tracedAnimations[2].beginTime - tracedAnimations[0].beginTime, 0.2,
+                             1e-6);
+  XCTAssertEqualWithAccuracy(tracedAnimations[1].beginTime - tracedAnimations[0].beginTime, 0.1,
+                             1e-6);
+
+  // Exit animations typically stagger from the last layer.
+  [tracedAnimations removeAllObjects];
+  MDMStagger *reversed = [MDMStagger staggerWithBlock:^NSTimeInterval(NSUInteger index,
+                                                                       NSUInteger count) {
+    return (count - 1 - index) * 0.1;
+  }];
+  [animator animateWithTraits:traits
+                      stagger:reversed
+                      between:@[ @1, @0 ]
+                       layers:layers
+                      keyPath:MDMKeyPathOpacity
+                   completion:nil];
+  XCTAssertEqualWithAccuracy(tracedAnimations[0].beginTime - tracedAnimations[2].beginTime, 0.2,
+                             1e-9);
+  XCTAssertNotEqualObjects(tracedAnimations[0].fillMode, tracedAnimations[2].fillMode);
+}
+
+#pragma mark - Interruptions
+
+- (void)testInterruptingSpringsContinueWithTheCurrentVelocity {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  CALayer *layer = [[CALayer alloc] init];
+  CAMediaTimingFunction *linear =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  MDMAnimationTraits *fadeIn = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:1
+                                                             timingCurve:linear];
+  [animator animateWithTraits:fadeIn between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  // Halfway through the fade in, the opacity is 0.5 and increasing by 1 per second.
+  layer.timeOffset = 0.5;
+
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:20];
+  MDMAnimationTraits *fadeOut = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                 duration:0.5
+                                                              timingCurve:springCurve];
+  __block CASpringAnimation *interruption = nil;
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    interruption = (CASpringAnimation *)animation;
+  }];
+  [animator animateWithTraits:fadeOut between:@[ @1, @0 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  XCTAssertTrue([interruption isKindOfClass:[CASpringAnimation class]]);
+  XCTAssertEqualWithAccuracy([interruption.fromValue doubleValue], 0.5, 0.01);
+  // Moving at 1 per second away from a destination that is 0.5 away.
+  XCTAssertEqualWithAccuracy(interruption.initialVelocity, -2, 0.05);
+}
+
+- (void)testInterruptingImplicitSpringsContinueWithTheCurrentVelocity {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  CALayer *layer = [[CALayer alloc] init];
+  layer.opacity = 0;
+  CAMediaTimingFunction *linear =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  MDMAnimationTraits *fadeIn = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:1
+                                                             timingCurve:linear];
+  [animator animateWithTraits:fadeIn animations:^{
+    layer.opacity = 1;
+  }];
+
+  // Halfway through the fade in, the opacity is 0.5 and increasing by 1 per second.
+  layer.timeOffset = 0.5;
+
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:20];
+  MDMAnimationTraits *fadeOut = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                 duration:0.5
+                                                              timingCurve:springCurve];
+  __block CASpringAnimation *interruption = nil;
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    interruption = (CASpringAnimation *)animation;
+  }];
+  [animator animateWithTraits:fadeOut animations:^{
+    layer.opacity = 0;
+  }];
+
+  XCTAssertTrue([interruption isKindOfClass:[CASpringAnimation class]]);
+  XCTAssertEqualWithAccuracy([interruption.fromValue doubleValue], 0.5, 0.01);
+  // Moving at 1 per second away from a destination that is 0.5 away.
+  XCTAssertEqualWithAccuracy(interruption.initialVelocity, -2, 0.05);
+}
+
+- (void)testInterruptionsReadFromThePresentationLayerOnceOthersReplaceRegisteredAnimations {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  CALayer *layer = [[CALayer alloc] init];
+  CAMediaTimingFunction *linear =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  MDMAnimationTraits *fadeIn = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:1
+                                                             timingCurve:linear];
+  [animator animateWithTraits:fadeIn between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  layer.timeOffset = 0.5;
+
+  // As happens when an animation of a batch finishes before the rest of the batch, the animation
+  // is no longer on the layer but remains registered. The layer has as many animations as before.
+  [layer removeAnimationForKey:layer.animationKeys.firstObject];
+  CABasicAnimation *foreign = [CABasicAnimation animationWithKeyPath:MDMKeyPathOpacity];
+  foreign.fromValue = @0;
+  foreign.toValue = @1;
+  foreign.duration = 1;
+  [layer addAnimation:foreign forKey:@"foreign"];
+
+  MDMSpringTimingCurve *springCurve =
+      [[MDMSpringTimingCurve alloc] initWithMass:1 tension:300 friction:20];
+  MDMAnimationTraits *fadeOut = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                 duration:0.5
+                                                              timingCurve:springCurve];
+  __block CASpringAnimation *interruption = nil;
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    interruption = (CASpringAnimation *)animation;
+  }];
+  [animator animateWithTraits:fadeOut between:@[ @1, @0 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  // Velocity is only known when the registered animations are evaluated.
+  XCTAssertTrue([interruption isKindOfClass:[CASpringAnimation class]]);
+  XCTAssertEqualWithAccuracy(interruption.initialVelocity, 0, 0.0001);
+}
+
+- (void)testInterruptingGeneratedSpringsKeepTheirGeneratedTiming {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  CALayer *layer = [[CALayer alloc] init];
+  CAMediaTimingFunction *linear =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear];
+  MDMAnimationTraits *fadeIn = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                duration:1
+                                                             timingCurve:linear];
+  [animator animateWithTraits:fadeIn between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  layer.timeOffset = 0.5;
+
+  MDMSpringTimingCurveGenerator *generator =
+      [[MDMSpringTimingCurveGenerator alloc] initWithDuration:0.5 dampingRatio:0.7];
+  MDMAnimationTraits *fadeOut = [[MDMAnimationTraits alloc] initWithDelay:0
+                                                                 duration:0.5
+                                                              timingCurve:generator];
+  __block CASpringAnimation *interruption = nil;
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    interruption = (CASpringAnimation *)animation;
+  }];
+  [animator animateWithTraits:fadeOut between:@[ @1, @0 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  XCTAssertTrue([interruption isKindOfClass:[CASpringAnimation class]]);
+  XCTAssertEqualWithAccuracy(interruption.initialVelocity, 0, 0.0001);
+  XCTAssertEqualWithAccuracy(interruption.duration, 0.5, 0.0001);
+}
+
+#pragma mark - Animation keys
+
+- (void)testGeneratedKeysAreReusedOnceTheirAnimationsAreRemoved {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  [animator animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  NSString *key = layer.animationKeys.firstObject;
+  [animator removeAllAnimations];
+  [animator animateWithTraits:traits between:@[ @1, @0 ] layer:layer keyPath:MDMKeyPathOpacity];
+
+  XCTAssertNotNil(key);
+  XCTAssertEqualObjects(layer.animationKeys, @[ key ]);
+}
+
+- (void)testAnimatorsSharingALayerDoNotReplaceEachOthersAnimations {
+  MDMMotionAnimator *first = [[MDMMotionAnimator alloc] init];
+  MDMMotionAnimator *second = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *layer = [[CALayer alloc] init];
+
+  [first animateWithTraits:traits between:@[ @0, @1 ] layer:layer keyPath:MDMKeyPathOpacity];
+  [second animateWithTraits:traits between:@[ @0, @4 ] layer:layer keyPath:MDMKeyPathCornerRadius];
+  XCTAssertEqual(layer.animationKeys.count, 2u);
+
+  // Removing one animator's animations leaves the other's in place.
+  [second removeAllAnimations];
+  XCTAssertEqual(layer.animationKeys.count, 1u);
+  CABasicAnimation *remaining =
+      (CABasicAnimation *)[layer animationForKey:layer.animationKeys.firstObject];
+  XCTAssertEqualObjects(remaining.keyPath, MDMKeyPathOpacity);
+  XCTAssertEqual([first currentMetrics].activeAnimationCount, 1u);
+}
+
+#pragma mark - Implicit animations
+
+- (void)testImplicitAnimationsStartedWhileAddingImplicitAnimationsUseTheirOwnActions {
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  CALayer *outerLayer = [[CALayer alloc] init];
+  CALayer *innerLayer = [[CALayer alloc] init];
+
+  NSMutableArray<NSString *> *tracedKeyPaths = [NSMutableArray array];
+  [animator addCoreAnimationTracer:^(CALayer *tracedLayer, CAAnimation *animation) {
+    NSString *keyPath = ((CABasicAnimation *)animation).keyPath;
+    [tracedKeyPaths addObject:[NSString stringWithFormat:@"%@.%@",
+                                  tracedLayer == outerLayer ? @"outer" : @"inner", keyPath]];
+    if (tracedLayer == outerLayer && [keyPath isEqualToString:MDMKeyPathOpacity]) {
+      [animator animateWithTraits:traits animations:^{
+        innerLayer.cornerRadius = 4;
+      }];
+    }
+  }];
+
+  [animator animateWithTraits:traits animations:^{
+    outerLayer.opacity = 0.5;
+    outerLayer.cornerRadius = 2;
+  }];
+  // A later block doesn't see the actions of earlier ones.
+  [animator animateWithTraits:traits animations:^{
+    innerLayer.opacity = 0.5;
+  }];
+
+  NSArray<NSString *> *expectedKeyPaths = @[ @"outer.opacity", @"inner.cornerRadius",
+                                             @"outer.cornerRadius", @"inner.opacity" ];
+  XCTAssertEqualObjects(tracedKeyPaths, expectedKeyPaths);
+  XCTAssertEqualWithAccuracy(innerLayer.cornerRadius, 4, 0.0001);
+  XCTAssertEqual(innerLayer.animationKeys.count, 2u);
+  XCTAssertEqual(outerLayer.animationKeys.count, 2u);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceOfPerCallSubmission {
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 500; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  [self measureBlock:^{
+    MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+    for (CALayer *layer in layers) {
+      [animator animateWithTraits:traits
+                          between:@[ @0, @1 ]
+                            layer:layer
+                          keyPath:MDMKeyPathOpacity];
+    }
+    [animator removeAllAnimations];
+  }];
+}
+
+- (void)testPerformanceOfRecordedSubmission {
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 500; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  [self measureBlock:^{
+    MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+    [animator recordAnimations:^{
+      for (CALayer *layer in layers) {
+        [animator animateWithTraits:traits
+                            between:@[ @0, @1 ]
+                              layer:layer
+                            keyPath:MDMKeyPathOpacity];
+      }
+    } completion:nil];
+    [animator removeAllAnimations];
+  }];
+}
+
+// Asserts that `animations`, which animates the opacity of each layer to `opacity`, allocates at
+// most kMaximumAnimatorAllocationsPerAnimation more per animation than Core Animation does to add
+// equivalent animations itself. Both are run beforehand so that they are measured in their steady
+// state.
+- (void)assertAllocationsPerAnimationOfAnimations:(void (^)(NSNumber *opacity))animations
+                                         toLayers:(NSArray<CALayer *> *)layers {
+  CABasicAnimation *prototype = [CABasicAnimation animation];
+  prototype.duration = 0.5;
+  prototype.timingFunction =
+      [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseInEaseOut];
+  void (^coreAnimation)(NSNumber *) = ^(NSNumber *opacity) {
+    for (CALayer *layer in layers) {
+      CABasicAnimation *animation = [prototype copy];
+      animation.keyPath = MDMKeyPathOpacity;
+      animation.fromValue = @(layer.opacity - opacity.floatValue);
+      animation.toValue = @0;
+      animation.additive = YES;
+      [layer addAnimation:animation forKey:MDMKeyPathOpacity];
+    }
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    for (CALayer *layer in layers) {
+      layer.opacity = opacity.floatValue;
+    }
+    [CATransaction commit];
+    for (CALayer *layer in layers) {
+      [layer removeAllAnimations];
+    }
+  };
+
+  NSArray<NSNumber *> *opacities = @[ @1, @0 ];
+  for (NSNumber *opacity in opacities) {
+    coreAnimation(opacity);
+    animations(opacity);
+  }
+  uint64_t coreAnimationCount = MainThreadAllocationCount(^{
+    for (NSNumber *opacity in opacities) {
+      coreAnimation(opacity);
+    }
+  });
+  uint64_t animatorCount = MainThreadAllocationCount(^{
+    for (NSNumber *opacity in opacities) {
+      animations(opacity);
+    }
+  });
+
+  double animationCount = (double)(layers.count * opacities.count);
+  double coreAnimationAllocations = (double)coreAnimationCount / animationCount;
+  double animatorAllocations = (double)animatorCount / animationCount;
+  XCTAssertLessThanOrEqual(animatorAllocations - coreAnimationAllocations,
+                           kMaximumAnimatorAllocationsPerAnimation,
+                           @"%.1f allocations per animation, of which Core Animation made %.1f.",
+                           animatorAllocations, coreAnimationAllocations);
+}
+
+- (void)testAllocationsOfRecordedSubmission {
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 500; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  NSArray *fadeIn = @[ @0, @1 ];
+  NSArray *fadeOut = @[ @1, @0 ];
+  // The animator is reused, so the measurements reflect its steady state.
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  [self assertAllocationsPerAnimationOfAnimations:^(NSNumber *opacity) {
+    NSArray *values = opacity.floatValue == 1 ? fadeIn : fadeOut;
+    [animator recordAnimations:^{
+      for (CALayer *layer in layers) {
+        [animator animateWithTraits:traits
+                            between:values
+                              layer:layer
+                            keyPath:MDMKeyPathOpacity];
+      }
+    } completion:nil];
+    [animator removeAllAnimations];
+  } toLayers:layers];
+}
+
+- (void)testAllocationsOfImplicitAnimations {
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 500; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  // The animator is reused, so the measurements reflect its steady state.
+  MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+  animator.beginFromCurrentState = YES;
+  [self assertAllocationsPerAnimationOfAnimations:^(NSNumber *opacity) {
+    [animator animateWithTraits:traits animations:^{
+      for (CALayer *layer in layers) {
+        layer.opacity = opacity.floatValue;
+      }
+    }];
+    [animator removeAllAnimations];
+  } toLayers:layers];
+}
+
+- (void)testPerformanceOfPerCallStaggering {
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  NSMutableArray<MDMAnimationTraits *> *traits = [NSMutableArray array];
+  for (NSInteger i = 0; i < 1000; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+    [traits addObject:[[MDMAnimationTraits alloc] initWithDelay:i * 0.01 duration:0.5]];
+  }
+  [self measureBlock:^{
+    MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+    for (NSUInteger i = 0; i < layers.count; ++i) {
+      [animator animateWithTraits:traits[i]
+                          between:@[ @0, @1 ]
+                            layer:layers[i]
+                          keyPath:MDMKeyPathOpacity];
+    }
+    [animator removeAllAnimations];
+  }];
+}
+
+- (void)testPerformanceOfStaggeredGroup {
+  NSMutableArray<CALayer *> *layers = [NSMutableArray array];
+  for (NSInteger i = 0; i < 1000; ++i) {
+    [layers addObject:[[CALayer alloc] init]];
+  }
+  MDMAnimationTraits *traits = [[MDMAnimationTraits alloc] initWithDuration:0.5];
+  MDMStagger *stagger = [MDMStagger linearStaggerWithInterval:0.01];
+  [self measureBlock:^{
+    MDMMotionAnimator *animator = [[MDMMotionAnimator alloc] init];
+    [animator animateWithTraits:traits
+                        stagger:stagger
+                        between:@[ @0, @1 ]
+                         layers:layers
+                        keyPath:MDMKeyPathOpacity
+                     completion:nil];
+    [animator removeAllAnimations];
+  }];
+}
+
 @end